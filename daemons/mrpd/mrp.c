@@ -379,9 +379,32 @@ int mrp_jointimer_stop(struct mrp_database *mrp_db)
 	return mrpd_timer_stop(mrp_db->join_timer);
 }
 
-int mrp_lvtimer_start(struct mrp_database *mrp_db)
+/*
+ * The leave timer of each attribute runs for MRP_LVTIMER_VAL, tracked in
+ * its registrar leave_time. One database timer is kept armed for the
+ * earliest of them, so a later attribute entering LV never postpones an
+ * earlier one.
+ */
+static int mrp_lvtimer_start_ms(struct mrp_database *mrp_db,
+				unsigned long timeout)
 {
 	int ret;
+	unsigned long expires = mrpd_now_ms() + timeout;
+
+	if (mrp_db->lv_timer_running &&
+	    (long)(expires - mrp_db->lv_timer_expires) >= 0)
+		return 0;
+
+	ret = mrpd_timer_start(mrp_db->lv_timer, timeout);
+	if (ret >= 0) {
+		mrp_db->lv_timer_running = 1;
+		mrp_db->lv_timer_expires = expires;
+	}
+	return ret;
+}
+
+int mrp_lvtimer_start(struct mrp_database *mrp_db)
+{
 	/* leavetimer has expired (10.7.5.21)
 	 * controls how long the Registrar state machine stays in the
 	 * LV state before transitioning to the MT state.
@@ -392,10 +415,7 @@ int mrp_lvtimer_start(struct mrp_database *mrp_db)
 	else
 		mrpd_log_printf("MRP start leave timer\n");
 #endif
-	ret = mrpd_timer_start(mrp_db->lv_timer, MRP_LVTIMER_VAL);
-	if (ret >= 0)
-		mrp_db->lv_timer_running = 1;
-	return ret;
+	return mrp_lvtimer_start_ms(mrp_db, MRP_LVTIMER_VAL);
 }
 
 int mrp_lvtimer_stop(struct mrp_database *mrp_db)
@@ -935,6 +955,7 @@ mrp_registrar_fsm(mrp_registrar_attribute_t * attrib,
 {
 	int mrp_state = attrib->mrp_state;
 	int notify = MRP_NOTIFY_NONE;
+	long remaining;
 
 	switch (event) {
 	case MRP_EVENT_BEGIN:
@@ -953,6 +974,7 @@ mrp_registrar_fsm(mrp_registrar_attribute_t * attrib,
 		 */
 		switch (mrp_state) {
 		case MRP_IN_STATE:
+			attrib->leave_time = mrpd_now_ms() + MRP_LVTIMER_VAL;
 			mrp_lvtimer_start(mrp_db);
 			mrp_state = MRP_LV_STATE;
 		default:
@@ -967,8 +989,8 @@ mrp_registrar_fsm(mrp_registrar_attribute_t * attrib,
 			mrp_state = MRP_IN_STATE;
 			break;
 		case MRP_LV_STATE:
-			/* should stop leavetimer - but we have only 1 lvtimer
-			 * for all attributes, and recieving a LVTIMER event
+			/* stops this attribute's leavetimer - the shared
+			 * database timer may still fire, but a LVTIMER event
 			 * is a don't-care if the attribute is in the IN state.
 			 */
 			mrp_state = MRP_IN_STATE;
@@ -988,8 +1010,8 @@ mrp_registrar_fsm(mrp_registrar_attribute_t * attrib,
 			mrp_state = MRP_IN_STATE;
 			break;
 		case MRP_LV_STATE:
-			/* should stop leavetimer - but we have only 1 lvtimer
-			 * for all attributes, and receiving a LVTIMER event
+			/* stops this attribute's leavetimer - the shared
+			 * database timer may still fire, but a LVTIMER event
 			 * is a don't-care if the attribute is in the IN state.
 			 */
 			notify = MRP_NOTIFY_JOIN;
@@ -1003,6 +1025,13 @@ mrp_registrar_fsm(mrp_registrar_attribute_t * attrib,
 	case MRP_EVENT_LVTIMER:
 		switch (mrp_state) {
 		case MRP_LV_STATE:
+			remaining = (long)(attrib->leave_time - mrpd_now_ms());
+			if (remaining > 0) {
+				/* this attribute's own leavetimer has not run
+				 * out yet, keep the database timer going */
+				mrp_lvtimer_start_ms(mrp_db, remaining);
+				break;
+			}
 			notify = MRP_NOTIFY_LV;
 			mrp_state = MRP_MT_STATE;
 			break;
@@ -61,6 +61,7 @@ typedef struct mrp_registrar_attribute {
 	int notify;
 	short rsvd;
 	unsigned char macaddr[6];	/* mac address of last registration */
+	unsigned long leave_time;	/* mrpd_now_ms() when LV expires */
 #ifdef LOG_MRP
 	int mrp_previous_state; /* for identifying state transitions for debug */
 #endif
@@ -198,6 +199,7 @@ struct mrp_database {
 	int join_timer_running;
 	HTIMER lv_timer;
 	int lv_timer_running;
+	unsigned long lv_timer_expires;
 	HTIMER lva_timer;
 	int lva_timer_running;
 	client_t *clients;
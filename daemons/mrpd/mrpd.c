@@ -62,6 +62,7 @@
 #include "mvrp.h"
 #include "msrp.h"
 #include "mmrp.h"
+#include "timer_wheel.h"
 
 static void mrpd_log_timer_event(char *src, int event);
 
@@ -113,43 +114,43 @@ extern struct mmrp_database *MMRP_db;
 extern struct mvrp_database *MVRP_db;
 extern struct msrp_database *MSRP_db;
 
+/*
+ * All mrpd timers live on one timer wheel, woken by a single timerfd that
+ * is re-armed only when the earliest pending expiry changes.
+ */
+static struct timer_wheel mrpd_timer_wheel;
+static int mrpd_timer_fd = -1;
+static uint64_t mrpd_timer_armed = TIMER_WHEEL_NEVER;
+
+unsigned long mrpd_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
 int mrpd_timer_create(void)
 {
-	int t = timerfd_create(CLOCK_MONOTONIC, 0);
-	if (-1 != t)
-		fcntl(t, F_SETFL, O_NONBLOCK);
-	return t;
+	return timer_wheel_create(&mrpd_timer_wheel);
 }
 
 void mrpd_timer_close(int t)
 {
 	if (-1 != t)
-		close(t);
+		timer_wheel_close(&mrpd_timer_wheel, t);
 }
 
 int mrpd_timer_start_interval(int timerfd,
 			      unsigned long value_ms, unsigned long interval_ms)
 {
-	int rc;
-	struct itimerspec itimerspec_new;
-	struct itimerspec itimerspec_old;
-	unsigned long ns_per_ms = 1000000;
-
-	memset(&itimerspec_new, 0, sizeof(itimerspec_new));
-	memset(&itimerspec_old, 0, sizeof(itimerspec_old));
-
-	if (interval_ms) {
-		itimerspec_new.it_interval.tv_sec = interval_ms / 1000;
-		itimerspec_new.it_interval.tv_nsec =
-		    (interval_ms % 1000) * ns_per_ms;
-	}
-
-	itimerspec_new.it_value.tv_sec = value_ms / 1000;
-	itimerspec_new.it_value.tv_nsec = (value_ms % 1000) * ns_per_ms;
+	if (-1 == timerfd)
+		return -1;
 
-	rc = timerfd_settime(timerfd, 0, &itimerspec_new, &itimerspec_old);
+	timer_wheel_start(&mrpd_timer_wheel, timerfd,
+			  (uint64_t)mrpd_now_ms() + value_ms, interval_ms);
 
-	return (rc);
+	return 0;
 }
 
 int mrpd_timer_start(int timerfd, unsigned long value_ms)
@@ -159,16 +160,65 @@ int mrpd_timer_start(int timerfd, unsigned long value_ms)
 
 int mrpd_timer_stop(int timerfd)
 {
-	int rc;
+	if (-1 == timerfd)
+		return -1;
+
+	timer_wheel_stop(&mrpd_timer_wheel, timerfd);
+
+	return 0;
+}
+
+static int mrpd_timer_expired(int timerfd)
+{
+	return timer_wheel_expired(&mrpd_timer_wheel, timerfd);
+}
+
+/* point the timerfd at the next time the wheel has work to do */
+static int mrpd_timer_arm(void)
+{
 	struct itimerspec itimerspec_new;
-	struct itimerspec itimerspec_old;
+	uint64_t next = timer_wheel_next(&mrpd_timer_wheel);
+
+	if (next == mrpd_timer_armed)
+		return 0;
 
 	memset(&itimerspec_new, 0, sizeof(itimerspec_new));
-	memset(&itimerspec_old, 0, sizeof(itimerspec_old));
+	if (TIMER_WHEEL_NEVER != next) {
+		/* an all-zero it_value would disarm the timer */
+		if (0 == next)
+			next = 1;
+		itimerspec_new.it_value.tv_sec = next / 1000;
+		itimerspec_new.it_value.tv_nsec = (next % 1000) * 1000000;
+	}
+	mrpd_timer_armed = next;
+
+	return timerfd_settime(mrpd_timer_fd, TFD_TIMER_ABSTIME,
+			       &itimerspec_new, NULL);
+}
 
-	rc = timerfd_settime(timerfd, 0, &itimerspec_new, &itimerspec_old);
+static void mrpd_timer_service(void)
+{
+	uint64_t expirations;
 
-	return (rc);
+	/* drain the wakeup; EAGAIN just means it had not fired */
+	if (read(mrpd_timer_fd, &expirations, sizeof(expirations)) < 0)
+		expirations = 0;
+	if (expirations)
+		mrpd_timer_armed = TIMER_WHEEL_NEVER;
+
+	timer_wheel_advance(&mrpd_timer_wheel, mrpd_now_ms());
+}
+
+int init_timer_wheel(void)
+{
+	timer_wheel_init(&mrpd_timer_wheel, mrpd_now_ms());
+
+	mrpd_timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
+	if (-1 == mrpd_timer_fd)
+		return -1;
+	fcntl(mrpd_timer_fd, F_SETFL, O_NONBLOCK);
+
+	return 0;
 }
 
 int gctimer_start()
@@ -562,23 +612,6 @@ int init_timers(void)
 	return -1;
 }
 
-int mrp_register_timers(struct mrp_database *mrp_db, fd_set * fds)
-{
-	int max_fd;
-
-	FD_SET(mrp_db->join_timer, fds);
-	FD_SET(mrp_db->lv_timer, fds);
-	FD_SET(mrp_db->lva_timer, fds);
-
-	max_fd = mrp_db->join_timer;
-	if (mrp_db->lv_timer > max_fd)
-		max_fd = mrp_db->lv_timer;
-	if (mrp_db->lva_timer > max_fd)
-		max_fd = mrp_db->lva_timer;
-
-	return max_fd;
-}
-
 int mrpd_reclaim()
 {
 
@@ -619,10 +652,6 @@ void process_events(void)
 
 		if (NULL == MMRP_db)
 			return;
-
-		rc = mrp_register_timers(&(MMRP_db->mrp_db), &fds);
-		if (rc > max_fd)
-			max_fd = rc;
 	}
 	if (mvrp_enable) {
 		FD_SET(mvrp_socket, &fds);
@@ -631,10 +660,6 @@ void process_events(void)
 
 		if (NULL == MVRP_db)
 			return;
-		rc = mrp_register_timers(&(MVRP_db->mrp_db), &fds);
-		if (rc > max_fd)
-			max_fd = rc;
-
 	}
 	if (msrp_enable) {
 		FD_SET(msrp_socket, &fds);
@@ -643,26 +668,19 @@ void process_events(void)
 
 		if (NULL == MSRP_db)
 			return;
-		rc = mrp_register_timers(&(MSRP_db->mrp_db), &fds);
-		if (rc > max_fd)
-			max_fd = rc;
-
 	}
 
-	FD_SET(periodic_timer, &fds);
-	if (periodic_timer > max_fd)
-		max_fd = periodic_timer;
+	FD_SET(mrpd_timer_fd, &fds);
+	if (mrpd_timer_fd > max_fd)
+		max_fd = mrpd_timer_fd;
 
 	rc = mrp_periodictimer_fsm(&mrp_periodic_state, MRP_EVENT_BEGIN);
 	if (rc)
 		return;
 
-	FD_SET(gc_timer, &fds);
-	if (gc_timer > max_fd)
-		max_fd = gc_timer;
-
 	do {
 
+		mrpd_timer_arm();
 		sel_fds = fds;
 		rc = select(max_fd + 1, &sel_fds, NULL, NULL, NULL);
 
@@ -673,6 +691,8 @@ void process_events(void)
 			return;	/* exit on error */
 		}
 		else {
+			mrpd_timer_service();
+
 			if (FD_ISSET(control_socket, &sel_fds)) {
 #if LOG_POLL_EVENTS
 				mrpd_log_printf("== EVENT recv_ctl_msg ==\n");
@@ -687,20 +707,17 @@ void process_events(void)
 #endif
 					mmrp_recv_msg();
 					}
-				if FD_ISSET
-					(MMRP_db->mrp_db.lva_timer, &sel_fds) {
+				if (mrpd_timer_expired(MMRP_db->mrp_db.lva_timer)) {
 					mrpd_log_timer_event("MMRP",
 							     MRP_EVENT_LVATIMER);
 					mmrp_event(MRP_EVENT_LVATIMER, NULL);
 					}
-				if FD_ISSET
-					(MMRP_db->mrp_db.lv_timer, &sel_fds) {
+				if (mrpd_timer_expired(MMRP_db->mrp_db.lv_timer)) {
 					mrpd_log_timer_event("MMRP",
 							     MRP_EVENT_LVTIMER);
 					mmrp_event(MRP_EVENT_LVTIMER, NULL);
 					}
-				if FD_ISSET
-					(MMRP_db->mrp_db.join_timer, &sel_fds) {
+				if (mrpd_timer_expired(MMRP_db->mrp_db.join_timer)) {
 					mrpd_log_timer_event("MMRP",
 							     MRP_EVENT_TX);
 					mmrp_event(MRP_EVENT_TX, NULL);
@@ -714,20 +731,17 @@ void process_events(void)
 #endif
 					mvrp_recv_msg();
 					}
-				if FD_ISSET
-					(MVRP_db->mrp_db.lva_timer, &sel_fds) {
+				if (mrpd_timer_expired(MVRP_db->mrp_db.lva_timer)) {
 					mrpd_log_timer_event("MVRP",
 							     MRP_EVENT_LVATIMER);
 					mvrp_event(MRP_EVENT_LVATIMER, NULL);
 					}
-				if FD_ISSET
-					(MVRP_db->mrp_db.lv_timer, &sel_fds) {
+				if (mrpd_timer_expired(MVRP_db->mrp_db.lv_timer)) {
 					mrpd_log_timer_event("MVRP",
 							     MRP_EVENT_LVTIMER);
 					mvrp_event(MRP_EVENT_LVTIMER, NULL);
 					}
-				if FD_ISSET
-					(MVRP_db->mrp_db.join_timer, &sel_fds) {
+				if (mrpd_timer_expired(MVRP_db->mrp_db.join_timer)) {
 					mrpd_log_timer_event("MVRP",
 							     MRP_EVENT_TX);
 					mvrp_event(MRP_EVENT_TX, NULL);
@@ -741,26 +755,23 @@ void process_events(void)
 #endif
 					msrp_recv_msg();
 				}
-				if FD_ISSET
-					(MSRP_db->mrp_db.lva_timer, &sel_fds) {
+				if (mrpd_timer_expired(MSRP_db->mrp_db.lva_timer)) {
 					mrpd_log_timer_event("MSRP",
 							     MRP_EVENT_LVATIMER);
 					msrp_event(MRP_EVENT_LVATIMER, NULL);
 					}
-				if FD_ISSET
-					(MSRP_db->mrp_db.lv_timer, &sel_fds) {
+				if (mrpd_timer_expired(MSRP_db->mrp_db.lv_timer)) {
 					mrpd_log_timer_event("MSRP",
 							     MRP_EVENT_LVTIMER);
 					msrp_event(MRP_EVENT_LVTIMER, NULL);
 					}
-				if FD_ISSET
-					(MSRP_db->mrp_db.join_timer, &sel_fds) {
+				if (mrpd_timer_expired(MSRP_db->mrp_db.join_timer)) {
 					mrpd_log_timer_event("MSRP",
 							     MRP_EVENT_TX);
 					msrp_event(MRP_EVENT_TX, NULL);
 					}
 			}
-			if (FD_ISSET(periodic_timer, &sel_fds)) {
+			if (mrpd_timer_expired(periodic_timer)) {
 #if LOG_POLL_EVENTS && LOG_TIMERS
 				mrpd_log_printf("== EVENT periodic_timer ==\n");
 #endif
@@ -776,7 +787,7 @@ void process_events(void)
 					msrp_event(MRP_EVENT_PERIODIC, NULL);
 				}
 			}
-			if (FD_ISSET(gc_timer, &sel_fds)) {
+			if (mrpd_timer_expired(gc_timer)) {
 				mrpd_reclaim();
 			}
 #if LOG_POLL_EVENTS
@@ -887,6 +898,12 @@ int main(int argc, char *argv[])
 	if (rc)
 		goto out;
 
+	rc = init_timer_wheel();
+	if (rc) {
+		printf("init_timer_wheel failed\n");
+		goto out;
+	}
+
 	rc = init_local_ctl();
 	if (rc)
 		goto out;
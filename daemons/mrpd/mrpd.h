@@ -126,6 +126,7 @@ struct mrp_database;
 int mrpd_init_timers(struct mrp_database *mrp_db);
 int mrpd_timer_start(HTIMER timerfd, unsigned long value_ms);
 int mrpd_timer_stop(HTIMER timerfd);
+unsigned long mrpd_now_ms(void);
 int mrpd_send_ctl_msg(struct sockaddr_in *client_addr, char *notify_data,
 		      int notify_len);
 int mrpd_init_protocol_socket(uint16_t etype, SOCKET * sock,
@@ -346,6 +346,11 @@ unsigned int clock_monotonic_in_ms(void)
 			      (double)clock_monotonic_freq.QuadPart);
 }
 
+unsigned long mrpd_now_ms(void)
+{
+	return clock_monotonic_in_ms();
+}
+
 HTIMER mrpd_timer_create(void)
 {
 	return (struct wtimer *)calloc(1, sizeof(struct wtimer));
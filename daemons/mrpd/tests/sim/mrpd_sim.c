@@ -0,0 +1,615 @@
+/*
+ * mrpd network simulator
+ *
+ * Runs many MRP participants in one process on a simulated shared
+ * segment and measures how long their MSRP (and optionally MVRP and MMRP)
+ * registrations take to converge, together with the CPU, memory and PDU
+ * cost of getting there. Time is simulated, so a run covering minutes of
+ * protocol activity finishes in however long the protocol code takes to
+ * execute, which makes the numbers usable as a benchmark.
+ *
+ * Stream k is advertised by station (k % nodes) and listened to by the
+ * next -l stations. The run has converged when every listener has
+ * registered the talker advertisement of each stream it listens to, every
+ * talker has registered a listener for each of its streams, and, when
+ * enabled, every station has registered the VLAN and the MAC addresses
+ * declared by all the others.
+ *
+ * The exit code is non-zero when the run does not converge, or when -T is
+ * given and convergence took longer than that, so the simulator can be
+ * used as a regression check.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "mrpd_sim.h"
+#include "msrp.h"
+#include "mvrp.h"
+#include "mmrp.h"
+
+extern struct msrp_database *MSRP_db;
+extern struct mvrp_database *MVRP_db;
+extern struct mmrp_database *MMRP_db;
+
+#define SIM_VLAN		2
+#define SIM_CLIENT_PORT		7500
+
+/* declarations other than streams; streams use 2k (talker), 2k+1 (listener) */
+#define SIM_DECLARE_DOMAIN	-1
+#define SIM_DECLARE_VLAN	-2
+#define SIM_DECLARE_MAC		-3
+
+struct sim sim;
+
+static unsigned long long rng_state;
+
+/*
+ * Simulator infrastructure
+ */
+
+unsigned long sim_random(unsigned long range)
+{
+	/* xorshift64*, so runs do not depend on the libc random() sequence
+	 * the protocol code itself draws from */
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return (unsigned long)((rng_state * 2685821657736338717ULL) >> 33) %
+	    range;
+}
+
+static int sim_event_before(const struct sim_event *a,
+			    const struct sim_event *b)
+{
+	if (a->time_ms != b->time_ms)
+		return a->time_ms < b->time_ms;
+	return a->seq < b->seq;
+}
+
+void sim_schedule(enum sim_event_type type, unsigned long long time_ms,
+		  int node, int arg, unsigned int generation,
+		  struct sim_frame *frame)
+{
+	struct sim_event ev;
+	unsigned long i;
+
+	if (sim.event_count == sim.event_size) {
+		unsigned long size = sim.event_size ? sim.event_size * 2 : 1024;
+		struct sim_event *events;
+
+		events = realloc(sim.events, size * sizeof *events);
+		if (NULL == events) {
+			fprintf(stderr, "out of memory for %lu events\n", size);
+			exit(2);
+		}
+		sim.events = events;
+		sim.event_size = size;
+	}
+
+	ev.time_ms = time_ms;
+	ev.seq = sim.event_seq++;
+	ev.type = type;
+	ev.node = node;
+	ev.arg = arg;
+	ev.generation = generation;
+	ev.frame = frame;
+
+	i = sim.event_count++;
+	while (i > 0) {
+		unsigned long parent = (i - 1) / 2;
+
+		if (!sim_event_before(&ev, &sim.events[parent]))
+			break;
+		sim.events[i] = sim.events[parent];
+		i = parent;
+	}
+	sim.events[i] = ev;
+
+	if (sim.event_count > sim.stats.max_queue)
+		sim.stats.max_queue = sim.event_count;
+}
+
+static void sim_pop(struct sim_event *out)
+{
+	struct sim_event last;
+	unsigned long i = 0;
+
+	*out = sim.events[0];
+	last = sim.events[--sim.event_count];
+
+	for (;;) {
+		unsigned long child = 2 * i + 1;
+
+		if (child >= sim.event_count)
+			break;
+		if (child + 1 < sim.event_count &&
+		    sim_event_before(&sim.events[child + 1], &sim.events[child]))
+			child++;
+		if (!sim_event_before(&sim.events[child], &last))
+			break;
+		sim.events[i] = sim.events[child];
+		i = child;
+	}
+	sim.events[i] = last;
+}
+
+void sim_frame_put(struct sim_frame *frame)
+{
+	if (--frame->refs == 0)
+		free(frame);
+}
+
+/*
+ * Scenario
+ */
+
+static void sim_stream_id(int stream, unsigned char id[8])
+{
+	int talker = stream % sim.cfg.nodes;
+
+	memcpy(id, sim.nodes[talker].station_addr, 6);
+	id[6] = (stream >> 8) & 0xff;
+	id[7] = stream & 0xff;
+}
+
+static int sim_stream_from_id(const unsigned char id[8])
+{
+	return (id[6] << 8) | id[7];
+}
+
+static int sim_listener_count(void)
+{
+	if (sim.cfg.listeners_per_stream > sim.cfg.nodes - 1)
+		return sim.cfg.nodes - 1;
+	return sim.cfg.listeners_per_stream;
+}
+
+static int sim_is_listener(int node, int stream)
+{
+	int talker = stream % sim.cfg.nodes;
+	int dist = (node - talker + sim.cfg.nodes) % sim.cfg.nodes;
+
+	return dist >= 1 && dist <= sim_listener_count();
+}
+
+static void sim_declare(int node, int what)
+{
+	struct sockaddr_in client;
+	char cmd[128];
+	unsigned char id[8];
+	int stream = what / 2;
+	int len;
+
+	sim_switch_node(node);
+
+	/* one client per station, as if one application were attached */
+	memset(&client, 0, sizeof client);
+	client.sin_family = AF_INET;
+	client.sin_port = htons(SIM_CLIENT_PORT);
+	client.sin_addr.s_addr = htonl(0x7f000001);
+
+	switch (what) {
+	case SIM_DECLARE_DOMAIN:
+		len = snprintf(cmd, sizeof cmd, "S+D:C=%d,P=%d,V=%04x",
+			       MSRP_SR_CLASS_A, MSRP_SR_CLASS_A_PRIO, SIM_VLAN);
+		msrp_recv_cmd(cmd, len + 1, &client);
+		return;
+	case SIM_DECLARE_VLAN:
+		len = snprintf(cmd, sizeof cmd, "V++:I=%04x", SIM_VLAN);
+		mvrp_recv_cmd(cmd, len + 1, &client);
+		return;
+	case SIM_DECLARE_MAC:
+		len = snprintf(cmd, sizeof cmd,
+			       "M++:M=%02x%02x%02x%02x%02x%02x",
+			       STATION_ADDR[0], STATION_ADDR[1], STATION_ADDR[2],
+			       STATION_ADDR[3], STATION_ADDR[4], STATION_ADDR[5]);
+		mmrp_recv_cmd(cmd, len + 1, &client);
+		return;
+	}
+
+	sim_stream_id(stream, id);
+	if (what & 1) {
+		len = snprintf(cmd, sizeof cmd,
+			       "S+L:L=%02x%02x%02x%02x%02x%02x%02x%02x,D=2",
+			       id[0], id[1], id[2], id[3],
+			       id[4], id[5], id[6], id[7]);
+	} else {
+		len = snprintf(cmd, sizeof cmd,
+			       "S++:S=%02x%02x%02x%02x%02x%02x%02x%02x,"
+			       "A=91e0f000%02x%02x,V=%04x,Z=576,I=8000,P=96,L=1000",
+			       id[0], id[1], id[2], id[3],
+			       id[4], id[5], id[6], id[7],
+			       (stream >> 8) & 0xff, stream & 0xff, SIM_VLAN);
+	}
+	msrp_recv_cmd(cmd, len + 1, &client);
+}
+
+static unsigned long long sim_arrival(void)
+{
+	if (0 == sim.cfg.arrival_ms)
+		return 0;
+	return sim_random(sim.cfg.arrival_ms + 1);
+}
+
+static int sim_setup(void)
+{
+	int i, k;
+
+	sim.nodes = calloc(sim.cfg.nodes, sizeof *sim.nodes);
+	if (NULL == sim.nodes)
+		return -1;
+
+	/* p2pmac stays 0, the segment is shared */
+	for (i = 0; i < sim.cfg.nodes; i++) {
+		struct sim_node *n = &sim.nodes[i];
+
+		n->index = i;
+		n->station_addr[0] = 0x02;	/* locally administered */
+		n->station_addr[3] = (i >> 16) & 0xff;
+		n->station_addr[4] = (i >> 8) & 0xff;
+		n->station_addr[5] = i & 0xff;
+
+		sim.cur = -1;
+		sim_switch_node(i);
+		n->periodic_timer = mrpd_timer_create();
+
+		if (msrp_init(1, sim.cfg.streams, 0) < 0 ||
+		    mvrp_init(sim.cfg.mvrp) < 0 || mmrp_init(sim.cfg.mmrp) < 0)
+			return -1;
+		n->msrp_db = MSRP_db;
+		n->mvrp_db = MVRP_db;
+		n->mmrp_db = MMRP_db;
+
+		n->periodic_state.state = 0;
+		mrp_periodictimer_fsm(&n->periodic_state, MRP_EVENT_BEGIN);
+
+		sim_schedule(SIM_EVENT_DECLARE, 0, i, SIM_DECLARE_DOMAIN, 0, NULL);
+		if (sim.cfg.mvrp) {
+			sim_schedule(SIM_EVENT_DECLARE, sim_arrival(), i,
+				     SIM_DECLARE_VLAN, 0, NULL);
+			n->expect_vlans = sim.cfg.nodes > 1;
+		}
+		if (sim.cfg.mmrp) {
+			sim_schedule(SIM_EVENT_DECLARE, sim_arrival(), i,
+				     SIM_DECLARE_MAC, 0, NULL);
+			n->expect_macs = sim.cfg.nodes - 1;
+		}
+	}
+
+	for (k = 0; k < sim.cfg.streams; k++) {
+		int talker = k % sim.cfg.nodes;
+
+		sim_schedule(SIM_EVENT_DECLARE, sim_arrival(), talker, 2 * k,
+			     0, NULL);
+		if (sim_listener_count())
+			sim.nodes[talker].expect_listeners++;
+
+		for (i = 0; i < sim.cfg.nodes; i++) {
+			if (!sim_is_listener(i, k))
+				continue;
+			sim_schedule(SIM_EVENT_DECLARE, sim_arrival(), i,
+				     2 * k + 1, 0, NULL);
+			sim.nodes[i].expect_talkers++;
+		}
+	}
+
+	return 0;
+}
+
+static int sim_node_converged(struct sim_node *n)
+{
+	struct msrp_attribute *sattrib;
+	struct mvrp_attribute *vattrib;
+	struct mmrp_attribute *mattrib;
+	int talkers = 0, listeners = 0, vlans = 0, macs = 0;
+
+	for (sattrib = n->msrp_db->attrib_list; sattrib;
+	     sattrib = sattrib->next) {
+		int stream;
+
+		if (sattrib->registrar.mrp_state != MRP_IN_STATE)
+			continue;
+		stream = sim_stream_from_id(sattrib->attribute.talk_listen.StreamID);
+		if (stream >= sim.cfg.streams)
+			continue;
+		if (MSRP_TALKER_ADV_TYPE == sattrib->type &&
+		    sim_is_listener(n->index, stream))
+			talkers++;
+		else if (MSRP_LISTENER_TYPE == sattrib->type &&
+			 stream % sim.cfg.nodes == n->index)
+			listeners++;
+	}
+	if (talkers < n->expect_talkers || listeners < n->expect_listeners)
+		return 0;
+
+	if (n->mvrp_db) {
+		for (vattrib = n->mvrp_db->attrib_list; vattrib;
+		     vattrib = vattrib->next) {
+			if (SIM_VLAN == vattrib->attribute &&
+			    vattrib->registrar.mrp_state == MRP_IN_STATE)
+				vlans++;
+		}
+		if (vlans < n->expect_vlans)
+			return 0;
+	}
+
+	if (n->mmrp_db) {
+		for (mattrib = n->mmrp_db->attrib_list; mattrib;
+		     mattrib = mattrib->next) {
+			if (MMRP_MACVEC_TYPE == mattrib->type &&
+			    mattrib->registrar.mrp_state == MRP_IN_STATE)
+				macs++;
+		}
+		if (macs < n->expect_macs)
+			return 0;
+	}
+
+	return 1;
+}
+
+static int sim_converged(void)
+{
+	int i;
+
+	for (i = 0; i < sim.cfg.nodes; i++) {
+		if (!sim_node_converged(&sim.nodes[i]))
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Run the event loop until everything has converged or the simulated
+ * time limit is reached. Returns the convergence time in ms, or -1.
+ */
+static long long sim_run(void)
+{
+	unsigned long long next_check = sim.cfg.check_ms;
+	struct sim_event ev;
+
+	while (sim.event_count) {
+		sim_pop(&ev);
+
+		while (ev.time_ms >= next_check &&
+		       next_check <= sim.cfg.max_time_ms) {
+			sim.now_ms = next_check;
+			if (sim_converged())
+				return (long long)next_check;
+			next_check += sim.cfg.check_ms;
+		}
+		if (ev.time_ms > sim.cfg.max_time_ms) {
+			sim.now_ms = sim.cfg.max_time_ms;
+			break;
+		}
+		sim.now_ms = ev.time_ms;
+
+		switch (ev.type) {
+		case SIM_EVENT_TIMER:
+			if (sim.timers[ev.arg].in_use &&
+			    sim.timers[ev.arg].generation == ev.generation)
+				sim_timer_fire(ev.arg);
+			break;
+		case SIM_EVENT_DELIVER:
+			sim_switch_node(ev.node);
+			sim.rx_frame = ev.frame;
+			sim.stats.pdus_delivered++;
+			switch (ntohs(((eth_hdr_t *)ev.frame->data)->typelen)) {
+			case MSRP_ETYPE:
+				if (MSRP_db)
+					msrp_recv_msg();
+				break;
+			case MVRP_ETYPE:
+				if (MVRP_db)
+					mvrp_recv_msg();
+				break;
+			case MMRP_ETYPE:
+				if (MMRP_db)
+					mmrp_recv_msg();
+				break;
+			}
+			sim.rx_frame = NULL;
+			sim_frame_put(ev.frame);
+			break;
+		case SIM_EVENT_DECLARE:
+			sim_declare(ev.node, ev.arg);
+			break;
+		}
+	}
+
+	return -1;
+}
+
+static void sim_teardown(void)
+{
+	struct sim_event ev;
+
+	while (sim.event_count) {
+		sim_pop(&ev);
+		if (SIM_EVENT_DELIVER == ev.type)
+			sim_frame_put(ev.frame);
+	}
+	free(sim.events);
+	free(sim.timers);
+	free(sim.nodes);
+}
+
+static double sim_timeval_s(const struct timeval *tv)
+{
+	return tv->tv_sec + tv->tv_usec / 1000000.0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"\n"
+		"usage: mrpd_sim [-hvcVM] [-n nodes] [-s streams] [-l listeners]\n"
+		"                [-p loss] [-d delay] [-j jitter] [-a arrival]\n"
+		"                [-t time] [-T limit] [-r seed]\n"
+		"\n"
+		"options:\n"
+		"    -h  show this message\n"
+		"    -n  number of stations on the segment (default 16)\n"
+		"    -s  number of streams (default 64)\n"
+		"    -l  listeners per stream (default 2)\n"
+		"    -V  also declare a VLAN on every station (MVRP)\n"
+		"    -M  also declare a MAC address on every station (MMRP)\n"
+		"    -p  PDU loss in percent (default 0)\n"
+		"    -d  PDU delay in ms (default 0)\n"
+		"    -j  additional random PDU delay in ms (default 0)\n"
+		"    -a  spread declarations over this many ms (default 0)\n"
+		"    -t  simulated time limit in seconds (default 60)\n"
+		"    -T  fail if convergence takes longer than this many ms\n"
+		"    -r  random seed (default 1)\n"
+		"    -c  print results as a CSV line\n"
+		"    -v  print the mrpd log\n"
+		"\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	struct rusage ru_start, ru_end;
+	struct timespec wall_start, wall_end;
+	double cpu_s, wall_s;
+	long long converged_ms;
+	int c;
+
+	sim.cfg.nodes = 16;
+	sim.cfg.streams = 64;
+	sim.cfg.listeners_per_stream = 2;
+	sim.cfg.max_time_ms = 60 * 1000;
+	sim.cfg.check_ms = 10;
+	sim.cfg.seed = 1;
+
+	for (;;) {
+		c = getopt(argc, argv, "hn:s:l:VMp:d:j:a:t:T:r:cv");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'n':
+			sim.cfg.nodes = atoi(optarg);
+			break;
+		case 's':
+			sim.cfg.streams = atoi(optarg);
+			break;
+		case 'l':
+			sim.cfg.listeners_per_stream = atoi(optarg);
+			break;
+		case 'V':
+			sim.cfg.mvrp = 1;
+			break;
+		case 'M':
+			sim.cfg.mmrp = 1;
+			break;
+		case 'p':
+			sim.cfg.loss = atof(optarg);
+			break;
+		case 'd':
+			sim.cfg.delay_ms = strtoul(optarg, NULL, 0);
+			break;
+		case 'j':
+			sim.cfg.jitter_ms = strtoul(optarg, NULL, 0);
+			break;
+		case 'a':
+			sim.cfg.arrival_ms = strtoul(optarg, NULL, 0);
+			break;
+		case 't':
+			sim.cfg.max_time_ms = strtoul(optarg, NULL, 0) * 1000;
+			break;
+		case 'T':
+			sim.cfg.limit_ms = strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			sim.cfg.seed = strtoul(optarg, NULL, 0);
+			break;
+		case 'c':
+			sim.cfg.csv = 1;
+			break;
+		case 'v':
+			sim.cfg.verbose++;
+			break;
+		case 'h':
+		default:
+			usage();
+		}
+	}
+	if (optind < argc || sim.cfg.nodes < 1 || sim.cfg.streams < 0 ||
+	    sim.cfg.streams > 0xffff || sim.cfg.listeners_per_stream < 0 ||
+	    sim.cfg.loss < 0.0 || sim.cfg.loss > 100.0)
+		usage();
+
+	rng_state = 0x9e3779b97f4a7c15ULL ^ sim.cfg.seed;
+	srandom(sim.cfg.seed);
+
+	getrusage(RUSAGE_SELF, &ru_start);
+	clock_gettime(CLOCK_MONOTONIC, &wall_start);
+
+	if (sim_setup() < 0) {
+		fprintf(stderr, "failed to set up %d stations\n", sim.cfg.nodes);
+		return 2;
+	}
+	converged_ms = sim_run();
+
+	clock_gettime(CLOCK_MONOTONIC, &wall_end);
+	getrusage(RUSAGE_SELF, &ru_end);
+
+	cpu_s = sim_timeval_s(&ru_end.ru_utime) -
+	    sim_timeval_s(&ru_start.ru_utime) +
+	    sim_timeval_s(&ru_end.ru_stime) - sim_timeval_s(&ru_start.ru_stime);
+	wall_s = (wall_end.tv_sec - wall_start.tv_sec) +
+	    (wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+
+	if (sim.cfg.csv) {
+		printf("nodes,streams,listeners,loss,delay_ms,jitter_ms,seed,"
+		       "converged_ms,sim_ms,wall_s,cpu_s,pdus_sent,"
+		       "pdus_delivered,pdus_lost,pdu_bytes,timer_events,"
+		       "ctl_msgs,max_queue,max_rss_kb\n");
+		printf("%d,%d,%d,%g,%lu,%lu,%u,%lld,%llu,%.6f,%.6f,%lu,%lu,%lu,"
+		       "%lu,%lu,%lu,%lu,%ld\n",
+		       sim.cfg.nodes, sim.cfg.streams, sim_listener_count(),
+		       sim.cfg.loss, sim.cfg.delay_ms, sim.cfg.jitter_ms,
+		       sim.cfg.seed, converged_ms, sim.now_ms, wall_s, cpu_s,
+		       sim.stats.pdus_sent, sim.stats.pdus_delivered,
+		       sim.stats.pdus_lost, sim.stats.pdu_bytes,
+		       sim.stats.timer_events, sim.stats.ctl_msgs,
+		       sim.stats.max_queue, ru_end.ru_maxrss);
+	} else {
+		printf("stations %d, streams %d, listeners/stream %d, "
+		       "loss %g%%, delay %lu+%lu ms, seed %u\n",
+		       sim.cfg.nodes, sim.cfg.streams, sim_listener_count(),
+		       sim.cfg.loss, sim.cfg.delay_ms, sim.cfg.jitter_ms,
+		       sim.cfg.seed);
+		if (converged_ms >= 0)
+			printf("converged after %lld ms simulated\n",
+			       converged_ms);
+		else
+			printf("NOT converged after %llu ms simulated\n",
+			       sim.now_ms);
+		printf("wall %.3f s, cpu %.3f s, max rss %ld kB\n",
+		       wall_s, cpu_s, ru_end.ru_maxrss);
+		printf("PDUs sent %lu (%lu bytes), delivered %lu, lost %lu\n",
+		       sim.stats.pdus_sent, sim.stats.pdu_bytes,
+		       sim.stats.pdus_delivered, sim.stats.pdus_lost);
+		printf("timer events %lu, client notifications %lu, "
+		       "max queued events %lu\n",
+		       sim.stats.timer_events, sim.stats.ctl_msgs,
+		       sim.stats.max_queue);
+		if (cpu_s > 0.0)
+			printf("%.0f PDUs delivered per cpu second\n",
+			       sim.stats.pdus_delivered / cpu_s);
+	}
+
+	sim_teardown();
+
+	if (converged_ms < 0)
+		return 1;
+	if (sim.cfg.limit_ms && converged_ms > (long long)sim.cfg.limit_ms)
+		return 1;
+	return 0;
+}
@@ -0,0 +1,160 @@
+#ifndef GUARD_MRPD_SIM_H
+#define GUARD_MRPD_SIM_H
+
+/*
+ * In-process network simulator for mrpd.
+ *
+ * Every simulated station runs its own copy of the MSRP, MVRP and MMRP
+ * databases. mrpd keeps those in globals, so the simulator swaps them in
+ * before it hands an event to a station. PDUs are exchanged through
+ * memory on a shared segment, with configurable loss and delay, and
+ * mrpd's timers run on a simulated millisecond clock.
+ *
+ * See sim_doubles.c for the mrpd platform functions routed into the
+ * simulator and mrpd_sim.c for the scenario and the measurements.
+ */
+
+#define MRP_CPPUTEST 1
+
+#include "mrpd.h"
+#include "mrp.h"
+
+struct msrp_database;
+struct mvrp_database;
+struct mmrp_database;
+
+/**
+ * One simulated station.
+ */
+struct sim_node {
+	int index;
+	unsigned char station_addr[6];
+
+	/* the mrpd globals while this station runs */
+	struct msrp_database *msrp_db;
+	struct mvrp_database *mvrp_db;
+	struct mmrp_database *mmrp_db;
+
+	HTIMER periodic_timer;
+	struct mrp_periodictimer_state periodic_state;
+
+	/* MSRP registrations the scenario waits for */
+	int expect_talkers;
+	int expect_listeners;
+	int expect_vlans;
+	int expect_macs;
+};
+
+/**
+ * A simulated mrpd timer.
+ */
+struct sim_timer {
+	int in_use;
+	int node;
+	/* bumped on every start and stop; queued expiries of older
+	 * generations are ignored */
+	unsigned int generation;
+	unsigned long interval_ms;
+};
+
+/**
+ * A PDU in flight, shared by all its deliveries.
+ */
+struct sim_frame {
+	int refs;
+	int src;
+	size_t len;
+	unsigned char data[];
+};
+
+enum sim_event_type {
+	SIM_EVENT_TIMER,
+	SIM_EVENT_DELIVER,
+	SIM_EVENT_DECLARE,
+};
+
+struct sim_event {
+	unsigned long long time_ms;
+	unsigned long long seq;
+	enum sim_event_type type;
+	int node;
+	int arg;
+	unsigned int generation;
+	struct sim_frame *frame;
+};
+
+/**
+ * Network and scenario parameters.
+ */
+struct sim_config {
+	int nodes;
+	int streams;
+	int listeners_per_stream;
+	int mvrp;
+	int mmrp;
+	double loss;
+	unsigned long delay_ms;
+	unsigned long jitter_ms;
+	unsigned long arrival_ms;
+	unsigned long max_time_ms;
+	unsigned long check_ms;
+	unsigned long limit_ms;
+	unsigned int seed;
+	int verbose;
+	int csv;
+};
+
+/**
+ * Counters collected while the simulation runs.
+ */
+struct sim_stats {
+	unsigned long pdus_sent;
+	unsigned long pdus_delivered;
+	unsigned long pdus_lost;
+	unsigned long pdu_bytes;
+	unsigned long timer_events;
+	unsigned long ctl_msgs;
+	unsigned long max_queue;
+};
+
+struct sim {
+	struct sim_config cfg;
+	struct sim_stats stats;
+
+	struct sim_node *nodes;
+	/* station whose databases are currently in the mrpd globals */
+	int cur;
+
+	struct sim_timer *timers;
+	int timer_count;
+
+	/* event queue, a binary heap ordered by time then sequence */
+	struct sim_event *events;
+	unsigned long event_count;
+	unsigned long event_size;
+	unsigned long long event_seq;
+	unsigned long long now_ms;
+
+	/* frame being received by msrp/mvrp/mmrp_recv_msg */
+	struct sim_frame *rx_frame;
+};
+
+extern struct sim sim;
+extern unsigned char STATION_ADDR[];
+
+/* sim_doubles.c */
+HTIMER mrpd_timer_create(void);
+void mrpd_timer_close(HTIMER t);
+int mrpd_timer_start_interval(HTIMER timerfd,
+			      unsigned long value_ms, unsigned long interval_ms);
+void sim_switch_node(int node);
+void sim_timer_fire(int timer);
+
+/* mrpd_sim.c */
+void sim_schedule(enum sim_event_type type, unsigned long long time_ms,
+		  int node, int arg, unsigned int generation,
+		  struct sim_frame *frame);
+void sim_frame_put(struct sim_frame *frame);
+unsigned long sim_random(unsigned long range);
+
+#endif
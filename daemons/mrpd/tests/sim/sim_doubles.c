@@ -0,0 +1,302 @@
+/*
+ * mrpd platform functions for the network simulator.
+ *
+ * These take the place of the timerfd, raw socket and control socket
+ * code in mrpd.c. Timers become events on the simulated clock, sent PDUs
+ * are delivered to the other stations on the segment, and client
+ * notifications are only counted.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "mrpd_sim.h"
+#include "msrp.h"
+#include "mvrp.h"
+#include "mmrp.h"
+
+extern SOCKET msrp_socket;
+extern SOCKET mvrp_socket;
+extern SOCKET mmrp_socket;
+extern struct msrp_database *MSRP_db;
+extern struct mvrp_database *MVRP_db;
+extern struct mmrp_database *MMRP_db;
+
+extern int msrp_event_orig(int event, struct msrp_attribute *rattrib);
+
+unsigned char STATION_ADDR[] = { 0x00, 0x88, 0x77, 0x66, 0x55, 0x44 };
+
+/*
+ * Station switching
+ */
+
+void sim_switch_node(int node)
+{
+	struct sim_node *n;
+
+	if (node == sim.cur)
+		return;
+
+	n = &sim.nodes[node];
+	MSRP_db = n->msrp_db;
+	MVRP_db = n->mvrp_db;
+	MMRP_db = n->mmrp_db;
+	msrp_socket = n->msrp_db ? MSRP_ETYPE : INVALID_SOCKET;
+	mvrp_socket = n->mvrp_db ? MVRP_ETYPE : INVALID_SOCKET;
+	mmrp_socket = n->mmrp_db ? MMRP_ETYPE : INVALID_SOCKET;
+	memcpy(STATION_ADDR, n->station_addr, sizeof n->station_addr);
+	sim.cur = node;
+}
+
+/*
+ * Timers
+ */
+
+HTIMER mrpd_timer_create(void)
+{
+	struct sim_timer *timers;
+	int id = sim.timer_count;
+
+	timers = realloc(sim.timers, (id + 1) * sizeof *timers);
+	assert(timers && "Out of simulator timers");
+	sim.timers = timers;
+	sim.timer_count++;
+
+	memset(&timers[id], 0, sizeof timers[id]);
+	timers[id].in_use = 1;
+	timers[id].node = sim.cur;
+
+	return (HTIMER)id;
+}
+
+void mrpd_timer_close(HTIMER t)
+{
+	int id = (int)t;
+
+	assert(id >= 0 && id < sim.timer_count);
+	sim.timers[id].in_use = 0;
+	sim.timers[id].generation++;
+}
+
+int mrpd_timer_start_interval(HTIMER timerfd,
+			      unsigned long value_ms, unsigned long interval_ms)
+{
+	int id = (int)timerfd;
+	struct sim_timer *t;
+
+	assert(id >= 0 && id < sim.timer_count);
+	t = &sim.timers[id];
+	t->generation++;
+	t->interval_ms = interval_ms;
+	sim_schedule(SIM_EVENT_TIMER, sim.now_ms + value_ms, t->node, id,
+		     t->generation, NULL);
+
+	return 0;
+}
+
+int mrpd_timer_start(HTIMER timerfd, unsigned long value_ms)
+{
+	return mrpd_timer_start_interval(timerfd, value_ms, 0);
+}
+
+int mrpd_timer_stop(HTIMER timerfd)
+{
+	int id = (int)timerfd;
+
+	assert(id >= 0 && id < sim.timer_count);
+	sim.timers[id].generation++;
+	sim.timers[id].interval_ms = 0;
+
+	return 0;
+}
+
+unsigned long mrpd_now_ms(void)
+{
+	return (unsigned long)sim.now_ms;
+}
+
+int mrpd_init_timers(struct mrp_database *mrp_db)
+{
+	mrp_db->join_timer = mrpd_timer_create();
+	mrp_db->lv_timer = mrpd_timer_create();
+	mrp_db->lva_timer = mrpd_timer_create();
+	mrp_db->join_timer_running = 0;
+	mrp_db->lv_timer_running = 0;
+	mrp_db->lva_timer_running = 0;
+
+	return 0;
+}
+
+int mrp_periodictimer_start()
+{
+	return mrpd_timer_start_interval(sim.nodes[sim.cur].periodic_timer,
+					 1000, 1000);
+}
+
+int mrp_periodictimer_stop()
+{
+	return mrpd_timer_stop(sim.nodes[sim.cur].periodic_timer);
+}
+
+/*
+ * Dispatch an expired timer the way process_events() in mrpd.c does.
+ */
+void sim_timer_fire(int id)
+{
+	struct sim_timer *t = &sim.timers[id];
+	struct sim_node *n;
+
+	sim_switch_node(t->node);
+	n = &sim.nodes[t->node];
+	sim.stats.timer_events++;
+
+	if (t->interval_ms)
+		sim_schedule(SIM_EVENT_TIMER, sim.now_ms + t->interval_ms,
+			     t->node, id, t->generation, NULL);
+
+	if (id == n->periodic_timer) {
+		mrp_periodictimer_fsm(&n->periodic_state, MRP_EVENT_PERIODIC);
+		if (MMRP_db)
+			mmrp_event(MRP_EVENT_PERIODIC, NULL);
+		if (MVRP_db)
+			mvrp_event(MRP_EVENT_PERIODIC, NULL);
+		if (MSRP_db)
+			msrp_event(MRP_EVENT_PERIODIC, NULL);
+		return;
+	}
+
+	if (MMRP_db) {
+		if (id == MMRP_db->mrp_db.lva_timer)
+			mmrp_event(MRP_EVENT_LVATIMER, NULL);
+		else if (id == MMRP_db->mrp_db.lv_timer)
+			mmrp_event(MRP_EVENT_LVTIMER, NULL);
+		else if (id == MMRP_db->mrp_db.join_timer)
+			mmrp_event(MRP_EVENT_TX, NULL);
+	}
+	if (MVRP_db) {
+		if (id == MVRP_db->mrp_db.lva_timer)
+			mvrp_event(MRP_EVENT_LVATIMER, NULL);
+		else if (id == MVRP_db->mrp_db.lv_timer)
+			mvrp_event(MRP_EVENT_LVTIMER, NULL);
+		else if (id == MVRP_db->mrp_db.join_timer)
+			mvrp_event(MRP_EVENT_TX, NULL);
+	}
+	if (MSRP_db) {
+		if (id == MSRP_db->mrp_db.lva_timer)
+			msrp_event(MRP_EVENT_LVATIMER, NULL);
+		else if (id == MSRP_db->mrp_db.lv_timer)
+			msrp_event(MRP_EVENT_LVTIMER, NULL);
+		else if (id == MSRP_db->mrp_db.join_timer)
+			msrp_event(MRP_EVENT_TX, NULL);
+	}
+}
+
+/*
+ * Sockets
+ */
+
+int mrpd_init_protocol_socket(uint16_t etype, SOCKET *sock,
+			      unsigned char *multicast_addr)
+{
+	(void)multicast_addr; /* unused */
+	*sock = etype;
+
+	return 0;
+}
+
+int mrpd_close_socket(SOCKET sock)
+{
+	(void)sock; /* unused */
+
+	return 0;
+}
+
+int mrpd_recvmsgbuf(SOCKET sock, char **buf)
+{
+	(void)sock; /* unused */
+	*buf = malloc(MAX_FRAME_SIZE);
+	if (NULL == *buf)
+		return -1;
+	memcpy(*buf, sim.rx_frame->data, sim.rx_frame->len);
+
+	return sim.rx_frame->len;
+}
+
+/*
+ * Put a PDU on the segment. Every other station gets its own copy of the
+ * event, each one subject to loss and jitter on its own.
+ */
+size_t mrpd_send(SOCKET sockfd, const void *buf, size_t len, int flags)
+{
+	struct sim_frame *frame;
+	int i;
+
+	(void)sockfd; /* unused */
+	(void)flags;  /* unused */
+
+	sim.stats.pdus_sent++;
+	sim.stats.pdu_bytes += len;
+
+	frame = malloc(sizeof *frame + len);
+	assert(frame && "Out of memory for PDU");
+	frame->refs = 1;
+	frame->src = sim.cur;
+	frame->len = len;
+	memcpy(frame->data, buf, len);
+
+	for (i = 0; i < sim.cfg.nodes; i++) {
+		unsigned long long when;
+
+		if (i == sim.cur)
+			continue;
+		if (sim.cfg.loss > 0.0 &&
+		    sim_random(1000000) < (unsigned long)(sim.cfg.loss * 10000.0)) {
+			sim.stats.pdus_lost++;
+			continue;
+		}
+		when = sim.now_ms + sim.cfg.delay_ms;
+		if (sim.cfg.jitter_ms)
+			when += sim_random(sim.cfg.jitter_ms + 1);
+		frame->refs++;
+		sim_schedule(SIM_EVENT_DELIVER, when, i, 0, 0, frame);
+	}
+	sim_frame_put(frame);
+
+	return len;
+}
+
+int mrpd_send_ctl_msg(struct sockaddr_in *client_addr, char *notify_data,
+		      int notify_len)
+{
+	(void)client_addr; /* unused */
+	(void)notify_data; /* unused */
+	sim.stats.ctl_msgs++;
+
+	return notify_len;
+}
+
+void mrpd_log_printf(const char *fmt, ...)
+{
+	va_list arglist;
+
+	if (!sim.cfg.verbose)
+		return;
+
+	printf("[%llu.%03llu n%d] ", sim.now_ms / 1000, sim.now_ms % 1000,
+	       sim.cur);
+	va_start(arglist, fmt);
+	vprintf(fmt, arglist);
+	va_end(arglist);
+}
+
+/*
+ * msrp.c is built with MRP_CPPUTEST, which renames its event handler so
+ * that the tests can observe it.
+ */
+int msrp_event(int event, struct msrp_attribute *rattrib)
+{
+	return msrp_event_orig(event, rattrib);
+}
@@ -24,6 +24,7 @@ void mrpd_reset(void)
 TRACE
 	test_state.periodic_timer_id = 0;
 	test_state.timers[0].state = TIMER_STOPPED;
+	test_state.now_ms = 0;
 
 	for (i = 1; i < MRPD_TIMER_COUNT; i++) {
 		test_state.timers[i].state = TIMER_UNDEF;
@@ -98,7 +99,8 @@ int mrpd_timer_start_interval(HTIMER timerfd,
 	int id = (int)timerfd;
 TRACE
 	assert(id >= 0 && id < MRPD_TIMER_COUNT);
-	assert(test_state.timers[id].state == TIMER_STOPPED);
+	/* like the timer wheel, starting a running timer replaces its expiry */
+	assert(test_state.timers[id].state != TIMER_UNDEF);
 	test_state.timers[id].state = TIMER_STARTED;
 	test_state.timers[id].value = value_ms;
 	test_state.timers[id].interval = interval_ms;
@@ -124,6 +126,12 @@ TRACE
         return 0;
 }
 
+unsigned long mrpd_now_ms(void)
+{
+TRACE
+	return test_state.now_ms;
+}
+
 int mrpd_init_timers(struct mrp_database *mrp_db)
 {
 TRACE
@@ -78,6 +78,7 @@ struct mrpd_test_state {
 	/* Timer State */
 	timer_double_t timers[MRPD_TIMER_COUNT];
 	HTIMER periodic_timer_id;
+	unsigned long now_ms;	/* returned by mrpd_now_ms() */
 
 	/* Control Message */
 	char ctl_msg_data[MAX_MRPD_CMDSZ];
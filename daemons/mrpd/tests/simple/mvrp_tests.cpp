@@ -136,3 +136,110 @@ TEST(MvrpTestGroup, TxLVA_clear_tx_flag)
 	CHECK(mrpd_send_packet_count() > 0);
 	CHECK_EQUAL(0, tx_flag_count);
 }
+
+/* declare a VLAN and register it as if a JoinIn had been received */
+static struct mvrp_attribute *registered_vlan(const char *cmd, uint16_t vid)
+{
+	struct mvrp_attribute a_ref;
+	struct mvrp_attribute *attrib;
+	char cmd_string[16];
+
+	strcpy(cmd_string, cmd);
+	mvrp_recv_cmd(cmd_string, (int)strlen(cmd_string) + 1, &client);
+	a_ref.attribute = vid;
+	attrib = mvrp_lookup(&a_ref);
+	if (NULL != attrib)
+		mrp_registrar_fsm(&attrib->registrar, &MVRP_db->mrp_db,
+				  MRP_EVENT_RJOININ);
+	return attrib;
+}
+
+/*
+ * Each attribute leaves MRP_LVTIMER_VAL after its own rLv!. A later leave
+ * does not postpone an earlier one, and the LVTIMER event only moves the
+ * attributes whose time has run out to MT.
+ */
+TEST(MvrpTestGroup, LeaveTimerPerAttribute)
+{
+	struct mvrp_attribute *a, *b;
+	timer_double_t *lv;
+
+	test_state.now_ms = 1000;
+	a = registered_vlan("V++:I=0010", 0x10);
+	b = registered_vlan("V++:I=0020", 0x20);
+	CHECK(a != NULL && b != NULL);
+	LONGS_EQUAL(MRP_IN_STATE, a->registrar.mrp_state);
+	lv = &test_state.timers[(int)MVRP_db->mrp_db.lv_timer];
+
+	mrp_registrar_fsm(&a->registrar, &MVRP_db->mrp_db, MRP_EVENT_RLV);
+	LONGS_EQUAL(MRP_LV_STATE, a->registrar.mrp_state);
+	LONGS_EQUAL(TIMER_STARTED, lv->state);
+	LONGS_EQUAL(MRP_LVTIMER_VAL, lv->value);
+
+	test_state.now_ms = 1300;
+	mrp_registrar_fsm(&b->registrar, &MVRP_db->mrp_db, MRP_EVENT_RLV);
+	LONGS_EQUAL(MRP_LV_STATE, b->registrar.mrp_state);
+	LONGS_EQUAL(1000 + MRP_LVTIMER_VAL, MVRP_db->mrp_db.lv_timer_expires);
+
+	test_state.now_ms = 1000 + MRP_LVTIMER_VAL;
+	mvrp_event(MRP_EVENT_LVTIMER, NULL);
+	LONGS_EQUAL(MRP_MT_STATE, a->registrar.mrp_state);
+	LONGS_EQUAL(MRP_LV_STATE, b->registrar.mrp_state);
+	/* re-armed for the rest of b's leave period */
+	LONGS_EQUAL(TIMER_STARTED, lv->state);
+	LONGS_EQUAL(300, lv->value);
+
+	test_state.now_ms = 1300 + MRP_LVTIMER_VAL;
+	mvrp_event(MRP_EVENT_LVTIMER, NULL);
+	LONGS_EQUAL(MRP_MT_STATE, b->registrar.mrp_state);
+	LONGS_EQUAL(TIMER_STOPPED, lv->state);
+}
+
+/*
+ * On LVTIMER the remaining attributes are visited in list order, not in
+ * the order they leave; the timer must end up armed for the earliest.
+ * A rejoin during LV keeps the attribute registered.
+ */
+TEST(MvrpTestGroup, LeaveTimerRearmsForEarliest)
+{
+	struct mvrp_attribute *a, *b, *c, *d;
+	timer_double_t *lv;
+
+	test_state.now_ms = 1000;
+	a = registered_vlan("V++:I=0001", 0x1);
+	b = registered_vlan("V++:I=0002", 0x2);
+	c = registered_vlan("V++:I=0003", 0x3);
+	d = registered_vlan("V++:I=0004", 0x4);
+	CHECK(a != NULL && b != NULL && c != NULL && d != NULL);
+	lv = &test_state.timers[(int)MVRP_db->mrp_db.lv_timer];
+
+	mrp_registrar_fsm(&c->registrar, &MVRP_db->mrp_db, MRP_EVENT_RLV);
+	mrp_registrar_fsm(&d->registrar, &MVRP_db->mrp_db, MRP_EVENT_RLV);
+	test_state.now_ms = 1300;
+	mrp_registrar_fsm(&b->registrar, &MVRP_db->mrp_db, MRP_EVENT_RLV);
+	test_state.now_ms = 1600;
+	mrp_registrar_fsm(&a->registrar, &MVRP_db->mrp_db, MRP_EVENT_RLV);
+	mrp_registrar_fsm(&d->registrar, &MVRP_db->mrp_db, MRP_EVENT_RJOININ);
+	LONGS_EQUAL(MRP_IN_STATE, d->registrar.mrp_state);
+
+	test_state.now_ms = 1000 + MRP_LVTIMER_VAL;
+	mvrp_event(MRP_EVENT_LVTIMER, NULL);
+	LONGS_EQUAL(MRP_LV_STATE, a->registrar.mrp_state);
+	LONGS_EQUAL(MRP_LV_STATE, b->registrar.mrp_state);
+	LONGS_EQUAL(MRP_MT_STATE, c->registrar.mrp_state);
+	LONGS_EQUAL(MRP_IN_STATE, d->registrar.mrp_state);
+	LONGS_EQUAL(TIMER_STARTED, lv->state);
+	LONGS_EQUAL(300, lv->value);
+
+	test_state.now_ms = 1300 + MRP_LVTIMER_VAL;
+	mvrp_event(MRP_EVENT_LVTIMER, NULL);
+	LONGS_EQUAL(MRP_LV_STATE, a->registrar.mrp_state);
+	LONGS_EQUAL(MRP_MT_STATE, b->registrar.mrp_state);
+	LONGS_EQUAL(300, lv->value);
+
+	test_state.now_ms = 1600 + MRP_LVTIMER_VAL;
+	mvrp_event(MRP_EVENT_LVTIMER, NULL);
+	LONGS_EQUAL(MRP_MT_STATE, a->registrar.mrp_state);
+	LONGS_EQUAL(MRP_IN_STATE, d->registrar.mrp_state);
+	LONGS_EQUAL(TIMER_STOPPED, lv->state);
+}
@@ -0,0 +1,271 @@
+/****************************************************************************
+  Copyright (c) 2012, Intel Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   3. Neither the name of the Intel Corporation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+#include <stdint.h>
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+
+#include "timer_wheel.h"
+
+}
+
+#define WHEEL_SPAN_MS	((uint64_t)1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+
+/* pseudo random numbers that are the same on every platform */
+static uint32_t test_rand_state;
+
+static uint32_t test_rand(void)
+{
+	test_rand_state = test_rand_state * 1103515245 + 12345;
+	return test_rand_state >> 8;
+}
+
+/* advance one ms short of the expiry, then onto it */
+static int expires_exactly_at(struct timer_wheel *tw, int id, uint64_t when)
+{
+	timer_wheel_advance(tw, when - 1);
+	if (timer_wheel_expired(tw, id))
+		return 0;
+	timer_wheel_advance(tw, when);
+	return timer_wheel_expired(tw, id);
+}
+
+TEST_GROUP(TimerWheelTestGroup)
+{
+	struct timer_wheel tw;
+
+	void setup()
+	{
+		timer_wheel_init(&tw, 0);
+	}
+
+	void teardown()
+	{
+		timer_wheel_free(&tw);
+	}
+};
+
+TEST(TimerWheelTestGroup, OneShotExpiresOnItsMillisecond)
+{
+	int id = timer_wheel_create(&tw);
+
+	CHECK(id >= 0);
+	timer_wheel_start(&tw, id, 10, 0);
+	LONGS_EQUAL(0, timer_wheel_advance(&tw, 9));
+	LONGS_EQUAL(0, timer_wheel_expired(&tw, id));
+	LONGS_EQUAL(1, timer_wheel_advance(&tw, 10));
+	LONGS_EQUAL(1, timer_wheel_expired(&tw, id));
+	/* collected once */
+	LONGS_EQUAL(0, timer_wheel_expired(&tw, id));
+	LONGS_EQUAL(0, timer_wheel_advance(&tw, 1000));
+	CHECK(TIMER_WHEEL_NEVER == timer_wheel_next(&tw));
+}
+
+TEST(TimerWheelTestGroup, RestartAndStopReplacePendingExpiry)
+{
+	int id = timer_wheel_create(&tw);
+
+	timer_wheel_start(&tw, id, 100, 0);
+	timer_wheel_start(&tw, id, 50, 0);
+	CHECK(expires_exactly_at(&tw, id, 50));
+	LONGS_EQUAL(0, timer_wheel_advance(&tw, 100));
+
+	/* an expiry not collected yet is discarded by a stop */
+	timer_wheel_start(&tw, id, 200, 0);
+	timer_wheel_advance(&tw, 200);
+	timer_wheel_stop(&tw, id);
+	LONGS_EQUAL(0, timer_wheel_expired(&tw, id));
+}
+
+/*
+ * Expiries on both sides of each level boundary, from an aligned and an
+ * unaligned start, so every timer is filed on a higher level and has to
+ * cascade down one or more times before it expires.
+ */
+TEST(TimerWheelTestGroup, CascadeAcrossLevels)
+{
+	static const uint64_t starts[] = { 0, 12345 };
+	static const uint64_t offsets[] = {
+		63, 64, 65, 127, 128, 4095, 4096, 4097, 5000,
+		262143, 262144, 262145, 300007, WHEEL_SPAN_MS - 1,
+		WHEEL_SPAN_MS, WHEEL_SPAN_MS + 70000
+	};
+	unsigned i, j;
+
+	for (i = 0; i < sizeof(starts) / sizeof(starts[0]); i++) {
+		for (j = 0; j < sizeof(offsets) / sizeof(offsets[0]); j++) {
+			uint64_t when = starts[i] + offsets[j];
+			int id;
+
+			timer_wheel_free(&tw);
+			timer_wheel_init(&tw, starts[i]);
+			id = timer_wheel_create(&tw);
+			timer_wheel_start(&tw, id, when, 0);
+			CHECK(expires_exactly_at(&tw, id, when));
+		}
+	}
+}
+
+TEST(TimerWheelTestGroup, NextExpiry)
+{
+	int a = timer_wheel_create(&tw);
+	int b = timer_wheel_create(&tw);
+	int wakeups = 0;
+	uint64_t next;
+
+	CHECK(TIMER_WHEEL_NEVER == timer_wheel_next(&tw));
+
+	timer_wheel_start(&tw, a, 10, 0);
+	CHECK(10 == timer_wheel_next(&tw));
+	timer_wheel_start(&tw, b, 3, 0);
+	CHECK(3 == timer_wheel_next(&tw));
+	timer_wheel_stop(&tw, b);
+	CHECK(10 == timer_wheel_next(&tw));
+	timer_wheel_stop(&tw, a);
+	CHECK(TIMER_WHEEL_NEVER == timer_wheel_next(&tw));
+
+	/*
+	 * A far timer may need a few wakeups to cascade, one per level at
+	 * most, and none of them is after the expiry.
+	 */
+	timer_wheel_start(&tw, a, 300007, 0);
+	do {
+		next = timer_wheel_next(&tw);
+		CHECK(next <= 300007);
+		timer_wheel_advance(&tw, next);
+		wakeups++;
+	} while (!timer_wheel_expired(&tw, a));
+	CHECK(300007 == next);
+	CHECK(wakeups <= TIMER_WHEEL_LEVELS);
+	CHECK(TIMER_WHEEL_NEVER == timer_wheel_next(&tw));
+
+	/*
+	 * From the middle of a level 1 slot, a timer almost 64 slots out
+	 * shares the index of the slot already cascaded; it is due when
+	 * that index comes round again, not now.
+	 */
+	timer_wheel_advance(&tw, 300100);
+	timer_wheel_start(&tw, a, 300100 + 4094, 0);
+	CHECK(((300100 + 4094) & ~(uint64_t)63) == timer_wheel_next(&tw));
+	CHECK(expires_exactly_at(&tw, a, 300100 + 4094));
+}
+
+/*
+ * Drive the wheel the way mrpd does, only waking at timer_wheel_next(),
+ * and check every timer against a plain list of expiry times. Each timer
+ * must expire on its exact ms and nothing may be due in between.
+ */
+TEST(TimerWheelTestGroup, NextExpiryDrivenLoopMatchesModel)
+{
+	enum { TIMERS = 300 };
+	int ids[TIMERS];
+	uint64_t expires[TIMERS];
+	uint64_t intervals[TIMERS];
+	int reloads[TIMERS];
+	uint64_t now = 0, next;
+	int running = TIMERS;
+	int wakeups = 0;
+	int i;
+
+	test_rand_state = 1;
+	for (i = 0; i < TIMERS; i++) {
+		ids[i] = timer_wheel_create(&tw);
+		/* spread over all levels and beyond the wheel span */
+		expires[i] = 1 + ((uint64_t)1 << (test_rand() % 26)) +
+		    test_rand() % 1000;
+		intervals[i] = (0 == i % 5) ? 1 + test_rand() % 5000 : 0;
+		reloads[i] = 20;
+		timer_wheel_start(&tw, ids[i], expires[i], intervals[i]);
+	}
+
+	while (running && wakeups < 100000) {
+		next = timer_wheel_next(&tw);
+		CHECK(next >= now);
+		for (i = 0; i < TIMERS; i++) {
+			if (expires[i])
+				CHECK(expires[i] >= next);
+		}
+		timer_wheel_advance(&tw, next);
+		now = next + 1;
+		wakeups++;
+
+		for (i = 0; i < TIMERS; i++) {
+			if (!timer_wheel_expired(&tw, ids[i]))
+				continue;
+			CHECK(expires[i] == next);
+			if (intervals[i] && reloads[i]--) {
+				expires[i] += intervals[i];
+			} else {
+				timer_wheel_stop(&tw, ids[i]);
+				expires[i] = 0;
+				running--;
+			}
+		}
+	}
+	LONGS_EQUAL(0, running);
+}
+
+/*
+ * One call to advance over a gap much longer than the wheel span, as after
+ * a suspend, expires every timer due within it once and keeps periodic
+ * timers on their grid.
+ */
+TEST(TimerWheelTestGroup, AdvanceOverLongGap)
+{
+	static const uint64_t whens[] = { 10, 5000, 1000000, 20000000 };
+	const uint64_t gap = 100000000;
+	int ids[4];
+	int periodic = timer_wheel_create(&tw);
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		ids[i] = timer_wheel_create(&tw);
+		timer_wheel_start(&tw, ids[i], whens[i], 0);
+	}
+	timer_wheel_start(&tw, periodic, 100, 100);
+
+	LONGS_EQUAL(4 + gap / 100, timer_wheel_advance(&tw, gap));
+	for (i = 0; i < 4; i++)
+		LONGS_EQUAL(1, timer_wheel_expired(&tw, ids[i]));
+	LONGS_EQUAL(1, timer_wheel_expired(&tw, periodic));
+	CHECK(timer_wheel_next(&tw) <= gap + 100);
+	CHECK(expires_exactly_at(&tw, periodic, gap + 100));
+
+	/* an idle wheel crosses any gap at once */
+	timer_wheel_stop(&tw, periodic);
+	LONGS_EQUAL(0, timer_wheel_advance(&tw, (uint64_t)1 << 50));
+	timer_wheel_start(&tw, periodic, ((uint64_t)1 << 50) + 70, 0);
+	CHECK(expires_exactly_at(&tw, periodic, ((uint64_t)1 << 50) + 70));
+}
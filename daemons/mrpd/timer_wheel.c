@@ -0,0 +1,324 @@
+/****************************************************************************
+  Copyright (c) 2012, Intel Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   3. Neither the name of the Intel Corporation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+/*
+ * hierarchical timer wheel driving all mrpd timers from one wake source
+ *
+ * Level 0 holds timers due within the next 64 ms, one slot per ms. Level N
+ * holds timers due within 64^(N+1) ms, one slot per 64^N ms, and is
+ * cascaded into the levels below whenever the current time crosses one of
+ * its slot boundaries. Starting or stopping a timer is O(1) and costs no
+ * system call; only the wheel as a whole is tied to a single OS timer.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "timer_wheel.h"
+
+#define LEVEL_SHIFT(level)	((level) * TIMER_WHEEL_BITS)
+#define LEVEL_SPAN(level)	((uint64_t)1 << LEVEL_SHIFT(level))
+#define WHEEL_SPAN		LEVEL_SPAN(TIMER_WHEEL_LEVELS)
+
+static int lowest_bit(uint64_t v)
+{
+	return __builtin_ctzll(v);
+}
+
+/* offset of the first occupied slot at or after 'from', wrapping around */
+static int next_slot(uint64_t occupied, int from)
+{
+	uint64_t rotated;
+
+	if (0 == from)
+		rotated = occupied;
+	else
+		rotated = (occupied >> from) |
+		    (occupied << (TIMER_WHEEL_SLOTS - from));
+	return lowest_bit(rotated);
+}
+
+static void slot_link(struct timer_wheel *tw, int id, int slot)
+{
+	struct timer_wheel_timer *t = &tw->timers[id];
+	int head = tw->slots[slot];
+
+	t->slot = slot;
+	t->prev = -1;
+	t->next = head;
+	if (-1 != head)
+		tw->timers[head].prev = id;
+	tw->slots[slot] = id;
+	tw->occupied[slot / TIMER_WHEEL_SLOTS] |=
+	    (uint64_t)1 << (slot % TIMER_WHEEL_SLOTS);
+}
+
+static void slot_unlink(struct timer_wheel *tw, int id)
+{
+	struct timer_wheel_timer *t = &tw->timers[id];
+	int slot = t->slot;
+
+	if (-1 == slot)
+		return;
+
+	if (-1 != t->prev)
+		tw->timers[t->prev].next = t->next;
+	else
+		tw->slots[slot] = t->next;
+	if (-1 != t->next)
+		tw->timers[t->next].prev = t->prev;
+
+	if (-1 == tw->slots[slot])
+		tw->occupied[slot / TIMER_WHEEL_SLOTS] &=
+		    ~((uint64_t)1 << (slot % TIMER_WHEEL_SLOTS));
+	t->slot = -1;
+	t->next = -1;
+	t->prev = -1;
+}
+
+/* file a timer on the lowest level whose range covers its expiry */
+static void wheel_insert(struct timer_wheel *tw, int id)
+{
+	uint64_t expires = tw->timers[id].expires;
+	uint64_t delta;
+	int level;
+
+	if (expires < tw->now)
+		expires = tw->now;
+	delta = expires - tw->now;
+	if (delta >= WHEEL_SPAN) {
+		delta = WHEEL_SPAN - 1;
+		expires = tw->now + delta;
+	}
+
+	for (level = 0; level < TIMER_WHEEL_LEVELS - 1; level++) {
+		if (delta < LEVEL_SPAN(level + 1))
+			break;
+	}
+
+	slot_link(tw, id, level * TIMER_WHEEL_SLOTS +
+		  (int)((expires >> LEVEL_SHIFT(level)) & TIMER_WHEEL_MASK));
+}
+
+/* take a whole slot off the wheel and return its list */
+static int slot_take(struct timer_wheel *tw, int slot)
+{
+	int head = tw->slots[slot];
+
+	tw->slots[slot] = -1;
+	tw->occupied[slot / TIMER_WHEEL_SLOTS] &=
+	    ~((uint64_t)1 << (slot % TIMER_WHEEL_SLOTS));
+	return head;
+}
+
+static void wheel_cascade(struct timer_wheel *tw, int level)
+{
+	int index = (int)((tw->now >> LEVEL_SHIFT(level)) & TIMER_WHEEL_MASK);
+	int id = slot_take(tw, level * TIMER_WHEEL_SLOTS + index);
+
+	while (-1 != id) {
+		int next = tw->timers[id].next;
+
+		tw->timers[id].slot = -1;
+		wheel_insert(tw, id);
+		id = next;
+	}
+}
+
+static int wheel_expire(struct timer_wheel *tw)
+{
+	int id = slot_take(tw, (int)(tw->now & TIMER_WHEEL_MASK));
+	int count = 0;
+
+	while (-1 != id) {
+		struct timer_wheel_timer *t = &tw->timers[id];
+		int next = t->next;
+
+		t->slot = -1;
+		t->expired = 1;
+		count++;
+		if (t->interval) {
+			t->expires += t->interval;
+			if (t->expires <= tw->now)
+				t->expires = tw->now + t->interval;
+			wheel_insert(tw, id);
+		}
+		id = next;
+	}
+	return count;
+}
+
+void timer_wheel_init(struct timer_wheel *tw, uint64_t now_ms)
+{
+	int i;
+
+	memset(tw, 0, sizeof(*tw));
+	tw->now = now_ms;
+	tw->free_list = -1;
+	for (i = 0; i < TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS; i++)
+		tw->slots[i] = -1;
+}
+
+void timer_wheel_free(struct timer_wheel *tw)
+{
+	free(tw->timers);
+	timer_wheel_init(tw, tw->now);
+}
+
+int timer_wheel_create(struct timer_wheel *tw)
+{
+	struct timer_wheel_timer *t;
+	int id;
+
+	if (-1 != tw->free_list) {
+		id = tw->free_list;
+		tw->free_list = tw->timers[id].next;
+	} else {
+		t = realloc(tw->timers, (tw->count + 1) * sizeof(*t));
+		if (NULL == t)
+			return -1;
+		tw->timers = t;
+		id = tw->count++;
+	}
+
+	t = &tw->timers[id];
+	memset(t, 0, sizeof(*t));
+	t->next = -1;
+	t->prev = -1;
+	t->slot = -1;
+	t->in_use = 1;
+
+	return id;
+}
+
+void timer_wheel_close(struct timer_wheel *tw, int id)
+{
+	if (id < 0 || id >= tw->count || !tw->timers[id].in_use)
+		return;
+
+	slot_unlink(tw, id);
+	tw->timers[id].in_use = 0;
+	tw->timers[id].next = tw->free_list;
+	tw->free_list = id;
+}
+
+void timer_wheel_start(struct timer_wheel *tw, int id, uint64_t expires_ms,
+		       uint64_t interval_ms)
+{
+	struct timer_wheel_timer *t = &tw->timers[id];
+
+	slot_unlink(tw, id);
+	t->expired = 0;
+	t->expires = expires_ms;
+	t->interval = interval_ms;
+	wheel_insert(tw, id);
+}
+
+void timer_wheel_stop(struct timer_wheel *tw, int id)
+{
+	struct timer_wheel_timer *t = &tw->timers[id];
+
+	slot_unlink(tw, id);
+	t->expired = 0;
+	t->interval = 0;
+}
+
+int timer_wheel_expired(struct timer_wheel *tw, int id)
+{
+	struct timer_wheel_timer *t = &tw->timers[id];
+
+	if (!t->expired)
+		return 0;
+	t->expired = 0;
+	return 1;
+}
+
+int timer_wheel_advance(struct timer_wheel *tw, uint64_t now_ms)
+{
+	int count = 0;
+
+	while (tw->now <= now_ms) {
+		uint64_t next;
+		int level;
+
+		/* refill the lower levels at each slot boundary, top down */
+		for (level = TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+			if (0 == (tw->now & (LEVEL_SPAN(level) - 1)))
+				wheel_cascade(tw, level);
+		}
+
+		count += wheel_expire(tw);
+
+		/* skip to the next expiry or cascade of an occupied level, so
+		 * a long gap costs no more than the timers due within it */
+		tw->now++;
+		next = timer_wheel_next(tw);
+		if (next > now_ms + 1)
+			next = now_ms + 1;
+		if (next > tw->now)
+			tw->now = next;
+	}
+
+	return count;
+}
+
+uint64_t timer_wheel_next(struct timer_wheel *tw)
+{
+	uint64_t best = TIMER_WHEEL_NEVER;
+	int level;
+
+	/* level 0 holds expiries within the next 64 ms, slot by slot */
+	if (tw->occupied[0])
+		best = tw->now + next_slot(tw->occupied[0],
+					   (int)(tw->now & TIMER_WHEEL_MASK));
+
+	/* higher levels only need a wakeup when their next slot cascades */
+	for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+		uint64_t block = tw->now >> LEVEL_SHIFT(level);
+		uint64_t when;
+		int offset;
+
+		if (!tw->occupied[level])
+			continue;
+
+		/* the current slot is due now only if its boundary has not
+		 * been processed yet; otherwise it is 64 slots away */
+		if (tw->now & (LEVEL_SPAN(level) - 1))
+			block++;
+		offset = next_slot(tw->occupied[level],
+				   (int)(block & TIMER_WHEEL_MASK));
+		when = (block + offset) << LEVEL_SHIFT(level);
+		if (when < best)
+			best = when;
+	}
+
+	return best;
+}
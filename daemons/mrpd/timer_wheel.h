@@ -0,0 +1,155 @@
+/****************************************************************************
+  Copyright (c) 2012, Intel Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   3. Neither the name of the Intel Corporation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+/*
+ * hierarchical timer wheel driving all mrpd timers from one wake source
+ */
+
+#ifndef TIMER_WHEEL_H_
+#define TIMER_WHEEL_H_
+
+#include <stdint.h>
+
+/*
+ * Each level has 64 slots; a slot on level N covers 64^N ms, so four levels
+ * reach about 4.6 hours. Timers further out than that are parked on the top
+ * level and re-filed when it cascades.
+ */
+#define TIMER_WHEEL_BITS	6
+#define TIMER_WHEEL_SLOTS	(1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK	(TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS	4
+
+#define TIMER_WHEEL_NEVER	UINT64_MAX
+
+/*
+ * Timers are addressed by index so the table can grow without
+ * invalidating the slot lists.
+ */
+struct timer_wheel_timer {
+	int next;
+	int prev;
+	int slot;		/* level * TIMER_WHEEL_SLOTS + index, or -1 */
+	int in_use;
+	int expired;		/* set on expiry, cleared by timer_wheel_expired() */
+	uint64_t expires;	/* ms */
+	uint64_t interval;	/* ms, 0 for one-shot timers */
+};
+
+struct timer_wheel {
+	uint64_t now;		/* next tick to process, in ms */
+	int slots[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];
+	uint64_t occupied[TIMER_WHEEL_LEVELS];
+	struct timer_wheel_timer *timers;
+	int count;
+	int free_list;
+};
+
+/**
+ * Initialize an empty wheel.
+ *
+ * \param tw The wheel.
+ * \param now_ms The current time.
+ */
+void timer_wheel_init(struct timer_wheel *tw, uint64_t now_ms);
+
+/**
+ * Release all timers of a wheel.
+ *
+ * \param tw The wheel.
+ */
+void timer_wheel_free(struct timer_wheel *tw);
+
+/**
+ * Allocate a stopped timer.
+ *
+ * \param tw The wheel.
+ * \return The timer handle, or -1 if out of memory.
+ */
+int timer_wheel_create(struct timer_wheel *tw);
+
+/**
+ * Stop a timer and return its handle to the wheel.
+ *
+ * \param tw The wheel.
+ * \param id The timer handle.
+ */
+void timer_wheel_close(struct timer_wheel *tw, int id);
+
+/**
+ * (Re)start a timer, replacing any pending expiry.
+ *
+ * \param tw The wheel.
+ * \param id The timer handle.
+ * \param expires_ms Absolute expiry time.
+ * \param interval_ms Reload interval, 0 for a one-shot timer.
+ */
+void timer_wheel_start(struct timer_wheel *tw, int id, uint64_t expires_ms,
+		       uint64_t interval_ms);
+
+/**
+ * Stop a timer and discard an expiry not yet collected.
+ *
+ * \param tw The wheel.
+ * \param id The timer handle.
+ */
+void timer_wheel_stop(struct timer_wheel *tw, int id);
+
+/**
+ * Collect the expiry of a timer.
+ *
+ * \param tw The wheel.
+ * \param id The timer handle.
+ * \return 1 if the timer expired since the last call, 0 otherwise.
+ */
+int timer_wheel_expired(struct timer_wheel *tw, int id);
+
+/**
+ * Expire every timer due at or before now_ms.
+ *
+ * \param tw The wheel.
+ * \param now_ms The current time.
+ * \return The number of timers that expired.
+ */
+int timer_wheel_advance(struct timer_wheel *tw, uint64_t now_ms);
+
+/**
+ * Find when timer_wheel_advance() next has work to do.
+ *
+ * This is the earliest expiry, or an earlier point at which a
+ * higher level has to be cascaded.
+ *
+ * \param tw The wheel.
+ * \return Absolute time in ms, or TIMER_WHEEL_NEVER if no timer is running.
+ */
+uint64_t timer_wheel_next(struct timer_wheel *tw);
+
+#endif
@@ -0,0 +1,238 @@
+/******************************************************************************
+
+  Copyright (c) 2018, Intel Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   3. Neither the name of the Intel Corporation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include <mix_kernels.h>
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+// Samples handled per vector iteration
+#define MIX_VECTOR_SAMPLES 8
+#endif
+
+#define PS16_MAX ( 32767 )
+#define PS16_MIN ( -32768 )
+
+#ifdef __SSE2__
+// Cleared to run the scalar loops only, for comparison
+static bool mix_vector = true;
+#endif
+
+bool isaudk_mix_set_vector( bool enable )
+{
+#ifdef __SSE2__
+	mix_vector = enable;
+	return true;
+#else
+	(void) enable;
+	return false;
+#endif
+}
+
+bool isaudk_mix_encoding_supported( isaudk_encoding_t encoding )
+{
+	switch( encoding )
+	{
+	default:
+		return false;
+	case ISAUDK_ENC_PS16:
+	case ISAUDK_ENC_PS24:
+	case ISAUDK_ENC_PS32:
+	case ISAUDK_ENC_PF32:
+		return true;
+	}
+}
+
+void isaudk_mix_clear( int32_t *acc, unsigned count )
+{
+	memset( acc, 0, count * sizeof( *acc ));
+}
+
+static void accumulate_ps16( int32_t *acc, const int16_t *in, unsigned count )
+{
+	unsigned i = 0;
+
+#ifdef __SSE2__
+	for( ; mix_vector && i + MIX_VECTOR_SAMPLES <= count;
+	       i += MIX_VECTOR_SAMPLES )
+	{
+		__m128i x, lo, hi;
+
+		x = _mm_loadu_si128( (const __m128i *) ( in + i ));
+		// Sign extend by placing each sample in the high half
+		lo = _mm_srai_epi32( _mm_unpacklo_epi16( x, x ), 16 );
+		hi = _mm_srai_epi32( _mm_unpackhi_epi16( x, x ), 16 );
+		_mm_storeu_si128( (__m128i *) ( acc + i ), _mm_add_epi32
+				  ( _mm_loadu_si128( (__m128i *) ( acc + i )), lo ));
+		_mm_storeu_si128( (__m128i *) ( acc + i + 4 ), _mm_add_epi32
+				  ( _mm_loadu_si128( (__m128i *) ( acc + i + 4 )),
+				    hi ));
+	}
+#endif
+	for( ; i < count; ++i )
+		acc[i] += in[i];
+}
+
+static void accumulate_ps24( int32_t *acc, const uint8_t *in, unsigned count )
+{
+	unsigned i;
+
+	for( i = 0; i < count; ++i, in += 3 )
+	{
+		int32_t sample;
+
+		// Assemble in the top 24 bits so the shift sign extends
+		sample = (int32_t) (( (uint32_t) in[0] << 8 ) |
+				    ( (uint32_t) in[1] << 16 ) |
+				    ( (uint32_t) in[2] << 24 ));
+		acc[i] += sample >> 16;
+	}
+}
+
+static void accumulate_ps32( int32_t *acc, const int32_t *in, unsigned count )
+{
+	unsigned i = 0;
+
+#ifdef __SSE2__
+	for( ; mix_vector && i + MIX_VECTOR_SAMPLES <= count;
+	       i += MIX_VECTOR_SAMPLES )
+	{
+		__m128i lo, hi;
+
+		lo = _mm_srai_epi32( _mm_loadu_si128( (const __m128i *) ( in + i )), 16 );
+		hi = _mm_srai_epi32( _mm_loadu_si128( (const __m128i *) ( in + i + 4 )), 16 );
+		_mm_storeu_si128( (__m128i *) ( acc + i ), _mm_add_epi32
+				  ( _mm_loadu_si128( (__m128i *) ( acc + i )), lo ));
+		_mm_storeu_si128( (__m128i *) ( acc + i + 4 ), _mm_add_epi32
+				  ( _mm_loadu_si128( (__m128i *) ( acc + i + 4 )),
+				    hi ));
+	}
+#endif
+	for( ; i < count; ++i )
+		acc[i] += in[i] >> 16;
+}
+
+static void accumulate_pf32( int32_t *acc, const float *in, unsigned count )
+{
+	unsigned i = 0;
+
+#ifdef __SSE2__
+	const __m128 scale = _mm_set1_ps( -PS16_MIN );
+	const __m128 max = _mm_set1_ps( PS16_MAX );
+	const __m128 min = _mm_set1_ps( PS16_MIN );
+
+	for( ; mix_vector && i + MIX_VECTOR_SAMPLES <= count;
+	       i += MIX_VECTOR_SAMPLES )
+	{
+		__m128 lo, hi;
+
+		// Clamp before conversion, out of range floats are undefined
+		lo = _mm_mul_ps( _mm_loadu_ps( in + i ), scale );
+		hi = _mm_mul_ps( _mm_loadu_ps( in + i + 4 ), scale );
+		lo = _mm_min_ps( _mm_max_ps( lo, min ), max );
+		hi = _mm_min_ps( _mm_max_ps( hi, min ), max );
+		_mm_storeu_si128( (__m128i *) ( acc + i ), _mm_add_epi32
+				  ( _mm_loadu_si128( (__m128i *) ( acc + i )),
+				    _mm_cvttps_epi32( lo )));
+		_mm_storeu_si128( (__m128i *) ( acc + i + 4 ), _mm_add_epi32
+				  ( _mm_loadu_si128( (__m128i *) ( acc + i + 4 )),
+				    _mm_cvttps_epi32( hi )));
+	}
+#endif
+	for( ; i < count; ++i )
+	{
+		float sample = in[i] * -PS16_MIN;
+
+		// NaN ends up at PS16_MIN, as in the vector path
+		if( !( sample > PS16_MIN ))
+			sample = PS16_MIN;
+		else if( sample > PS16_MAX )
+			sample = PS16_MAX;
+		acc[i] += (int32_t) sample;
+	}
+}
+
+void isaudk_mix_accumulate( int32_t *acc,
+			    const isaudk_sample_block_t *block,
+			    isaudk_encoding_t encoding, unsigned count )
+{
+	if( count > PS16_SAMPLE_COUNT )
+		count = PS16_SAMPLE_COUNT;
+
+	switch( encoding )
+	{
+	default:
+		// Unsupported formats are refused at stream registration
+		break;
+	case ISAUDK_ENC_PS16:
+		accumulate_ps16( acc, block->PS16, count );
+		break;
+	case ISAUDK_ENC_PS24:
+		accumulate_ps24( acc, block->PS24, count );
+		break;
+	case ISAUDK_ENC_PS32:
+		accumulate_ps32( acc, block->PS32, count );
+		break;
+	case ISAUDK_ENC_PF32:
+		accumulate_pf32( acc, block->PF32, count );
+		break;
+	}
+}
+
+void isaudk_mix_store_ps16( int16_t *out, const int32_t *acc,
+			    unsigned count )
+{
+	unsigned i = 0;
+
+#ifdef __SSE2__
+	for( ; mix_vector && i + MIX_VECTOR_SAMPLES <= count;
+	       i += MIX_VECTOR_SAMPLES )
+	{
+		// Pack saturates to the int16_t range
+		_mm_storeu_si128( (__m128i *) ( out + i ), _mm_packs_epi32
+				  ( _mm_loadu_si128( (const __m128i *) ( acc + i )),
+				    _mm_loadu_si128( (const __m128i *) ( acc + i + 4 ))));
+	}
+#endif
+	for( ; i < count; ++i )
+	{
+		if( acc[i] > PS16_MAX )
+			out[i] = PS16_MAX;
+		else if( acc[i] < PS16_MIN )
+			out[i] = PS16_MIN;
+		else
+			out[i] = acc[i];
+	}
+}
@@ -0,0 +1,60 @@
+/******************************************************************************
+
+  Copyright (c) 2018, Intel Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   3. Neither the name of the Intel Corporation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef MIX_KERNELS_H
+#define MIX_KERNELS_H
+
+#include <sdk.h>
+
+// Mixing is done in an int32_t accumulator holding 16 bit scaled sample
+// values. Inputs of every encoding are scaled to 16 bits when they are
+// added, saturation only happens when the accumulator is stored, so the
+// accumulator has headroom for 65536 full scale streams.
+
+bool isaudk_mix_encoding_supported( isaudk_encoding_t encoding );
+
+// Turns the SSE2 loops on (the default) or off. Returns false if they
+// aren't compiled in, then only the scalar loops run.
+bool isaudk_mix_set_vector( bool enable );
+
+void isaudk_mix_clear( int32_t *acc, unsigned count );
+
+void isaudk_mix_accumulate( int32_t *acc,
+			    const isaudk_sample_block_t *block,
+			    isaudk_encoding_t encoding, unsigned count );
+
+void isaudk_mix_store_ps16( int16_t *out, const int32_t *acc,
+			    unsigned count );
+
+#endif/*MIX_KERNELS_H*/
@@ -33,8 +33,8 @@
 
 #include <sdk.h>
 
-#include <linked_list.h>
 #include <audio_output.h>
+#include <mix_kernels.h>
 #include <util.h>
 #include <stream.h>
 #include <init.h>
@@ -50,6 +50,7 @@
 #include <limits.h>
 //maximum allowed PER_STREAM_BUFFER_COUNT is 100
 #define PER_STREAM_BUFFER_COUNT 3
+#define MIXER_MAX_STREAMS 64
 
 #define NSEC_PER_SEC 			( 1000000000ULL )
 #define START_THRESHOLD			( 30000000 ) /*ns*/
@@ -88,18 +89,37 @@ struct isaudk_mixer_handle {
 	struct isaudk_cross_time	audio_initial_cross_time;
 	uint64_t samples_written;
 
-	linked_list_t stream_list;
+	// Registered streams, the first one drives the output timing. Slots
+	// are filled before stream_count is published so the mixer loop
+	// reads them without taking a lock
+	isaudk_stream_handle_t streams[MIXER_MAX_STREAMS];
+	unsigned stream_count;
+
+	// Mixed output per buffer index, valid while mix_seq matches the
+	// write sequence of the first stream
+	isaudk_sample_block_t mix_buffer[PER_STREAM_BUFFER_COUNT];
+	uint8_t mix_seq[PER_STREAM_BUFFER_COUNT];
+	int32_t mix_acc[PS16_SAMPLE_COUNT];
+	isaudk_sample_block_t output_buffer;
 };
 
+// The buffers form a single producer, single consumer queue between the
+// stream and the mixer loop. Each side only stores its own sequence
+// numbers, with release semantics, so buffers are handed over without
+// taking a lock
 struct per_stream_sample_buffer
 {
 	isaudk_sample_block_t buffer[PER_STREAM_BUFFER_COUNT];
 	uint16_t count[PER_STREAM_BUFFER_COUNT];
+	struct isaudk_format format;
 
 	// incremented by the mixer loop each time buffer is read
 	uint8_t read_seq[PER_STREAM_BUFFER_COUNT];
 	// incremented each time buffer is written
 	uint8_t write_seq[PER_STREAM_BUFFER_COUNT];
+	// buffer is mixed into the output and is released with the first
+	// stream's buffer, only used by the mixer loop
+	bool mixed[PER_STREAM_BUFFER_COUNT];
 
 	uint8_t idx;
 	uint8_t eos;
@@ -126,7 +146,7 @@ bool _mixer_init( struct isaudk_mixer_handle *mixer )
 	mixer->fatal = false;
 	mixer->running = false;
 	mixer->start_req = false;
-	mixer->stream_list = ll_alloc();
+	mixer->stream_count = 0;
 	mixer->mode = ISAUDK_SILENCE;
 
 	if( isaudk_create_signal( &mixer->wake_signal ) != ISAUDK_SIGNAL_OK )
@@ -175,9 +195,10 @@ isaudk_mixer_register_stream( struct isaudk_mixer_handle *mixer,
 	struct per_stream_sample_buffer *sample_buffer;
 	int i;
 
-	// Check that the format matches
+	// Any mixable encoding is accepted, the layout must match
 	if( format != NULL &&
-	    !isaudk_is_format_equal( format, &mixer->format ))
+	    ( !isaudk_mix_encoding_supported( format->encoding ) ||
+	      format->channels != mixer->format.channels ))
 		return ISAUDK_BADFORMAT;
 
 	// Check that the format matches
@@ -189,6 +210,7 @@ isaudk_mixer_register_stream( struct isaudk_mixer_handle *mixer,
 		malloc((size_t) sizeof( struct per_stream_sample_buffer ));
 	if( sample_buffer == NULL )
 		return ISAUDK_NOMEMORY;
+	sample_buffer->format = format != NULL ? *format : mixer->format;
 	sample_buffer->idx = 0;
 	sample_buffer->flag = false;
 	sample_buffer->remainder = PS16_SAMPLE_COUNT/mixer->format.channels;
@@ -201,6 +223,7 @@ isaudk_mixer_register_stream( struct isaudk_mixer_handle *mixer,
 	{
 		sample_buffer->read_seq[i] = 1;
 		sample_buffer->write_seq[i] = 0;
+		sample_buffer->mixed[i] = false;
 	}
 	sample_buffer->eos = UCHAR_MAX;
 
@@ -209,13 +232,14 @@ isaudk_mixer_register_stream( struct isaudk_mixer_handle *mixer,
 	if( pthread_mutex_lock( &mixer->mixer_state_lock ) != 0 )
 		return ISAUDK_PTHREAD;
 
-	if( !ll_add_head( mixer->stream_list,
-			  isaudk_get_stream_mixer_reference( stream )))
+	if( mixer->stream_count == MIXER_MAX_STREAMS )
 	{
 		ret = ISAUDK_NOMEMORY;
 		goto unlock;
 	}
-
+	mixer->streams[mixer->stream_count] = stream;
+	__atomic_store_n( &mixer->stream_count, mixer->stream_count + 1,
+			  __ATOMIC_RELEASE );
 
 unlock:
 	if( pthread_mutex_unlock( &mixer->mixer_state_lock ) != 0 )
@@ -224,14 +248,17 @@ unlock:
 	return ret;
 }
 
-static unsigned get_buffer_sample_count( struct isaudk_mixer_handle *mixer )
+static unsigned get_buffer_sample_count( struct isaudk_format *format )
 {
-	switch( mixer->format.encoding )
+	switch( format->encoding )
 	{
 	default:
 		// Unsupported format request
 		return 0;
 	case ISAUDK_ENC_PS16:
+	case ISAUDK_ENC_PS24:
+	case ISAUDK_ENC_PS32:
+	case ISAUDK_ENC_PF32:
 		return PS16_SAMPLE_COUNT;
 	}
 
@@ -262,18 +289,18 @@ isaudk_mixer_set_buffer_sample_count( isaudk_stream_handle_t stream,
 	if( idx > PER_STREAM_BUFFER_COUNT - 1 )
 		return ISAUDK_INVALIDARG;
 
-	if( count > get_buffer_sample_count( mixer ))
+	if( count > get_buffer_sample_count( &buffer->format ))
 		return ISAUDK_INVALIDARG;
 
 	// This would cause us to over-write a buffer that hasn't rendered
-	if( UINT8_ADD( buffer->write_seq[idx], 1 ) != buffer->read_seq[idx] )
+	if( UINT8_ADD( buffer->write_seq[idx], 1 ) !=
+	    __atomic_load_n( &buffer->read_seq[idx], __ATOMIC_ACQUIRE ))
 	{
 		return ISAUDK_AGAIN;
 	}
 
-	pthread_mutex_lock( &mixer->mixer_state_lock );
-	thread_exit_code = mixer->thread_exit_code;
-	pthread_mutex_unlock( &mixer->mixer_state_lock );
+	thread_exit_code = __atomic_load_n( &mixer->thread_exit_code,
+					    __ATOMIC_ACQUIRE );
 	if( thread_exit_code != ISAUDK_SUCCESS )
 		return thread_exit_code;
 
@@ -281,7 +308,10 @@ isaudk_mixer_set_buffer_sample_count( isaudk_stream_handle_t stream,
 	if( eos )
 		buffer->eos = idx;
 
-	++buffer->write_seq[idx];
+	// Publishes the samples and count to the mixer loop
+	__atomic_store_n( &buffer->write_seq[idx],
+			  UINT8_ADD( buffer->write_seq[idx], 1 ),
+			  __ATOMIC_RELEASE );
 	isaudk_signal_send( mixer->wake_signal );
 
 	return ISAUDK_SUCCESS;
@@ -312,6 +342,98 @@ struct mixer_loop_arg
 	CHECKED_PTHREAD_CALL_FATAL			\
 	( pthread_mutex_unlock( &mixer->mixer_state_lock ), mixer )
 
+static struct per_stream_sample_buffer *
+get_stream_sample_buffer( struct isaudk_mixer_handle *mixer, unsigned i )
+{
+	return (struct per_stream_sample_buffer *)
+		isaudk_stream_get_mixer_private( mixer->streams[i] );
+}
+
+// Returns the output samples for buffer index idx. The first stream's
+// buffer is mixed with the same buffer of every other stream that is
+// ready, those are held until the first stream's buffer is played
+static void *mix_stream_buffers( struct isaudk_mixer_handle *mixer,
+				 unsigned idx )
+{
+	struct per_stream_sample_buffer *first, *stream_buffer;
+	unsigned stream_count, i;
+	uint8_t seq;
+
+	stream_count = __atomic_load_n( &mixer->stream_count,
+					__ATOMIC_ACQUIRE );
+	first = get_stream_sample_buffer( mixer, 0 );
+
+	// Nothing to mix, play the stream buffer directly
+	if( stream_count == 1 &&
+	    first->format.encoding == mixer->format.encoding )
+		return get_buffer_pointer( &mixer->format, first->buffer + idx );
+
+	seq = __atomic_load_n( &first->write_seq[idx], __ATOMIC_ACQUIRE );
+	if( mixer->mix_seq[idx] == seq )
+		return mixer->mix_buffer[idx].PS16;
+
+	isaudk_mix_clear( mixer->mix_acc, PS16_SAMPLE_COUNT );
+	isaudk_mix_accumulate( mixer->mix_acc, first->buffer + idx,
+			       first->format.encoding, PS16_SAMPLE_COUNT );
+	for( i = 1; i < stream_count; ++i )
+	{
+		stream_buffer = get_stream_sample_buffer( mixer, i );
+		if( !stream_buffer->mixed[idx] )
+		{
+			if( __atomic_load_n( &stream_buffer->write_seq[idx],
+					     __ATOMIC_ACQUIRE ) !=
+			    stream_buffer->read_seq[idx] )
+				continue;
+			stream_buffer->mixed[idx] = true;
+		}
+		isaudk_mix_accumulate( mixer->mix_acc,
+				       stream_buffer->buffer + idx,
+				       stream_buffer->format.encoding,
+				       stream_buffer->count[idx] );
+	}
+	isaudk_mix_store_ps16( mixer->mix_buffer[idx].PS16, mixer->mix_acc,
+			       PS16_SAMPLE_COUNT );
+	mixer->mix_seq[idx] = seq;
+
+	return mixer->mix_buffer[idx].PS16;
+}
+
+// Returns buffer index idx of the other streams once the first stream's
+// buffer is played
+static void release_stream_buffers( struct isaudk_mixer_handle *mixer,
+				    unsigned idx )
+{
+	struct per_stream_sample_buffer *stream_buffer;
+	unsigned stream_count, i;
+
+	stream_count = __atomic_load_n( &mixer->stream_count,
+					__ATOMIC_ACQUIRE );
+	for( i = 1; i < stream_count; ++i )
+	{
+		stream_buffer = get_stream_sample_buffer( mixer, i );
+		if( !stream_buffer->mixed[idx] )
+			continue;
+		stream_buffer->mixed[idx] = false;
+		__atomic_store_n( &stream_buffer->idx,
+				  ( idx + 1 ) % PER_STREAM_BUFFER_COUNT,
+				  __ATOMIC_RELEASE );
+		__atomic_store_n( &stream_buffer->read_seq[idx],
+				  UINT8_ADD( stream_buffer->read_seq[idx], 1 ),
+				  __ATOMIC_RELEASE );
+		isaudk_signal_send( stream_buffer->signal );
+	}
+}
+
+static void release_buffer( struct isaudk_mixer_handle *mixer,
+			    struct per_stream_sample_buffer *stream_buffer,
+			    unsigned idx )
+{
+	__atomic_store_n( &stream_buffer->read_seq[idx],
+			  UINT8_ADD( stream_buffer->read_seq[idx], 1 ),
+			  __ATOMIC_RELEASE );
+	release_stream_buffers( mixer, idx );
+}
+
 void *mixer_loop( void *_arg )
 {
 	struct mixer_loop_arg *arg = (struct mixer_loop_arg *) _arg;
@@ -323,6 +445,9 @@ void *mixer_loop( void *_arg )
 	int64_t remainder_sample_count, wait_buffer_count = -10, wait_time;
 	int64_t wait_samples, samples_played = 0;
 	double small_remainder;
+	int16_t *output = mixer->output_buffer.PS16;
+	int16_t offset = 0;
+	unsigned i;
 
 	void *buffer;
 	void *buffer_from;
@@ -339,6 +464,11 @@ void *mixer_loop( void *_arg )
 	mixer->start_time.time = ULLONG_MAX;
 	mixer->mode = ISAUDK_SILENCE;
 
+	// Output stays silent until the first audio buffer is copied in
+	memset( output, 0, PS16_SAMPLE_COUNT * sizeof( *output ));
+	// Differs from the initial write sequence, nothing is mixed yet
+	for( i = 0; i < PER_STREAM_BUFFER_COUNT; ++i )
+		mixer->mix_seq[i] = UCHAR_MAX;
 
 	mixer->audio_initial_cross_time.sys.time = 0;
 	mixer->audio_initial_cross_time.dev.time = 0;
@@ -352,7 +482,8 @@ void *mixer_loop( void *_arg )
 	if( sigerr != ISAUDK_SIGNAL_OK ) {
 		MIXER_LOOP_LOCK_MIXER;
 		mixer->running = false;
-		mixer->thread_exit_code = ISAUDK_PTHREAD;
+		__atomic_store_n( &mixer->thread_exit_code, ISAUDK_PTHREAD,
+				  __ATOMIC_RELEASE );
 		MIXER_LOOP_UNLOCK_MIXER;
 
 		return NULL;
@@ -363,15 +494,9 @@ void *mixer_loop( void *_arg )
 		unsigned samples_to_write;
 		bool write_result;
 		struct isaudk_cross_time curr_cross_time;
-		int16_t SILENCE[PS16_SAMPLE_COUNT] = {0};
-		int16_t offset;
 		int buffer_idx;
 
-		MIXER_LOOP_LOCK_MIXER;
-		stream = isaudk_mixer_reference_to_stream
-			( ll_get_addr( ll_get_head( mixer->stream_list )) );
-		MIXER_LOOP_UNLOCK_MIXER;
-
+		stream = mixer->streams[0];
 		stream_buffer = isaudk_stream_get_mixer_private( stream );
 		stream_buffer->remainder = 0;
 		buffer = get_buffer_pointer
@@ -380,7 +505,9 @@ void *mixer_loop( void *_arg )
 
 		// Play buffer
 		while( stream_buffer->read_seq[stream_buffer->idx] !=
-		       stream_buffer->write_seq[stream_buffer->idx] )
+		       __atomic_load_n
+		       ( &stream_buffer->write_seq[stream_buffer->idx],
+			 __ATOMIC_ACQUIRE ))
 		{
 			isaudk_signal_wait( mixer->wake_signal, 0 );
 		}
@@ -388,19 +515,14 @@ void *mixer_loop( void *_arg )
 		samples_to_write = stream_buffer->count[stream_buffer->idx];
 		if  (mixer->mode == ISAUDK_AUDIO) {
 			buffer_idx = stream_buffer->idx;
-			audio_buffer = get_buffer_pointer( &mixer->format, stream_buffer->buffer + buffer_idx );
-			if ( buffer_idx == (PER_STREAM_BUFFER_COUNT - 1) ) {
-				next_buffer = get_buffer_pointer( &mixer->format, stream_buffer->buffer );
-			}
-			else {
-				next_buffer = get_buffer_pointer( &mixer->format, stream_buffer->buffer + buffer_idx + 1 );
-			}
-			memcpy( (void *)( SILENCE ), (const void *)( &((int16_t *)(audio_buffer))[PS16_SAMPLE_COUNT - offset] ), offset*sizeof(int16_t) );
-			memcpy( (void *)( &(SILENCE[offset]) ), (const void *)(next_buffer), (PS16_SAMPLE_COUNT - offset)*sizeof(int16_t) );
-			write_result = mixer->output->fn->queue_output_buffer( mixer->output->ctx, SILENCE, &samples_to_write );
+			audio_buffer = mix_stream_buffers( mixer, buffer_idx );
+			next_buffer = mix_stream_buffers( mixer, ( buffer_idx + 1 ) % PER_STREAM_BUFFER_COUNT );
+			memcpy( (void *)( output ), (const void *)( &((int16_t *)(audio_buffer))[PS16_SAMPLE_COUNT - offset] ), offset*sizeof(int16_t) );
+			memcpy( (void *)( &(output[offset]) ), (const void *)(next_buffer), (PS16_SAMPLE_COUNT - offset)*sizeof(int16_t) );
+			write_result = mixer->output->fn->queue_output_buffer( mixer->output->ctx, output, &samples_to_write );
 		}
 		else {
-			write_result = mixer->output->fn->queue_output_buffer( mixer->output->ctx, SILENCE, &samples_to_write );
+			write_result = mixer->output->fn->queue_output_buffer( mixer->output->ctx, output, &samples_to_write );
 		}
 
 		buffer_cycles_done++;
@@ -409,14 +531,15 @@ void *mixer_loop( void *_arg )
 		if( !write_result )
 		{
 			MIXER_LOOP_LOCK_MIXER;
-			mixer->thread_exit_code = ISAUDK_FATAL;
+			__atomic_store_n( &mixer->thread_exit_code,
+					  ISAUDK_FATAL, __ATOMIC_RELEASE );
 			MIXER_LOOP_UNLOCK_MIXER;
 			break;
 		}
 
 		mixer->samples_written += samples_to_write;
 		if  (mixer->mode == ISAUDK_AUDIO ) {
-			++stream_buffer->read_seq[stream_buffer->idx];
+			release_buffer( mixer, stream_buffer, stream_buffer->idx );
 		}
 
 		if( !mixer->playing )
@@ -467,7 +590,9 @@ void *mixer_loop( void *_arg )
 				wait_time = mixer->requested_start_time.time - mixer->start_time.time;
 					if (wait_time < 0) {
 						mixer->start_time.time = 0xffffff;
-					stream_buffer->idx = ISAUDK_INVALIDTIME;
+					__atomic_store_n( &stream_buffer->idx,
+							  ISAUDK_INVALIDTIME,
+							  __ATOMIC_RELEASE );
 					isaudk_signal_send( stream_buffer->signal );
 					return NULL;
 				}
@@ -482,22 +607,21 @@ void *mixer_loop( void *_arg )
 				offset = 2*remainder_sample_count;
 				for (int i = 0; i < wait_buffer_count; i++) {
 					write_result = mixer->output->fn->queue_output_buffer
-						( mixer->output->ctx, SILENCE, &samples_to_write );
+						( mixer->output->ctx, output, &samples_to_write );
 				}
 
 
-				for (int i = 0; i < offset; i++) {
-					SILENCE[i] = 0;
-				}
-				buffer_from = get_buffer_pointer( &mixer->format,stream_buffer->buffer );
-				memcpy( (void *)( &(SILENCE[offset]) ), (const void *)buffer_from, (PS16_SAMPLE_COUNT - offset)*sizeof(int16_t) );
+				memset( output, 0, offset*sizeof(int16_t) );
+				buffer_from = mix_stream_buffers( mixer, 0 );
+				memcpy( (void *)( &(output[offset]) ), (const void *)buffer_from, (PS16_SAMPLE_COUNT - offset)*sizeof(int16_t) );
 
 				write_result = mixer->output->fn->queue_output_buffer
-					( mixer->output->ctx, SILENCE, &samples_to_write );
+					( mixer->output->ctx, output, &samples_to_write );
 
 				mixer->audio_start_time.time =mixer->start_time.time + wait_time - small_remainder;
-				stream_buffer->idx = 0;
-				++stream_buffer->read_seq[stream_buffer->idx];
+				__atomic_store_n( &stream_buffer->idx, 0,
+						  __ATOMIC_RELEASE );
+				release_buffer( mixer, stream_buffer, stream_buffer->idx );
 				stream_buffer->remainder = remainder_sample_count;
 				mixer->start_time.time = mixer->requested_start_time.time;
 				mixer->mode = ISAUDK_AUDIO;
@@ -525,7 +649,10 @@ void *mixer_loop( void *_arg )
 				mixer->output->fn->stop( mixer->output->ctx );
 				break;
 			}
-			stream_buffer->idx = ( stream_buffer->idx + 1 ) %PER_STREAM_BUFFER_COUNT;
+			__atomic_store_n( &stream_buffer->idx,
+					  ( stream_buffer->idx + 1 ) %
+					  PER_STREAM_BUFFER_COUNT,
+					  __ATOMIC_RELEASE );
 		}
 
 	}
@@ -535,7 +662,8 @@ void *mixer_loop( void *_arg )
 
 	// Send a signal at the end, if we exit abnormally the client may
 	// be "hung" waiting for a signal
-	isaudk_signal_send( stream_buffer->signal );
+	for( i = 0; i < mixer->stream_count; ++i )
+		isaudk_signal_send( get_stream_sample_buffer( mixer, i )->signal );
 
 	return NULL;
 }
@@ -632,14 +760,22 @@ isaudk_mixer_get_current_index( isaudk_stream_handle_t stream, bool *roll )
 	uint8_t retval;
 
 	buffer = isaudk_stream_get_mixer_private( stream );
-	retval = buffer->idx;
+	// The mixer loop moves idx and bumps read_seq while the client reads them
+	retval = __atomic_load_n( &buffer->idx, __ATOMIC_ACQUIRE );
+	// ISAUDK_INVALIDTIME once the requested start time has passed
+	if( retval >= PER_STREAM_BUFFER_COUNT )
+	{
+		*roll = false;
+		return retval;
+	}
 
-	if( buffer->write_seq[retval] != buffer->read_seq[retval] )
+	if( __atomic_load_n( &buffer->write_seq[retval], __ATOMIC_ACQUIRE ) !=
+	    __atomic_load_n( &buffer->read_seq[retval], __ATOMIC_ACQUIRE ))
 		*roll = true;
 	else
 		*roll = false;
 
-	return buffer->idx;
+	return retval;
 }
 
 bool
@@ -0,0 +1,249 @@
+/******************************************************************************
+
+  Copyright (c) 2018, Intel Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright notice,
+      this list of conditions and the following disclaimer.
+
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+   3. Neither the name of the Intel Corporation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include <mix_kernels.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+#include <math.h>
+
+// Mixes a set of streams in every supported encoding the way the mixer
+// loop does, without an audio device, and reports the time per block.
+// The SSE2 loops are checked against the scalar ones first, with random
+// samples, out of range floats and a block length that leaves a tail.
+
+#define BENCH_STREAMS		32
+#define BENCH_BLOCKS		10000
+#define BENCH_CHANNELS		2
+#define BENCH_RATE		48000
+
+static const isaudk_encoding_t encodings[] =
+{
+	ISAUDK_ENC_PS16, ISAUDK_ENC_PS24, ISAUDK_ENC_PS32, ISAUDK_ENC_PF32
+};
+#define ENCODING_COUNT ( sizeof( encodings ) / sizeof( encodings[0] ))
+
+// Fills the block with a full scale square wave
+static void fill_block( isaudk_sample_block_t *block,
+			isaudk_encoding_t encoding, unsigned stream )
+{
+	unsigned i;
+
+	for( i = 0; i < PS16_SAMPLE_COUNT; ++i )
+	{
+		bool high = (( i / BENCH_CHANNELS + stream ) / 24 ) % 2;
+
+		switch( encoding )
+		{
+		default:
+			break;
+		case ISAUDK_ENC_PS16:
+			block->PS16[i] = high ? INT16_MAX : INT16_MIN;
+			break;
+		case ISAUDK_ENC_PS24:
+			block->PS24[3*i] = high ? 0xFF : 0x00;
+			block->PS24[3*i+1] = high ? 0xFF : 0x00;
+			block->PS24[3*i+2] = high ? 0x7F : 0x80;
+			break;
+		case ISAUDK_ENC_PS32:
+			block->PS32[i] = high ? INT32_MAX : INT32_MIN;
+			break;
+		case ISAUDK_ENC_PF32:
+			block->PF32[i] = high ? 1.0 : -1.0;
+			break;
+		}
+	}
+}
+
+// Fills the block with random samples. Floats run past full scale and
+// include a NaN and both infinities.
+static void fill_random( isaudk_sample_block_t *block,
+			 isaudk_encoding_t encoding, uint32_t seed )
+{
+	unsigned i;
+
+	for( i = 0; i < sizeof( block->PS24 ); ++i )
+	{
+		seed = seed * 1664525 + 1013904223;
+		block->PS24[i] = seed >> 24;
+	}
+	if( encoding != ISAUDK_ENC_PF32 )
+		return;
+	for( i = 0; i < PS16_SAMPLE_COUNT; ++i )
+	{
+		seed = seed * 1664525 + 1013904223;
+		block->PF32[i] = (float) (int32_t) seed / ( 1U << 30 ) * 0.625;
+	}
+	block->PF32[1] = NAN;
+	block->PF32[2] = INFINITY;
+	block->PF32[3] = -INFINITY;
+}
+
+static void mix_blocks( int32_t *acc, int16_t *out,
+			const isaudk_sample_block_t *input, unsigned streams,
+			int encoding, unsigned count )
+{
+	unsigned i;
+
+	isaudk_mix_clear( acc, PS16_SAMPLE_COUNT );
+	for( i = 0; i < streams; ++i )
+		isaudk_mix_accumulate( acc, input + i, encoding < 0 ?
+				       encodings[i % ENCODING_COUNT] :
+				       encodings[encoding], count );
+	isaudk_mix_store_ps16( out, acc, count );
+}
+
+// Mixes each encoding alone, then all of them, with and without the SSE2
+// loops. Returns the number of mixes that differ.
+static unsigned compare_kernels( isaudk_sample_block_t *input,
+				 unsigned streams )
+{
+	static const char *names[] = { "PS16", "PS24", "PS32", "PF32" };
+	static int32_t acc[2][PS16_SAMPLE_COUNT];
+	static int16_t out[2][PS16_SAMPLE_COUNT];
+	const unsigned counts[] = { PS16_SAMPLE_COUNT, PS16_SAMPLE_COUNT - 5 };
+	unsigned failed = 0;
+	unsigned c, i, v;
+	int e;
+
+	for( c = 0; c < sizeof( counts ) / sizeof( counts[0] ); ++c )
+	for( e = -1; e < (int) ENCODING_COUNT; ++e )
+	{
+		for( i = 0; i < streams; ++i )
+			fill_random( input + i, e < 0 ?
+				     encodings[i % ENCODING_COUNT] :
+				     encodings[e], i + 1 );
+		for( v = 0; v < 2; ++v )
+		{
+			isaudk_mix_set_vector( v == 0 );
+			memset( acc[v], 0, sizeof( acc[v] ));
+			memset( out[v], 0, sizeof( out[v] ));
+			mix_blocks( acc[v], out[v], input, streams, e,
+				    counts[c] );
+		}
+		isaudk_mix_set_vector( true );
+
+		for( i = 0; i < counts[c]; ++i )
+			if( acc[0][i] != acc[1][i] || out[0][i] != out[1][i] )
+				break;
+		if( i < counts[c] )
+		{
+			printf( "%s, %u samples: SSE2 and scalar differ at "
+				"sample %u (%" PRId32 "/%d vs %" PRId32 "/%d)\n",
+				e < 0 ? "all encodings" : names[e], counts[c],
+				i, acc[0][i], out[0][i], acc[1][i],
+				out[1][i] );
+			++failed;
+		}
+	}
+
+	return failed;
+}
+
+static uint64_t now_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int main( int argc, char **argv )
+{
+	static isaudk_sample_block_t input[BENCH_STREAMS];
+	static int32_t acc[PS16_SAMPLE_COUNT];
+	static isaudk_sample_block_t output;
+	unsigned streams = BENCH_STREAMS;
+	unsigned blocks = BENCH_BLOCKS;
+	unsigned clipped = 0;
+	unsigned failed;
+	uint64_t start, elapsed;
+	double block_ns[2], realtime_ns;
+	bool vector;
+	unsigned i, j, v;
+
+	if( argc > 1 )
+		streams = atoi( argv[1] );
+	if( argc > 2 )
+		blocks = atoi( argv[2] );
+	if( streams == 0 || streams > BENCH_STREAMS || blocks == 0 )
+	{
+		fprintf( stderr, "Usage: %s [streams (1-%u)] [blocks]\n",
+			 argv[0], BENCH_STREAMS );
+		return 1;
+	}
+
+	vector = isaudk_mix_set_vector( true );
+	failed = vector ? compare_kernels( input, streams ) : 0;
+	if( vector )
+		printf( "SSE2 and scalar mixes %s\n",
+			failed ? "differ" : "match" );
+	else
+		printf( "SSE2 not compiled in, timing the scalar mix only\n" );
+
+	for( i = 0; i < streams; ++i )
+		fill_block( input + i, encodings[i % ENCODING_COUNT], i );
+
+	for( v = 0; v < ( vector ? 2 : 1 ); ++v )
+	{
+		isaudk_mix_set_vector( v == 0 );
+		start = now_ns();
+		for( j = 0; j < blocks; ++j )
+			mix_blocks( acc, output.PS16, input, streams, -1,
+				    PS16_SAMPLE_COUNT );
+		elapsed = now_ns() - start;
+		block_ns[v] = (double) elapsed / blocks;
+	}
+	isaudk_mix_set_vector( true );
+
+	for( i = 0; i < PS16_SAMPLE_COUNT; ++i )
+		if( output.PS16[i] == INT16_MAX || output.PS16[i] == INT16_MIN )
+			++clipped;
+
+	realtime_ns = 1000000000.0 * PS16_SAMPLE_COUNT /
+		( BENCH_CHANNELS * BENCH_RATE );
+	printf( "Mixed %u streams x %u blocks of %u samples\n", streams,
+		blocks, PS16_SAMPLE_COUNT );
+	for( v = 0; v < ( vector ? 2 : 1 ); ++v )
+		printf( "%-6s %.0f ns per block, %.1f ns per stream block, "
+			"%.2f%% of real time\n", v == 0 && vector ? "SSE2" :
+			"scalar", block_ns[v], block_ns[v] / streams,
+			100.0 * block_ns[v] / realtime_ns );
+	printf( "Saturated samples in last block: %u\n", clipped );
+
+	return failed ? 1 : 0;
+}
@@ -107,6 +107,9 @@ typedef enum
 {
 	ISAUDK_ENC_NONE,	//!< Defer format
 	ISAUDK_ENC_PS16 = 0x02,	//!< PCM signed 16 bit
+	ISAUDK_ENC_PS24 = 0x03,	//!< PCM signed 24 bit, packed 3 byte little endian
+	ISAUDK_ENC_PS32 = 0x04,	//!< PCM signed 32 bit
+	ISAUDK_ENC_PF32 = 0x05,	//!< PCM 32 bit float, full scale is +/-1.0
 } isaudk_encoding_t;
 
 //! \def PS16_SAMPLE_COUNT
@@ -146,10 +149,15 @@ extern const isaudk_sample_rate_t _48K_SAMPLE_RATE;
 //! \union isaudk_sample_block_t
 //! \brief Sample block.
 //! \details	Maximum 4096 byte block containing a whole number of audio
-//!		frames for common channel configuration and sample sizes
+//!		frames for common channel configuration and sample sizes.
+//!		A block carries PS16_SAMPLE_COUNT sample values in any
+//!		encoding
 typedef union
 {
 	int16_t PS16[2*PS16_SAMPLE_COUNT]; //!< 16 bit signed sample values
+	uint8_t PS24[3*PS16_SAMPLE_COUNT]; //!< packed 24 bit sample values
+	int32_t PS32[PS16_SAMPLE_COUNT];   //!< 32 bit signed sample values
+	float   PF32[PS16_SAMPLE_COUNT];   //!< 32 bit float sample values
 } isaudk_sample_block_t;
 
 //! \union isaudk_jumbo_sample_block_t
@@ -61,6 +61,12 @@ get_buffer_pointer( struct isaudk_format *format,
 		return NULL;
 	case ISAUDK_ENC_PS16:
 		return buffer->PS16;
+	case ISAUDK_ENC_PS24:
+		return buffer->PS24;
+	case ISAUDK_ENC_PS32:
+		return buffer->PS32;
+	case ISAUDK_ENC_PF32:
+		return buffer->PF32;
 	}
 
 	return NULL;
@@ -5,233 +5,156 @@
 #include <errno.h>
 #include <pcap.h>
 #include <unistd.h>
-#include <sys/time.h> 
+#include <sys/time.h>
 #include "async_pcap_storing.h"
 
-struct storing_packet {
-    void *mem;
-    uint32_t size;
+/*
+ * Frames are copied into a preallocated ring of fixed-size slots. The
+ * capture thread is the only producer and the storing thread the only
+ * consumer, so the ring needs no locks: each side owns one index and
+ * publishes it with a release store.
+ */
+
+// Slots written to the file before the consumer index is published
+#define STORE_BATCH         64
+// Storing thread sleep when the ring is empty
+#define STORE_IDLE_USEC     100
+// stdio buffer of the dump file, so pcap_dump ends up in large writes
+#define STORE_FILE_BUFFER   (1024 * 1024)
+
+struct storing_slot {
     uint32_t used_size;
     uint32_t real_size;
     uint64_t ts;
-    struct storing_packet *next;
 };
 
 struct pcap_store_control {
-    struct storing_packet *free;
-    struct storing_packet *busy;
-    struct storing_packet *last_busy;
+    struct storing_slot *slots;
+    uint8_t *mem;
+    uint32_t slot_count;    // power of two
+    uint32_t slot_size;
+    uint32_t head;          // written by the producer only
+    uint32_t tail;          // written by the storing thread only
+    uint32_t lost;
+    pcap_t *pcap;
     pcap_dumper_t *pd;
+    FILE *file;
+    char *file_buf;
     pthread_t thread_id;
-    pthread_mutex_t free_lock;
-    pthread_mutex_t busy_lock;
+    int thread_started;
     uint32_t stop_signal;
-    uint32_t stop_confirm;
 };
 
-static void release_packets(struct storing_packet *packet)
+static uint32_t load_acquire(uint32_t *p)
 {
-    struct storing_packet *next;
-    while( packet ) {
-        next = packet->next;
-        if( packet->mem ) {
-            free(packet->mem);
-        }
-        free(packet);
-        packet = next;
-    }
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
 }
 
-static struct storing_packet *alloc_packet(uint32_t size)
+static void store_release(uint32_t *p, uint32_t val)
 {
-    struct storing_packet *packet = malloc(sizeof(*packet));
-    if( packet ) {
-        packet->next = NULL;
-        packet->size = size;
-        packet->used_size = 0;
-        packet->real_size = 0;
-        packet->ts = 0;
-        packet->mem = malloc(size);
-        if( !packet->mem ) {
-            free(packet);
-            packet = NULL;
-        }
-    }
-    return packet;
+    __atomic_store_n(p, val, __ATOMIC_RELEASE);
 }
 
-static void dump_in_file(void *context, struct storing_packet *store_packet)
+static void dump_slot(struct pcap_store_control *ctrl, uint32_t idx)
 {
-    struct pcap_store_control *ctrl = (struct pcap_store_control *)context;
-    while( store_packet ) {
-        if( store_packet->real_size ) {
-            struct pcap_pkthdr pkt_hdr;
-            pkt_hdr.ts.tv_sec = store_packet->ts / 1000000000;
-            pkt_hdr.ts.tv_usec = (store_packet->ts - 1000000000 * pkt_hdr.ts.tv_sec); // / 1000;
-            pkt_hdr.caplen = store_packet->used_size;
-            pkt_hdr.len = store_packet->real_size;
-            pcap_dump((u_char *)ctrl->pd, &pkt_hdr, store_packet->mem);
-            store_packet->used_size = 0;
-            store_packet->real_size = 0;
-            //printf("Store packet %p in file\n", store_packet);
+    struct storing_slot *slot = &ctrl->slots[idx];
+    struct pcap_pkthdr pkt_hdr;
+
+    pkt_hdr.ts.tv_sec = slot->ts / 1000000000;
+    pkt_hdr.ts.tv_usec = (slot->ts - 1000000000 * pkt_hdr.ts.tv_sec); // nanosecond precision file
+    pkt_hdr.caplen = slot->used_size;
+    pkt_hdr.len = slot->real_size;
+    pcap_dump((u_char *)ctrl->pd, &pkt_hdr, ctrl->mem + (size_t)idx * ctrl->slot_size);
+}
+
+/* Write out everything queued so far. Returns the number of frames stored. */
+static uint32_t dump_ready(struct pcap_store_control *ctrl)
+{
+    uint32_t tail = ctrl->tail;
+    uint32_t head = load_acquire(&ctrl->head);
+    uint32_t count = 0;
+
+    while( tail != head ) {
+        uint32_t batch_end = head - tail > STORE_BATCH ? tail + STORE_BATCH : head;
+        for( ; tail != batch_end; tail++, count++ ) {
+            dump_slot(ctrl, tail & (ctrl->slot_count - 1));
         }
-        store_packet = store_packet->next;
+        store_release(&ctrl->tail, tail);
+        head = load_acquire(&ctrl->head);
     }
+    return count;
 }
 
 static void *store_thread(void *context)
 {
-    int res;
     struct pcap_store_control *ctrl = (struct pcap_store_control *)context;
-    struct storing_packet *store_packet = NULL;
-    ctrl->stop_confirm = 0;
-    while( !ctrl->stop_signal ) {
-        if( store_packet ) {
-            res = pthread_mutex_trylock(&ctrl->free_lock);
-            if( res == EBUSY ) {
-                usleep(1);
-                continue;
-            } else if ( res ) {
-                printf("Mutex error: %s!", strerror(errno));
-                break;
-            }
-            store_packet->next = ctrl->free;
-            ctrl->free = store_packet;
-            pthread_mutex_unlock(&ctrl->free_lock);
-            store_packet = NULL;
-        }
-
-        if( !ctrl->busy ) {
-            usleep(1);
-            continue;
-        }
+    int flushed = 1;
 
-        res = pthread_mutex_trylock(&ctrl->busy_lock);
-        if( res == EBUSY ) {
-            usleep(1);
+    while( !__atomic_load_n(&ctrl->stop_signal, __ATOMIC_ACQUIRE) ) {
+        if( dump_ready(ctrl) ) {
+            flushed = 0;
             continue;
-        } else if ( res ) {
-            printf("Mutex error: %s!", strerror(errno));
-            break;
         }
-        store_packet = ctrl->busy;
-        ctrl->busy = ctrl->busy->next;
-        if( ctrl->last_busy == store_packet ) {
-            ctrl->last_busy = ctrl->busy;
+        if( !flushed ) {
+            // Idle: let the file catch up with what has been captured
+            pcap_dump_flush(ctrl->pd);
+            flushed = 1;
         }
-        pthread_mutex_unlock(&ctrl->busy_lock);
-        store_packet->next = NULL;
-        dump_in_file(context, store_packet);
+        usleep(STORE_IDLE_USEC);
     }
-    //printf("Thread exit. Busy packets: %p\n", ctrl->busy);
-    if( store_packet ) {
-        release_packets(store_packet);
-    }
-
-    ctrl->stop_confirm = 1;
+    dump_ready(ctrl);
     return NULL;
 }
 
 int async_pcap_store_packet(void *context, void *buf, uint32_t size, uint64_t ts)
 {
     struct pcap_store_control *ctrl = (struct pcap_store_control *)context;
-    struct storing_packet *store_packet = NULL;
-    int i, res = 0;
-    if( ctrl->free ) {
-        for( i = 100; i; i--) {
-            res = pthread_mutex_trylock(&ctrl->free_lock);
-            if( !res ) {
-                break;
-            } else if ( res !=EBUSY ) {
-                printf("Mutex error: %s!", strerror(errno));
-                break;
-            }
-            usleep(1);
-        }
-    } else {
-        res = ENOMEM;
-    }
-
-    if( res ) {
-        store_packet = alloc_packet(size);
-    } else {
-        store_packet = ctrl->free;
-        ctrl->free = store_packet->next;
-        pthread_mutex_unlock(&ctrl->free_lock);
-        store_packet->next = NULL;
-    }
-
-    //printf("Add packet. %p. Res %x\n", store_packet, res);
-    if( !store_packet ) {
-        return -ENOMEM;
-    }
+    struct storing_slot *slot;
+    uint32_t head = ctrl->head;
+    uint32_t idx;
 
-    store_packet->used_size = size < store_packet->size ? size : store_packet->size;
-    store_packet->real_size = size;
-    memcpy(store_packet->mem, buf, store_packet->used_size);
-    store_packet->ts = ts;
-
-    for( i = 1000; i; i--) {
-        res = pthread_mutex_trylock(&ctrl->busy_lock);
-        if( !res ) {
-            break;
-        } else if ( res !=EBUSY ) {
-            printf("Mutex error: %s!", strerror(errno));
-            break;
+    if( head - load_acquire(&ctrl->tail) >= ctrl->slot_count ) {
+        if( !ctrl->lost++ ) {
+            printf("Loose packet! ts %lu. Storing does not keep up, further losses are counted\n", ts);
         }
-        usleep(1);
+        return -ENOBUFS;
     }
-    if( !res ) {
-        if( ctrl->last_busy ) {
-            ctrl->last_busy->next = store_packet;
-        } else {
-            ctrl->busy = store_packet;
-        }
-        ctrl->last_busy = store_packet;
-        pthread_mutex_unlock(&ctrl->busy_lock);
-    } else {
-        printf("Loose packet! ts %lu\n", ts);
-        release_packets(store_packet);
-    }
-    return res;
+
+    idx = head & (ctrl->slot_count - 1);
+    slot = &ctrl->slots[idx];
+    slot->used_size = size < ctrl->slot_size ? size : ctrl->slot_size;
+    slot->real_size = size;
+    slot->ts = ts;
+    memcpy(ctrl->mem + (size_t)idx * ctrl->slot_size, buf, slot->used_size);
+    store_release(&ctrl->head, head + 1);
+    return 0;
 }
 
 void async_pcap_release_context(void *context)
 {
     struct pcap_store_control *ctrl = (struct pcap_store_control *)context;
     if( ctrl ) {
-        int i;
-        ctrl->stop_signal = 1;
-        for(i = 100; i && !ctrl->stop_confirm; i-- ) {
-            usleep(1);
-            continue;
-        };
-
-        if( !ctrl->stop_confirm ) {
-            void *ret;
-            pthread_cancel(ctrl->thread_id);
-            pthread_join(ctrl->thread_id, &ret);
-            printf("Cannot close thread correctly! Cancel it! Result: %p.", ret);
+        if( ctrl->thread_started ) {
+            __atomic_store_n(&ctrl->stop_signal, 1, __ATOMIC_RELEASE);
+            pthread_join(ctrl->thread_id, NULL);
         }
 
-        if( ctrl->busy ) {
-            dump_in_file(context, ctrl->busy);
-            release_packets(ctrl->busy);
-            ctrl->busy = NULL;
-            ctrl->last_busy = NULL;
+        if( ctrl->lost ) {
+            printf("Lost %u packets while storing to pcap file\n", ctrl->lost);
         }
 
         if( ctrl->pd ) {
+            // Also closes ctrl->file
             pcap_dump_close(ctrl->pd);
-            ctrl->pd = NULL;
+        } else if( ctrl->file ) {
+            fclose(ctrl->file);
         }
-
-        if( ctrl->free ) {
-            release_packets(ctrl->free);
-            ctrl->free = NULL;
+        if( ctrl->pcap ) {
+            pcap_close(ctrl->pcap);
         }
-        pthread_mutex_destroy(&ctrl->busy_lock);
-        pthread_mutex_destroy(&ctrl->free_lock);
+        free(ctrl->file_buf);
+        free(ctrl->mem);
+        free(ctrl->slots);
         free(ctrl);
     }
 }
@@ -240,55 +163,56 @@ int async_pcap_initialize_context(char *file_name, uint32_t packet_count, uint32
 {
     int res;
     struct pcap_store_control *ctrl;
-    pcap_t *pcap;
+    uint32_t slot_count = 1;
 
     if( !context || !packet_count || !packet_size ) {
         return -EINVAL;
     }
 
-    ctrl = (struct pcap_store_control *)malloc(sizeof(*ctrl));
-    if( !ctrl ) {
-        return -ENOMEM;
+    // Round up so that the ring index is a mask
+    while( slot_count < packet_count ) {
+        if( slot_count & 0x80000000 ) {
+            return -EINVAL;
+        }
+        slot_count <<= 1;
     }
-    ctrl->free = NULL;
-    ctrl->busy = NULL;
-    ctrl->stop_signal = 0;
-    ctrl->stop_confirm = 1;
-    ctrl->last_busy = NULL;
 
-    if( res = pthread_mutex_init(&ctrl->busy_lock, NULL) ) {
-        free(ctrl);
-        return res;
+    ctrl = (struct pcap_store_control *)calloc(1, sizeof(*ctrl));
+    if( !ctrl ) {
+        return -ENOMEM;
     }
+    ctrl->slot_count = slot_count;
+    ctrl->slot_size = packet_size;
 
-    if( res = pthread_mutex_init(&ctrl->free_lock, NULL) ) {
-        pthread_mutex_destroy(&ctrl->busy_lock);
-        free(ctrl);
-        return res;
+    ctrl->slots = calloc(slot_count, sizeof(*ctrl->slots));
+    ctrl->mem = malloc((size_t)slot_count * packet_size);
+    if( !ctrl->slots || !ctrl->mem ) {
+        printf("Cannot allocate memory for packets! Packet count %u. Packet size %u\n", slot_count, packet_size);
+        async_pcap_release_context(ctrl);
+        return -ENOMEM;
     }
+    // Touch the ring now rather than on the first frames of the capture
+    memset(ctrl->mem, 0, (size_t)slot_count * packet_size);
 
-    pcap = pcap_open_dead_with_tstamp_precision(DLT_EN10MB, packet_size, PCAP_TSTAMP_PRECISION_NANO);
-    ctrl->pd = pcap_dump_open(pcap, file_name);
-    if( ctrl->pd == NULL )  {
+    ctrl->file = fopen(file_name, "wb");
+    if( ctrl->file == NULL ) {
+        printf("PCAP Dump open error! %s: %s\n", file_name, strerror(errno));
         async_pcap_release_context(ctrl);
-        printf("PCAP Dump open error! %s\n", pcap_geterr(pcap));
         return -ENFILE;
     }
-
-    while( --packet_count ) {
-        struct storing_packet *new_pkt = alloc_packet(packet_size);
-        if( !new_pkt ) {
-            printf("Cannot allocate memory for packets! Rest of packets: %d. Packet size %d\n", packet_count, packet_size);
-            break;
-        }
-        new_pkt->next = ctrl->free;
-        ctrl->free = new_pkt;
+    ctrl->file_buf = malloc(STORE_FILE_BUFFER);
+    if( ctrl->file_buf ) {
+        setvbuf(ctrl->file, ctrl->file_buf, _IOFBF, STORE_FILE_BUFFER);
     }
 
-    if( packet_count > 0 ) {
+    ctrl->pcap = pcap_open_dead_with_tstamp_precision(DLT_EN10MB, packet_size, PCAP_TSTAMP_PRECISION_NANO);
+    if( ctrl->pcap ) {
+        ctrl->pd = pcap_dump_fopen(ctrl->pcap, ctrl->file);
+    }
+    if( ctrl->pd == NULL )  {
+        printf("PCAP Dump open error! %s\n", ctrl->pcap ? pcap_geterr(ctrl->pcap) : "no pcap handle");
         async_pcap_release_context(ctrl);
-        printf("Cannot allocate memory! Packet count %d. Error: %s\n", packet_count, strerror(res));
-        return -ENOMEM;
+        return -ENFILE;
     }
 
     res = pthread_create(&ctrl->thread_id, NULL, &store_thread, ctrl);
@@ -298,15 +222,7 @@ int async_pcap_initialize_context(char *file_name, uint32_t packet_count, uint32
         async_pcap_release_context(ctrl);
         return res;
     }
-    for( res = 100; res && ctrl->stop_confirm; res-- ) {
-        usleep(100);
-    }
-
-    if( ctrl->stop_confirm ) {
-        printf("Thread is not run! Exit.");
-        async_pcap_release_context(ctrl);
-        return res;
-    }
+    ctrl->thread_started = 1;
 
     *context = ctrl;
     return 0;
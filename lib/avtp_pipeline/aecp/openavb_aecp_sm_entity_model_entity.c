@@ -44,6 +44,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define	AVB_LOG_COMPONENT	"AECP"
 #include "openavb_log.h"
 
+#include "openavb_time.h"
 #include "openavb_aem.h"
 #include "openavb_aecp.h"
 #include "openavb_aecp_message.h"
@@ -81,6 +82,35 @@ THREAD_DEFINITON(openavbAecpSMEntityModelEntityThread);
 
 static openavb_list_t s_commandQueue = NULL;
 
+// Controllers registered for unsolicited notifications IEEE Std 1722.1-2013 clause 7.5.1
+#define AECP_MAX_UNSOLICITED_CONTROLLERS	8
+// Counters are sent unsolicited at most once per second IEEE Std 1722.1-2013 clause 7.4.42
+#define AECP_UNSOLICITED_COUNTERS_MSEC		1000
+// Descriptors whose counters are tracked for unsolicited GET_COUNTERS responses
+#define AECP_MAX_UNSOLICITED_COUNTERS		16
+
+typedef struct {
+	bool inUse;
+	U8 host[ETH_ALEN];
+	U8 controller_entity_id[8];
+	U16 sequence_id;
+} aecp_unsolicited_controller_t;
+
+typedef struct {
+	U16 descriptor_type;
+	U16 descriptor_index;
+	U32 counters_valid;
+	U8 counters_block[128];
+} aecp_unsolicited_counters_t;
+
+static aecp_unsolicited_controller_t s_unsolicitedControllers[AECP_MAX_UNSOLICITED_CONTROLLERS];
+static int s_unsolicitedControllerCount = 0;
+// AVTP control header of the last registration, used for the unsolicited responses
+static openavb_aecp_control_header_t s_unsolicitedHeaders;
+// Counters last sent to the controllers
+static aecp_unsolicited_counters_t s_unsolicitedCounters[AECP_MAX_UNSOLICITED_COUNTERS];
+static U64 s_nextCountersNS = 0;
+
 // Returns 1 if the queue was not empty before adding the new command,
 //  0 if the queue was empty before adding the new command,
 //  or -1 if an error occurred.
@@ -260,6 +290,142 @@ bool processCommandCheckRestriction_StreamNotRunning(U16 descriptor_type, U16 de
 }
 
 // Process an incoming command and make it the response data on return.
+static U8 registerUnsolicited(openavb_aecp_AEMCommandResponse_t *pCommand)
+{
+	aecp_unsolicited_controller_t *pFree = NULL;
+	int i1;
+
+	for (i1 = 0; i1 < AECP_MAX_UNSOLICITED_CONTROLLERS; i1++) {
+		aecp_unsolicited_controller_t *pController = &s_unsolicitedControllers[i1];
+		if (pController->inUse) {
+			if (memcmp(pController->controller_entity_id, pCommand->commonPdu.controller_entity_id, sizeof(pController->controller_entity_id)) == 0) {
+				// Already registered. The controller may have moved.
+				memcpy(pController->host, pCommand->host, ETH_ALEN);
+				return OPENAVB_AEM_COMMAND_STATUS_SUCCESS;
+			}
+		}
+		else if (!pFree) {
+			pFree = pController;
+		}
+	}
+	if (!pFree) {
+		return OPENAVB_AEM_COMMAND_STATUS_NO_RESOURCES;
+	}
+
+	pFree->inUse = TRUE;
+	memcpy(pFree->host, pCommand->host, ETH_ALEN);
+	memcpy(pFree->controller_entity_id, pCommand->commonPdu.controller_entity_id, sizeof(pFree->controller_entity_id));
+	pFree->sequence_id = 0;
+	s_unsolicitedControllerCount++;
+	memcpy(&s_unsolicitedHeaders, &pCommand->headers, sizeof(s_unsolicitedHeaders));
+
+	// Send all the counters with the next check, so the new controller gets them.
+	memset(s_unsolicitedCounters, 0, sizeof(s_unsolicitedCounters));
+	s_nextCountersNS = 0;
+	return OPENAVB_AEM_COMMAND_STATUS_SUCCESS;
+}
+
+static U8 deregisterUnsolicited(openavb_aecp_AEMCommandResponse_t *pCommand)
+{
+	int i1;
+
+	for (i1 = 0; i1 < AECP_MAX_UNSOLICITED_CONTROLLERS; i1++) {
+		aecp_unsolicited_controller_t *pController = &s_unsolicitedControllers[i1];
+		if (pController->inUse
+				&& memcmp(pController->controller_entity_id, pCommand->commonPdu.controller_entity_id, sizeof(pController->controller_entity_id)) == 0) {
+			pController->inUse = FALSE;
+			s_unsolicitedControllerCount--;
+		}
+	}
+	return OPENAVB_AEM_COMMAND_STATUS_SUCCESS;
+}
+
+// Send a response to every controller registered for unsolicited notifications.
+static void sendUnsolicited(openavb_aecp_AEMCommandResponse_t *pResponse)
+{
+	int i1;
+
+	memcpy(&pResponse->headers, &s_unsolicitedHeaders, sizeof(pResponse->headers));
+	pResponse->headers.message_type = OPENAVB_AECP_MESSAGE_TYPE_AEM_RESPONSE;
+	pResponse->headers.status = OPENAVB_AEM_COMMAND_STATUS_SUCCESS;
+	memcpy(pResponse->headers.target_entity_id, openavbAecpSMGlobalVars.myEntityID, sizeof(pResponse->headers.target_entity_id));
+	pResponse->entityModelPdu.u = 1;
+
+	for (i1 = 0; i1 < AECP_MAX_UNSOLICITED_CONTROLLERS; i1++) {
+		aecp_unsolicited_controller_t *pController = &s_unsolicitedControllers[i1];
+		if (pController->inUse) {
+			memcpy(pResponse->host, pController->host, ETH_ALEN);
+			memcpy(pResponse->commonPdu.controller_entity_id, pController->controller_entity_id, sizeof(pController->controller_entity_id));
+			pResponse->commonPdu.sequence_id = pController->sequence_id++;
+			openavbAecpMessageSend(pResponse);
+		}
+	}
+}
+
+// Returns TRUE when the counters should be checked for changes.
+static bool unsolicitedCountersDue(void)
+{
+	U64 nowNS;
+
+	if (s_unsolicitedControllerCount == 0) {
+		return FALSE;
+	}
+	if (!CLOCK_GETTIME64(OPENAVB_CLOCK_MONOTONIC, &nowNS)) {
+		return FALSE;
+	}
+	return nowNS >= s_nextCountersNS;
+}
+
+// Send an unsolicited GET_COUNTERS response for every descriptor whose counters changed since the last check.
+static void sendChangedCounters(void)
+{
+	static const U16 descriptorTypes[] = {
+		OPENAVB_AEM_DESCRIPTOR_ENTITY,
+		OPENAVB_AEM_DESCRIPTOR_AVB_INTERFACE,
+		OPENAVB_AEM_DESCRIPTOR_CLOCK_DOMAIN,
+		OPENAVB_AEM_DESCRIPTOR_STREAM_INPUT,
+	};
+	static openavb_aecp_AEMCommandResponse_t response;
+	openavb_aecp_command_data_get_counters_t *pCmd = &response.entityModelPdu.command_data.getCountersCmd;
+	openavb_aecp_response_data_get_counters_t *pRsp = &response.entityModelPdu.command_data.getCountersRsp;
+	U16 configIdx = openavbAemGetConfigIdx();
+	U64 nowNS;
+	int tracked = 0;
+	unsigned int i1;
+
+	if (CLOCK_GETTIME64(OPENAVB_CLOCK_MONOTONIC, &nowNS)) {
+		s_nextCountersNS = nowNS + ((U64)AECP_UNSOLICITED_COUNTERS_MSEC * NANOSECONDS_PER_MSEC);
+	}
+
+	for (i1 = 0; i1 < sizeof(descriptorTypes) / sizeof(descriptorTypes[0]); i1++) {
+		U16 descriptorIdx;
+		for (descriptorIdx = 0;
+				tracked < AECP_MAX_UNSOLICITED_COUNTERS && openavbAemGetDescriptor(configIdx, descriptorTypes[i1], descriptorIdx);
+				descriptorIdx++) {
+			memset(&response, 0, sizeof(response));
+			response.entityModelPdu.command_type = OPENAVB_AEM_COMMAND_CODE_GET_COUNTERS;
+			pCmd->descriptor_type = descriptorTypes[i1];
+			pCmd->descriptor_index = descriptorIdx;
+			if (openavbAecpCommandGetCountersHandler(pCmd, pRsp) != OPENAVB_AEM_COMMAND_STATUS_SUCCESS || !pRsp->counters_valid) {
+				continue;
+			}
+
+			aecp_unsolicited_counters_t *pSent = &s_unsolicitedCounters[tracked++];
+			if (pSent->descriptor_type == pRsp->descriptor_type
+					&& pSent->descriptor_index == pRsp->descriptor_index
+					&& pSent->counters_valid == pRsp->counters_valid
+					&& memcmp(pSent->counters_block, pRsp->counters_block, sizeof(pSent->counters_block)) == 0) {
+				continue;
+			}
+			pSent->descriptor_type = pRsp->descriptor_type;
+			pSent->descriptor_index = pRsp->descriptor_index;
+			pSent->counters_valid = pRsp->counters_valid;
+			memcpy(pSent->counters_block, pRsp->counters_block, sizeof(pSent->counters_block));
+			sendUnsolicited(&response);
+		}
+	}
+}
+
 void processCommand()
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AECP);
@@ -1057,8 +1223,10 @@ void processCommand()
 			}
 			break;
 		case OPENAVB_AEM_COMMAND_CODE_REGISTER_UNSOLICITED_NOTIFICATION:
+			pCommand->headers.status = registerUnsolicited(pCommand);
 			break;
 		case OPENAVB_AEM_COMMAND_CODE_DEREGISTER_UNSOLICITED_NOTIFICATION:
+			pCommand->headers.status = deregisterUnsolicited(pCommand);
 			break;
 		case OPENAVB_AEM_COMMAND_CODE_IDENTIFY_NOTIFICATION:
 			break;
@@ -1166,9 +1334,16 @@ void openavbAecpSMEntityModelEntityStateMachine()
 
 				// Wait for a change in state
 				while (state == OPENAVB_AECP_SM_ENTITY_MODEL_ENTITY_STATE_WAITING && bRunning) {
+					bool bCountersTimer = (s_unsolicitedControllerCount > 0);
 					AECP_SM_UNLOCK();
 					SEM_ERR_T(err);
-					SEM_WAIT(openavbAecpSMEntityModelEntityWaitingSemaphore, err);
+					if (bCountersTimer) {
+						// Wake up to check the counters for registered controllers.
+						SEM_TIMEDWAIT(openavbAecpSMEntityModelEntityWaitingSemaphore, AECP_UNSOLICITED_COUNTERS_MSEC, err);
+					}
+					else {
+						SEM_WAIT(openavbAecpSMEntityModelEntityWaitingSemaphore, err);
+					}
 					AECP_SM_LOCK();
 
 					if (SEM_IS_ERR_NONE(err)) {
@@ -1182,12 +1357,24 @@ void openavbAecpSMEntityModelEntityStateMachine()
 							state = OPENAVB_AECP_SM_ENTITY_MODEL_ENTITY_STATE_RECEIVED_COMMAND;
 						}
 					}
+
+					if (state == OPENAVB_AECP_SM_ENTITY_MODEL_ENTITY_STATE_WAITING && bRunning && unsolicitedCountersDue()) {
+						state = OPENAVB_AECP_SM_ENTITY_MODEL_ENTITY_STATE_UNSOLICITED_RESPONSE;
+					}
 				}
 				break;
 
 			case OPENAVB_AECP_SM_ENTITY_MODEL_ENTITY_STATE_UNSOLICITED_RESPONSE:
 				AVB_LOG_DEBUG("State:  OPENAVB_AECP_SM_ENTITY_MODEL_ENTITY_STATE_UNSOLICITED_RESPONSE");
 
+				if (openavbAecpSMEntityModelEntityVars.doUnsolicited) {
+					sendUnsolicited(&openavbAecpSMEntityModelEntityVars.unsolicited);
+					openavbAecpSMEntityModelEntityVars.doUnsolicited = FALSE;
+				}
+				if (unsolicitedCountersDue()) {
+					sendChangedCounters();
+				}
+
 				state = OPENAVB_AECP_SM_ENTITY_MODEL_ENTITY_STATE_WAITING;
 				break;
 
@@ -1275,6 +1462,9 @@ void openavbAecpSMEntityModelEntityStart()
 	// Initialize the linked list (queue).
 	s_commandQueue = openavbListNewList();
 
+	memset(s_unsolicitedControllers, 0, sizeof(s_unsolicitedControllers));
+	s_unsolicitedControllerCount = 0;
+
 	// Start the Advertise Entity State Machine
 	bool errResult;
 	THREAD_CREATE(openavbAecpSMEntityModelEntityThread, openavbAecpSMEntityModelEntityThread, NULL, openavbAecpSMEntityModelEntityThreadFn, NULL);
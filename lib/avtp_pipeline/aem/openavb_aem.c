@@ -49,6 +49,7 @@ MUTEX_HANDLE(openavbAemMutex);
 #define AEM_UNLOCK() { MUTEX_CREATE_ERR(); MUTEX_UNLOCK(openavbAemMutex); MUTEX_LOG_ERR("Mutex unlock failure"); }
 
 static openavb_avdecc_entity_model_t *pAemEntityModel = NULL;
+static const openavb_aem_compiled_model_t *pAemCompiledModel = NULL;
 
 ////////////////////////////////
 // Private (internal) functions
@@ -239,6 +240,215 @@ void *openavbAemFindDescriptor(U16 configIdx, U16 descriptorType, U16 descriptor
 	return retDescriptor;
 }
 
+// Descriptor types whose content is fixed once the model is built. These can be served from a compiled model.
+static bool openavbAemIsCompilableType(U16 descriptorType)
+{
+	switch (descriptorType) {
+		case OPENAVB_AEM_DESCRIPTOR_CONFIGURATION:
+		case OPENAVB_AEM_DESCRIPTOR_JACK_INPUT:
+		case OPENAVB_AEM_DESCRIPTOR_JACK_OUTPUT:
+		case OPENAVB_AEM_DESCRIPTOR_CLOCK_SOURCE:
+		case OPENAVB_AEM_DESCRIPTOR_LOCALE:
+		case OPENAVB_AEM_DESCRIPTOR_STRINGS:
+		case OPENAVB_AEM_DESCRIPTOR_STREAM_PORT_INPUT:
+		case OPENAVB_AEM_DESCRIPTOR_STREAM_PORT_OUTPUT:
+		case OPENAVB_AEM_DESCRIPTOR_EXTERNAL_PORT_INPUT:
+		case OPENAVB_AEM_DESCRIPTOR_EXTERNAL_PORT_OUTPUT:
+		case OPENAVB_AEM_DESCRIPTOR_AUDIO_CLUSTER:
+		case OPENAVB_AEM_DESCRIPTOR_AUDIO_MAP:
+			return TRUE;
+		default:
+			return FALSE;
+	}
+}
+
+static const openavb_aem_compiled_descriptor_t *openavbAemFindCompiledDescriptor(U16 configIdx, U16 descriptorType, U16 descriptorIdx)
+{
+	if (!pAemCompiledModel || descriptorType >= OPENAVB_AEM_DESCRIPTOR_COUNT) {
+		return NULL;
+	}
+
+	U16 i1;
+	for (i1 = pAemCompiledModel->pTypeFirst[descriptorType]; i1 < pAemCompiledModel->pTypeFirst[descriptorType + 1]; i1++) {
+		const openavb_aem_compiled_descriptor_t *pCompiled = &pAemCompiledModel->pDescriptors[i1];
+		if (pCompiled->descriptorIdx == descriptorIdx &&
+				(pCompiled->configIdx == configIdx || pCompiled->configIdx == OPENAVB_AEM_DESCRIPTOR_INVALID)) {
+			return pCompiled;
+		}
+	}
+	return NULL;
+}
+
+bool openavbAemSetCompiledModel(const openavb_aem_compiled_model_t *pCompiledModel, U32 configHash)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AEM);
+
+	// Every compiled descriptor is built from the configuration, so a model generated from the
+	// same configuration holds the same descriptors the runtime model would.
+	if (pCompiledModel && pCompiledModel->configHash != configHash) {
+		AVB_LOGF_ERROR("Compiled entity model doesn't match the configuration (0x%08x, expected 0x%08x). Regenerate it with openavb_avdecc -g. Using the runtime model.",
+			pCompiledModel->configHash, configHash);
+		pAemCompiledModel = NULL;
+		AVB_TRACE_EXIT(AVB_TRACE_AEM);
+		return FALSE;
+	}
+
+	pAemCompiledModel = pCompiledModel;
+	AVB_TRACE_EXIT(AVB_TRACE_AEM);
+	return TRUE;
+}
+
+bool openavbAemIsCompiledType(U16 descriptorType)
+{
+	return pAemCompiledModel && openavbAemIsCompilableType(descriptorType);
+}
+
+static void openavbAemCompileArray(openavb_array_t descriptors, U16 configIdx,
+	openavb_aem_compiled_descriptor_t *pCompiled, U16 *pCount, U8 *pImage, U32 *pImageLength)
+{
+	S32 idx;
+	for (idx = 0; descriptors && idx < openavbArraySize(descriptors); idx++) {
+		openavb_aem_descriptor_common_t *pDescriptorCommon = openavbArrayDataIdx(descriptors, idx);
+		U16 descriptorSize;
+		if (!pDescriptorCommon || *pCount >= OPENAVB_AEM_COMPILED_MAX_DESCRIPTORS ||
+				*pImageLength + OPENAVB_AEM_COMPILED_MAX_DESCRIPTOR > OPENAVB_AEM_COMPILED_MAX_IMAGE) {
+			continue;
+		}
+		if (IS_OPENAVB_FAILURE(pDescriptorCommon->descriptorPvtPtr->update(pDescriptorCommon)) ||
+				IS_OPENAVB_FAILURE(pDescriptorCommon->descriptorPvtPtr->toBuf(pDescriptorCommon,
+					OPENAVB_AEM_COMPILED_MAX_DESCRIPTOR, pImage + *pImageLength, &descriptorSize))) {
+			AVB_LOGF_ERROR("Failed to serialize descriptor type 0x%04x index %u", pDescriptorCommon->descriptor_type, idx);
+			continue;
+		}
+		pCompiled[*pCount].configIdx = configIdx;
+		pCompiled[*pCount].descriptorType = pDescriptorCommon->descriptor_type;
+		pCompiled[*pCount].descriptorIdx = idx;
+		pCompiled[*pCount].length = descriptorSize;
+		pCompiled[*pCount].offset = *pImageLength;
+		*pImageLength += descriptorSize;
+		(*pCount)++;
+	}
+}
+
+openavbRC openavbAemWriteCompiledModel(FILE *pFile, U32 configHash)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AEM);
+
+	// Make sure Entity Model is created
+	if (!openavbAemCheckModel(TRUE)) {
+		AVB_RC_LOG_TRACE_RET(AVB_RC(OPENAVB_AVDECC_FAILURE | OPENAVBAVDECC_RC_ENTITY_MODEL_MISSING), AVB_TRACE_AEM);
+	}
+
+	if (!pFile) {
+		AVB_RC_LOG_TRACE_RET(AVB_RC(OPENAVB_AVDECC_FAILURE | OPENAVB_RC_INVALID_ARGUMENT), AVB_TRACE_AEM);
+	}
+
+	openavb_aem_compiled_descriptor_t *pCompiled = calloc(OPENAVB_AEM_COMPILED_MAX_DESCRIPTORS, sizeof(*pCompiled));
+	U8 *pImage = malloc(OPENAVB_AEM_COMPILED_MAX_IMAGE);
+	if (!pCompiled || !pImage) {
+		free(pCompiled);
+		free(pImage);
+		AVB_RC_LOG_TRACE_RET(AVB_RC(OPENAVB_AVDECC_FAILURE | OPENAVB_RC_OUT_OF_MEMORY), AVB_TRACE_AEM);
+	}
+
+	U16 typeFirst[OPENAVB_AEM_DESCRIPTOR_COUNT + 1];
+	U16 count = 0;
+	U32 imageLength = 0;
+	U16 descriptorType;
+	S32 configIdx;
+	S32 nConfigs = openavbArraySize(pAemEntityModel->aemConfigurations);
+
+	// Serialize in type, configuration, index order so a lookup only scans its own type.
+	for (descriptorType = 0; descriptorType < OPENAVB_AEM_DESCRIPTOR_COUNT; descriptorType++) {
+		typeFirst[descriptorType] = count;
+		if (!openavbAemIsCompilableType(descriptorType)) {
+			continue;
+		}
+		for (configIdx = 0; configIdx < nConfigs; configIdx++) {
+			openavb_aem_configuration_t *pConfig = openavbArrayDataIdx(pAemEntityModel->aemConfigurations, configIdx);
+			if (!pConfig) {
+				continue;
+			}
+			if (descriptorType == OPENAVB_AEM_DESCRIPTOR_CONFIGURATION) {
+				U16 descriptorSize;
+				openavb_aem_descriptor_configuration_t *pDescriptor = pConfig->pDescriptorConfiguration;
+				if (pDescriptor && count < OPENAVB_AEM_COMPILED_MAX_DESCRIPTORS &&
+						imageLength + OPENAVB_AEM_COMPILED_MAX_DESCRIPTOR <= OPENAVB_AEM_COMPILED_MAX_IMAGE &&
+						IS_OPENAVB_SUCCESS(pDescriptor->descriptorPvtPtr->toBuf(pDescriptor,
+							OPENAVB_AEM_COMPILED_MAX_DESCRIPTOR, pImage + imageLength, &descriptorSize))) {
+					pCompiled[count].configIdx = configIdx;
+					pCompiled[count].descriptorType = descriptorType;
+					pCompiled[count].descriptorIdx = pDescriptor->descriptor_index;
+					pCompiled[count].length = descriptorSize;
+					pCompiled[count].offset = imageLength;
+					imageLength += descriptorSize;
+					count++;
+				}
+			}
+			else {
+				openavbAemCompileArray(pConfig->descriptorsArray[descriptorType], configIdx, pCompiled, &count, pImage, &imageLength);
+			}
+		}
+		openavbAemCompileArray(pAemEntityModel->aemNonTopLevelDescriptorsArray[descriptorType], OPENAVB_AEM_DESCRIPTOR_INVALID,
+			pCompiled, &count, pImage, &imageLength);
+	}
+	typeFirst[OPENAVB_AEM_DESCRIPTOR_COUNT] = count;
+
+	U32 i1;
+	fprintf(pFile, "/* Compiled AVDECC entity model. Generated by openavb_avdecc -g, do not edit. */\n\n");
+	fprintf(pFile, "#include \"openavb_aem.h\"\n\n");
+
+	fprintf(pFile, "static const U8 aemImage[%u] = {", imageLength ? imageLength : 1);
+	for (i1 = 0; i1 < imageLength; i1++) {
+		fprintf(pFile, "%s0x%02x,", (i1 % 16) ? " " : "\n\t", pImage[i1]);
+	}
+	fprintf(pFile, "\n};\n\n");
+
+	fprintf(pFile, "static const openavb_aem_compiled_descriptor_t aemDescriptors[%u] = {\n", count ? count : 1);
+	for (i1 = 0; i1 < count; i1++) {
+		fprintf(pFile, "\t{ 0x%04x, 0x%04x, %u, %u, %u },\n",
+			pCompiled[i1].configIdx, pCompiled[i1].descriptorType, pCompiled[i1].descriptorIdx,
+			pCompiled[i1].length, pCompiled[i1].offset);
+	}
+	fprintf(pFile, "};\n\n");
+
+	fprintf(pFile, "static const U16 aemTypeFirst[%u] = {", OPENAVB_AEM_DESCRIPTOR_COUNT + 1);
+	for (i1 = 0; i1 <= OPENAVB_AEM_DESCRIPTOR_COUNT; i1++) {
+		fprintf(pFile, "%s%u,", (i1 % 16) ? " " : "\n\t", typeFirst[i1]);
+	}
+	fprintf(pFile, "\n};\n\n");
+
+	fprintf(pFile, "const openavb_aem_compiled_model_t openavbAemCompiledModel = {\n"
+		"\t0x%08x,\n\t%u,\n\taemDescriptors,\n\taemTypeFirst,\n\t%u,\n\taemImage\n};\n", configHash, count, imageLength);
+
+	AVB_LOGF_INFO("Compiled entity model: %u descriptors, %u bytes", count, imageLength);
+
+	free(pCompiled);
+	free(pImage);
+
+	if (ferror(pFile)) {
+		AVB_RC_LOG_TRACE_RET(AVB_RC(OPENAVB_AVDECC_FAILURE | OPENAVBAVDECC_RC_GENERIC), AVB_TRACE_AEM);
+	}
+
+	AVB_RC_TRACE_RET(OPENAVB_AVDECC_SUCCESS, AVB_TRACE_AEM);
+}
+
+void openavbAemLogModelStats(U32 buildUSec)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AEM);
+
+	if (openavbAemCheckModel(FALSE)) {
+		AVB_LOGF_INFO("Entity model built in %u usec: %u descriptors, %u bytes allocated",
+			buildUSec, pAemEntityModel->descriptorCount, pAemEntityModel->descriptorBytes);
+		if (pAemCompiledModel) {
+			AVB_LOGF_INFO("Compiled entity model: %u descriptors, %u bytes read-only",
+				pAemCompiledModel->descriptorCount, pAemCompiledModel->imageLength);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_AEM);
+}
+
 openavbRC openavbAemSerializeDescriptor(U16 configIdx, U16 descriptorType, U16 descriptorIdx, U16 bufSize, U8 *pBuf, U16 *descriptorSize)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AEM);
@@ -254,6 +464,17 @@ openavbRC openavbAemSerializeDescriptor(U16 configIdx, U16 descriptorType, U16 d
 
 	*descriptorSize = 0;
 
+	// Descriptors in the compiled model are already serialized
+	const openavb_aem_compiled_descriptor_t *pCompiled = openavbAemFindCompiledDescriptor(configIdx, descriptorType, descriptorIdx);
+	if (pCompiled) {
+		if (pCompiled->length > bufSize) {
+			AVB_RC_LOG_TRACE_RET(AVB_RC(OPENAVB_AVDECC_FAILURE | OPENAVBAVDECC_RC_BUFFER_TOO_SMALL), AVB_TRACE_AEM);
+		}
+		memcpy(pBuf, pAemCompiledModel->pImage + pCompiled->offset, pCompiled->length);
+		*descriptorSize = pCompiled->length;
+		AVB_RC_TRACE_RET(OPENAVB_AVDECC_SUCCESS, AVB_TRACE_AEM);
+	}
+
 	void *pDescriptor = openavbAemFindDescriptor(configIdx, descriptorType, descriptorIdx);
 	if (pDescriptor) {
 		openavb_aem_descriptor_common_t *pDescriptorCommon = pDescriptor;
@@ -304,6 +525,8 @@ bool openavbAemAddDescriptorConfiguration(openavb_aem_descriptor_configuration_t
 	*pResultIdx = retIdx;
 
 	pAemEntityModel->pDescriptorEntity->configurations_count++;
+	pAemEntityModel->descriptorCount++;
+	pAemEntityModel->descriptorBytes += pDescriptor->descriptorPvtPtr->size + sizeof(*pDescriptor->descriptorPvtPtr);
 
 	AVB_TRACE_EXIT(AVB_TRACE_AEM);
 	return TRUE;
@@ -397,6 +620,8 @@ extern DLL_EXPORT bool openavbAemAddDescriptor(void *pDescriptor, U16 configIdx,
 		if (elem) {
 			*pResultIdx = openavbArrayGetIdx(elem);
 			pDescriptorCommon->descriptor_index = *pResultIdx;
+			pAemEntityModel->descriptorCount++;
+			pAemEntityModel->descriptorBytes += pDescriptorCommon->descriptorPvtPtr->size + sizeof(*pDescriptorCommon->descriptorPvtPtr);
 			if (pDescriptorCommon->descriptorPvtPtr->bTopLevel) {
 				if (!IS_OPENAVB_SUCCESS(openavbAemAddDescriptorToConfiguration(pDescriptorCommon->descriptor_type, configIdx))) {
 					AVB_TRACE_EXIT(AVB_TRACE_AEM);
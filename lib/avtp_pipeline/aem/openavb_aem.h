@@ -79,8 +79,43 @@ typedef struct {
 
 	openavb_array_t aemConfigurations;
 	openavb_array_t aemNonTopLevelDescriptorsArray[OPENAVB_AEM_DESCRIPTOR_COUNT];
+
+	// Descriptors added to the model and the memory allocated for them
+	U32 descriptorCount;
+	U32 descriptorBytes;
 } openavb_avdecc_entity_model_t;
 
+// Limits used when generating a compiled model
+#define OPENAVB_AEM_COMPILED_MAX_DESCRIPTOR 508
+#define OPENAVB_AEM_COMPILED_MAX_DESCRIPTORS 4096
+#define OPENAVB_AEM_COMPILED_MAX_IMAGE (256 * 1024)
+
+// A descriptor serialized when the compiled model was generated.
+typedef struct {
+	U16 configIdx;		// OPENAVB_AEM_DESCRIPTOR_INVALID for non-top-level descriptors
+	U16 descriptorType;
+	U16 descriptorIdx;
+	U16 length;
+	U32 offset;			// Offset of the serialized descriptor in the image
+} openavb_aem_compiled_descriptor_t;
+
+// An entity model compiled into the binary. It holds the serialized images of the descriptors
+// that don't change once the model is built. Descriptors with runtime state (entity, AVB
+// interface, audio unit, streams, clock domain, controls) are still built by openavbAemAddDescriptor().
+typedef struct {
+	U32 configHash;				// Hash of the configuration the model was generated from
+	U16 descriptorCount;
+	const openavb_aem_compiled_descriptor_t *pDescriptors;	// Sorted by type, configuration and index
+	const U16 *pTypeFirst;		// Index of the first descriptor of each type, OPENAVB_AEM_DESCRIPTOR_COUNT + 1 entries
+	U32 imageLength;
+	const U8 *pImage;
+} openavb_aem_compiled_model_t;
+
+#if AVB_FEATURE_AEM_COMPILED
+// Generated with openavb_avdecc -g
+extern const openavb_aem_compiled_model_t openavbAemCompiledModel;
+#endif
+
 
 // Create the Entity Model
 openavbRC openavbAemCreate(openavb_aem_descriptor_entity_t *pDescriptorEntity);
@@ -97,6 +132,20 @@ bool openavbAemCheckModel(bool bLog);
 // Return the array of descriptors for a specific descroptor type for the specified configuration.
 openavb_array_t openavbAemGetDescriptorArray(U16 configIdx, U16 descriptorType);
 
+// Use a compiled model for the descriptors it holds. The model is only used if it was generated from a configuration
+// with the same hash. Returns FALSE if it wasn't. NULL serializes everything from the runtime model.
+bool openavbAemSetCompiledModel(const openavb_aem_compiled_model_t *pCompiledModel, U32 configHash);
+
+// Returns TRUE if descriptors of this type are served from the compiled model, and so must not be added to the runtime model.
+bool openavbAemIsCompiledType(U16 descriptorType);
+
+// Write the descriptors of the model that can be compiled as C source defining openavbAemCompiledModel.
+// configHash identifies the configuration the model was built from.
+openavbRC openavbAemWriteCompiledModel(FILE *pFile, U32 configHash);
+
+// Log the size of the model and how long it took to build.
+void openavbAemLogModelStats(U32 buildUSec);
+
 // Serialize a descriptor into a buffer. pBuf is filled with the descriptor data. descriptorSize is set to the size of the data placed into the buffer.
 openavbRC openavbAemSerializeDescriptor(U16 configIdx, U16 descriptorType, U16 descriptorIdx, U16 bufSize, U8 *pBuf, U16 *descriptorSize);
 
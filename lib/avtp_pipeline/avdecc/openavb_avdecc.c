@@ -60,6 +60,7 @@ static U8 talker_stream_sources = 0;
 static U8 listener_stream_sources = 0;
 static bool first_talker = 1;
 static bool first_listener = 1;
+static U16 compiled_clock_sources = 0;
 
 bool openavbAvdeccStartAdp()
 {
@@ -138,6 +139,41 @@ void openavbAvdeccFindMacAddr(void)
 	}
 }
 
+// Add a clock source for the stream, and a clock domain holding the clock sources added so far.
+static bool openavbAvdeccAddClockDomain(U16 nConfigIdx, const openavb_avdecc_configuration_cfg_t *pCfg)
+{
+	U16 nResultIdx;
+
+	if (openavbAemIsCompiledType(OPENAVB_AEM_DESCRIPTOR_CLOCK_SOURCE)) {
+		// The clock source is served from the compiled model.
+		compiled_clock_sources++;
+	}
+	else {
+		openavb_aem_descriptor_clock_source_t *pNewClockSource = openavbAemDescriptorClockSourceNew();
+		if (!openavbAemAddDescriptor(pNewClockSource, nConfigIdx, &nResultIdx) ||
+				!openavbAemDescriptorClockSourceInitialize(pNewClockSource, nConfigIdx, pCfg)) {
+			AVB_LOG_ERROR("Error adding AVDECC Clock Source to configuration");
+			return FALSE;
+		}
+	}
+
+	openavb_aem_descriptor_clock_domain_t *pNewClockDomain = openavbAemDescriptorClockDomainNew();
+	if (!openavbAemAddDescriptor(pNewClockDomain, nConfigIdx, &nResultIdx) ||
+			!openavbAemDescriptorClockDomainInitialize(pNewClockDomain, nConfigIdx, pCfg)) {
+		AVB_LOG_ERROR("Error adding AVDECC Clock Domain to configuration");
+		return FALSE;
+	}
+
+	// Compiled clock sources aren't in the runtime model, so the domain didn't find them.
+	while (pNewClockDomain->clock_sources_count < compiled_clock_sources &&
+			pNewClockDomain->clock_sources_count < OPENAVB_DESCRIPTOR_CLOCK_DOMAIN_MAX_CLOCK_SOURCES) {
+		pNewClockDomain->clock_sources[pNewClockDomain->clock_sources_count] = pNewClockDomain->clock_sources_count;
+		pNewClockDomain->clock_sources_count++;
+	}
+
+	return TRUE;
+}
+
 bool openavbAvdeccAddConfiguration(openavb_tl_data_cfg_t *stream)
 {
 	bool first_time = 0;
@@ -245,17 +281,7 @@ bool openavbAvdeccAddConfiguration(openavb_tl_data_cfg_t *stream)
 		if (first_talker)
 		{
 			first_talker = 0;
-			openavb_aem_descriptor_clock_source_t *pNewClockSource = openavbAemDescriptorClockSourceNew();
-			if (!openavbAemAddDescriptor(pNewClockSource, nConfigIdx, &nResultIdx) ||
-					!openavbAemDescriptorClockSourceInitialize(pNewClockSource, nConfigIdx, pCfg)) {
-				AVB_LOG_ERROR("Error adding AVDECC Clock Source to configuration");
-				AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
-				return FALSE;
-			}
-			openavb_aem_descriptor_clock_domain_t *pNewClockDomain = openavbAemDescriptorClockDomainNew();
-			if (!openavbAemAddDescriptor(pNewClockDomain, nConfigIdx, &nResultIdx) ||
-					!openavbAemDescriptorClockDomainInitialize(pNewClockDomain, nConfigIdx, pCfg)) {
-				AVB_LOG_ERROR("Error adding AVDECC Clock Domain to configuration");
+			if (!openavbAvdeccAddClockDomain(nConfigIdx, pCfg)) {
 				AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
 				return FALSE;
 			}
@@ -283,17 +309,7 @@ bool openavbAvdeccAddConfiguration(openavb_tl_data_cfg_t *stream)
 		}
 		if (first_listener)
 		{
-			openavb_aem_descriptor_clock_source_t *pNewClockSource = openavbAemDescriptorClockSourceNew();
-			if (!openavbAemAddDescriptor(pNewClockSource, nConfigIdx, &nResultIdx) ||
-					!openavbAemDescriptorClockSourceInitialize(pNewClockSource, nConfigIdx, pCfg)) {
-				AVB_LOG_ERROR("Error adding AVDECC Clock Source to configuration");
-				AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
-				return FALSE;
-			}
-			openavb_aem_descriptor_clock_domain_t *pNewClockDomain = openavbAemDescriptorClockDomainNew();
-			if (!openavbAemAddDescriptor(pNewClockDomain, nConfigIdx, &nResultIdx) ||
-					!openavbAemDescriptorClockDomainInitialize(pNewClockDomain, nConfigIdx, pCfg)) {
-				AVB_LOG_ERROR("Error adding AVDECC Clock Domain to configuration");
+			if (!openavbAvdeccAddClockDomain(nConfigIdx, pCfg)) {
 				AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
 				return FALSE;
 			}
@@ -310,7 +326,7 @@ bool openavbAvdeccAddConfiguration(openavb_tl_data_cfg_t *stream)
 		AVB_LOG_DEBUG("AVDECC listener configuration added");
 	}
 
-	if (first_time)
+	if (first_time && gAvdeccCfg.pAemDescriptorLocaleStringsHandler)
 	{
 		// Add the localized strings to the configuration.
 		if (!openavbAemDescriptorLocaleStringsHandlerAddToConfiguration(gAvdeccCfg.pAemDescriptorLocaleStringsHandler, nConfigIdx)) {
@@ -331,6 +347,9 @@ extern DLL_EXPORT bool openavbAvdeccInitialize()
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC);
 
+	U64 buildStartNS;
+	CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &buildStartNS);
+
 	gAvdeccCfg.pDescriptorEntity = openavbAemDescriptorEntityNew();
 	if (!gAvdeccCfg.pDescriptorEntity) {
 		AVB_LOG_ERROR("Failed to allocate an AVDECC descriptor");
@@ -361,14 +380,18 @@ extern DLL_EXPORT bool openavbAvdeccInitialize()
 	openavbAemDescriptorEntitySet_serial_number(gAvdeccCfg.pDescriptorEntity, gAvdeccCfg.serial_number);
 
 	// Initialize the localized strings support.
-	gAvdeccCfg.pAemDescriptorLocaleStringsHandler = openavbAemDescriptorLocaleStringsHandlerNew();
-	if (gAvdeccCfg.pAemDescriptorLocaleStringsHandler) {
-		// Add the strings to the locale strings hander.
-		openavbAemDescriptorLocaleStringsHandlerSet_local_string(
-			gAvdeccCfg.pAemDescriptorLocaleStringsHandler, gAvdeccCfg.locale_identifier, gAvdeccCfg.vendor_name, LOCALE_STRING_VENDOR_NAME_INDEX);
-		openavbAemDescriptorLocaleStringsHandlerSet_local_string(
-			gAvdeccCfg.pAemDescriptorLocaleStringsHandler, gAvdeccCfg.locale_identifier, gAvdeccCfg.model_name, LOCALE_STRING_MODEL_NAME_INDEX);
-
+	// A compiled model already holds the LOCALE and STRINGS descriptors.
+	if (!openavbAemIsCompiledType(OPENAVB_AEM_DESCRIPTOR_STRINGS)) {
+		gAvdeccCfg.pAemDescriptorLocaleStringsHandler = openavbAemDescriptorLocaleStringsHandlerNew();
+		if (gAvdeccCfg.pAemDescriptorLocaleStringsHandler) {
+			// Add the strings to the locale strings hander.
+			openavbAemDescriptorLocaleStringsHandlerSet_local_string(
+				gAvdeccCfg.pAemDescriptorLocaleStringsHandler, gAvdeccCfg.locale_identifier, gAvdeccCfg.vendor_name, LOCALE_STRING_VENDOR_NAME_INDEX);
+			openavbAemDescriptorLocaleStringsHandlerSet_local_string(
+				gAvdeccCfg.pAemDescriptorLocaleStringsHandler, gAvdeccCfg.locale_identifier, gAvdeccCfg.model_name, LOCALE_STRING_MODEL_NAME_INDEX);
+		}
+	}
+	if (gAvdeccCfg.pAemDescriptorLocaleStringsHandler || openavbAemIsCompiledType(OPENAVB_AEM_DESCRIPTOR_STRINGS)) {
 		// Have the descriptor entity reference the locale strings.
 		openavbAemDescriptorEntitySet_vendor_name(gAvdeccCfg.pDescriptorEntity, 0, LOCALE_STRING_VENDOR_NAME_INDEX);
 		openavbAemDescriptorEntitySet_model_name(gAvdeccCfg.pDescriptorEntity, 0, LOCALE_STRING_MODEL_NAME_INDEX);
@@ -398,20 +421,22 @@ extern DLL_EXPORT bool openavbAvdeccInitialize()
 
 	// Add non-top-level descriptors.  These are independent of the configurations.
 	// STRINGS are handled by gAvdeccCfg.pAemDescriptorLocaleStringsHandler, so not included here.
+	// Descriptors held by a compiled model are served from it and not allocated.
 	U16 nResultIdx;
-	if (!openavbAemAddDescriptor(openavbAemDescriptorAudioClusterNew(), OPENAVB_AEM_DESCRIPTOR_INVALID, &nResultIdx)) {
+	if (!openavbAemIsCompiledType(OPENAVB_AEM_DESCRIPTOR_AUDIO_CLUSTER) &&
+			!openavbAemAddDescriptor(openavbAemDescriptorAudioClusterNew(), OPENAVB_AEM_DESCRIPTOR_INVALID, &nResultIdx)) {
 		AVB_LOG_ERROR("Error adding AVDECC Audio Cluster");
 		AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
 		return FALSE;
 	}
-	if (gAvdeccCfg.bTalker) {
+	if (gAvdeccCfg.bTalker && !openavbAemIsCompiledType(OPENAVB_AEM_DESCRIPTOR_STREAM_PORT_OUTPUT)) {
 		if (!openavbAemAddDescriptor(openavbAemDescriptorStreamPortOutputNew(), OPENAVB_AEM_DESCRIPTOR_INVALID, &nResultIdx)) {
 			AVB_LOG_ERROR("Error adding AVDECC Output Stream Port");
 			AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
 			return FALSE;
 		}
 	}
-	if (gAvdeccCfg.bListener) {
+	if (gAvdeccCfg.bListener && !openavbAemIsCompiledType(OPENAVB_AEM_DESCRIPTOR_STREAM_PORT_INPUT)) {
 		if (!openavbAemAddDescriptor(openavbAemDescriptorStreamPortInputNew(), OPENAVB_AEM_DESCRIPTOR_INVALID, &nResultIdx)) {
 			AVB_LOG_ERROR("Error adding AVDECC Input Stream Port");
 			AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
@@ -456,6 +481,10 @@ extern DLL_EXPORT bool openavbAvdeccInitialize()
 			OPENAVB_ADP_LISTENER_CAPABILITIES_AUDIO_SINK);
 	}
 
+	U64 buildEndNS;
+	CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &buildEndNS);
+	openavbAemLogModelStats((buildEndNS - buildStartNS) / NANOSECONDS_PER_USEC);
+
 	AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
 	return TRUE;
 }
@@ -38,6 +38,9 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
  * This code implements functions used by both sides of the IPC.
  */
 
+#include <ctype.h>
+#include <stdio.h>
+
 
 // We are accessed from multiple threads, so need a mutex
 MUTEX_HANDLE(gAvdeccMsgStateMutex);
@@ -190,3 +193,17 @@ avdecc_msg_state_t * AvdeccMsgStateListGetIndex(int nIndex)
 	AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
 	return NULL;
 }
+
+void openavbAvdeccMsgCountersName(char * name, size_t nameSize, const char * friendly_name, int pid)
+{
+	// The friendly name may contain anything; keep only characters that are safe in an object name.
+	// Leave room for the process id, which keeps clients with the same friendly_name apart.
+	char suffix[16];
+	size_t suffixLen = snprintf(suffix, sizeof(suffix), "_%d", pid);
+	size_t len = snprintf(name, nameSize, "%s", AVB_AVDECC_MSG_COUNTERS_SHM);
+	while (*friendly_name && len + suffixLen + 1 < nameSize) {
+		char c = *friendly_name++;
+		name[len++] = (isalnum((unsigned char)c) || c == '-' || c == '.') ? c : '_';
+	}
+	snprintf(name + len, nameSize - len, "%s", suffix);
+}
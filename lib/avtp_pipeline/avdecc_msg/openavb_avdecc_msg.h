@@ -37,11 +37,14 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define OPENAVB_AVDECC_MSG_H
 
 #include "openavb_types.h"
+#include "openavb_avtp_counters.h"
 
 #define AVB_AVDECC_MSG_HANDLE_INVALID	(-1)
 #define AVDECC_MSG_RECONNECT_SECONDS	10
 #define AVB_AVDECC_MSG_UNIX_PATH		"/tmp/avdecc_msg"
 #define MAX_AVDECC_MSG_CLIENTS			16
+#define AVB_AVDECC_MSG_COUNTERS_SHM		"/avdecc_msg_counters_"
+#define AVB_AVDECC_MSG_COUNTERS_MAGIC	0x41434E54
 
 
 ////////////////
@@ -156,6 +159,24 @@ typedef struct {
 bool openavbAvdeccMsgServerOpen(void);
 void openavbAvdeccMsgServerClose(void);
 
+// Stream counters a client publishes in shared memory, named after its friendly_name and process id.
+// The client's stream thread updates them in place and the server reads them directly,
+// so answering GET_COUNTERS never needs a message round trip.
+typedef struct {
+	U32 magic;
+	U32 size;
+	avtp_rx_counters_t rx;
+} openavbAvdeccMsgCounters_t;
+
+// Build the shared memory object name used for the counters of friendly_name in process pid.
+void openavbAvdeccMsgCountersName(char * name, size_t nameSize, const char * friendly_name, int pid);
+// Client create and map the counters of its stream, starting from zero. Closing unlinks them.
+openavbAvdeccMsgCounters_t * openavbAvdeccMsgClntCountersOpen(const char * friendly_name);
+void openavbAvdeccMsgClntCountersClose(openavbAvdeccMsgCounters_t * pCounters, const char * friendly_name);
+// Server map the counters of the client in process pid read only. Returns NULL if the client has not published any.
+const openavbAvdeccMsgCounters_t * openavbAvdeccMsgSrvrCountersOpen(const char * friendly_name, int pid);
+void openavbAvdeccMsgSrvrCountersClose(const openavbAvdeccMsgCounters_t * pCounters);
+
 #include "openavb_avdecc_msg_osal.h"
 
 
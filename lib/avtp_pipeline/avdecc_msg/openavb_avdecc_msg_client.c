@@ -627,6 +627,15 @@ void* openavbAvdeccMsgThreadFn(void *pv)
 
 	avdeccMsgState.avdeccMsgHandle =
 		avdeccMsgState.pTLState->avdeccMsgHandle = AVB_AVDECC_MSG_HANDLE_INVALID;
+
+	if (avdeccMsgState.pTLState->cfg.role == AVB_ROLE_LISTENER) {
+		// Publish the Listener counters before the server learns about us.
+		avdeccMsgState.pCounters = openavbAvdeccMsgClntCountersOpen(avdeccMsgState.pTLState->cfg.friendly_name);
+		if (avdeccMsgState.pCounters) {
+			avdeccMsgState.pTLState->pAvdeccRxCounters = &avdeccMsgState.pCounters->rx;
+		}
+	}
+
 	while (avdeccMsgState.pTLState->bAvdeccMsgRunning) {
 		AVB_TRACE_LINE(AVB_TRACE_AVDECC_MSG_DETAIL);
 
@@ -682,6 +691,10 @@ void* openavbAvdeccMsgThreadFn(void *pv)
 		}
 	}
 
+	// The Listener has been stopped by now, so nothing updates the counters anymore.
+	avdeccMsgState.pTLState->pAvdeccRxCounters = NULL;
+	openavbAvdeccMsgClntCountersClose(avdeccMsgState.pCounters, avdeccMsgState.pTLState->cfg.friendly_name);
+
 	avdeccMsgState.pTLState = NULL;
 
 	// Perform the base cleanup.
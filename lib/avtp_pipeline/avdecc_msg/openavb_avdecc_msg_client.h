@@ -51,6 +51,9 @@ struct _avdecc_msg_state {
 	// Handle to the AVDECC Msg handle for the connection to the server.
 	int avdeccMsgHandle;
 
+	// Listener counters published to the server.
+	openavbAvdeccMsgCounters_t *pCounters;
+
 };
 
 
@@ -154,6 +154,7 @@ bool openavbAvdeccMsgSrvrHndlInitIdentifyFromClient(int avdeccMsgHandle, char *
 		// The handle was already specified.  Something has gone terribly wrong!
 		AVB_LOGF_ERROR("avdeccMsgHandle %d already used", avdeccMsgHandle);
 		AvdeccMsgStateListRemove(pState);
+		openavbAvdeccMsgSrvrCountersClose(pState->pCounters);
 		free(pState);
 		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
 		return false;
@@ -170,6 +171,7 @@ bool openavbAvdeccMsgSrvrHndlInitIdentifyFromClient(int avdeccMsgHandle, char *
 	}
 	pState->avdeccMsgHandle = avdeccMsgHandle;
 	pState->bTalker = (talker != 0);
+	pState->clientPid = openavbAvdeccMsgSrvrGetClientPid(avdeccMsgHandle);
 	pState->lastRequestedState = pState->lastReportedState = OPENAVB_AVDECC_MSG_UNKNOWN;
 
 	// Find the state information matching this item.
@@ -199,6 +201,11 @@ bool openavbAvdeccMsgSrvrHndlInitIdentifyFromClient(int avdeccMsgHandle, char *
 	pState->stream = currentStream;
 	currentStream->client = pState;
 
+	if (!pState->bTalker) {
+		// The Listener publishes its counters before identifying itself.
+		pState->pCounters = openavbAvdeccMsgSrvrCountersOpen(friendly_name, pState->clientPid);
+	}
+
 	AVB_LOGF_INFO("Client %d Detected, friendly_name:  %s",
 		avdeccMsgHandle, friendly_name);
 
@@ -444,6 +451,29 @@ bool openavbAvdeccMsgSrvrHndlChangeNotificationFromClient(int avdeccMsgHandle, o
 }
 
 
+const avtp_rx_counters_t * openavbAvdeccMsgSrvrGetRxCounters(int avdeccMsgHandle)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
+
+	avdecc_msg_state_t *pState = AvdeccMsgStateListGet(avdeccMsgHandle);
+	if (!pState || pState->bTalker || !pState->stream) {
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return NULL;
+	}
+	if (!pState->pCounters) {
+		// Not published when the client identified itself; it may have been started since.
+		pState->pCounters = openavbAvdeccMsgSrvrCountersOpen(pState->stream->friendly_name, pState->clientPid);
+		if (!pState->pCounters) {
+			AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+			return NULL;
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+	return &pState->pCounters->rx;
+}
+
+
 /* Called if a client closes their end of the IPC
  */
 void openavbAvdeccMsgSrvrCloseClientConnection(int avdeccMsgHandle)
@@ -458,6 +488,7 @@ void openavbAvdeccMsgSrvrCloseClientConnection(int avdeccMsgHandle)
 			// Clear the stream pointer to this object.
 			pState->stream = NULL;
 		}
+		openavbAvdeccMsgSrvrCountersClose(pState->pCounters);
 		free(pState);
 
 		// If there are no more Talkers or Listeners, stop ADP.
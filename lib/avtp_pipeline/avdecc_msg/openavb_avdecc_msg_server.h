@@ -52,6 +52,18 @@ struct _avdecc_msg_state {
 	// Talker/Listener state information.
 	openavbAvdeccMsgStateType_t lastRequestedState;
 	openavbAvdeccMsgStateType_t lastReportedState;
+
+	// Counters published by a Listener client, mapped read only. NULL until available.
+	const openavbAvdeccMsgCounters_t * pCounters;
+
+	// Process id of the client, which names its counters.
+	int clientPid;
 };
 
+// Get the process id of the client connected on avdeccMsgHandle, or -1 if unknown.
+int openavbAvdeccMsgSrvrGetClientPid(int avdeccMsgHandle);
+
+// Get the counters published by the client, mapping them on first use.
+const avtp_rx_counters_t * openavbAvdeccMsgSrvrGetRxCounters(int avdeccMsgHandle);
+
 #endif // OPENAVB_AVDECC_MSG_SERVER_H
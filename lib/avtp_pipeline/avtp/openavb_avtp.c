@@ -40,6 +40,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include <string.h>
 #include <assert.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <errno.h>
 #include "openavb_platform.h"
 #include "openavb_types.h"
@@ -47,6 +48,8 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_avtp.h"
 #include "openavb_rawsock.h"
 #include "openavb_mediaq.h"
+#include "openavb_queue.h"
+#include "openavb_time.h"
 
 #define	AVB_LOG_COMPONENT	"AVTP"
 #include "openavb_log.h"
@@ -54,13 +57,52 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 // Maximum time that AVTP RX/TX calls should block before returning
 #define AVTP_MAX_BLOCK_USEC (1 * MICROSECONDS_PER_SECOND)
 
+// How long the RX pipeline threads block before checking whether they should stop
+#define AVTP_RX_PIPE_BLOCK_USEC (100 * MICROSECONDS_PER_MSEC)
+#define AVTP_RX_PIPE_BLOCK_MSEC (AVTP_RX_PIPE_BLOCK_USEC / MICROSECONDS_PER_MSEC)
+
+THREAD_TYPE(rxNetThread);
+THREAD_TYPE(rxDeliveryThread);
+
+// A received AVTP PDU on its way from the network thread to reassembly
+typedef struct {
+	U32 len;
+	U8 data[];
+} avtp_rx_pipe_frame_t;
+
+struct avtp_rx_pipeline {
+	avtp_stream_t *pStream;
+	volatile bool bRunning;
+
+	// Network thread to reassembly (the listener thread). Single producer and
+	// single consumer; frameSem counts the frames pushed.
+	openavb_queue_t frameQueue;
+	U32 maxPduLen;
+	SEM_T(frameSem)
+
+	// Reassembly to delivery is the media queue in thread safe mode. The
+	// delivery thread sets bDeliveryWaiting while it waits for an item.
+	SEM_T(deliverySem)
+	bool bDeliveryWaiting;
+
+	THREAD_DEFINITON(rxNetThread);
+	THREAD_DEFINITON(rxDeliveryThread);
+
+	avtp_rx_pipeline_stats_t stats;
+};
+
 /*
  * This is broken out into a function, so that we can close and reopen
  * the socket if we detect a problem receiving frames.
  */
 static openavbRC openAvtpSock(avtp_stream_t *pStream)
 {
-	if (pStream->tx) {
+	if (pStream->tx && pStream->nSharedFrames) {
+		// Share one socket and ring with the other streams of this SR class
+		pStream->rawsock = openavbRawsockOpenShared(pStream->ifname, pStream->txPriority, pStream->fwmark,
+			ETHERTYPE_AVTP, pStream->frameLen, pStream->nbuffers, pStream->nSharedFrames);
+	}
+	else if (pStream->tx) {
 		pStream->rawsock = openavbRawsockOpen(pStream->ifname, FALSE, TRUE, ETHERTYPE_AVTP, pStream->frameLen, pStream->nbuffers);
 	}
 	else {
@@ -90,6 +132,27 @@ static openavbRC openAvtpSock(avtp_stream_t *pStream)
 #define HIDX_AVTP_HIDE7_TV1			1
 #define HIDX_AVTP_HIDE7_TU1			3
 #define HIDX_AVTP_TIMESPAMP32		12
+
+// Common stream header fields checked on receive
+#define HIDX_AVTP_STREAM_ID64		4
+#define HIDX_STREAM_DATA_LEN16		20
+
+// Fields of the first header word (subtype, sv, version, mr, gv, tv, sequence_num, tu)
+#define HDR0_SUBTYPE_SHIFT			24
+#define HDR0_SV_BIT					0x00800000
+#define HDR0_VERSION_SHIFT			20
+#define HDR0_MR_BIT					0x00080000
+#define HDR0_GV_BIT					0x00020000
+#define HDR0_TV_BIT					0x00010000
+#define HDR0_SEQ_SHIFT				8
+#define HDR0_TU_BIT					0x00000001
+// subtype, sv and version must match the expected word exactly
+#define HDR0_EXPECT_MASK			0xFFF00000
+
+// Subtypes whose stream_data_length is at HIDX_STREAM_DATA_LEN16 (61883/IIDC, AAF, CVF)
+#define AVTP_SUBTYPE_61883_IIDC		0x00
+#define AVTP_SUBTYPE_AAF			0x02
+#define AVTP_SUBTYPE_CVF			0x03
 static void processTimestampEval(avtp_stream_t *pStream, U8 *pHdr)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVTP_DETAIL);
@@ -100,9 +163,19 @@ static void processTimestampEval(avtp_stream_t *pStream, U8 *pHdr)
 
 		if (tsValid && !tsUncertain) {
 			U32 ts = ntohl(*(U32 *)(&pHdr[HIDX_AVTP_TIMESPAMP32]));
-			U32 tsSmoothed = openavbTimestampEvalTimestamp(pStream->tsEval, ts);
-			if (tsSmoothed != ts) {
-				*(U32 *)(&pHdr[HIDX_AVTP_TIMESPAMP32]) = htonl(tsSmoothed);
+			if (!pStream->bTsEvalSmoothing) {
+				// The frame is left alone, evaluate the timestamps in batches
+				pStream->tsEvalBatch[pStream->tsEvalBatchCnt++] = ts;
+				if (pStream->tsEvalBatchCnt == OPENAVB_AVTP_TS_EVAL_BATCH) {
+					openavbTimestampEvalTimestamps(pStream->tsEval, pStream->tsEvalBatch, pStream->tsEvalBatchCnt);
+					pStream->tsEvalBatchCnt = 0;
+				}
+			}
+			else {
+				U32 tsSmoothed = openavbTimestampEvalTimestamp(pStream->tsEval, ts);
+				if (tsSmoothed != ts) {
+					*(U32 *)(&pHdr[HIDX_AVTP_TIMESPAMP32]) = htonl(tsSmoothed);
+				}
 			}
 		}
 	}
@@ -110,6 +183,18 @@ static void processTimestampEval(avtp_stream_t *pStream, U8 *pHdr)
 	AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
 }
 
+static void x_avtpTimestampEvalEnd(avtp_stream_t *pStream)
+{
+	if (pStream->tsEval) {
+		if (pStream->tsEvalBatchCnt) {
+			openavbTimestampEvalTimestamps(pStream->tsEval, pStream->tsEvalBatch, pStream->tsEvalBatchCnt);
+			pStream->tsEvalBatchCnt = 0;
+		}
+		openavbTimestampEvalDelete(pStream->tsEval);
+		pStream->tsEval = NULL;
+	}
+}
+
 
 /* Initialize AVTP for talking
  */
@@ -125,6 +210,7 @@ openavbRC openavbAvtpTxInit(
 	U16 vlanID,
 	U8  vlanPCP,
 	U16 nbuffers,
+	U32 nSharedFrames,
 	void **pStream_out)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVTP);
@@ -158,6 +244,9 @@ openavbRC openavbAvtpTxInit(
 	// and save other stuff needed to (re)open the socket
 	pStream->ifname = strdup(ifname);
 	pStream->nbuffers = nbuffers;
+	pStream->nSharedFrames = nSharedFrames;
+	pStream->txPriority = vlanPCP;
+	pStream->fwmark = fwmark;
 
 	// Open a raw socket
 	openavbRC rc = openAvtpSock(pStream);
@@ -328,6 +417,11 @@ openavbRC openavbAvtpTx(void *pv, bool bSend, bool txBlockingInIntf)
 		U64 timeNsec = 0;
 
 		if (!txBlockingInIntf) {
+			if (pStream->bTxZeroCopy) {
+				// The interface module may build its item right in this frame
+				openavbMediaQTxFrameBegin(pStream->pMediaQ, pAvtpFrame, avtpFrameLen);
+			}
+
 			// Call interface module to read data
 			pStream->pIntfCB->intf_tx_cb(pStream->pMediaQ);
 
@@ -347,6 +441,10 @@ openavbRC openavbAvtpTx(void *pv, bool bSend, bool txBlockingInIntf)
 			// Call mapping module to move data into AVTP frame
 			txCBResult = pStream->pMapCB->map_tx_cb(pStream->pMediaQ, pAvtpFrame, &avtpFrameLen);
 
+			if (pStream->bTxZeroCopy) {
+				openavbMediaQTxFrameEnd(pStream->pMediaQ);
+			}
+
 			pStream->bytes += avtpFrameLen;
 		}
 		else {
@@ -410,6 +508,7 @@ openavbRC openavbAvtpRxInit(
 	char *ifname,
 	AVBStreamID_t *streamID,
 	U8 *daddr,
+	U32 max_transit_usec,
 	U16 nbuffers,
 	bool rxSignalMode,
 	void **pStream_out)
@@ -435,6 +534,7 @@ openavbRC openavbAvtpRxInit(
 	}
 	pStream->tx = FALSE;
 	pStream->nLost = -1;
+	pStream->pRxCounters = &pStream->rxCounters;
 
 	pStream->pMediaQ = pMediaQ;
 	pStream->pMapCB = pMapCB;
@@ -471,6 +571,17 @@ openavbRC openavbAvtpRxInit(
 	// Save the AVTP subtype
 	pStream->subtype = pStream->pMapCB->map_subtype_cb();
 
+	// Precompute what the header of every received frame is checked against
+	pStream->rxHdrWord0 = ((U32)(pStream->subtype & 0x7F) << HDR0_SUBTYPE_SHIFT) | HDR0_SV_BIT
+		| ((U32)(pStream->pMapCB->map_avtp_version_cb() & 0x07) << HDR0_VERSION_SHIFT);
+	static const U8 zeroStreamID[8] = { 0 };
+	pStream->bRxCheckStreamID = memcmp(pStream->streamIDnet, zeroStreamID, sizeof(zeroStreamID)) != 0;
+	pStream->bRxCheckDataLen = pStream->subtype == AVTP_SUBTYPE_61883_IIDC
+		|| pStream->subtype == AVTP_SUBTYPE_AAF
+		|| pStream->subtype == AVTP_SUBTYPE_CVF;
+	pStream->max_transit_usec = max_transit_usec;
+	pStream->rxMaxEarlyNsec = max_transit_usec * NANOSECONDS_PER_USEC;
+
 	*pStream_out = (void *)pStream;
 	AVB_RC_TRACE_RET(OPENAVB_AVTP_SUCCESS, AVB_TRACE_AVTP);
 }
@@ -478,69 +589,118 @@ openavbRC openavbAvtpRxInit(
 static void x_avtpRxFrame(avtp_stream_t *pStream, U8 *pFrame, U32 frameLen)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVTP_DETAIL);
-	IF_LOG_INTERVAL(4096) AVB_LOGF_DEBUG("pFrame=%p, len=%u", pFrame, frameLen);
-	U8 subtype, flags, flags2, rxSeq, nLost, avtpVersion;
-	U8 *pRead = pFrame;
-
-	// AVTP Header
-	//
-	// Check control/data bit.  We only expect data packets.
-	if (0 == (*pRead & 0x80)) {
-		// - 7 bits 	subtype
-		subtype = *pRead++ & 0x7F;
-		flags   = *pRead++;
-		avtpVersion = (flags >> 4) & 0x07;
-
-		// Check AVTPDU version, BZ 106
-		if (0 == avtpVersion) {
-
-			rxSeq = *pRead++;
-
-			if (pStream->nLost == -1) {
-				// first frame received, don't check for mismatch
-				pStream->nLost = 0;
-			}
-			else if (pStream->avtp_sequence_num != rxSeq) {
-				nLost = (rxSeq - pStream->avtp_sequence_num)
-					+ (rxSeq < pStream->avtp_sequence_num ? 256 : 0);
-				AVB_LOGF_INFO("AVTP sequence mismatch: expected: %3u,\tgot: %3u,\tlost %3d",
-					pStream->avtp_sequence_num, rxSeq, nLost);
-				pStream->nLost += nLost;
-			}
-			pStream->avtp_sequence_num = rxSeq + 1;
+	avtp_rx_counters_t *pCounters = pStream->pRxCounters;
+	avtp_stream_hdr_t hdr;
+
+	if (frameLen < AVTP_COMMON_STREAM_DATA_HDR_LEN) {
+		AVTP_RX_COUNTER_INC(pCounters, unsupportedFormat);
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
+		return;
+	}
 
-			pStream->bytes += frameLen;
+	// Subtype (including the control/data bit), stream valid and version in a single compare.
+	U32 word0 = ntohl(*(U32 *)pFrame);
+	if ((word0 & HDR0_EXPECT_MASK) != pStream->rxHdrWord0) {
+		AVTP_RX_COUNTER_INC(pCounters, unsupportedFormat);
+		IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("Unexpected AVTP header: subtype=0x%02x, sv=%u, version=%u",
+			word0 >> HDR0_SUBTYPE_SHIFT, (word0 & HDR0_SV_BIT) ? 1 : 0, (word0 >> HDR0_VERSION_SHIFT) & 0x07);
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
+		return;
+	}
 
-			flags2 = *pRead++;
-			IF_LOG_INTERVAL(4096) AVB_LOGF_DEBUG("subtype=%u, sv=%u, ver=%u, mr=%u, tv=%u tu=%u",
-				subtype, flags & 0x80, avtpVersion,
-				flags & 0x08, flags & 0x01, flags2 & 0x01);
+	if (pStream->bRxCheckStreamID
+		&& memcmp(pFrame + HIDX_AVTP_STREAM_ID64, pStream->streamIDnet, sizeof(pStream->streamIDnet)) != 0) {
+		AVTP_RX_COUNTER_INC(pCounters, streamIdMismatch);
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
+		return;
+	}
 
-			pRead += 8;
+	if (pStream->rxTestDropInterval && ++pStream->rxTestDropCount >= pStream->rxTestDropInterval) {
+		// Test aid: lose the frame as the network would, before anything counts it.
+		pStream->rxTestDropCount = 0;
+		IF_LOG_INTERVAL(100) AVB_LOG_INFO("Dropping received frame (rx_test_drop_interval)");
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
+		return;
+	}
 
-			if (pStream->tsEval) {
-				processTimestampEval(pStream, pFrame);
-			}
+	hdr.subtype = word0 >> HDR0_SUBTYPE_SHIFT;
+	hdr.version = (word0 >> HDR0_VERSION_SHIFT) & 0x07;
+	hdr.mr = (word0 & HDR0_MR_BIT) ? TRUE : FALSE;
+	hdr.gv = (word0 & HDR0_GV_BIT) ? TRUE : FALSE;
+	hdr.tv = (word0 & HDR0_TV_BIT) ? TRUE : FALSE;
+	hdr.sequenceNum = (word0 >> HDR0_SEQ_SHIFT) & 0xFF;
+	hdr.tu = (word0 & HDR0_TU_BIT) ? TRUE : FALSE;
+	hdr.streamDataLen = ntohs(*(U16 *)(pFrame + HIDX_STREAM_DATA_LEN16));
+
+	AVTP_RX_COUNTER_INC(pCounters, framesRx);
+	if (!pStream->bRxMediaLocked) {
+		pStream->bRxMediaLocked = TRUE;
+		AVTP_RX_COUNTER_INC(pCounters, mediaLocked);
+	}
 
-			pStream->pMapCB->map_rx_cb(pStream->pMediaQ, pFrame, frameLen);
+	if (pStream->nLost == -1) {
+		// first frame received, don't check for mismatch
+		pStream->nLost = 0;
+		pStream->rxLastMr = hdr.mr;
+	}
+	else {
+		if (pStream->avtp_sequence_num != hdr.sequenceNum) {
+			AVTP_RX_COUNTER_INC(pCounters, seqMismatch);
+			pStream->nLost += (U8)(hdr.sequenceNum - pStream->avtp_sequence_num);
+		}
+		if (hdr.mr != pStream->rxLastMr) {
+			AVTP_RX_COUNTER_INC(pCounters, mediaReset);
+			pStream->rxLastMr = hdr.mr;
+		}
+	}
+	pStream->avtp_sequence_num = hdr.sequenceNum + 1;
 
-			// NOTE : This is a redundant call. It is handled in avtpTryRx()
-			// pStream->pIntfCB->intf_rx_cb(pStream->pMediaQ);
+	pStream->bytes += frameLen;
 
-			pStream->info.rx.bComplete = TRUE;
+	if (pStream->bRxCheckDataLen && hdr.streamDataLen > frameLen - AVTP_COMMON_STREAM_DATA_HDR_LEN) {
+		AVTP_RX_COUNTER_INC(pCounters, unsupportedFormat);
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
+		return;
+	}
 
-			// to prevent unused variable warnings
-			(void)subtype;
-			(void)flags2;
+	if (pStream->tsEval) {
+		processTimestampEval(pStream, pFrame);
+	}
+	hdr.timestamp = ntohl(*(U32 *)(pFrame + HIDX_AVTP_TIMESPAMP32));
+
+	if (hdr.tv) {
+		AVTP_RX_COUNTER_INC(pCounters, tsValid);
+		if (hdr.tu) {
+			AVTP_RX_COUNTER_INC(pCounters, tsUncertain);
 		}
 		else {
-			AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVBAVTP_RC_INVALID_AVTP_VERSION));
+			// Cached to keep the gPTP shared memory lock out of the per packet path
+			U64 nowNsec = WALLTIME_CACHED_NSEC(&pStream->rxWallTime);
+			S32 deltaNsec = (S32)(hdr.timestamp - (U32)nowNsec);
+			if (deltaNsec < 0) {
+				AVTP_RX_COUNTER_INC(pCounters, lateTimestamp);
+			}
+			else if ((U32)deltaNsec > pStream->rxMaxEarlyNsec) {
+				AVTP_RX_COUNTER_INC(pCounters, earlyTimestamp);
+			}
 		}
 	}
 	else {
-		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVBAVTP_RC_IGNORING_CONTROL_PACKET));
+		AVTP_RX_COUNTER_INC(pCounters, tsNotValid);
 	}
 
+	if (pStream->pMapCB->map_rx_hdr_cb) {
+		pStream->pMapCB->map_rx_hdr_cb(pStream->pMediaQ, &hdr, pFrame, frameLen);
+	}
+	else {
+		pStream->pMapCB->map_rx_cb(pStream->pMediaQ, pFrame, frameLen);
+	}
+
+	// NOTE : This is a redundant call. It is handled in avtpTryRx()
+	// pStream->pIntfCB->intf_rx_cb(pStream->pMediaQ);
+
+	pStream->info.rx.bComplete = TRUE;
+
 	AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
 }
 
@@ -569,6 +729,11 @@ static void avtpTryRx(avtp_stream_t *pStream)
 			timeout = AVTP_MAX_BLOCK_USEC;
 			pBuf = (U8 *)openavbRawsockGetRxFrame(pStream->rawsock, timeout, &offsetToFrame, &frameLen);
 			if (!pBuf) {
+				if (pStream->bRxMediaLocked) {
+					// Nothing received for a whole blocking period
+					pStream->bRxMediaLocked = FALSE;
+					AVTP_RX_COUNTER_INC(pStream->pRxCounters, mediaUnlocked);
+				}
 				AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
 				return;
 			}
@@ -599,7 +764,18 @@ static void avtpTryRx(avtp_stream_t *pStream)
 	else {
 		pAvtpPdu = pBuf + offsetToFrame + hdrLen;
 		avtpPduLen = frameLen - hdrLen;
-		x_avtpRxFrame(pStream, pAvtpPdu, avtpPduLen);
+		if (pStream->bRxZeroCopy) {
+			openavbMediaQRxFrameBegin(pStream->pMediaQ, pBuf);
+			x_avtpRxFrame(pStream, pAvtpPdu, avtpPduLen);
+			if (openavbMediaQRxFrameEnd(pStream->pMediaQ)) {
+				// A media queue item now owns the frame
+				AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
+				return;
+			}
+		}
+		else {
+			x_avtpRxFrame(pStream, pAvtpPdu, avtpPduLen);
+		}
 	}
 	openavbRawsockRelRxFrame(pStream->rawsock, pBuf);
 
@@ -651,6 +827,363 @@ U64 openavbAvtpBytes(void *pv)
 	return bytes;
 }
 
+void openavbAvtpRxCounters(void *pv, avtp_rx_counters_t *pCounters)
+{
+	avtp_stream_t *pStream = (avtp_stream_t *)pv;
+	if (!pStream) {
+		// Quietly return. Since this can be called before a stream is available.
+		memset(pCounters, 0, sizeof(*pCounters));
+		return;
+	}
+	*pCounters = *pStream->pRxCounters;
+}
+
+void openavbAvtpRxSetCounters(void *pv, avtp_rx_counters_t *pCounters)
+{
+	avtp_stream_t *pStream = (avtp_stream_t *)pv;
+	if (!pStream || !pCounters) {
+		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVB_RC_INVALID_ARGUMENT));
+		return;
+	}
+	pStream->pRxCounters = pCounters;
+}
+
+void openavbAvtpRxSetTestDrop(void *pv, U32 dropInterval)
+{
+	avtp_stream_t *pStream = (avtp_stream_t *)pv;
+	if (!pStream) {
+		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVB_RC_INVALID_ARGUMENT));
+		return;
+	}
+	pStream->rxTestDropInterval = dropInterval;
+	pStream->rxTestDropCount = 0;
+}
+
+bool openavbAvtpTxZeroCopyOn(void *pv)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVTP);
+
+	avtp_stream_t *pStream = (avtp_stream_t *)pv;
+	if (!pStream) {
+		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVB_RC_INVALID_ARGUMENT));
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return FALSE;
+	}
+
+	if (!openavbMediaQTxFrameRefModeOn(pStream->pMediaQ)) {
+		AVB_LOG_WARNING("Zero copy transmit not enabled");
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return FALSE;
+	}
+
+	pStream->bTxZeroCopy = TRUE;
+	AVB_LOG_INFO("Zero copy transmit enabled");
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+	return TRUE;
+}
+
+// Returns a received frame referenced by the media queue to the ring
+static void x_avtpRxFrameRelease(void *pRelCtx, void *pRxFrame)
+{
+	openavbRawsockRelRxFrame(pRelCtx, pRxFrame);
+}
+
+bool openavbAvtpRxZeroCopyOn(void *pv)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVTP);
+
+	avtp_stream_t *pStream = (avtp_stream_t *)pv;
+	if (!pStream || !pStream->rawsock) {
+		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVB_RC_INVALID_ARGUMENT));
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return FALSE;
+	}
+
+	int holdLimit = openavbRawsockRxHoldLimit(pStream->rawsock);
+	if (holdLimit <= 0) {
+		AVB_LOG_WARNING("Raw socket type can not hold received frames; zero copy receive not enabled");
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return FALSE;
+	}
+
+	// Keep half of the ring free for the kernel to receive into. Beyond that
+	// limit mapping modules copy payloads as usual. Reception stops when the
+	// ring wraps around to a frame that is still referenced, so items must be
+	// consumed within about a ring of frames.
+	U32 maxRefs = holdLimit / 2;
+	if (maxRefs == 0 || !openavbMediaQRxFrameRefModeOn(pStream->pMediaQ, x_avtpRxFrameRelease, pStream->rawsock, maxRefs)) {
+		AVB_LOG_WARNING("Zero copy receive not enabled");
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return FALSE;
+	}
+
+	pStream->bRxZeroCopy = TRUE;
+	AVB_LOGF_INFO("Zero copy receive enabled; up to %u of %d ring frames referenced by the media queue", maxRefs, holdLimit);
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+	return TRUE;
+}
+
+// RX pipeline network thread. Copies AVTP PDUs out of the raw socket so
+// the ring is returned to the kernel without waiting for reassembly.
+static void *avtpRxNetThreadFn(void *pv)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVTP);
+
+	struct avtp_rx_pipeline *pPipe = (struct avtp_rx_pipeline *)pv;
+	avtp_stream_t *pStream = pPipe->pStream;
+
+	while (pPipe->bRunning) {
+		U32 offsetToFrame, frameLen;
+		hdr_info_t hdrInfo;
+
+		U8 *pBuf = (U8 *)openavbRawsockGetRxFrame(pStream->rawsock, AVTP_RX_PIPE_BLOCK_USEC, &offsetToFrame, &frameLen);
+		if (!pBuf) {
+			continue;
+		}
+
+		int hdrLen = openavbRawsockRxParseHdr(pStream->rawsock, pBuf, &hdrInfo);
+		if (hdrLen < 0) {
+			AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVBAVTP_RC_PARSING_FRAME_HEADER));
+		}
+		else {
+			U32 avtpPduLen = frameLen - hdrLen;
+			openavb_queue_elem_t elem = NULL;
+			if (avtpPduLen <= pPipe->maxPduLen) {
+				elem = openavbQueueHeadLock(pPipe->frameQueue);
+			}
+			if (elem) {
+				avtp_rx_pipe_frame_t *pFrame = (avtp_rx_pipe_frame_t *)openavbQueueData(elem);
+				memcpy(pFrame->data, pBuf + offsetToFrame + hdrLen, avtpPduLen);
+				pFrame->len = avtpPduLen;
+				openavbQueueHeadPush(pPipe->frameQueue);
+
+				SEM_ERR_T(err);
+				SEM_POST(pPipe->frameSem, err);
+				SEM_LOG_ERR(err);
+
+				pPipe->stats.framesQueued++;
+				U32 level = openavbQueueGetElemCount(pPipe->frameQueue);
+				if (level > pPipe->stats.queueLevelMax) {
+					pPipe->stats.queueLevelMax = level;
+				}
+			}
+			else {
+				pPipe->stats.framesDropped++;
+				IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("RX pipeline dropped a frame: %u bytes, %u queued",
+					avtpPduLen, openavbQueueGetElemCount(pPipe->frameQueue));
+			}
+		}
+		openavbRawsockRelRxFrame(pStream->rawsock, pBuf);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+	return NULL;
+}
+
+// RX pipeline delivery thread. Hands media queue items to the interface
+// module at their presentation time, as avtpTryRx() does without the pipeline.
+static void *avtpRxDeliveryThreadFn(void *pv)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVTP);
+
+	struct avtp_rx_pipeline *pPipe = (struct avtp_rx_pipeline *)pv;
+	avtp_stream_t *pStream = pPipe->pStream;
+
+	while (pPipe->bRunning) {
+		U32 usecTill;
+
+		if (!openavbMediaQUsecTillTail(pStream->pMediaQ, &usecTill)) {
+			// Nothing to deliver. Check again after announcing the wait so an
+			// item pushed in between is not slept through.
+			pPipe->bDeliveryWaiting = TRUE;
+			__sync_synchronize();
+			if (!openavbMediaQUsecTillTail(pStream->pMediaQ, &usecTill)) {
+				SEM_ERR_T(err);
+				SEM_TIMEDWAIT(pPipe->deliverySem, AVTP_RX_PIPE_BLOCK_MSEC, err);
+				if (!SEM_IS_ERR_NONE(err) && !SEM_IS_ERR_TIMEOUT(err)) {
+					SEM_LOG_ERR(err);
+				}
+			}
+			pPipe->bDeliveryWaiting = FALSE;
+			continue;
+		}
+
+		if (usecTill > 0) {
+			// Items stay in order, so nothing is due before the tail
+			if (usecTill > AVTP_RX_PIPE_BLOCK_USEC)
+				usecTill = AVTP_RX_PIPE_BLOCK_USEC;
+			SLEEP_NSEC((U64)usecTill * NANOSECONDS_PER_USEC);
+			continue;
+		}
+
+		pStream->pIntfCB->intf_rx_cb(pStream->pMediaQ);
+		pPipe->stats.deliveryCalls++;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+	return NULL;
+}
+
+static void x_avtpRxPipelineDelete(struct avtp_rx_pipeline *pPipe)
+{
+	SEM_ERR_T(err);
+	SEM_DESTROY(pPipe->frameSem, err);
+	SEM_LOG_ERR(err);
+	SEM_DESTROY(pPipe->deliverySem, err);
+	SEM_LOG_ERR(err);
+	openavbQueueDeleteQueue(pPipe->frameQueue);
+	free(pPipe);
+}
+
+static void x_avtpRxPipelineOff(avtp_stream_t *pStream)
+{
+	struct avtp_rx_pipeline *pPipe = pStream->pRxPipeline;
+
+	pPipe->bRunning = FALSE;
+	SEM_ERR_T(err);
+	SEM_POST(pPipe->deliverySem, err);
+	SEM_LOG_ERR(err);
+	THREAD_JOIN(pPipe->rxNetThread, NULL);
+	THREAD_JOIN(pPipe->rxDeliveryThread, NULL);
+
+	AVB_LOGF_INFO("RX pipeline stopped: queued=%" PRIu64 ", dropped=%" PRIu64 ", deliveries=%" PRIu64,
+		pPipe->stats.framesQueued, pPipe->stats.framesDropped, pPipe->stats.deliveryCalls);
+
+	pStream->pRxPipeline = NULL;
+	x_avtpRxPipelineDelete(pPipe);
+}
+
+bool openavbAvtpRxPipelineOn(void *pv, U32 nFrames, U32 netAffinity, U32 deliveryAffinity, U32 rtPriority)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVTP);
+
+	avtp_stream_t *pStream = (avtp_stream_t *)pv;
+	if (!pStream || !pStream->rawsock || pStream->pRxPipeline || nFrames == 0) {
+		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVB_RC_INVALID_ARGUMENT));
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return FALSE;
+	}
+	if (pStream->bRxZeroCopy) {
+		AVB_LOG_WARNING("RX pipeline can not be used with zero copy receive");
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return FALSE;
+	}
+
+	struct avtp_rx_pipeline *pPipe = calloc(1, sizeof(struct avtp_rx_pipeline));
+	if (!pPipe) {
+		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVB_RC_OUT_OF_MEMORY));
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return FALSE;
+	}
+	pPipe->pStream = pStream;
+	pPipe->maxPduLen = pStream->frameLen;
+	pPipe->frameQueue = openavbQueueNewQueue(sizeof(avtp_rx_pipe_frame_t) + pPipe->maxPduLen, nFrames);
+	if (!pPipe->frameQueue) {
+		free(pPipe);
+		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVB_RC_OUT_OF_MEMORY));
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return FALSE;
+	}
+
+	SEM_ERR_T(err);
+	SEM_INIT(pPipe->frameSem, 0, err);
+	SEM_LOG_ERR(err);
+	SEM_INIT(pPipe->deliverySem, 0, err);
+	SEM_LOG_ERR(err);
+
+	// Reassembly pushes to the media queue while the delivery thread pulls from it
+	openavbMediaQThreadSafeOn(pStream->pMediaQ);
+
+	bool errResult;
+	pPipe->bRunning = TRUE;
+	THREAD_CREATE(rxNetThread, pPipe->rxNetThread, NULL, avtpRxNetThreadFn, pPipe);
+	THREAD_CHECK_ERROR(pPipe->rxNetThread, "RX pipeline network thread create failed", errResult);
+	if (errResult) {
+		x_avtpRxPipelineDelete(pPipe);
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return FALSE;
+	}
+	THREAD_CREATE(rxDeliveryThread, pPipe->rxDeliveryThread, NULL, avtpRxDeliveryThreadFn, pPipe);
+	THREAD_CHECK_ERROR(pPipe->rxDeliveryThread, "RX pipeline delivery thread create failed", errResult);
+	if (errResult) {
+		pPipe->bRunning = FALSE;
+		THREAD_JOIN(pPipe->rxNetThread, NULL);
+		x_avtpRxPipelineDelete(pPipe);
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return FALSE;
+	}
+
+	if (rtPriority != 0) {
+		THREAD_SET_RT_PRIORITY(pPipe->rxNetThread, rtPriority);
+		THREAD_SET_RT_PRIORITY(pPipe->rxDeliveryThread, rtPriority);
+	}
+	if (netAffinity != 0xFFFFFFFF) {
+		THREAD_PIN(pPipe->rxNetThread, netAffinity);
+	}
+	if (deliveryAffinity != 0xFFFFFFFF) {
+		THREAD_PIN(pPipe->rxDeliveryThread, deliveryAffinity);
+	}
+
+	pStream->pRxPipeline = pPipe;
+	AVB_LOGF_INFO("RX pipeline enabled; %u frames between network RX and reassembly", nFrames);
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+	return TRUE;
+}
+
+void openavbAvtpRxPipelineStats(void *pv, avtp_rx_pipeline_stats_t *pStats)
+{
+	avtp_stream_t *pStream = (avtp_stream_t *)pv;
+	if (!pStream || !pStream->pRxPipeline) {
+		// Quietly return. Since this can be called before a stream is available.
+		memset(pStats, 0, sizeof(*pStats));
+		return;
+	}
+
+	struct avtp_rx_pipeline *pPipe = pStream->pRxPipeline;
+	*pStats = pPipe->stats;
+	pStats->queueLevel = openavbQueueGetElemCount(pPipe->frameQueue);
+	pPipe->stats.queueLevelMax = 0;
+}
+
+/*
+ * Reassemble one frame passed on by the RX pipeline network thread. The
+ * delivery thread is woken if it is waiting for media queue items.
+ */
+static void avtpPipelineRx(avtp_stream_t *pStream)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVTP_DETAIL);
+
+	struct avtp_rx_pipeline *pPipe = pStream->pRxPipeline;
+	SEM_ERR_T(err);
+
+	SEM_TIMEDWAIT(pPipe->frameSem, AVTP_MAX_BLOCK_USEC / MICROSECONDS_PER_MSEC, err);
+	if (!SEM_IS_ERR_NONE(err)) {
+		if (SEM_IS_ERR_TIMEOUT(err) && pStream->bRxMediaLocked) {
+			// Nothing received for a whole blocking period
+			pStream->bRxMediaLocked = FALSE;
+			AVTP_RX_COUNTER_INC(pStream->pRxCounters, mediaUnlocked);
+		}
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
+		return;
+	}
+
+	openavb_queue_elem_t elem = openavbQueueTailLock(pPipe->frameQueue);
+	if (elem) {
+		avtp_rx_pipe_frame_t *pFrame = (avtp_rx_pipe_frame_t *)openavbQueueData(elem);
+		x_avtpRxFrame(pStream, pFrame->data, pFrame->len);
+		openavbQueueTailPull(pPipe->frameQueue);
+
+		if (pPipe->bDeliveryWaiting && __sync_bool_compare_and_swap(&pPipe->bDeliveryWaiting, TRUE, FALSE)) {
+			SEM_POST(pPipe->deliverySem, err);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
+}
+
 openavbRC openavbAvtpRx(void *pv)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVTP_DETAIL);
@@ -661,7 +1194,12 @@ openavbRC openavbAvtpRx(void *pv)
 	}
 
 	// Check our socket, and potentially receive some data.
-	avtpTryRx(pStream);
+	if (pStream->pRxPipeline) {
+		avtpPipelineRx(pStream);
+	}
+	else {
+		avtpTryRx(pStream);
+	}
 
 	// See if there's a complete (re-assembled) data sample.
 	if (pStream->info.rx.bComplete) {
@@ -684,6 +1222,8 @@ void openavbAvtpConfigTimsstampEval(void *handle, U32 tsInterval, U32 reportInte
 	}
 
 	pStream->tsEval = openavbTimestampEvalNew();
+	pStream->bTsEvalSmoothing = smoothing;
+	pStream->tsEvalBatchCnt = 0;
 	openavbTimestampEvalInitialize(pStream->tsEval, tsInterval);
 	openavbTimestampEvalSetReport(pStream->tsEval, reportInterval);
 	if (smoothing) {
@@ -730,6 +1270,8 @@ void openavbAvtpShutdownTalker(void *pv)
 		if (pStream->ifname)
 			free(pStream->ifname);
 
+		x_avtpTimestampEvalEnd(pStream);
+
 		// free the malloc'd stream info
 		free(pStream);
 	}
@@ -744,18 +1286,39 @@ void openavbAvtpShutdownListener(void *pv)
 
 	avtp_stream_t *pStream = (avtp_stream_t *)pv;
 	if (pStream) {
+		if (pStream->pRxPipeline) {
+			// Stop the threads before the interface and the raw socket go away
+			x_avtpRxPipelineOff(pStream);
+		}
+
+		if (pStream->bRxZeroCopy) {
+			// The interface may hold ring frames. Let it drop them and return
+			// the ones still queued before the ring goes away.
+			pStream->pIntfCB->intf_end_cb(pStream->pMediaQ);
+			pStream->pMapCB->map_end_cb(pStream->pMediaQ);
+			openavbMediaQRxFrameRefModeOff(pStream->pMediaQ);
+		}
+
 		// close the rawsock
 		if (pStream->rawsock) {
 			openavbRawsockClose(pStream->rawsock);
 			pStream->rawsock = NULL;
 		}
 
-		pStream->pIntfCB->intf_end_cb(pStream->pMediaQ);
-		pStream->pMapCB->map_end_cb(pStream->pMediaQ);
+		if (!pStream->bRxZeroCopy) {
+			pStream->pIntfCB->intf_end_cb(pStream->pMediaQ);
+			pStream->pMapCB->map_end_cb(pStream->pMediaQ);
+		}
+
+		if (pStream->bRxMediaLocked) {
+			AVTP_RX_COUNTER_INC(pStream->pRxCounters, mediaUnlocked);
+		}
 
 		if (pStream->ifname)
 			free(pStream->ifname);
 
+		x_avtpTimestampEvalEnd(pStream);
+
 		// free the malloc'd stream info
 		free(pStream);
 	}
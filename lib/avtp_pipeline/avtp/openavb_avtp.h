@@ -43,6 +43,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_map_pub.h"
 #include "openavb_rawsock.h"
 #include "openavb_timestamp.h"
+#include "openavb_avtp_counters.h"
 
 #define ETHERTYPE_AVTP 0x22F0
 #define ETHERTYPE_8021Q 0x8100
@@ -61,6 +62,9 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 //#define OPENAVB_AVTP_REPORT_RX_STATS 1
 #define OPENAVB_AVTP_REPORT_INTERVAL 100
 
+// Timestamps gathered before they are evaluated, when they are not smoothed
+#define OPENAVB_AVTP_TS_EVAL_BATCH 32
+
 typedef struct {
 	// These are significant only for RX data
 	U32					timestamp;  // delivery timestamp
@@ -81,6 +85,21 @@ typedef struct {
 	media_q_t 				mediaq;
 } avtp_state_t;
 
+// Occupancy of the listener RX pipeline, see openavbAvtpRxPipelineOn()
+typedef struct {
+	// Frames passed from the network thread to reassembly
+	U64 framesQueued;
+	// Frames dropped by the network thread because the frame queue was full
+	U64 framesDropped;
+	// Frames waiting for reassembly now, and the most since the last call
+	U32 queueLevel;
+	U32 queueLevelMax;
+	// Interface RX callbacks made by the delivery thread
+	U64 deliveryCalls;
+} avtp_rx_pipeline_stats_t;
+
+struct avtp_rx_pipeline;
+
 
 /* Info associated with an AVTP stream (RX or TX).
  *
@@ -99,6 +118,11 @@ typedef struct
 	char* ifname;
 	// Number of rawsock buffers
 	U16 nbuffers;
+	// Number of frames in a TX ring shared with other streams, 0 for a socket of our own
+	U32 nSharedFrames;
+	// Priority and mark a shared TX socket is keyed by
+	U8 txPriority;
+	U32 fwmark;
 	// The rawsock library handle.  Used to send or receive frames.
 	void *rawsock;
 	// The streamID - in network form
@@ -134,12 +158,38 @@ typedef struct
 	
 	// Timestamp evaluation related
 	openavb_timestamp_eval_t tsEval;
+	bool bTsEvalSmoothing;
+	U32 tsEvalBatch[OPENAVB_AVTP_TS_EVAL_BATCH];
+	U32 tsEvalBatchCnt;
 
 	// Stat related	
 	// RX frames lost
 	int nLost;
 	// Bytes sent or recieved
 	U64 bytes;
+	// RX header expectations, precomputed at init
+	U32 rxHdrWord0;
+	bool bRxCheckStreamID;
+	bool bRxCheckDataLen;
+	U32 rxMaxEarlyNsec;
+	// Cached wall time for the RX timestamp checks
+	spin_wait_t rxWallTime;
+	// Media clock restart flag of the last frame received
+	bool rxLastMr;
+	// RX media lock state, for the media locked/unlocked counters
+	bool bRxMediaLocked;
+	// RX header counters. Points to rxCounters unless openavbAvtpRxSetCounters() is used.
+	avtp_rx_counters_t rxCounters;
+	avtp_rx_counters_t *pRxCounters;
+	// Test aid: drop every Nth received frame, set with openavbAvtpRxSetTestDrop()
+	U32 rxTestDropInterval;
+	U32 rxTestDropCount;
+	// RX frames may stay in the raw socket ring while referenced by media queue items
+	bool bRxZeroCopy;
+	// Interface modules may fill the TX frame through the media queue head item
+	bool bTxZeroCopy;
+	// Network RX and interface delivery threads, NULL when the listener thread does everything
+	struct avtp_rx_pipeline *pRxPipeline;
 	
 } avtp_stream_t;
 
@@ -158,6 +208,7 @@ openavbRC openavbAvtpTxInit(media_q_t *pMediaQ,
 					U16 vlanID,
 					U8  vlanPCP,
 					U16 nbuffers,
+					U32 nSharedFrames,
 					void **pStream_out);
 
 openavbRC openavbAvtpTx(void *pv, bool bSend, bool txBlockingInIntf);
@@ -168,6 +219,7 @@ openavbRC openavbAvtpRxInit(media_q_t *pMediaQ,
 					char* ifname,
 					AVBStreamID_t *streamID,
 					U8* destAddr,
+					U32 max_transit_usec,
 					U16 nbuffers,
 					bool rxSignalMode,
 					void **pStream_out);
@@ -188,5 +240,12 @@ int openavbAvtpRxBufferLevel(void *handle);
 int openavbAvtpLost(void *handle);
 
 U64 openavbAvtpBytes(void *handle);
+void openavbAvtpRxCounters(void *handle, avtp_rx_counters_t *pCounters);
+void openavbAvtpRxSetCounters(void *handle, avtp_rx_counters_t *pCounters);
+void openavbAvtpRxSetTestDrop(void *handle, U32 dropInterval);
+bool openavbAvtpRxZeroCopyOn(void *handle);
+bool openavbAvtpTxZeroCopyOn(void *handle);
+bool openavbAvtpRxPipelineOn(void *handle, U32 nFrames, U32 netAffinity, U32 deliveryAffinity, U32 rtPriority);
+void openavbAvtpRxPipelineStats(void *handle, avtp_rx_pipeline_stats_t *pStats);
 
 #endif //AVB_AVTP_H
@@ -0,0 +1,66 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Per stream AVTP RX counters. Kept apart from openavb_avtp.h
+* so that processes which only read the counters (AVDECC) need no other AVTP
+* declarations.
+*/
+
+#ifndef AVB_AVTP_COUNTERS_H
+#define AVB_AVTP_COUNTERS_H 1
+
+#include "openavb_types_base_pub.h"
+
+// Per stream RX counters, in the spirit of the IEEE 1722.1 STREAM_INPUT counters.
+// The counters may be placed in shared memory and read by another process. The
+// RX thread is the only writer, so relaxed atomic loads and stores are enough.
+typedef struct {
+	U32					mediaLocked;
+	U32					mediaUnlocked;
+	U32					framesRx;
+	U32					seqMismatch;
+	U32					mediaReset;
+	U32					tsValid;
+	U32					tsNotValid;
+	U32					tsUncertain;
+	U32					unsupportedFormat;
+	U32					streamIdMismatch;
+	U32					lateTimestamp;
+	U32					earlyTimestamp;
+} avtp_rx_counters_t;
+
+#define AVTP_RX_COUNTER_INC(pCounters, field) \
+	__atomic_store_n(&(pCounters)->field, (pCounters)->field + 1, __ATOMIC_RELAXED)
+#define AVTP_RX_COUNTER_GET(pCounters, field) \
+	__atomic_load_n(&(pCounters)->field, __ATOMIC_RELAXED)
+
+#endif // AVB_AVTP_COUNTERS_H
@@ -1,4 +1,5 @@
 AVB_FEATURE_AVDECC ?= 1
+AVB_AEM_COMPILED_MODEL ?=
 PLATFORM_TOOLCHAIN ?= generic
 
 .PHONY: all clean
@@ -22,5 +23,6 @@ build_avdecc/Makefile:
 	cmake -DCMAKE_BUILD_TYPE=Release \
 	      -DCMAKE_TOOLCHAIN_FILE=../platform/Linux/$(PLATFORM_TOOLCHAIN).cmake \
 	      -DAVB_FEATURE_AVDECC=$(AVB_FEATURE_AVDECC) \
+	      -DAVB_AEM_COMPILED_MODEL=$(AVB_AEM_COMPILED_MODEL) \
 	      ..
 
@@ -157,4 +157,17 @@ typedef enum {
 	AVB_MCR_CRS
 }avb_audio_mcr_t;
 
+/** Packet loss concealment done by audio listeners.
+ */
+typedef enum {
+	/// Lost packets are not replaced, this is the default
+	AVB_AUDIO_CONCEAL_NONE,
+	/// Lost packets are replaced with silence
+	AVB_AUDIO_CONCEAL_SILENCE,
+	/// Lost packets are replaced with the last packet received
+	AVB_AUDIO_CONCEAL_REPEAT,
+	/// Lost packets are replaced with a linear ramp between the frames around the gap
+	AVB_AUDIO_CONCEAL_INTERPOLATE
+} avb_audio_concealment_t;
+
 #endif // AVB_AUDIO_PUB_H
@@ -136,6 +136,45 @@ typedef void (*openavb_map_rx_init_cb_t)(media_q_t *pMediaQ);
  */
 typedef bool (*openavb_map_rx_cb_t)(media_q_t *pMediaQ, U8 *pData, U32 datalen);
 
+/** AVTP common stream header of a received frame.
+ *
+ * Decoded once by AVTP and already validated against the stream (subtype,
+ * version, stream ID and, for formats using the common stream header layout,
+ * stream_data_length against the frame length).
+ */
+typedef struct {
+	/// AVTP subtype
+	U8 subtype;
+	/// AVTP version
+	U8 version;
+	/// Sequence number
+	U8 sequenceNum;
+	/// Media clock restart flag
+	bool mr;
+	/// Gateway info valid flag
+	bool gv;
+	/// Timestamp valid flag
+	bool tv;
+	/// Timestamp uncertain flag
+	bool tu;
+	/// AVTP presentation timestamp. Only meaningful when tv is set
+	U32 timestamp;
+	/// Length of the stream data following the 24 byte header
+	U16 streamDataLen;
+} avtp_stream_hdr_t;
+
+/** This callback occurs when running as a listener and data is available.
+ * Optional replacement for \ref openavb_map_rx_cb_t. When set it is called
+ * instead of the receive callback, so the mapping module does not need to
+ * parse or check the common stream header again.
+ *
+ * \param pMediaQ A pointer to the media queue for this stream
+ * \param pHdr decoded AVTP header of the frame
+ * \param pData pointer to data (starting with the AVTP header)
+ * \param dataLen length of data
+ */
+typedef bool (*openavb_map_rx_hdr_cb_t)(media_q_t *pMediaQ, const avtp_stream_hdr_t *pHdr, U8 *pData, U32 datalen);
+
 /** This callback will be called when the stream is closing.
  *
  * \param pMediaQ A pointer to the media queue for this stream
@@ -219,6 +258,8 @@ typedef struct {
 	openavb_map_set_src_bitrate_cb_t    map_set_src_bitrate_cb;
 	/// Max interval frames callback.
 	openavb_map_get_max_interval_frames_cb_t map_get_max_interval_frames_cb;
+	/// Receive callback with decoded AVTP header (optional).
+	openavb_map_rx_hdr_cb_t				map_rx_hdr_cb;
 
 #if ATL_LAUNCHTIME_ENABLED
 	// Launchtime calculation
@@ -30,10 +30,13 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 *************************************************************************************************************/
 
 /*
-* MODULE SUMMARY : Tone generator interface module. Talker only.
+* MODULE SUMMARY : Tone generator interface module.
 * 
 * - This interface module generates and audio tone for use with -6 and AAF mappings
 * - Requires an OSAL sin implementation of reasonable performance. 
+* - Can instead generate per channel counter or pseudo random verification patterns. Run as a
+*   listener the module checks those patterns for continuity, channel mapping, bit exactness
+*   and presentation time error.
 */
 
 #include <stdlib.h>
@@ -55,6 +58,15 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #define PI 3.14159265358979f
 
+// Fewest frame counter bits a verification pattern sample may be left with
+#define TONEGEN_PATTERN_MIN_COUNTER_BITS 8
+
+typedef enum {
+	TONEGEN_PATTERN_TONE,
+	TONEGEN_PATTERN_COUNTER,
+	TONEGEN_PATTERN_PRBS,
+} tonegen_pattern_t;
+
 typedef struct {
 	/////////////
 	// Config data
@@ -94,6 +106,15 @@ typedef struct {
 	bool fv2Enabled;
 	U32 fv2;
 
+	// intf_nv_pattern: Tone or one of the verification patterns
+	tonegen_pattern_t pattern;
+
+	// intf_nv_check_report_sec: How often the checker reports. 0 only reports at the end.
+	U32 checkReportSec;
+
+	// intf_nv_check_late_usec: Presentation time error above which an item counts as late
+	U32 checkLateUSec;
+
 	/////////////
 	// Variable data
 	/////////////
@@ -123,6 +144,33 @@ typedef struct {
 
 	bool fixedTimestampEnabled;
 
+	// intf_nv_pace_tx: Block in the TX callback until the next item is due.
+	bool paceTx;
+
+	// Pacing start time and number of frames generated since then
+	U64 paceStartNS;
+	U64 paceFrames;
+
+	// Frame counter carried by the verification patterns
+	U32 patternFrame;
+
+	// Checker state. Counts are totals, presentation time errors are per report interval.
+	bool checkEnabled;
+	bool checkLocked;
+	U32 checkNextFrame;
+	U64 checkNextReportNS;
+	U64 checkItems;
+	U64 checkFrames;
+	U32 checkGaps;
+	U64 checkLostFrames;
+	U64 checkMapErrors;
+	U64 checkBitErrors;
+	U32 checkPtCount;
+	S32 checkPtMinUSec;
+	S32 checkPtMaxUSec;
+	S64 checkPtAccumUSec;
+	U32 checkLate;
+
 } pvt_data_t;
 
 #define MSEC_PER_COUNT 250
@@ -208,6 +256,39 @@ static bool xSupportedMappingFormat(media_q_t *pMediaQ)
 	return FALSE;
 }
 
+// Bits of a counter sample that hold the frame counter. The channel number takes the top
+// bits, as many as it needs to tell all configured channels apart.
+static U32 xPatternCounterBits(pvt_data_t *pPvtData, U32 bits)
+{
+	U32 tagBits = 1;
+	while (tagBits < bits && (1U << tagBits) < (U32)pPvtData->audioChannels) {
+		tagBits++;
+	}
+	return bits - tagBits;
+}
+
+// Width of the sample word that carries a verification pattern. Float samples are carried
+// as their raw 32 bit container so they are checked bit for bit as well. Returns 0 if the
+// configured format can't carry a pattern, or if the channel number leaves less than
+// TONEGEN_PATTERN_MIN_COUNTER_BITS for the frame counter.
+static U32 xPatternBits(pvt_data_t *pPvtData)
+{
+	U32 bits = 0;
+
+	if (pPvtData->audioType == AVB_AUDIO_TYPE_FLOAT) {
+		bits = 32;
+	}
+	else if (pPvtData->audioType == AVB_AUDIO_TYPE_INT || pPvtData->audioType == AVB_AUDIO_TYPE_UINT) {
+		if (pPvtData->audioBitDepth == 16 || pPvtData->audioBitDepth == 24 || pPvtData->audioBitDepth == 32) {
+			bits = pPvtData->audioBitDepth;
+		}
+	}
+	if (bits && xPatternCounterBits(pPvtData, bits) < TONEGEN_PATTERN_MIN_COUNTER_BITS) {
+		return 0;
+	}
+	return bits;
+}
+
 // Each configuration name value pair for this mapping will result in this callback being called.
 void openavbIntfToneGenCfgCB(media_q_t *pMediaQ, const char *name, const char *value) 
 {
@@ -337,6 +418,32 @@ void openavbIntfToneGenCfgCB(media_q_t *pMediaQ, const char *name, const char *v
 			pPvtData->volume = pow(10.0, vol/10.0);
 		}
 
+		else if (strcmp(name, "intf_nv_pace_tx") == 0) {
+			val = strtol(value, &pEnd, 10);
+			pPvtData->paceTx = (val == 1);
+		}
+
+		else if (strcmp(name, "intf_nv_pattern") == 0) {
+			if (strncasecmp(value, "tone", 4) == 0)
+				pPvtData->pattern = TONEGEN_PATTERN_TONE;
+			else if (strncasecmp(value, "counter", 7) == 0)
+				pPvtData->pattern = TONEGEN_PATTERN_COUNTER;
+			else if (strncasecmp(value, "prbs", 4) == 0)
+				pPvtData->pattern = TONEGEN_PATTERN_PRBS;
+			else {
+				AVB_LOG_ERROR("Invalid pattern configured for intf_nv_pattern.");
+				pPvtData->pattern = TONEGEN_PATTERN_TONE;
+			}
+		}
+
+		else if (strcmp(name, "intf_nv_check_report_sec") == 0) {
+			pPvtData->checkReportSec = strtol(value, &pEnd, 10);
+		}
+
+		else if (strcmp(name, "intf_nv_check_late_usec") == 0) {
+			pPvtData->checkLateUSec = strtol(value, &pEnd, 10);
+		}
+
 		else if (strcmp(name, "intf_nv_fv1") == 0) {
 			pPvtData->fv1 = strtol(value, &pEnd, 10);
 			pPvtData->fv1Enabled = true;
@@ -393,6 +500,20 @@ void openavbIntfToneGenTxInitCB(media_q_t *pMediaQ)
 		}
 		
 		pPvtData->melodyIdx = 0;
+
+		pPvtData->paceStartNS = 0;
+		pPvtData->paceFrames = 0;
+
+		pPvtData->patternFrame = 0;
+		if (pPvtData->pattern != TONEGEN_PATTERN_TONE) {
+			if (!xPatternBits(pPvtData)) {
+				AVB_LOG_ERROR("Verification patterns need 16, 24 or 32 bit integer or float samples and at most 256 channels at 16 bit. Generating the tone.");
+				pPvtData->pattern = TONEGEN_PATTERN_TONE;
+			}
+			else if (pPvtData->fvChannels > 0) {
+				AVB_LOG_WARNING("intf_nv_fv1 and intf_nv_fv2 are ignored with verification patterns.");
+			}
+		}
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
@@ -453,6 +574,84 @@ static U32 convertToDesiredEndianOrder32(U32 hostData, avb_audio_endian_t audioE
 #endif
 }
 
+// The pattern sample for a frame and channel. A counter sample holds the channel number in
+// its top bits and the frame counter in the rest (see xPatternCounterBits()). In PRBS mode
+// channel 0 keeps the counter so the checker can follow the stream and the other channels
+// carry a pseudo random sequence indexed by the frame counter and seeded with the full
+// channel number.
+static U32 xPatternSample(pvt_data_t *pPvtData, U32 bits, U32 frame, U32 channel)
+{
+	U32 counterBits = xPatternCounterBits(pPvtData, bits);
+	U32 counterMask = (1U << counterBits) - 1;
+
+	if (pPvtData->pattern == TONEGEN_PATTERN_PRBS && channel > 0) {
+		U32 x = ((frame & counterMask) * 0x9E3779B1) ^ ((channel + 1) * 0x85EBCA77);
+		x ^= x >> 15;
+		x *= 0x2C1B3C6D;
+		x ^= x >> 12;
+		x *= 0x297A2D39;
+		x ^= x >> 15;
+		return bits == 32 ? x : x & ((1U << bits) - 1);
+	}
+	return (channel << counterBits) | (frame & counterMask);
+}
+
+static void xPutPatternWord(pvt_data_t *pPvtData, U8 *pData, U32 bits, U32 word)
+{
+	if (bits == 32) {
+		U32 tmp32 = convertToDesiredEndianOrder32(word, pPvtData->audioEndian);
+		memcpy(pData, (U8 *)&tmp32, 4);
+	} else if (bits == 24) {
+		U32 tmp24 = convertToDesiredEndianOrder32(word << 8, pPvtData->audioEndian);
+		if (pPvtData->audioEndian == AVB_AUDIO_ENDIAN_BIG) {
+			memcpy(pData, (U8 *)&tmp24, 3);
+		} else {
+			memcpy(pData, ((U8 *)&tmp24) + 1, 3);
+		}
+	} else {
+		U16 tmp16 = convertToDesiredEndianOrder16(word, pPvtData->audioEndian);
+		memcpy(pData, (U8 *)&tmp16, 2);
+	}
+}
+
+static U32 xGetPatternWord(pvt_data_t *pPvtData, U8 *pData, U32 bits)
+{
+	if (bits == 32) {
+		U32 tmp32;
+		memcpy((U8 *)&tmp32, pData, 4);
+		return convertToDesiredEndianOrder32(tmp32, pPvtData->audioEndian);
+	} else if (bits == 24) {
+		U32 tmp24 = 0;
+		if (pPvtData->audioEndian == AVB_AUDIO_ENDIAN_BIG) {
+			memcpy((U8 *)&tmp24, pData, 3);
+		} else {
+			memcpy(((U8 *)&tmp24) + 1, pData, 3);
+		}
+		return convertToDesiredEndianOrder32(tmp24, pPvtData->audioEndian) >> 8;
+	} else {
+		U16 tmp16;
+		memcpy((U8 *)&tmp16, pData, 2);
+		return convertToDesiredEndianOrder16(tmp16, pPvtData->audioEndian);
+	}
+}
+
+// Fill a media queue item with the verification pattern. Every channel carries the pattern,
+// the fixed values are not used in this mode.
+static void xFillPatternItem(pvt_data_t *pPvtData, media_q_pub_map_uncmp_audio_info_t *pPubMapUncmpAudioInfo, U8 *pData)
+{
+	U32 bits = xPatternBits(pPvtData);
+	U32 frameCnt;
+	U32 channelCnt;
+
+	for (frameCnt = 0; frameCnt < pPubMapUncmpAudioInfo->framesPerItem; frameCnt++) {
+		for (channelCnt = 0; channelCnt < pPubMapUncmpAudioInfo->audioChannels; channelCnt++) {
+			xPutPatternWord(pPvtData, pData, bits, xPatternSample(pPvtData, bits, pPvtData->patternFrame, channelCnt));
+			pData += bits / 8;
+		}
+		pPvtData->patternFrame++;
+	}
+}
+
 // This callback will be called for each AVB transmit interval. Commonly this will be
 // 4000 or 8000 times  per second.
 bool openavbIntfToneGenTxCB(media_q_t *pMediaQ)
@@ -470,6 +669,17 @@ bool openavbIntfToneGenTxCB(media_q_t *pMediaQ)
 		if (pPvtData->intervalCounter++ % pPubMapUncmpAudioInfo->packingFactor != 0)
 			return TRUE;
 
+		if (pPvtData->paceTx) {
+			// Wait until the frames for the next item would have been produced. This lets the
+			// interface drive transmission when the talker is run with tx_blocking_in_intf = 1.
+			if (!pPvtData->paceStartNS) {
+				CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &pPvtData->paceStartNS);
+			}
+			else {
+				SLEEP_UNTIL_NSEC(pPvtData->paceStartNS + (pPvtData->paceFrames * NANOSECONDS_PER_SECOND) / pPubMapUncmpAudioInfo->audioRate);
+			}
+		}
+
 		media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
 		if (pMediaQItem) {
 			if (pMediaQItem->itemSize < pPubMapUncmpAudioInfo->itemSize) {
@@ -481,8 +691,14 @@ bool openavbIntfToneGenTxCB(media_q_t *pMediaQ)
 			U32 frameCnt;
 			U32 channelCnt;
 			U8 *pData = pMediaQItem->pPubData;
+			U32 toneFrames = pPubMapUncmpAudioInfo->framesPerItem;
+
+			if (pPvtData->pattern != TONEGEN_PATTERN_TONE) {
+				xFillPatternItem(pPvtData, pPubMapUncmpAudioInfo, pData);
+				toneFrames = 0;
+			}
 
-			for (frameCnt = 0; frameCnt < pPubMapUncmpAudioInfo->framesPerItem; frameCnt++) {
+			for (frameCnt = 0; frameCnt < toneFrames; frameCnt++) {
 
 				// Check for tone on / off toggle
 				if (!pPvtData->freqCountdown) {
@@ -585,6 +801,8 @@ bool openavbIntfToneGenTxCB(media_q_t *pMediaQ)
 
 			openavbMediaQHeadPush(pMediaQ);
 
+			pPvtData->paceFrames += pPubMapUncmpAudioInfo->framesPerItem;
+
 			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
 			return TRUE;
 		}
@@ -598,11 +816,144 @@ bool openavbIntfToneGenTxCB(media_q_t *pMediaQ)
 	return FALSE;
 }
 
+static void xCheckResetInterval(pvt_data_t *pPvtData)
+{
+	pPvtData->checkPtCount = 0;
+	pPvtData->checkPtMinUSec = 0;
+	pPvtData->checkPtMaxUSec = 0;
+	pPvtData->checkPtAccumUSec = 0;
+}
+
+static void xCheckReport(pvt_data_t *pPvtData)
+{
+	S32 ptAvgUSec = 0;
+	if (pPvtData->checkPtCount) {
+		ptAvgUSec = pPvtData->checkPtAccumUSec / pPvtData->checkPtCount;
+	}
+
+	AVB_LOGF_INFO("Checker: items %llu, frames %llu, gaps %u, lost frames %llu, mapping errors %llu, bit errors %llu",
+		pPvtData->checkItems, pPvtData->checkFrames, pPvtData->checkGaps, pPvtData->checkLostFrames,
+		pPvtData->checkMapErrors, pPvtData->checkBitErrors);
+	AVB_LOGF_INFO("Checker: presentation time error min %d usec, max %d usec, avg %d usec, late %u",
+		pPvtData->checkPtMinUSec, pPvtData->checkPtMaxUSec, ptAvgUSec, pPvtData->checkLate);
+
+	xCheckResetInterval(pPvtData);
+}
+
+// Check the samples of one media queue item against the pattern. The checker locks onto the
+// frame counter in channel 0 and follows it from then on. A jump in that counter is a gap
+// in the stream once channel 1 of the same frame carries the sample for the new counter as
+// well, so a single corrupted channel 0 word is a bit error rather than two gaps. A sample
+// that doesn't match is a mapping error if it is the expected sample of another channel,
+// otherwise a bit error.
+static void xCheckPatternItem(pvt_data_t *pPvtData, media_q_pub_map_uncmp_audio_info_t *pPubMapUncmpAudioInfo, media_q_item_t *pMediaQItem)
+{
+	U32 bits = xPatternBits(pPvtData);
+	U32 counterBits = xPatternCounterBits(pPvtData, bits);
+	U32 counterMask = (1U << counterBits) - 1;
+	U32 channels = pPubMapUncmpAudioInfo->audioChannels;
+	U32 frameBytes = channels * (bits / 8);
+	U32 frames = pMediaQItem->dataLen / frameBytes;
+	U8 *pData = pMediaQItem->pPubData;
+	U32 frameCnt;
+	U32 channelCnt;
+
+	for (frameCnt = 0; frameCnt < frames; frameCnt++) {
+		U32 word0 = xGetPatternWord(pPvtData, pData, bits);
+		U32 counter = word0 & counterMask;
+
+		if (!pPvtData->checkLocked) {
+			pPvtData->checkNextFrame = counter;
+			pPvtData->checkLocked = TRUE;
+		}
+		else if (counter != pPvtData->checkNextFrame && (word0 >> counterBits) == 0
+			&& (channels == 1 || xGetPatternWord(pPvtData, pData + bits / 8, bits) == xPatternSample(pPvtData, bits, counter, 1))) {
+			pPvtData->checkGaps++;
+			pPvtData->checkLostFrames += (counter - pPvtData->checkNextFrame) & counterMask;
+			pPvtData->checkNextFrame = counter;
+		}
+
+		for (channelCnt = 0; channelCnt < channels; channelCnt++) {
+			U32 word = xGetPatternWord(pPvtData, pData, bits);
+			pData += bits / 8;
+
+			if (word != xPatternSample(pPvtData, bits, pPvtData->checkNextFrame, channelCnt)) {
+				U32 otherCnt;
+				for (otherCnt = 0; otherCnt < channels; otherCnt++) {
+					if (otherCnt != channelCnt && word == xPatternSample(pPvtData, bits, pPvtData->checkNextFrame, otherCnt)) {
+						break;
+					}
+				}
+				if (otherCnt < channels) {
+					pPvtData->checkMapErrors++;
+				}
+				else {
+					pPvtData->checkBitErrors++;
+				}
+			}
+		}
+
+		pPvtData->checkNextFrame = (pPvtData->checkNextFrame + 1) & counterMask;
+		pPvtData->checkFrames++;
+	}
+
+	// How far past its presentation time the item was handed to the interface
+	if (openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime) && !openavbAvtpTimeTimestampIsUncertain(pMediaQItem->pAvtpTime)) {
+		S32 ptUSec = -openavbAvtpTimeUsecDelta(pMediaQItem->pAvtpTime);
+		if (!pPvtData->checkPtCount || ptUSec < pPvtData->checkPtMinUSec) {
+			pPvtData->checkPtMinUSec = ptUSec;
+		}
+		if (!pPvtData->checkPtCount || ptUSec > pPvtData->checkPtMaxUSec) {
+			pPvtData->checkPtMaxUSec = ptUSec;
+		}
+		pPvtData->checkPtAccumUSec += ptUSec;
+		pPvtData->checkPtCount++;
+		if (ptUSec > (S32)pPvtData->checkLateUSec) {
+			pPvtData->checkLate++;
+		}
+	}
+
+	pPvtData->checkItems++;
+}
+
 // A call to this callback indicates that this interface module will be
 // a listener. Any listener initialization can be done in this function.
 void openavbIntfToneGenRxInitCB(media_q_t *pMediaQ) 
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		pPvtData->checkEnabled = FALSE;
+		if (pPvtData->pattern == TONEGEN_PATTERN_TONE) {
+			AVB_LOG_WARNING("Set intf_nv_pattern to check the received stream. Received items are dropped.");
+		}
+		else if (!xPatternBits(pPvtData)) {
+			AVB_LOG_ERROR("Verification patterns need 16, 24 or 32 bit integer or float samples and at most 256 channels at 16 bit. Received items are dropped.");
+		}
+		else {
+			U64 nowNS;
+			CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
+
+			pPvtData->checkEnabled = TRUE;
+			pPvtData->checkLocked = FALSE;
+			pPvtData->checkNextReportNS = nowNS + ((U64)pPvtData->checkReportSec * NANOSECONDS_PER_SECOND);
+			pPvtData->checkItems = 0;
+			pPvtData->checkFrames = 0;
+			pPvtData->checkGaps = 0;
+			pPvtData->checkLostFrames = 0;
+			pPvtData->checkMapErrors = 0;
+			pPvtData->checkBitErrors = 0;
+			pPvtData->checkLate = 0;
+			xCheckResetInterval(pPvtData);
+		}
+	}
+
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
 }
 
@@ -610,6 +961,39 @@ void openavbIntfToneGenRxInitCB(media_q_t *pMediaQ)
 bool openavbIntfToneGenRxCB(media_q_t *pMediaQ) 
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_INTF_DETAIL);
+
+	if (pMediaQ) {
+		bool moreItems = TRUE;
+		media_q_pub_map_uncmp_audio_info_t *pPubMapUncmpAudioInfo = pMediaQ->pPubMapInfo;
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return FALSE;
+		}
+
+		while (moreItems) {
+			media_q_item_t *pMediaQItem = openavbMediaQTailLock(pMediaQ, FALSE);
+			if (pMediaQItem) {
+				if (pPvtData->checkEnabled && pMediaQItem->dataLen) {
+					xCheckPatternItem(pPvtData, pPubMapUncmpAudioInfo, pMediaQItem);
+				}
+				openavbMediaQTailPull(pMediaQ);
+			}
+			else {
+				moreItems = FALSE;
+			}
+		}
+
+		if (pPvtData->checkEnabled && pPvtData->checkReportSec) {
+			U64 nowNS;
+			CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
+			if (nowNS > pPvtData->checkNextReportNS) {
+				xCheckReport(pPvtData);
+				pPvtData->checkNextReportNS += ((U64)pPvtData->checkReportSec * NANOSECONDS_PER_SECOND);
+			}
+		}
+	}
+
 	AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
 	return FALSE;
 }
@@ -619,6 +1003,15 @@ bool openavbIntfToneGenRxCB(media_q_t *pMediaQ)
 void openavbIntfToneGenEndCB(media_q_t *pMediaQ) 
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (pPvtData && pPvtData->checkEnabled) {
+			xCheckReport(pPvtData);
+			pPvtData->checkEnabled = FALSE;
+		}
+	}
+
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
 }
 
@@ -637,20 +1030,13 @@ void openavbIntfToneGenEnableFixedTimestamp(media_q_t *pMediaQ, bool enabled, U3
 
 		pPvtData->fixedTimestampEnabled = enabled;
 		if (pPvtData->fixedTimestampEnabled) {
-			U32 per, rate, rem;
 			/* Ignore passed in transmit interval and use framesPerItem and audioRate so
-			   we work with both AAF and 61883-6 */
-			/* Carefully scale values to avoid U32 overflow or loss of precision */
-			per = MICROSECONDS_PER_SECOND * pPubMapUncmpAudioInfo->framesPerItem * 10;
-			rate = pPvtData->audioRate/100;
-			transmitInterval = per/rate;
-			rem = per % rate;
-			if (rem != 0) {
-				rem *= 10;
-				rem /= rate;
-			}
-			openavbMcsInit(&pPvtData->mcs, transmitInterval, rem, 10);
-			AVB_LOGF_INFO("Fixed timestamping enabled: %d %d/%d", transmitInterval, rem, 10);
+			   we work with both AAF and 61883-6. The period is kept as an exact fraction
+			   and the servo keeps the edges locked to gPTP time. */
+			openavbMcsInit(&pPvtData->mcs, (U64)NANOSECONDS_PER_SECOND * pPubMapUncmpAudioInfo->framesPerItem, pPvtData->audioRate);
+			openavbMcsServoInit(&pPvtData->mcs, 0, 0, 0);
+			AVB_LOGF_INFO("Fixed timestamping enabled: %llu %u/%u ns", (unsigned long long)pPvtData->mcs.nsPerAdvance,
+				pPvtData->mcs.fracPerAdvance, pPvtData->mcs.fracDen);
 		}
 
 		if (batchFactor != 1) {
@@ -700,6 +1086,11 @@ extern bool DLL_EXPORT openavbIntfToneGenInitialize(media_q_t *pMediaQ, openavb_
 		pPvtData->fvChannels = 0;
 
 		pPvtData->fixedTimestampEnabled = false;
+		pPvtData->paceTx = false;
+
+		pPvtData->pattern = TONEGEN_PATTERN_TONE;
+		pPvtData->checkReportSec = 10;
+		pPvtData->checkLateUSec = 1000;
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
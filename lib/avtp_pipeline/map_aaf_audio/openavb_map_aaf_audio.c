@@ -71,6 +71,19 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define HIDX_AVTP_HIDE7_SP			22
 #define SP_M0_BIT					(1 << 4)
 
+// Number of consecutive late packets after which the listener assumes the
+// talker has restarted and resynchronizes to the new sequence numbers.
+#define AAF_MAX_LATE_PACKETS		16
+
+// The per packet routines are written once with the configuration as constant
+// arguments. Forcing them inline lets every specialized callback built from
+// them keep only the code for its configuration.
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define AAF_SPECIALIZE static inline __attribute__ ((always_inline))
+#else
+#define AAF_SPECIALIZE static inline
+#endif
+
 typedef enum {
 	AAF_RATE_UNSPEC = 0,
 	AAF_RATE_8K,
@@ -110,6 +123,10 @@ typedef enum {
 	TS_SPARSE_MODE_ENABLED		= 1
 } avb_audio_sparse_mode_t;
 
+// Converts integer samples of one AAF sample size to another (network byte order).
+// Returns the end of the converted data.
+typedef U8 *(*aaf_convert_fn_t)(U8 *pOut, const U8 *pIn, const U8 *pInEnd);
+
 typedef struct {
 	/////////////
 	// Config data
@@ -133,9 +150,26 @@ typedef struct {
 	// MCR clock recovery interval
 	U32 mcrRecoveryInterval;
 
+	// map_nv_low_latency: Send each media queue item as soon as it is available,
+	// even if it holds fewer frames than a full packet.
+	bool lowLatency;
+
+	// map_nv_loss_concealment: How the listener fills the gap left by lost packets.
+	avb_audio_concealment_t concealment;
+
+	// map_nv_max_conceal_packets: Largest gap (in packets) the listener will conceal.
+	// Larger gaps are treated as a discontinuity.
+	U32 maxConcealPackets;
+
+	// map_nv_rx_slot_mode: Listener places each packet into the media queue item
+	// that matches its presentation time, so out of order packets are kept.
+	bool rxSlotMode;
+
 	/////////////
 	// Variable data
 	/////////////
+	// Slot mode: each item's pPvtMapData is a bitmap of the frames written
+	bool rxSlotFramesAlloc;
 	U32 maxTransitUsec;     // In microseconds
 
 	aaf_nominal_sample_rate_t 	aaf_rate;
@@ -155,6 +189,31 @@ typedef struct {
 
 	bool mediaQItemSyncTS;
 
+	// Callbacks of the stream. The transmit callback is replaced at TX init by
+	// the one specialized for the configuration.
+	openavb_map_cb_t *pMapCB;
+
+	// Talker format info quadlet (network order), built at TX init
+	U32 txFormatInfo;
+
+	// Listener format and packet info quadlets last accepted. Packets carrying
+	// the same quadlets skip the format checks.
+	bool rxFormatLatched;
+	U32 rxFormatInfo;
+	U32 rxPacketInfo;
+	U32 rxPayloadSize;
+	aaf_convert_fn_t rxConvert;
+
+	// Listener packet ordering and loss concealment
+	bool rxSeqValid;
+	U8 rxLastSeq;
+	U32 rxLateCount;
+	bool rxNextTimestampValid;
+	U32 rxNextTimestamp;
+	U32 rxLastSize;
+	U8 *pRxLastData;
+	U8 *pRxConcealData;
+
 } pvt_data_t;
 
 static void x_calculateSizes(media_q_t *pMediaQ)
@@ -294,6 +353,10 @@ static void x_calculateSizes(media_q_t *pMediaQ)
 		}
 
 		// MediaQ item size calculations
+		if (pPvtData->lowLatency && pPvtData->packingFactor != 1) {
+			AVB_LOGF_WARNING("Packing factor %d ignored in low latency mode (must be 1)", pPvtData->packingFactor);
+			pPvtData->packingFactor = 1;
+		}
 		pPubMapInfo->packingFactor = pPvtData->packingFactor;
 		pPubMapInfo->framesPerItem = pPubMapInfo->framesPerPacket * pPvtData->packingFactor;
 		pPubMapInfo->itemFrameSizeBytes = pPubMapInfo->itemSampleSizeBytes * pPubMapInfo->audioChannels;
@@ -347,6 +410,34 @@ void openavbMapAVTPAudioCfgCB(media_q_t *pMediaQ, const char *name, const char *
 				pPvtData->sparseMode = TS_SPARSE_MODE_DISABLED;
 			}
 		}
+		else if (strcmp(name, "map_nv_low_latency") == 0) {
+			char *pEnd;
+			U32 tmp;
+			tmp = strtol(value, &pEnd, 10);
+			if (*pEnd == '\0' && (tmp == 0 || tmp == 1)) {
+				pPvtData->lowLatency = (tmp == 1);
+			}
+		}
+		else if (strcmp(name, "map_nv_loss_concealment") == 0) {
+			char *pEnd;
+			U32 tmp;
+			tmp = strtol(value, &pEnd, 10);
+			if (*pEnd == '\0' && tmp <= AVB_AUDIO_CONCEAL_INTERPOLATE) {
+				pPvtData->concealment = (avb_audio_concealment_t)tmp;
+			}
+		}
+		else if (strcmp(name, "map_nv_max_conceal_packets") == 0) {
+			char *pEnd;
+			pPvtData->maxConcealPackets = strtol(value, &pEnd, 10);
+		}
+		else if (strcmp(name, "map_nv_rx_slot_mode") == 0) {
+			char *pEnd;
+			U32 tmp;
+			tmp = strtol(value, &pEnd, 10);
+			if (*pEnd == '\0' && (tmp == 0 || tmp == 1)) {
+				pPvtData->rxSlotMode = (tmp == 1);
+			}
+		}
 		else if (strcmp(name, "map_nv_audio_mcr") == 0) {
 			char *pEnd;
 			pPvtData->audioMcr = (avb_audio_mcr_t)strtol(value, &pEnd, 10);
@@ -442,25 +533,9 @@ void openavbMapAVTPAudioGenInitCB(media_q_t *pMediaQ)
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
-// A call to this callback indicates that this mapping module will be
-// a talker. Any talker initialization can be done in this function.
-void openavbMapAVTPAudioTxInitCB(media_q_t *pMediaQ)
-{
-	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
-	if (pMediaQ) {
-		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
-		if (pPvtData) {
-			pPvtData->isTalker = TRUE;
-		}
-	}
-	AVB_TRACE_EXIT(AVB_TRACE_MAP);
-}
-
-// CORE_TODO: This callback should be updated to work in a similar way the uncompressed audio mapping. With allowing AVTP packets to be built
-//  from multiple media queue items. This allows interface to set into the media queue blocks of audio frames to properly correspond to
-//  a SYT_INTERVAL. Additionally the public data member sytInterval needs to be set in the same way the uncompressed audio mapping does.
-// This talker callback will be called for each AVB observation interval.
-tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
+// Build the packet for the next interval. lowLatency and sparseMode are
+// constants in the specialized callbacks below.
+AAF_SPECIALIZE tx_cb_ret_t x_txPacket(media_q_t *pMediaQ, U8 *pData, U32 *dataLen, const bool lowLatency, const bool sparseMode)
 {
 	media_q_item_t *pMediaQItem = NULL;
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP_DETAIL);
@@ -479,24 +554,24 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 
 	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
 
-	U32 bytesNeeded = pPubMapInfo->itemFrameSizeBytes * pPubMapInfo->framesPerPacket;
-	if (!openavbMediaQIsAvailableBytes(pMediaQ, pPubMapInfo->itemFrameSizeBytes * pPubMapInfo->framesPerPacket, TRUE)) {
-		AVB_LOG_VERBOSE("Not enough bytes are ready");
+	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+	if (!pPvtData) {
+		AVB_LOG_ERROR("Private mapping module data not allocated.");
 		AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
 		return TX_CB_RET_PACKET_NOT_READY;
 	}
 
-	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
-	if (!pPvtData) {
-		AVB_LOG_ERROR("Private mapping module data not allocated.");
-		openavbMediaQTailUnlock(pMediaQ);
+	// In low latency mode a packet is sent as soon as a single frame is available.
+	U32 bytesNeeded = pPubMapInfo->itemFrameSizeBytes * pPubMapInfo->framesPerPacket;
+	U32 bytesRequired = lowLatency ? pPubMapInfo->itemFrameSizeBytes : bytesNeeded;
+	if (!openavbMediaQIsAvailableBytes(pMediaQ, bytesRequired, TRUE)) {
+		AVB_LOG_VERBOSE("Not enough bytes are ready");
 		AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
 		return TX_CB_RET_PACKET_NOT_READY;
 	}
 
 	if ((*dataLen - TOTAL_HEADER_SIZE) < pPvtData->payloadSize) {
 		AVB_LOG_ERROR("Not enough room in packet for payload");
-		openavbMediaQTailUnlock(pMediaQ);
 		AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
 		return TX_CB_RET_PACKET_NOT_READY;
 	}
@@ -511,9 +586,20 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 		pMediaQItem = openavbMediaQTailLock(pMediaQ, TRUE);
 		if (pMediaQItem && pMediaQItem->pPubData && pMediaQItem->dataLen > 0) {
 
+			U32 payloadSize = pPvtData->payloadSize;
+			if (lowLatency) {
+				// Send whatever whole frames the item holds, up to a full packet.
+				U32 bytesAvail = pMediaQItem->dataLen - pMediaQItem->readIdx;
+				bytesAvail -= bytesAvail % pPubMapInfo->itemFrameSizeBytes;
+				if (bytesAvail < payloadSize) {
+					payloadSize = bytesAvail;
+				}
+				bytesNeeded = payloadSize;
+			}
+
 			// timestamp set in the interface module, here just validate
 			// In sparse mode, the timestamp valid flag should be set every eighth AAF AVPTDU.
-			if (pPvtData->sparseMode == TS_SPARSE_MODE_ENABLED && (pHdrV0[HIDX_AVTP_SEQ_NUM] & 0x07) != 0) {
+			if (sparseMode && (pHdrV0[HIDX_AVTP_SEQ_NUM] & 0x07) != 0) {
 				// Skip over this timestamp, as using sparse mode.
 				pHdrV0[HIDX_AVTP_HIDE7_TV1] &= ~0x01;
 				pHdrV0[HIDX_AVTP_HIDE7_TU1] &= ~0x01;
@@ -527,43 +613,45 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 				*pHdr++ = 0; // Clear the timestamp field
 			}
 			else {
+				// The item timestamp is for its first frame. Offset it to the first frame of this packet
+				// so every packet carries an exact timestamp, not just the first one from each item.
+				avtp_time_t pktTime = *pMediaQItem->pAvtpTime;
+				if (pMediaQItem->readIdx > 0) {
+					U64 frameOffset = pMediaQItem->readIdx / pPubMapInfo->itemFrameSizeBytes;
+					openavbAvtpTimeAddNSec(&pktTime, (frameOffset * NANOSECONDS_PER_SECOND) / pPubMapInfo->audioRate);
+				}
+
 				// Add the max transit time.
-				openavbAvtpTimeAddUSec(pMediaQItem->pAvtpTime, pPvtData->maxTransitUsec);
+				openavbAvtpTimeAddUSec(&pktTime, pPvtData->maxTransitUsec);
 
 				// Set timestamp valid flag
 				pHdrV0[HIDX_AVTP_HIDE7_TV1] |= 0x01;
 
 				// Set (clear) timestamp uncertain flag
-				if (openavbAvtpTimeTimestampIsUncertain(pMediaQItem->pAvtpTime))
+				if (openavbAvtpTimeTimestampIsUncertain(&pktTime))
 					pHdrV0[HIDX_AVTP_HIDE7_TU1] |= 0x01;
 				else pHdrV0[HIDX_AVTP_HIDE7_TU1] &= ~0x01;
 
 				// - 4 bytes	avtp_timestamp
-				*pHdr++ = htonl(openavbAvtpTimeGetAvtpTimestamp(pMediaQItem->pAvtpTime));
-
-				openavbAvtpTimeSetTimestampValid(pMediaQItem->pAvtpTime, FALSE);
+				*pHdr++ = htonl(openavbAvtpTimeGetAvtpTimestamp(&pktTime));
 			}
 
 			// - 4 bytes	format info (format, sample rate, channels per frame, bit depth)
-			tmp32 = pPvtData->aaf_format << 24;
-			tmp32 |= pPvtData->aaf_rate  << 20;
-			tmp32 |= pPubMapInfo->audioChannels << 8;
-			tmp32 |= pPvtData->aaf_bit_depth;
-			*pHdr++ = htonl(tmp32);
+			*pHdr++ = pPvtData->txFormatInfo;
 
 			// - 4 bytes	packet info (data length, evt field)
-			tmp32 = pPvtData->payloadSize << 16;
+			tmp32 = payloadSize << 16;
 			tmp32 |= pPvtData->aaf_event_field << 8;
 			*pHdr++ = htonl(tmp32);
 
 			// Set (clear) sparse mode flag
-			if (pPvtData->sparseMode == TS_SPARSE_MODE_ENABLED) {
+			if (sparseMode) {
 				pHdrV0[HIDX_AVTP_HIDE7_SP] |= SP_M0_BIT;
 			} else {
 				pHdrV0[HIDX_AVTP_HIDE7_SP] &= ~SP_M0_BIT;
 			}
 
-			if ((pMediaQItem->dataLen - pMediaQItem->readIdx) < pPvtData->payloadSize) {
+			if (payloadSize == 0 || (pMediaQItem->dataLen - pMediaQItem->readIdx) < payloadSize) {
 				// This should not happen so we will just toss it away.
 				AVB_LOG_ERROR("Not enough data in media queue item for packet");
 				openavbMediaQTailPull(pMediaQ);
@@ -571,10 +659,10 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 				return TX_CB_RET_PACKET_NOT_READY;
 			}
 
-			memcpy(pPayload, (uint8_t *)pMediaQItem->pPubData + pMediaQItem->readIdx, pPvtData->payloadSize);
-			bytesProcessed += pPvtData->payloadSize;
+			memcpy(pPayload, (uint8_t *)pMediaQItem->pPubData + pMediaQItem->readIdx, payloadSize);
+			bytesProcessed += payloadSize;
 
-			pMediaQItem->readIdx += pPvtData->payloadSize;
+			pMediaQItem->readIdx += payloadSize;
 			if (pMediaQItem->readIdx >= pMediaQItem->dataLen) {
 				// Finished reading the entire item
 				openavbMediaQTailPull(pMediaQ);
@@ -596,18 +684,77 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 	return TX_CB_RET_PACKET_READY;
 }
 
+#define AAF_TX_CB(name, lowLatency, sparseMode) \
+static tx_cb_ret_t name(media_q_t *pMediaQ, U8 *pData, U32 *dataLen) \
+{ \
+	return x_txPacket(pMediaQ, pData, dataLen, lowLatency, sparseMode); \
+}
+
+AAF_TX_CB(x_txCB, FALSE, FALSE)
+AAF_TX_CB(x_txCBSparse, FALSE, TRUE)
+AAF_TX_CB(x_txCBLowLatency, TRUE, FALSE)
+AAF_TX_CB(x_txCBLowLatencySparse, TRUE, TRUE)
+
+// A call to this callback indicates that this mapping module will be
+// a talker. Any talker initialization can be done in this function.
+void openavbMapAVTPAudioTxInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	if (pMediaQ) {
+		media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (pPvtData) {
+			pPvtData->isTalker = TRUE;
+
+			U32 tmp32 = pPvtData->aaf_format << 24;
+			tmp32 |= pPvtData->aaf_rate  << 20;
+			tmp32 |= pPubMapInfo->audioChannels << 8;
+			tmp32 |= pPvtData->aaf_bit_depth;
+			pPvtData->txFormatInfo = htonl(tmp32);
+
+			// Select the transmit callback for this configuration
+			static const openavb_map_tx_cb_t txCBs[2][2] = {
+				{ x_txCB, x_txCBSparse },
+				{ x_txCBLowLatency, x_txCBLowLatencySparse },
+			};
+			pPvtData->pMapCB->map_tx_cb =
+				txCBs[pPvtData->lowLatency ? 1 : 0][pPvtData->sparseMode == TS_SPARSE_MODE_ENABLED ? 1 : 0];
+		}
+	}
+	AVB_TRACE_EXIT(AVB_TRACE_MAP);
+}
+
+// CORE_TODO: This callback should be updated to work in a similar way the uncompressed audio mapping. With allowing AVTP packets to be built
+//  from multiple media queue items. This allows interface to set into the media queue blocks of audio frames to properly correspond to
+//  a SYT_INTERVAL. Additionally the public data member sytInterval needs to be set in the same way the uncompressed audio mapping does.
+// This talker callback will be called for each AVB observation interval.
+tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
+{
+	pvt_data_t *pPvtData = pMediaQ ? pMediaQ->pPvtMapInfo : NULL;
+	if (!pPvtData) {
+		AVB_LOG_ERROR("Private mapping module data not allocated.");
+		return TX_CB_RET_PACKET_NOT_READY;
+	}
+
+	// Generic version, TX init normally replaces it with a specialized callback.
+	return x_txPacket(pMediaQ, pData, dataLen, pPvtData->lowLatency, pPvtData->sparseMode == TS_SPARSE_MODE_ENABLED);
+}
+
 // A call to this callback indicates that this mapping module will be
 // a listener. Any listener initialization can be done in this function.
 void openavbMapAVTPAudioRxInitCB(media_q_t *pMediaQ)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
 	if (pMediaQ) {
+		media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
 		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
 		if (!pPvtData) {
 			AVB_LOG_ERROR("Private mapping module data not allocated.");
 			return;
 		}
 		pPvtData->isTalker = FALSE;
+		pPvtData->rxFormatLatched = FALSE;
+		pPvtData->rxConvert = NULL;
 		if (pPvtData->audioMcr != AVB_MCR_NONE) {
 			HAL_INIT_MCR_V2(pPvtData->txInterval, pPvtData->packingFactor, pPvtData->mcrTimestampInterval, pPvtData->mcrRecoveryInterval);
 		}
@@ -635,101 +782,489 @@ void openavbMapAVTPAudioRxInitCB(media_q_t *pMediaQ)
 				AVB_LOGF_WARNING("Wrong packing factor value set (%d) for sparse timestamping mode", pPvtData->packingFactor);
 			}
 		}
+
+		if (pPvtData->rxSlotMode) {
+			if (pPvtData->sparseMode == TS_SPARSE_MODE_ENABLED) {
+				AVB_LOG_WARNING("Slot mode needs a timestamp in every packet; packets without one will be dropped");
+			}
+			if (!openavbMediaQSlotModeOn(pMediaQ,
+					(U64)pPubMapInfo->framesPerItem * NANOSECONDS_PER_SECOND, pPubMapInfo->audioRate)) {
+				AVB_LOG_ERROR("Unable to enable media queue slot mode");
+				pPvtData->rxSlotMode = FALSE;
+			}
+			else if (!pPvtData->rxSlotFramesAlloc) {
+				if (openavbMediaQAllocItemMapData(pMediaQ, 0, ((pPubMapInfo->framesPerItem + 31) / 32) * sizeof(U32))) {
+					pPvtData->rxSlotFramesAlloc = TRUE;
+				}
+				else {
+					AVB_LOG_ERROR("Unable to allocate slot frame tracking");
+					pPvtData->rxSlotMode = FALSE;
+				}
+			}
+		}
+
+		pPvtData->rxSeqValid = FALSE;
+		pPvtData->rxLateCount = 0;
+		pPvtData->rxNextTimestampValid = FALSE;
+		pPvtData->rxLastSize = 0;
+		if (pPvtData->concealment != AVB_AUDIO_CONCEAL_NONE) {
+			if (!pPvtData->pRxLastData) {
+				pPvtData->pRxLastData = calloc(1, pPvtData->payloadSize);
+			}
+			if (!pPvtData->pRxConcealData) {
+				pPvtData->pRxConcealData = calloc(1, pPvtData->payloadSize);
+			}
+			if (!pPvtData->pRxLastData || !pPvtData->pRxConcealData) {
+				AVB_LOG_ERROR("Unable to allocate loss concealment buffers; concealment disabled");
+				pPvtData->concealment = AVB_AUDIO_CONCEAL_NONE;
+			}
+		}
 	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
-// This callback occurs when running as a listener and data is available.
-bool openavbMapAVTPAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
+// Write one packet worth of listener format data to the media queue head.
+// The data is translated in place for the interface. Returns FALSE if the media queue is full.
+static bool x_rxWriteMediaQ(media_q_t *pMediaQ, U8 *pData, U32 dataLen, bool tsValid, U32 timestamp, bool tsUncertain)
 {
-	AVB_TRACE_ENTRY(AVB_TRACE_MAP_DETAIL);
-	if (pMediaQ && pData) {
-		U8 *pHdrV0 = pData;
-		U32 *pHdr = (U32 *)(pData + AVTP_V0_HEADER_SIZE);
-		U8  *pPayload = pData + TOTAL_HEADER_SIZE;
-		media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
-		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
-		if (!pPvtData) {
-			AVB_LOG_ERROR("Private mapping module data not allocated.");
-			return FALSE;
-		}
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
 
-		aaf_sample_format_t incoming_aaf_format;
-		U8 incoming_bit_depth;
-		int tmp;
-		bool dataValid = TRUE;
-		bool dataConversionEnabled = FALSE;
+	// Get item pointer in media queue
+	media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+	if (!pMediaQItem) {
+		IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("Media queue full");
+		return FALSE;
+	}
 
-		U32 timestamp = ntohl(*pHdr++);
-		U32 format_info = ntohl(*pHdr++);
-		U32 packet_info = ntohl(*pHdr++);
+	bool dataValid = TRUE;
 
-		bool listenerSparseMode = (pPvtData->sparseMode == TS_SPARSE_MODE_ENABLED) ? TRUE : FALSE;
-		bool streamSparseMode = (pHdrV0[HIDX_AVTP_HIDE7_SP] & SP_M0_BIT) ? TRUE : FALSE;
-		U16 payloadLen = ntohs(*(U16 *)(&pHdrV0[HIDX_STREAM_DATA_LEN16]));
+	// set timestamp if first data written to item
+	if (pMediaQItem->dataLen == 0) {
 
-		if (payloadLen > dataLen - TOTAL_HEADER_SIZE) {
-			if (pPvtData->dataValid)
-				AVB_LOGF_ERROR("header data len %d > actual data len %d",
-					       payloadLen, dataLen - TOTAL_HEADER_SIZE);
+		// Set timestamp valid flag
+		openavbAvtpTimeSetTimestampValid(pMediaQItem->pAvtpTime, tsValid);
+
+		if (openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime)) {
+			// Get the timestamp and place it in the media queue item.
+			openavbAvtpTimeSetToTimestamp(pMediaQItem->pAvtpTime, timestamp);
+
+			openavbAvtpTimeSubUSec(pMediaQItem->pAvtpTime, pPubMapInfo->presentationLatencyUSec);
+
+			// Set timestamp uncertain flag
+			openavbAvtpTimeSetTimestampUncertain(pMediaQItem->pAvtpTime, tsUncertain);
+			// Set flag to inform that MediaQ is synchronized with timestamped packets
+			 pPvtData->mediaQItemSyncTS = TRUE;
+		}
+		else if (!pPvtData->mediaQItemSyncTS) {
+			//we need packet with valid TS for first data written to item
+			AVB_LOG_DEBUG("Timestamp not valid for MediaQItem - initial packets dropped");
+			IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("Timestamp not valid for MediaQItem - initial packets dropped");
 			dataValid = FALSE;
 		}
+	}
+	if (dataValid) {
+		if (pPubMapInfo->intf_rx_translate_cb) {
+			pPubMapInfo->intf_rx_translate_cb(pMediaQ, pData, dataLen);
+		}
+
+		memcpy((uint8_t *)pMediaQItem->pPubData + pMediaQItem->dataLen, pData, dataLen);
+		pMediaQItem->dataLen += dataLen;
+	}
+
+	if (pMediaQItem->dataLen < pMediaQItem->itemSize
+			&& !(pPvtData->lowLatency && pMediaQItem->dataLen > 0)) {
+		// More data can be written to the item
+		openavbMediaQHeadUnlock(pMediaQ);
+	}
+	else {
+		// The item is full (or holds a low latency packet) push it.
+		openavbMediaQHeadPush(pMediaQ);
+	}
+	return TRUE;
+}
+
+// Write frames into a locked slot at the given byte offset and unlock it.
+static void x_rxWriteSlotItem(media_q_t *pMediaQ, media_q_item_t *pMediaQItem, U32 offset, U8 *pData, U32 dataLen)
+{
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+
+	if (pPubMapInfo->intf_rx_translate_cb) {
+		pPubMapInfo->intf_rx_translate_cb(pMediaQ, pData, dataLen);
+	}
+
+	// Only frames not written yet count, so a duplicate packet neither adds
+	// to dataLen nor completes a slot that is still missing other frames.
+	U32 *pFilled = pMediaQItem->pPvtMapData;
+	U32 frameSize = pPubMapInfo->itemFrameSizeBytes;
+	U32 frame = offset / frameSize;
+	U32 frames = dataLen / frameSize;
+	U32 i1, newFrames = 0;
+	if (pMediaQItem->dataLen == 0) {
+		// First write since the slot was recycled
+		memset(pFilled, 0, ((pPubMapInfo->framesPerItem + 31) / 32) * sizeof(U32));
+	}
+	for (i1 = frame; i1 < frame + frames; i1++) {
+		if (!(pFilled[i1 / 32] & (1u << (i1 % 32)))) {
+			newFrames++;
+		}
+	}
+	if (newFrames == frames) {
+		memcpy((U8 *)pMediaQItem->pPubData + offset, pData, frames * frameSize);
+	}
+	else if (newFrames) {
+		for (i1 = 0; i1 < frames; i1++) {
+			if (!(pFilled[(frame + i1) / 32] & (1u << ((frame + i1) % 32)))) {
+				memcpy((U8 *)pMediaQItem->pPubData + offset + i1 * frameSize, pData + i1 * frameSize, frameSize);
+			}
+		}
+	}
+	else {
+		IF_LOG_INTERVAL(1000) AVB_LOG_WARNING("Duplicate packet dropped");
+	}
+	for (i1 = frame; i1 < frame + frames; i1++) {
+		pFilled[i1 / 32] |= 1u << (i1 % 32);
+	}
+	pMediaQItem->dataLen += newFrames * frameSize;
+
+	openavbMediaQSlotUnlock(pMediaQ, pMediaQItem, pMediaQItem->dataLen >= pPubMapInfo->framesPerItem * frameSize);
+}
+
+// Place a packet into the media queue slot that matches its presentation time.
+// Missing data is left as silence by the media queue. A packet that runs past the
+// end of its slot continues at the start of the next slot.
+static void x_rxWriteSlot(media_q_t *pMediaQ, U8 *pData, U32 dataLen, bool tsValid, U32 timestamp)
+{
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+
+	if (!tsValid) {
+		IF_LOG_INTERVAL(1000) AVB_LOG_WARNING("Packet without valid timestamp dropped in slot mode");
+		return;
+	}
+
+	avtp_time_t presentationTime;
+	memset(&presentationTime, 0, sizeof(presentationTime));
+	openavbAvtpTimeSetToTimestamp(&presentationTime, timestamp);
+	openavbAvtpTimeSubUSec(&presentationTime, pPubMapInfo->presentationLatencyUSec);
+	U64 presentationNsec = openavbAvtpTimeGetAvtpTimeNS(&presentationTime);
+	U32 frameSize = pPubMapInfo->itemFrameSizeBytes;
+
+	// A packet is never longer than an item, so it spans at most two slots. The second
+	// is found from the last frame when the first slot has already been filled.
+	U64 tailNsec = presentationNsec
+		+ ((U64)(dataLen / frameSize - 1) * NANOSECONDS_PER_SECOND) / pPubMapInfo->audioRate;
+
+	media_q_item_t *pMediaQItem = openavbMediaQSlotLock(pMediaQ, presentationNsec);
+	if (pMediaQItem) {
+		// Frame position of the packet within the slot
+		U64 slotNsec = openavbAvtpTimeGetAvtpTimeNS(pMediaQItem->pAvtpTime);
+		U32 offset = 0;
+		if (presentationNsec > slotNsec) {
+			U64 frames = ((presentationNsec - slotNsec) * pPubMapInfo->audioRate + NANOSECONDS_PER_SECOND / 2) / NANOSECONDS_PER_SECOND;
+			offset = frames * frameSize;
+		}
+		U32 writeLen = 0;
+		if (offset < pMediaQItem->itemSize) {
+			writeLen = (offset + dataLen > pMediaQItem->itemSize) ? pMediaQItem->itemSize - offset : dataLen;
+			x_rxWriteSlotItem(pMediaQ, pMediaQItem, offset, pData, writeLen);
+		}
+		else {
+			openavbMediaQSlotUnlock(pMediaQ, pMediaQItem, pMediaQItem->dataLen >= pPubMapInfo->framesPerItem * frameSize);
+		}
+		if (writeLen == dataLen) {
+			return;
+		}
+		// The rest starts where this slot ends.
+		tailNsec = slotNsec + ((U64)pPubMapInfo->framesPerItem * NANOSECONDS_PER_SECOND) / pPubMapInfo->audioRate;
+	}
 
-		if ((incoming_aaf_format = (aaf_sample_format_t) ((format_info >> 24) & 0xFF)) != pPvtData->aaf_format) {
-			// Check if we can convert the incoming data.
-			if (incoming_aaf_format >= AAF_FORMAT_INT_32 && incoming_aaf_format <= AAF_FORMAT_INT_16 &&
-					pPvtData->aaf_format >= AAF_FORMAT_INT_32 && pPvtData->aaf_format <= AAF_FORMAT_INT_16) {
-				// Integer conversion should be supported.
-				dataConversionEnabled = TRUE;
+	media_q_item_t *pTailItem = openavbMediaQSlotLock(pMediaQ, tailNsec);
+	if (!pTailItem) {
+		if (!pMediaQItem) {
+			IF_LOG_INTERVAL(1000) AVB_LOG_WARNING("Late, duplicate or early packet dropped");
+		}
+		return;
+	}
+	U64 tailSlotNsec = openavbAvtpTimeGetAvtpTimeNS(pTailItem->pAvtpTime);
+	U32 skip = 0;
+	if (tailSlotNsec > presentationNsec) {
+		U64 frames = ((tailSlotNsec - presentationNsec) * pPubMapInfo->audioRate + NANOSECONDS_PER_SECOND / 2) / NANOSECONDS_PER_SECOND;
+		skip = frames * frameSize;
+	}
+	if (skip == 0 || skip >= dataLen) {
+		// Same slot as the start of the packet, which couldn't be written
+		openavbMediaQSlotUnlock(pMediaQ, pTailItem, pTailItem->dataLen >= pPubMapInfo->framesPerItem * frameSize);
+		return;
+	}
+	x_rxWriteSlotItem(pMediaQ, pTailItem, 0, pData + skip, dataLen - skip);
+}
+
+// Move the expected timestamp of the next packet past dataLen bytes of frames.
+static void x_rxAdvanceTimestamp(media_q_t *pMediaQ, U32 dataLen)
+{
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+
+	if (pPvtData->rxNextTimestampValid) {
+		U64 frames = dataLen / pPubMapInfo->packetFrameSizeBytes;
+		pPvtData->rxNextTimestamp += (U32)((frames * NANOSECONDS_PER_SECOND) / pPubMapInfo->audioRate);
+	}
+}
+
+// Sample access for interpolation. Samples are in AAF (network) byte order.
+static double x_getSample(const U8 *pSample, aaf_sample_format_t format)
+{
+	switch (format) {
+		case AAF_FORMAT_FLOAT_32:
+			{
+				U32 raw = ntohl(*(U32 *)pSample);
+				float value;
+				memcpy(&value, &raw, sizeof(value));
+				return value;
 			}
-			else {
-				if (pPvtData->dataValid)
-					AVB_LOGF_ERROR("Listener format %d doesn't match received data (%d)",
-						pPvtData->aaf_format, incoming_aaf_format);
-				dataValid = FALSE;
+		case AAF_FORMAT_INT_32:
+			return (S32)ntohl(*(U32 *)pSample);
+		case AAF_FORMAT_INT_24:
+			return (S32)(((U32)pSample[0] << 24) | ((U32)pSample[1] << 16) | ((U32)pSample[2] << 8)) >> 8;
+		case AAF_FORMAT_INT_16:
+			return (S16)ntohs(*(U16 *)pSample);
+		default:
+			return 0;
+	}
+}
+
+static void x_putSample(U8 *pSample, aaf_sample_format_t format, double value)
+{
+	switch (format) {
+		case AAF_FORMAT_FLOAT_32:
+			{
+				float fValue = (float)value;
+				U32 raw;
+				memcpy(&raw, &fValue, sizeof(raw));
+				*(U32 *)pSample = htonl(raw);
 			}
+			break;
+		case AAF_FORMAT_INT_32:
+			*(U32 *)pSample = htonl((U32)(S32)value);
+			break;
+		case AAF_FORMAT_INT_24:
+			{
+				S32 iValue = (S32)value;
+				pSample[0] = (iValue >> 16) & 0xFF;
+				pSample[1] = (iValue >> 8) & 0xFF;
+				pSample[2] = iValue & 0xFF;
+			}
+			break;
+		case AAF_FORMAT_INT_16:
+			*(U16 *)pSample = htons((U16)(S16)value);
+			break;
+		default:
+			break;
+	}
+}
+
+// Fill the media queue for lostPackets packets missing just before pNextData.
+// Work is bounded by map_nv_max_conceal_packets. Returns FALSE if the media queue is full.
+static bool x_rxConceal(media_q_t *pMediaQ, U32 lostPackets, const U8 *pNextData)
+{
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+
+	U32 frameSize = pPubMapInfo->packetFrameSizeBytes;
+	U32 sampleSize = pPubMapInfo->packetSampleSizeBytes;
+	U32 packetSize = pPvtData->rxLastSize;
+	U32 framesPerPacket = packetSize / frameSize;
+	U32 totalFrames = lostPackets * framesPerPacket;
+	const U8 *pPrevFrame = pPvtData->pRxLastData + packetSize - frameSize;
+	U32 packet;
+
+	IF_LOG_INTERVAL(1000) AVB_LOGF_INFO("Concealing %u lost packets", lostPackets);
+
+	for (packet = 0; packet < lostPackets; packet++) {
+		U8 *pOut = pPvtData->pRxConcealData;
+
+		switch (pPvtData->concealment) {
+			case AVB_AUDIO_CONCEAL_REPEAT:
+				memcpy(pOut, pPvtData->pRxLastData, packetSize);
+				break;
+			case AVB_AUDIO_CONCEAL_INTERPOLATE:
+				{
+					// Linear ramp from the last frame received to the first frame after the gap.
+					U32 frame, channel;
+					for (frame = 0; frame < framesPerPacket; frame++) {
+						double position = (double)(packet * framesPerPacket + frame + 1) / (totalFrames + 1);
+						for (channel = 0; channel < pPubMapInfo->audioChannels; channel++) {
+							double prev = x_getSample(pPrevFrame + channel * sampleSize, pPvtData->aaf_format);
+							double next = x_getSample(pNextData + channel * sampleSize, pPvtData->aaf_format);
+							x_putSample(pOut, pPvtData->aaf_format, prev + (next - prev) * position);
+							pOut += sampleSize;
+						}
+					}
+				}
+				break;
+			case AVB_AUDIO_CONCEAL_SILENCE:
+			default:
+				// Zero is silence for both the integer and float formats.
+				memset(pOut, 0, packetSize);
+				break;
 		}
-		if ((tmp = ((format_info >> 20) & 0x0F)) != pPvtData->aaf_rate) {
-			if (pPvtData->dataValid)
-				AVB_LOGF_ERROR("Listener sample rate (%d) doesn't match received data (%d)",
-					pPvtData->aaf_rate, tmp);
-			dataValid = FALSE;
+
+		if (!x_rxWriteMediaQ(pMediaQ, pPvtData->pRxConcealData, packetSize,
+				pPvtData->rxNextTimestampValid, pPvtData->rxNextTimestamp, FALSE)) {
+			return FALSE;
+		}
+		x_rxAdvanceTimestamp(pMediaQ, packetSize);
+	}
+
+	return TRUE;
+}
+
+// Integer sample conversion between the received and the configured AAF format.
+// Samples are big endian, so padding appends zero bytes (Clause 7.3.4) and
+// truncation drops the least significant bytes.
+#define AAF_CONVERT_FN(IN, OUT) \
+static U8 *x_convert##IN##to##OUT(U8 *pOut, const U8 *pIn, const U8 *pInEnd) \
+{ \
+	while (pIn < pInEnd) { \
+		int i; \
+		for (i = 0; i < (IN < OUT ? IN : OUT); ++i) { \
+			*pOut++ = *pIn++; \
+		} \
+		for ( ; i < OUT; ++i) { \
+			*pOut++ = 0; \
+		} \
+		pIn += (IN > OUT ? IN - OUT : 0); \
+	} \
+	return pOut; \
+}
+AAF_CONVERT_FN(2, 3)
+AAF_CONVERT_FN(2, 4)
+AAF_CONVERT_FN(3, 2)
+AAF_CONVERT_FN(3, 4)
+AAF_CONVERT_FN(4, 2)
+AAF_CONVERT_FN(4, 3)
+
+// Indexed by [received bytes per sample - 2][configured bytes per sample - 2]
+static const aaf_convert_fn_t x_convertFns[3][3] = {
+	{ NULL,            x_convert2to3,  x_convert2to4 },
+	{ x_convert3to2,   NULL,           x_convert3to4 },
+	{ x_convert4to2,   x_convert4to3,  NULL },
+};
+
+// Check the format and packet info quadlets of a received packet against the
+// listener configuration. A valid format is latched, so following packets of the
+// same stream only need to compare the two quadlets.
+static bool x_rxCheckFormat(media_q_t *pMediaQ, U32 format_info, U32 packet_info)
+{
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+	aaf_sample_format_t incoming_aaf_format;
+	U8 incoming_bit_depth;
+	int tmp;
+	bool dataValid = TRUE;
+	bool dataConversionEnabled = FALSE;
+
+	pPvtData->rxFormatLatched = FALSE;
+	pPvtData->rxConvert = NULL;
+
+	if ((incoming_aaf_format = (aaf_sample_format_t) ((format_info >> 24) & 0xFF)) != pPvtData->aaf_format) {
+		// Check if we can convert the incoming data.
+		if (incoming_aaf_format >= AAF_FORMAT_INT_32 && incoming_aaf_format <= AAF_FORMAT_INT_16 &&
+				pPvtData->aaf_format >= AAF_FORMAT_INT_32 && pPvtData->aaf_format <= AAF_FORMAT_INT_16) {
+			// Integer conversion should be supported.
+			dataConversionEnabled = TRUE;
 		}
-		if ((tmp = ((format_info >> 8) & 0x3FF)) != pPubMapInfo->audioChannels) {
+		else {
 			if (pPvtData->dataValid)
-				AVB_LOGF_ERROR("Listener channel count (%d) doesn't match received data (%d)",
-					pPubMapInfo->audioChannels, tmp);
+				AVB_LOGF_ERROR("Listener format %d doesn't match received data (%d)",
+					pPvtData->aaf_format, incoming_aaf_format);
 			dataValid = FALSE;
 		}
-		if ((incoming_bit_depth = (U8) (format_info & 0xFF)) == 0) {
+	}
+	if ((tmp = ((format_info >> 20) & 0x0F)) != pPvtData->aaf_rate) {
+		if (pPvtData->dataValid)
+			AVB_LOGF_ERROR("Listener sample rate (%d) doesn't match received data (%d)",
+				pPvtData->aaf_rate, tmp);
+		dataValid = FALSE;
+	}
+	if ((tmp = ((format_info >> 8) & 0x3FF)) != pPubMapInfo->audioChannels) {
+		if (pPvtData->dataValid)
+			AVB_LOGF_ERROR("Listener channel count (%d) doesn't match received data (%d)",
+				pPubMapInfo->audioChannels, tmp);
+		dataValid = FALSE;
+	}
+	if ((incoming_bit_depth = (U8) (format_info & 0xFF)) == 0) {
+		if (pPvtData->dataValid)
+			AVB_LOGF_ERROR("Listener bit depth (%d) not valid",
+				incoming_bit_depth);
+		dataValid = FALSE;
+	}
+	U32 rxPayloadSize = pPvtData->payloadSize;
+	if ((tmp = ((packet_info >> 16) & 0xFFFF)) != pPvtData->payloadSize) {
+		if (pPvtData->lowLatency && !dataConversionEnabled
+				&& tmp > 0 && tmp < pPvtData->payloadSize && (tmp % pPubMapInfo->packetFrameSizeBytes) == 0) {
+			// Low latency talkers may send packets holding less than a full packet of frames.
+			rxPayloadSize = tmp;
+		}
+		else if (!dataConversionEnabled) {
 			if (pPvtData->dataValid)
-				AVB_LOGF_ERROR("Listener bit depth (%d) not valid",
-					incoming_bit_depth);
+				AVB_LOGF_ERROR("Listener payload size (%d) doesn't match received data (%d)",
+					pPvtData->payloadSize, tmp);
 			dataValid = FALSE;
 		}
-		if ((tmp = ((packet_info >> 16) & 0xFFFF)) != pPvtData->payloadSize) {
-			if (!dataConversionEnabled) {
+		else {
+			int nInSampleLength = 6 - incoming_aaf_format; // Calculate the number of integer bytes per sample received
+			int nOutSampleLength = 6 - pPvtData->aaf_format; // Calculate the number of integer bytes per sample we want
+			if (tmp / nInSampleLength != pPvtData->payloadSize / nOutSampleLength) {
 				if (pPvtData->dataValid)
-					AVB_LOGF_ERROR("Listener payload size (%d) doesn't match received data (%d)",
-						pPvtData->payloadSize, tmp);
+					AVB_LOGF_ERROR("Listener payload samples (%d) doesn't match received data samples (%d)",
+						pPvtData->payloadSize / nOutSampleLength, tmp / nInSampleLength);
 				dataValid = FALSE;
 			}
-			else {
-				int nInSampleLength = 6 - incoming_aaf_format; // Calculate the number of integer bytes per sample received
-				int nOutSampleLength = 6 - pPvtData->aaf_format; // Calculate the number of integer bytes per sample we want
-				if (tmp / nInSampleLength != pPvtData->payloadSize / nOutSampleLength) {
-					if (pPvtData->dataValid)
-						AVB_LOGF_ERROR("Listener payload samples (%d) doesn't match received data samples (%d)",
-							pPvtData->payloadSize / nOutSampleLength, tmp / nInSampleLength);
-					dataValid = FALSE;
-				}
-			}
 		}
-		if ((tmp = ((packet_info >> 8) & 0x0F)) != pPvtData->aaf_event_field) {
-			if (pPvtData->dataValid)
-				AVB_LOGF_ERROR("Listener event field (%d) doesn't match received data (%d)",
-					pPvtData->aaf_event_field, tmp);
+	}
+	if ((tmp = ((packet_info >> 8) & 0x0F)) != pPvtData->aaf_event_field) {
+		if (pPvtData->dataValid)
+			AVB_LOGF_ERROR("Listener event field (%d) doesn't match received data (%d)",
+				pPvtData->aaf_event_field, tmp);
+	}
+
+	if (dataValid) {
+		if (dataConversionEnabled) {
+			pPvtData->rxConvert = x_convertFns[(6 - incoming_aaf_format) - 2][(6 - pPvtData->aaf_format) - 2];
 		}
+		pPvtData->rxPayloadSize = rxPayloadSize;
+		pPvtData->rxFormatInfo = format_info;
+		pPvtData->rxPacketInfo = packet_info;
+		pPvtData->rxFormatLatched = TRUE;
+	}
+	return dataValid;
+}
+
+// This callback occurs when running as a listener and data is available.
+bool openavbMapAVTPAudioRxHdrCB(media_q_t *pMediaQ, const avtp_stream_hdr_t *pAvtpHdr, U8 *pData, U32 dataLen)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP_DETAIL);
+	if (pMediaQ && pData) {
+		U8 *pHdrV0 = pData;
+		U32 *pHdr = (U32 *)(pData + AVTP_V0_HEADER_SIZE);
+		U8  *pPayload = pData + TOTAL_HEADER_SIZE;
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return FALSE;
+		}
+
+		// The common header has been decoded and checked by AVTP, including the payload length.
+		U32 timestamp = pAvtpHdr->timestamp;
+		pHdr++;		// avtp_timestamp
+		U32 format_info = ntohl(*pHdr++);
+		U32 packet_info = ntohl(*pHdr++);
+
+		bool listenerSparseMode = (pPvtData->sparseMode == TS_SPARSE_MODE_ENABLED) ? TRUE : FALSE;
+		bool streamSparseMode = (pHdrV0[HIDX_AVTP_HIDE7_SP] & SP_M0_BIT) ? TRUE : FALSE;
+		U16 payloadLen = pAvtpHdr->streamDataLen;
+
 		if (streamSparseMode && !listenerSparseMode) {
 			AVB_LOG_INFO("Listener enabling sparse mode to match incoming stream");
 			pPvtData->sparseMode = TS_SPARSE_MODE_ENABLED;
@@ -741,113 +1276,95 @@ bool openavbMapAVTPAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 			listenerSparseMode = FALSE;
 		}
 
+		bool dataValid = pPvtData->rxFormatLatched
+			&& format_info == pPvtData->rxFormatInfo && packet_info == pPvtData->rxPacketInfo;
+		if (!dataValid) {
+			dataValid = x_rxCheckFormat(pMediaQ, format_info, packet_info);
+		}
+
 		if (dataValid) {
 			if (!pPvtData->dataValid) {
 				AVB_LOG_INFO("RX data valid, stream un-muted");
 				pPvtData->dataValid = TRUE;
 			}
 
-			// Get item pointer in media queue
-			media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
-			if (pMediaQItem) {
-				// set timestamp if first data written to item
-				if (pMediaQItem->dataLen == 0) {
-
-					// Set timestamp valid flag
-					openavbAvtpTimeSetTimestampValid(pMediaQItem->pAvtpTime, (pHdrV0[HIDX_AVTP_HIDE7_TV1] & 0x01) ? TRUE : FALSE);
-
-					if (openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime)) {
-						// Get the timestamp and place it in the media queue item.
-						openavbAvtpTimeSetToTimestamp(pMediaQItem->pAvtpTime, timestamp);
+			U8 *pRxData = pPayload;
+			U32 rxPayloadSize = pPvtData->rxPayloadSize;
+			if (pPvtData->rxConvert) {
+				static U8 s_audioBuffer[1500];
+				U8 *pOutData = pPvtData->rxConvert(s_audioBuffer, pPayload, pPayload + payloadLen);
+				if (pOutData - s_audioBuffer != pPvtData->payloadSize) {
+					AVB_LOGF_ERROR("Output not expected size (%d instead of %d)", pOutData - s_audioBuffer, pPvtData->payloadSize);
+				}
+				pRxData = s_audioBuffer;
+			}
 
-						openavbAvtpTimeSubUSec(pMediaQItem->pAvtpTime, pPubMapInfo->presentationLatencyUSec);
+			if (pPvtData->rxSlotMode) {
+				// The media queue orders the data and marks what is missing.
+				x_rxWriteSlot(pMediaQ, pRxData, rxPayloadSize, pAvtpHdr->tv, timestamp);
+				AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+				return TRUE;
+			}
 
-						// Set timestamp uncertain flag
-						openavbAvtpTimeSetTimestampUncertain(pMediaQItem->pAvtpTime, (pHdrV0[HIDX_AVTP_HIDE7_TU1] & 0x01) ? TRUE : FALSE);
-						// Set flag to inform that MediaQ is synchronized with timestamped packets
-						 pPvtData->mediaQItemSyncTS = TRUE;
-					}
-					else if (!pPvtData->mediaQItemSyncTS) {
-						//we need packet with valid TS for first data written to item
-						AVB_LOG_DEBUG("Timestamp not valid for MediaQItem - initial packets dropped");
-						IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("Timestamp not valid for MediaQItem - initial packets dropped");
-						dataValid = FALSE;
-					}
+			// Use the sequence number to find where this packet belongs.
+			U8 seqNum = pAvtpHdr->sequenceNum;
+			if (pPvtData->rxSeqValid) {
+				U8 seqGap = seqNum - pPvtData->rxLastSeq - 1;
+				if (seqGap >= 0x80 && pPvtData->rxLateCount < AAF_MAX_LATE_PACKETS) {
+					// Late or duplicate packet. Its place in the media queue has already been filled.
+					pPvtData->rxLateCount++;
+					IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("Dropped late or duplicate packet (seq %u, expected %u)",
+						seqNum, (U8)(pPvtData->rxLastSeq + 1));
+					AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+					return TRUE;
 				}
-				if (dataValid) {
-					if (!dataConversionEnabled) {
-						// Just use the raw incoming data, and ignore the incoming bit_depth.
-						if (pPubMapInfo->intf_rx_translate_cb) {
-							pPubMapInfo->intf_rx_translate_cb(pMediaQ, pPayload, pPvtData->payloadSize);
+				if (seqGap > 0 && seqGap < 0x80) {
+					if (pPvtData->concealment != AVB_AUDIO_CONCEAL_NONE && seqGap <= pPvtData->maxConcealPackets) {
+						if (!x_rxConceal(pMediaQ, seqGap, pRxData)) {
+							AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+							return FALSE;   // Media queue full
 						}
-
-						memcpy((uint8_t *)pMediaQItem->pPubData + pMediaQItem->dataLen, pPayload, pPvtData->payloadSize);
 					}
 					else {
-						static U8 s_audioBuffer[1500];
-						U8 *pInData = pPayload;
-						U8 *pInDataEnd = pPayload + payloadLen;
-						U8 *pOutData = s_audioBuffer;
-						int nInSampleLength = 6 - incoming_aaf_format; // Calculate the number of integer bytes per sample received
-						int nOutSampleLength = 6 - pPvtData->aaf_format; // Calculate the number of integer bytes per sample we want
-						int i;
-						if (nInSampleLength < nOutSampleLength) {
-							// We need to pad the data supplied.
-							while (pInData < pInDataEnd) {
-								for (i = 0; i < nInSampleLength; ++i) {
-									*pOutData++ = *pInData++;
-								}
-								for ( ; i < nOutSampleLength; ++i) {
-									*pOutData++ = 0; // Value specified in Clause 7.3.4.
-								}
-							}
-						}
-						else {
-							// We need to truncate the data supplied.
-							while (pInData < pInDataEnd) {
-								for (i = 0; i < nOutSampleLength; ++i) {
-									*pOutData++ = *pInData++;
-								}
-								pInData += (nInSampleLength - nOutSampleLength);
-							}
-						}
-						if (pOutData - s_audioBuffer != pPvtData->payloadSize) {
-							AVB_LOGF_ERROR("Output not expected size (%d instead of %d)", pOutData - s_audioBuffer, pPvtData->payloadSize);
-						}
-
-						if (pPubMapInfo->intf_rx_translate_cb) {
-							pPubMapInfo->intf_rx_translate_cb(pMediaQ, s_audioBuffer, pPvtData->payloadSize);
-						}
-
-						memcpy((uint8_t *)pMediaQItem->pPubData + pMediaQItem->dataLen, s_audioBuffer, pPvtData->payloadSize);
+						IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("%u packets lost, gap not concealed", seqGap);
 					}
-
-					pMediaQItem->dataLen += pPvtData->payloadSize;
-				}
-
-				if (pMediaQItem->dataLen < pMediaQItem->itemSize) {
-					// More data can be written to the item
-					openavbMediaQHeadUnlock(pMediaQ);
-				}
-				else {
-					// The item is full push it.
-					openavbMediaQHeadPush(pMediaQ);
 				}
+			}
+			pPvtData->rxLateCount = 0;
 
-				AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
-				return TRUE;    // Normal exit
+			if (pPvtData->pRxLastData) {
+				// Keep a copy of the untranslated data for repeat and interpolation.
+				memcpy(pPvtData->pRxLastData, pRxData, rxPayloadSize);
 			}
-			else {
-				IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("Media queue full");
+
+			bool tsValid = pAvtpHdr->tv;
+			bool tsUncertain = pAvtpHdr->tu;
+			if (!x_rxWriteMediaQ(pMediaQ, pRxData, rxPayloadSize, tsValid, timestamp, tsUncertain)) {
 				AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
 				return FALSE;   // Media queue full
 			}
+
+			if (pPvtData->mediaQItemSyncTS) {
+				pPvtData->rxSeqValid = TRUE;
+				pPvtData->rxLastSeq = seqNum;
+				pPvtData->rxLastSize = rxPayloadSize;
+				if (tsValid) {
+					pPvtData->rxNextTimestamp = timestamp;
+					pPvtData->rxNextTimestampValid = TRUE;
+				}
+				x_rxAdvanceTimestamp(pMediaQ, rxPayloadSize);
+			}
+
+			AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+			return TRUE;    // Normal exit
 		}
 		else {
 			if (pPvtData->dataValid) {
 				AVB_LOG_INFO("RX data invalid, stream muted");
 				pPvtData->dataValid = FALSE;
 			}
+			pPvtData->rxSeqValid = FALSE;
+			pPvtData->rxNextTimestampValid = FALSE;
 		}
 	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
@@ -872,6 +1389,11 @@ void openavbMapAVTPAudioEndCB(media_q_t *pMediaQ)
 		}
 
 		pPvtData->mediaQItemSyncTS = FALSE;
+
+		free(pPvtData->pRxLastData);
+		pPvtData->pRxLastData = NULL;
+		free(pPvtData->pRxConcealData);
+		pPvtData->pRxConcealData = NULL;
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
@@ -899,6 +1421,7 @@ extern DLL_EXPORT bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb
 		}
 
 		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		pPvtData->pMapCB = pMapCB;
 
 		pMapCB->map_cfg_cb = openavbMapAVTPAudioCfgCB;
 		pMapCB->map_subtype_cb = openavbMapAVTPAudioSubtypeCB;
@@ -909,7 +1432,7 @@ extern DLL_EXPORT bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb
 		pMapCB->map_tx_init_cb = openavbMapAVTPAudioTxInitCB;
 		pMapCB->map_tx_cb = openavbMapAVTPAudioTxCB;
 		pMapCB->map_rx_init_cb = openavbMapAVTPAudioRxInitCB;
-		pMapCB->map_rx_cb = openavbMapAVTPAudioRxCB;
+		pMapCB->map_rx_hdr_cb = openavbMapAVTPAudioRxHdrCB;
 		pMapCB->map_end_cb = openavbMapAVTPAudioEndCB;
 		pMapCB->map_gen_end_cb = openavbMapAVTPAudioGenEndCB;
 
@@ -923,6 +1446,8 @@ extern DLL_EXPORT bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb
 		pPvtData->aaf_event_field = AAF_STATIC_CHANNELS_LAYOUT;
 		pPvtData->intervalCounter = 0;
 		pPvtData->mediaQItemSyncTS = FALSE;
+		pPvtData->concealment = AVB_AUDIO_CONCEAL_NONE;
+		pPvtData->maxConcealPackets = 8;
 		openavbMediaQSetMaxLatency(pMediaQ, inMaxTransitUsec);
 	}
 
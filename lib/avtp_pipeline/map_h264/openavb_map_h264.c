@@ -393,7 +393,10 @@ bool openavbMapH264RxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 			((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->timestamp =
 					ntohl(*(U32 *)(&pHdr[HIDX_H264_TIMESTAMP32]));
 
-			if (pMediaQItem->itemSize >= payloadLen) {
+			if (openavbMediaQHeadRefRxFrame(pMediaQ, pMediaQItem, pPayload, payloadLen)) {
+				// Item references the payload in the received frame
+			}
+			else if (pMediaQItem->itemSize >= payloadLen) {
 				memcpy(pMediaQItem->pPubData, pPayload, payloadLen);
 				pMediaQItem->dataLen = payloadLen;
 			}
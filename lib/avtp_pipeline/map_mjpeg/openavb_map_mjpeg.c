@@ -349,7 +349,10 @@ bool openavbMapMjpegRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 				((media_q_item_map_mjpeg_pub_data_t *)pMediaQItem->pPubMapData)->lastFragment = FALSE;
 			}
 
-			if (pMediaQItem->itemSize >= dataLen - TOTAL_HEADER_SIZE) {
+			if (openavbMediaQHeadRefRxFrame(pMediaQ, pMediaQItem, pPayload, dataLen - TOTAL_HEADER_SIZE)) {
+				// Item references the payload in the received frame
+			}
+			else if (pMediaQItem->itemSize >= dataLen - TOTAL_HEADER_SIZE) {
 				memcpy(pMediaQItem->pPubData, pPayload, payloadLen);
 				pMediaQItem->dataLen = dataLen - TOTAL_HEADER_SIZE;
 			}
@@ -75,8 +75,22 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 * AVTP timestamp	: Standard AVTP
 * Vendor_eui_1		: Vendor specific (includes OPENAVB format : Pipe Mapping 0x01)
 * Data Length		: Length of the data payload
-* Vendor_eui_2		: Vendor specific
+* Vendor_eui_2		: Vendor specific (fragment information, see below)
 * 
+* Items larger than map_nv_max_payload_size are split across consecutive
+* frames when map_nv_max_item_size is set. Vendor_eui_2 is then:
+* 
+*  -+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-
+* |P|F|L|fragment index           |
+*  -+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-
+* 
+* P					: Fragment information present
+* F					: First fragment of the item
+* L					: Last fragment of the item
+* Fragment index	: Index of the fragment in the item, modulo 8192
+* 
+* Items that fit in one frame are sent with Vendor_eui_2 of 0, as talkers
+* without fragmentation do.
 */
 
 #include "openavb_platform_pub.h"
@@ -125,6 +139,12 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 // - 2 bytes	vendor specific
 #define HIDX_VENDOR2_EUI16			22
 
+// Vendor_eui_2 fragment information
+#define PIPE_FRAG_PRESENT			0x8000
+#define PIPE_FRAG_FIRST				0x4000
+#define PIPE_FRAG_LAST				0x2000
+#define PIPE_FRAG_INDEX_MASK		0x1FFF
+
 typedef struct {
 	/////////////
 	// Config data
@@ -141,6 +161,9 @@ typedef struct {
 	// map_nv_pull_header
 	bool pull_header;
 
+	// map_nv_max_item_size. 0 = no fragmentation.
+	U32 maxItemSize;
+
 
 	/////////////
 	// Variable data
@@ -157,6 +180,18 @@ typedef struct {
 	// Maximum transit time
 	U32 maxTransitUsec;     // In microseconds
 
+	// Talker: offset and index of the next fragment of the tail item
+	U32 txFragOffset;
+	U16 txFragIndex;
+	// Talker: the item in flight, slots are reused so its timestamp tells it apart
+	media_q_item_t *pTxFragItem;
+	U64 txFragTimeNS;
+
+	// Listener: head item being reassembled
+	bool rxFragActive;
+	U16 rxFragIndex;
+	U32 rxFragDropped;
+
 } pvt_data_t;
 
 // Each configuration name value pair for this mapping will result in this callback being called.
@@ -185,6 +220,10 @@ void openavbMapPipeCfgCB(media_q_t *pMediaQ, const char *name, const char *value
 			pPvtData->maxDataSize = (pPvtData->maxPayloadSize + TOTAL_HEADER_SIZE);
 			pPvtData->itemSize =	pPvtData->maxPayloadSize;
 		}
+		else if (strcmp(name, "map_nv_max_item_size") == 0) {
+			char *pEnd;
+			pPvtData->maxItemSize = strtol(value, &pEnd, 10);
+		}
 		else if (strcmp(name, "map_nv_push_header") == 0) {
 			char *pEnd;
 			long tmp;
@@ -266,6 +305,21 @@ void openavbMapPipeGenInitCB(media_q_t *pMediaQ)
 			return;
 		}
 
+		if (pPvtData->maxItemSize) {
+			U32 frags = (pPvtData->maxItemSize + pPvtData->maxPayloadSize - 1) / pPvtData->maxPayloadSize;
+			if (pPvtData->push_header || pPvtData->pull_header) {
+				AVB_LOG_WARNING("map_nv_max_item_size ignored with map_nv_push_header or map_nv_pull_header");
+				pPvtData->maxItemSize = 0;
+			}
+			else if (frags > PIPE_FRAG_INDEX_MASK + 1) {
+				AVB_LOGF_ERROR("map_nv_max_item_size of %u needs more than %u fragments", pPvtData->maxItemSize, PIPE_FRAG_INDEX_MASK + 1);
+				pPvtData->maxItemSize = pPvtData->maxPayloadSize * (PIPE_FRAG_INDEX_MASK + 1);
+			}
+			if (pPvtData->maxItemSize > pPvtData->itemSize) {
+				pPvtData->itemSize = pPvtData->maxItemSize;
+			}
+		}
+
 		openavbMediaQSetSize(pMediaQ, pPvtData->itemCount, pPvtData->itemSize);
 	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
@@ -279,6 +333,80 @@ void openavbMapPipeTxInitCB(media_q_t *pMediaQ)
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
+// Fill in the AVTP and mapping headers for one frame of the item
+static void x_pipeSetHeader(U8 *pHdr, media_q_item_t *pMediaQItem, U16 payloadLen, U16 fragInfo)
+{
+	// Set timestamp valid flag
+	if (openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime))
+		pHdr[HIDX_AVTP_HIDE7_TV1] |= 0x01;      // Set
+	else {
+		pHdr[HIDX_AVTP_HIDE7_TV1] &= ~0x01;     // Clear
+	}
+
+	// Set timestamp uncertain flag
+	if (openavbAvtpTimeTimestampIsUncertain(pMediaQItem->pAvtpTime))
+		pHdr[HIDX_AVTP_HIDE7_TU1] |= 0x01;      // Set
+	else pHdr[HIDX_AVTP_HIDE7_TU1] &= ~0x01;     // Clear
+
+	*(U32 *)(&pHdr[HIDX_AVTP_TIMESPAMP32]) = htonl(openavbAvtpTimeGetAvtpTimestamp(pMediaQItem->pAvtpTime));
+	*(U32 *)(&pHdr[HIDX_OPENAVB_FORMAT8]) = 0x00000000;
+	pHdr[HIDX_OPENAVB_FORMAT8] = MAP_PIPE_OPENAVB_FORMAT;
+	// for alignment
+	payloadLen = htons(payloadLen);
+	memcpy(&pHdr[HIDX_AVTP_DATALEN16], &payloadLen, sizeof(U16));
+
+	fragInfo = htons(fragInfo);
+	memcpy(&pHdr[HIDX_VENDOR2_EUI16], &fragInfo, sizeof(U16));
+}
+
+// Send the next fragment of the tail item. The item stays in the media queue
+// until its last fragment is sent.
+static tx_cb_ret_t x_pipeTxFragment(media_q_t *pMediaQ, pvt_data_t *pPvtData, media_q_item_t *pMediaQItem, U8 *pData, U32 *dataLen)
+{
+	if (pPvtData->txFragOffset >= pMediaQItem->dataLen) {
+		AVB_LOGF_ERROR("Fragment offset %u beyond item of %u bytes, item dropped", pPvtData->txFragOffset, pMediaQItem->dataLen);
+		pPvtData->txFragOffset = 0;
+		pPvtData->txFragIndex = 0;
+		pPvtData->pTxFragItem = NULL;
+		openavbMediaQTailPull(pMediaQ);
+		return TX_CB_RET_PACKET_NOT_READY;
+	}
+
+	U32 fragLen = pMediaQItem->dataLen - pPvtData->txFragOffset;
+	U16 fragInfo = PIPE_FRAG_PRESENT | (pPvtData->txFragIndex & PIPE_FRAG_INDEX_MASK);
+
+	if (pPvtData->txFragOffset == 0) {
+		// PTP walltime already set in the interface module. Just add the max transit time.
+		openavbAvtpTimeAddUSec(pMediaQItem->pAvtpTime, pPvtData->maxTransitUsec);
+		fragInfo |= PIPE_FRAG_FIRST;
+		pPvtData->pTxFragItem = pMediaQItem;
+		pPvtData->txFragTimeNS = openavbAvtpTimeGetAvtpTimeNS(pMediaQItem->pAvtpTime);
+	}
+	if (fragLen > pPvtData->maxPayloadSize) {
+		fragLen = pPvtData->maxPayloadSize;
+	}
+	else {
+		fragInfo |= PIPE_FRAG_LAST;
+	}
+
+	x_pipeSetHeader(pData, pMediaQItem, fragLen, fragInfo);
+	memcpy(pData + TOTAL_HEADER_SIZE, (U8 *)pMediaQItem->pPubData + pPvtData->txFragOffset, fragLen);
+	*dataLen = fragLen + TOTAL_HEADER_SIZE;
+
+	if (fragInfo & PIPE_FRAG_LAST) {
+		pPvtData->txFragOffset = 0;
+		pPvtData->txFragIndex = 0;
+		pPvtData->pTxFragItem = NULL;
+		openavbMediaQTailPull(pMediaQ);
+	}
+	else {
+		pPvtData->txFragOffset += fragLen;
+		pPvtData->txFragIndex++;
+		openavbMediaQTailUnlock(pMediaQ);
+	}
+	return TX_CB_RET_PACKET_READY;
+}
+
 // This talker callback will be called for each AVB observation interval.
 tx_cb_ret_t openavbMapPipeTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 {
@@ -294,8 +422,25 @@ tx_cb_ret_t openavbMapPipeTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 
 		media_q_item_t *pMediaQItem = openavbMediaQTailLock(pMediaQ, TRUE);
 
+		if (pMediaQItem && pPvtData->txFragOffset
+			&& (pMediaQItem != pPvtData->pTxFragItem
+				|| openavbAvtpTimeGetAvtpTimeNS(pMediaQItem->pAvtpTime) != pPvtData->txFragTimeNS)) {
+			// The item in flight was purged as stale, the rest of it is gone
+			IF_LOG_INTERVAL(1000) AVB_LOG_WARNING("Fragmented item left the media queue before its last fragment");
+			pPvtData->txFragOffset = 0;
+			pPvtData->txFragIndex = 0;
+			pPvtData->pTxFragItem = NULL;
+		}
+
 		if (pMediaQItem) {
 			if (pMediaQItem->dataLen > 0) {
+				if (pPvtData->maxItemSize && (pPvtData->txFragOffset || pMediaQItem->dataLen > pPvtData->maxPayloadSize)) {
+					tx_cb_ret_t ret = x_pipeTxFragment(pMediaQ, pPvtData, pMediaQItem, pData, dataLen);
+					AVB_TRACE_LINE(AVB_TRACE_MAP_LINE);
+					AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+					return ret;
+				}
+
 				if (pMediaQItem->dataLen > pPvtData->maxDataSize) {
 					AVB_LOGF_ERROR("Media queue data item size too large. Reported size: %d  Max Size: %d", pMediaQItem->dataLen, pPvtData->maxDataSize);
 					AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
@@ -306,32 +451,16 @@ tx_cb_ret_t openavbMapPipeTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 				// PTP walltime already set in the interface module. Just add the max transit time.
 				openavbAvtpTimeAddUSec(pMediaQItem->pAvtpTime, pPvtData->maxTransitUsec);
 
-				// Set timestamp valid flag
-				if (openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime))
-					pHdr[HIDX_AVTP_HIDE7_TV1] |= 0x01;      // Set
-				else {
-					pHdr[HIDX_AVTP_HIDE7_TV1] &= ~0x01;     // Clear
-				}
-
-				// Set timestamp uncertain flag
-				if (openavbAvtpTimeTimestampIsUncertain(pMediaQItem->pAvtpTime))
-					pHdr[HIDX_AVTP_HIDE7_TU1] |= 0x01;      // Set
-				else pHdr[HIDX_AVTP_HIDE7_TU1] &= ~0x01;     // Clear
-
-				*(U32 *)(&pHdr[HIDX_AVTP_TIMESPAMP32]) = htonl(openavbAvtpTimeGetAvtpTimestamp(pMediaQItem->pAvtpTime));
-				*(U32 *)(&pHdr[HIDX_OPENAVB_FORMAT8]) = 0x00000000;
-				pHdr[HIDX_OPENAVB_FORMAT8] = MAP_PIPE_OPENAVB_FORMAT;
-				// for alignment
-				U16 payloadLen = htons(pMediaQItem->dataLen);;
-				memcpy(&pHdr[HIDX_AVTP_DATALEN16], &payloadLen, sizeof(U16));
-				
-				*(U16 *)(&pHdr[HIDX_VENDOR2_EUI16]) = 0x0000;
-
 				if (pPvtData->pull_header) {
-					memcpy(pData, pMediaQItem->pPubData, pMediaQItem->dataLen);
+					// The item is the whole AVTP frame. In zero copy transmit mode the
+					// interface module built it in place.
+					if (pMediaQItem->pTxFrame != pData) {
+						memcpy(pData, pMediaQItem->pPubData, pMediaQItem->dataLen);
+					}
 					*dataLen = pMediaQItem->dataLen;
 				}
 				else {
+					x_pipeSetHeader(pHdr, pMediaQItem, pMediaQItem->dataLen, 0x0000);
 					memcpy(pPayload, pMediaQItem->pPubData, pMediaQItem->dataLen);
 					*dataLen = pMediaQItem->dataLen + TOTAL_HEADER_SIZE;
 				}
@@ -364,6 +493,85 @@ void openavbMapPipeRxInitCB(media_q_t *pMediaQ)
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
+// Give up on the item being reassembled. The head item is reused by the next one.
+static void x_pipeRxFragDrop(pvt_data_t *pPvtData, const char *reason)
+{
+	pPvtData->rxFragActive = FALSE;
+	pPvtData->rxFragDropped++;
+	IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("Fragmented item dropped (%s). Dropped items: %u", reason, pPvtData->rxFragDropped);
+}
+
+// Copy one fragment straight into the head item. The item is pushed once its
+// last fragment arrives; a missing fragment drops only the item it belongs to.
+static bool x_pipeRxFragment(media_q_t *pMediaQ, pvt_data_t *pPvtData, U8 *pData, U32 dataLen, U16 fragInfo)
+{
+	const U8 *pHdr = pData;
+	U8 *pPayload = pData + TOTAL_HEADER_SIZE;
+	U16 fragIndex = fragInfo & PIPE_FRAG_INDEX_MASK;
+	media_q_item_t *pMediaQItem;
+	U16 payloadLen;
+
+	memcpy(&payloadLen, &pHdr[HIDX_AVTP_DATALEN16], sizeof(U16));
+	payloadLen = ntohs(payloadLen);
+	if (dataLen < TOTAL_HEADER_SIZE || payloadLen > dataLen - TOTAL_HEADER_SIZE) {
+		if (pPvtData->rxFragActive) {
+			x_pipeRxFragDrop(pPvtData, "short frame");
+		}
+		return FALSE;
+	}
+
+	if (fragInfo & PIPE_FRAG_FIRST) {
+		if (pPvtData->rxFragActive) {
+			x_pipeRxFragDrop(pPvtData, "last fragment missing");
+		}
+	}
+	else if (!pPvtData->rxFragActive) {
+		// Joined in the middle of an item, or its start was already dropped
+		return FALSE;
+	}
+	else if (fragIndex != ((pPvtData->rxFragIndex + 1) & PIPE_FRAG_INDEX_MASK)) {
+		x_pipeRxFragDrop(pPvtData, "fragment missing");
+		return FALSE;
+	}
+
+	pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+	if (!pMediaQItem) {
+		if (pPvtData->rxFragActive) {
+			x_pipeRxFragDrop(pPvtData, "media queue full");
+		}
+		IF_LOG_INTERVAL(1000) AVB_LOG_INFO("Media queue full");
+		return FALSE;
+	}
+
+	if (fragInfo & PIPE_FRAG_FIRST) {
+		U32 timestamp = ntohl(*(U32 *)(&pHdr[HIDX_AVTP_TIMESPAMP32]));
+		openavbAvtpTimeSetToTimestamp(pMediaQItem->pAvtpTime, timestamp);
+		openavbAvtpTimeSetTimestampValid(pMediaQItem->pAvtpTime, (pHdr[HIDX_AVTP_HIDE7_TV1] & 0x01) ? TRUE : FALSE);
+		openavbAvtpTimeSetTimestampUncertain(pMediaQItem->pAvtpTime, (pHdr[HIDX_AVTP_HIDE7_TU1] & 0x01) ? TRUE : FALSE);
+		pMediaQItem->dataLen = 0;
+		pPvtData->rxFragActive = TRUE;
+	}
+	pPvtData->rxFragIndex = fragIndex;
+
+	if (pMediaQItem->dataLen + payloadLen > pMediaQItem->itemSize) {
+		openavbMediaQHeadUnlock(pMediaQ);
+		x_pipeRxFragDrop(pPvtData, "item larger than map_nv_max_item_size");
+		return FALSE;
+	}
+
+	memcpy((U8 *)pMediaQItem->pPubData + pMediaQItem->dataLen, pPayload, payloadLen);
+	pMediaQItem->dataLen += payloadLen;
+
+	if (fragInfo & PIPE_FRAG_LAST) {
+		pPvtData->rxFragActive = FALSE;
+		openavbMediaQHeadPush(pMediaQ);
+	}
+	else {
+		openavbMediaQHeadUnlock(pMediaQ);
+	}
+	return TRUE;
+}
+
 // This callback occurs when running as a listener and data is available.
 bool openavbMapPipeRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 {
@@ -377,6 +585,21 @@ bool openavbMapPipeRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 			return FALSE;
 		}
 
+		if (!pPvtData->push_header) {
+			U16 fragInfo;
+			memcpy(&fragInfo, &pHdr[HIDX_VENDOR2_EUI16], sizeof(U16));
+			fragInfo = ntohs(fragInfo);
+			if (fragInfo & PIPE_FRAG_PRESENT) {
+				bool ret = x_pipeRxFragment(pMediaQ, pPvtData, pData, dataLen, fragInfo);
+				AVB_TRACE_LINE(AVB_TRACE_MAP_LINE);
+				AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+				return ret;
+			}
+			if (pPvtData->rxFragActive) {
+				x_pipeRxFragDrop(pPvtData, "last fragment missing");
+			}
+		}
+
 		media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
 		if (pMediaQItem) {
 			U32 timestamp = ntohl(*(U32 *)(&pHdr[HIDX_AVTP_TIMESPAMP32]));
@@ -387,7 +610,10 @@ bool openavbMapPipeRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 			openavbAvtpTimeSetTimestampUncertain(pMediaQItem->pAvtpTime, (pHdr[HIDX_AVTP_HIDE7_TU1] & 0x01) ? TRUE : FALSE);
 
 			if (pPvtData->push_header) {
-				if (pMediaQItem->itemSize >= dataLen) {
+				if (openavbMediaQHeadRefRxFrame(pMediaQ, pMediaQItem, pData, dataLen)) {
+					// Item references the whole AVTPDU in the received frame
+				}
+				else if (pMediaQItem->itemSize >= dataLen) {
 					memcpy(pMediaQItem->pPubData, pData, dataLen);
 					pMediaQItem->dataLen = dataLen;
 				}
@@ -402,7 +628,10 @@ bool openavbMapPipeRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 				memcpy(&payloadLen, &pHdr[HIDX_AVTP_DATALEN16], sizeof(U16));
 				payloadLen = ntohs(payloadLen);
 
-				if (pMediaQItem->itemSize >= payloadLen) {
+				if (openavbMediaQHeadRefRxFrame(pMediaQ, pMediaQItem, pPayload, payloadLen)) {
+					// Item references the payload in the received frame
+				}
+				else if (pMediaQItem->itemSize >= payloadLen) {
 					memcpy(pMediaQItem->pPubData, pPayload, payloadLen);
 					pMediaQItem->dataLen = payloadLen;
 				}
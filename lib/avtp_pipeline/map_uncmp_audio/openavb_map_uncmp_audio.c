@@ -120,6 +120,18 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 // 2 bytes		syt (synchronization timing) Set to 0xffff according to 1722
 #define HIDX_SYT16					30
 
+// Number of consecutive late packets after which the listener assumes the
+// talker has restarted and resynchronizes to the new data block counter.
+#define UNCMP_MAX_LATE_PACKETS		16
+
+// The packet routines are written once and instantiated for each media queue
+// sample size, so the per sample work has no branches on the configuration.
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define UNCMP_SPECIALIZE static inline __attribute__ ((always_inline))
+#else
+#define UNCMP_SPECIALIZE static inline
+#endif
+
 typedef struct {
 	/////////////
 	// Config data
@@ -134,6 +146,13 @@ typedef struct {
 	//	the minimal needed.
 	U32 packingFactor;
 
+	// map_nv_loss_concealment: How the listener fills the gap left by lost packets.
+	avb_audio_concealment_t concealment;
+
+	// map_nv_max_conceal_packets: Largest gap (in packets) the listener will conceal.
+	// Larger gaps are treated as a discontinuity.
+	U32 maxConcealPackets;
+
 	/////////////
 	// Variable data
 	/////////////
@@ -149,6 +168,18 @@ typedef struct {
 	U8 DBC;
 
 	avb_audio_mcr_t audioMcr;
+
+	// Listener packet ordering and loss concealment
+	bool rxDbcValid;
+	U8 rxNextDbc;
+	U32 rxLateCount;
+	bool rxNextTimestampValid;
+	U32 rxNextTimestamp;
+	U32 rxLastFrames;
+	U8 *pRxLastData;
+
+	// Callbacks of the stream, used to install the specialized packet routines.
+	openavb_map_cb_t *pMapCB;
 #if ATL_LAUNCHTIME_ENABLED
 	// Transmit interval in nanoseconds.
 	U32 txIntervalNs;
@@ -322,6 +353,18 @@ void openavbMapUncmpAudioCfgCB(media_q_t *pMediaQ, const char *name, const char
 			char *pEnd;
 			pPvtData->audioMcr = (avb_audio_mcr_t)strtol(value, &pEnd, 10);
 		}
+		else if (strcmp(name, "map_nv_loss_concealment") == 0) {
+			char *pEnd;
+			U32 tmp;
+			tmp = strtol(value, &pEnd, 10);
+			if (*pEnd == '\0' && tmp <= AVB_AUDIO_CONCEAL_INTERPOLATE) {
+				pPvtData->concealment = (avb_audio_concealment_t)tmp;
+			}
+		}
+		else if (strcmp(name, "map_nv_max_conceal_packets") == 0) {
+			char *pEnd;
+			pPvtData->maxConcealPackets = strtol(value, &pEnd, 10);
+		}
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
@@ -438,6 +481,9 @@ static U64 last_time = 0;
 }
 #endif
 
+static tx_cb_ret_t x_txCB16(media_q_t *pMediaQ, U8 *pData, U32 *dataLen);
+static tx_cb_ret_t x_txCB24(media_q_t *pMediaQ, U8 *pData, U32 *dataLen);
+
 // A call to this callback indicates that this mapping module will be
 // a talker. Any talker initialization can be done in this function.
 void openavbMapUncmpAudioTxInitCB(media_q_t *pMediaQ)
@@ -465,11 +511,14 @@ void openavbMapUncmpAudioTxInitCB(media_q_t *pMediaQ)
 		return;
 	}
 
+	pPvtData->pMapCB->map_tx_cb = (pPubMapInfo->itemSampleSizeBytes == 2) ? x_txCB16 : x_txCB24;
+
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
-// This talker callback will be called for each AVB observation interval.
-tx_cb_ret_t openavbMapUncmpAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
+// Build one packet. sampleSize is the media queue sample size (2 or 3 bytes)
+// and is a constant in every instantiation.
+UNCMP_SPECIALIZE tx_cb_ret_t x_txPacket(media_q_t *pMediaQ, U8 *pData, U32 *dataLen, const U32 sampleSize)
 {
 	media_q_item_t *pMediaQItem = NULL;
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP_DETAIL);
@@ -542,25 +591,16 @@ tx_cb_ret_t openavbMapUncmpAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen
 				while (framesProcessed < pPubMapInfo->framesPerPacket && pMediaQItem->readIdx < pMediaQItem->dataLen) {
 					int i1;
 					for (i1 = 0; i1 < pPubMapInfo->audioChannels; i1++) {
-						if (pPubMapInfo->itemSampleSizeBytes == 2) {
-							S32 sample = *(S16 *)pItemData;
-							sample &= 0x0000ffff;
-							sample = sample << 8;
-							sample |= pPvtData->AM824_label;
-							sample = htonl(sample);
-							*(U32 *)(pAVTPDataUnit) = sample;
-							pAVTPDataUnit += 4;
-							pItemData += 2;
+						U32 sample;
+						if (sampleSize == 2) {
+							sample = (U32)(*(U16 *)pItemData) << 8;
 						}
 						else {
-							S32 sample = *(S32 *)pItemData;
-							sample &= 0x00ffffff;
-							sample |= pPvtData->AM824_label;
-							sample = htonl(sample);
-							*(U32 *)(pAVTPDataUnit) = sample;
-							pAVTPDataUnit += 4;
-							pItemData += 3;
+							sample = pItemData[0] | ((U32)pItemData[1] << 8) | ((U32)pItemData[2] << 16);
 						}
+						*(U32 *)(pAVTPDataUnit) = htonl(sample | pPvtData->AM824_label);
+						pAVTPDataUnit += 4;
+						pItemData += sampleSize;
 					}
 					framesProcessed++;
 					if (dbc % sytInt == 0) {
@@ -610,16 +650,166 @@ tx_cb_ret_t openavbMapUncmpAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen
 	return TX_CB_RET_PACKET_NOT_READY;
 }
 
+static tx_cb_ret_t x_txCB16(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
+{
+	return x_txPacket(pMediaQ, pData, dataLen, 2);
+}
+
+static tx_cb_ret_t x_txCB24(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
+{
+	return x_txPacket(pMediaQ, pData, dataLen, 3);
+}
+
+// This talker callback will be called for each AVB observation interval.
+// TX init replaces it with the routine for the configured sample size.
+tx_cb_ret_t openavbMapUncmpAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
+{
+	media_q_pub_map_uncmp_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	return x_txPacket(pMediaQ, pData, dataLen, pPubMapInfo->itemSampleSizeBytes == 2 ? 2 : 3);
+}
+
+static bool x_rxCB16(media_q_t *pMediaQ, U8 *pData, U32 dataLen);
+static bool x_rxCB24(media_q_t *pMediaQ, U8 *pData, U32 dataLen);
+
 // A call to this callback indicates that this mapping module will be
 // a listener. Any listener initialization can be done in this function.
 void openavbMapUncmpAudioRxInitCB(media_q_t *pMediaQ)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	if (pMediaQ) {
+		media_q_pub_map_uncmp_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			AVB_TRACE_EXIT(AVB_TRACE_MAP);
+			return;
+		}
+
+		pPvtData->rxDbcValid = FALSE;
+		pPvtData->rxLateCount = 0;
+		pPvtData->rxNextTimestampValid = FALSE;
+		pPvtData->rxLastFrames = 0;
+		if (pPvtData->concealment != AVB_AUDIO_CONCEAL_NONE && !pPvtData->pRxLastData) {
+			pPvtData->pRxLastData = calloc(1, pPubMapInfo->itemSize);
+			if (!pPvtData->pRxLastData) {
+				AVB_LOG_ERROR("Unable to allocate loss concealment buffer; concealment disabled");
+				pPvtData->concealment = AVB_AUDIO_CONCEAL_NONE;
+			}
+		}
+
+		pPvtData->pMapCB->map_rx_cb = (pPubMapInfo->itemSampleSizeBytes == 2) ? x_rxCB16 : x_rxCB24;
+	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
-// This callback occurs when running as a listener and data is available.
-bool openavbMapUncmpAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
+// Media queue item samples are host order, 2 or 3 bytes wide.
+static S32 x_getItemSample(const U8 *pSample, U32 sampleSize)
+{
+	if (sampleSize == 2) {
+		return *(S16 *)pSample;
+	}
+	return (S32)(((U32)pSample[0] << 8) | ((U32)pSample[1] << 16) | ((U32)pSample[2] << 24)) >> 8;
+}
+
+static void x_putItemSample(U8 *pSample, U32 sampleSize, S32 value)
+{
+	if (sampleSize == 2) {
+		*(S16 *)pSample = value;
+	}
+	else {
+		pSample[0] = value & 0xFF;
+		pSample[1] = (value >> 8) & 0xFF;
+		pSample[2] = (value >> 16) & 0xFF;
+	}
+}
+
+// Convert an AM824 sample from the packet to media queue item scale.
+static S32 x_getPacketSample(const U8 *pDataUnit, U32 sampleSize)
+{
+	S32 sample = (S32)(ntohl(*(U32 *)pDataUnit) << 8) >> 8;
+	if (sampleSize == 2) {
+		return sample >> 8;
+	}
+	return sample;
+}
+
+// Fill the media queue for lostFrames frames missing just before pNextDataUnit.
+// Work is bounded by map_nv_max_conceal_packets. Returns FALSE if the media queue is full.
+static bool x_rxConceal(media_q_t *pMediaQ, U32 lostFrames, const U8 *pNextDataUnit)
+{
+	media_q_pub_map_uncmp_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+	U32 sampleSize = pPubMapInfo->itemSampleSizeBytes;
+	U32 frameSize = pPubMapInfo->itemFrameSizeBytes;
+	const U8 *pPrevFrame = pPvtData->pRxLastData;
+	U32 frame = 0;
+
+	if (pPvtData->rxLastFrames > 0) {
+		pPrevFrame += (pPvtData->rxLastFrames - 1) * frameSize;
+	}
+
+	IF_LOG_INTERVAL(1000) AVB_LOGF_INFO("Concealing %u lost frames", lostFrames);
+
+	while (frame < lostFrames) {
+		media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+		if (!pMediaQItem) {
+			IF_LOG_INTERVAL(1000) AVB_LOG_INFO("Media queue full");
+			return FALSE;
+		}
+
+		if (pMediaQItem->dataLen == 0) {
+			// Keep media queue items aligned on SYT_INTERVAL, as is done for received packets.
+			U8 dbcIdx = (U8)(pPvtData->rxNextDbc + frame) % pPubMapInfo->sytInterval;
+			if (dbcIdx > 0) {
+				frame += pPubMapInfo->sytInterval - dbcIdx;
+				openavbMediaQHeadUnlock(pMediaQ);
+				continue;
+			}
+
+			openavbAvtpTimeSetToTimestamp(pMediaQItem->pAvtpTime,
+				pPvtData->rxNextTimestamp + (U32)((frame * NANOSECONDS_PER_SECOND) / pPubMapInfo->audioRate));
+			openavbAvtpTimeSetTimestampValid(pMediaQItem->pAvtpTime, pPvtData->rxNextTimestampValid);
+			openavbAvtpTimeSetTimestampUncertain(pMediaQItem->pAvtpTime, FALSE);
+		}
+
+		U8 *pItemData = (U8 *)pMediaQItem->pPubData + pMediaQItem->dataLen;
+		U8 *pItemDataEnd = (U8 *)pMediaQItem->pPubData + pMediaQItem->itemSize;
+		while (frame < lostFrames && (pItemData + frameSize) <= pItemDataEnd) {
+			if (pPvtData->rxLastFrames == 0 || pPvtData->concealment == AVB_AUDIO_CONCEAL_SILENCE) {
+				memset(pItemData, 0, frameSize);
+			}
+			else if (pPvtData->concealment == AVB_AUDIO_CONCEAL_REPEAT) {
+				memcpy(pItemData, pPvtData->pRxLastData + (frame % pPvtData->rxLastFrames) * frameSize, frameSize);
+			}
+			else {
+				// Linear ramp from the last frame received to the first frame after the gap.
+				int i1;
+				for (i1 = 0; i1 < pPubMapInfo->audioChannels; i1++) {
+					S32 prev = x_getItemSample(pPrevFrame + i1 * sampleSize, sampleSize);
+					S32 next = x_getPacketSample(pNextDataUnit + i1 * 4, sampleSize);
+					x_putItemSample(pItemData + i1 * sampleSize, sampleSize,
+						prev + (S32)(((S64)(next - prev) * (frame + 1)) / (lostFrames + 1)));
+				}
+			}
+			pItemData += frameSize;
+			pMediaQItem->dataLen += frameSize;
+			frame++;
+		}
+
+		if (pMediaQItem->dataLen < pMediaQItem->itemSize) {
+			openavbMediaQHeadUnlock(pMediaQ);
+		}
+		else {
+			openavbMediaQHeadPush(pMediaQ);
+		}
+	}
+
+	return TRUE;
+}
+
+// Process one received packet. sampleSize is the media queue sample size
+// (2 or 3 bytes) and is a constant in every instantiation.
+UNCMP_SPECIALIZE bool x_rxPacket(media_q_t *pMediaQ, U8 *pData, U32 dataLen, const U32 sampleSize)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP_DETAIL);
 	if (pMediaQ && pData) {
@@ -651,6 +841,42 @@ bool openavbMapUncmpAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 		U8 dbcIdx = dbc % pPubMapInfo->sytInterval;
 		U8 *pAVTPDataUnit = pPayload;
 		U8 *pAVTPDataUnitEnd = pData + AVTP_V0_HEADER_SIZE + MAP_HEADER_SIZE + payloadLen;
+		U32 packetFrames = (pAVTPDataUnitEnd > pAVTPDataUnit) ? (pAVTPDataUnitEnd - pAVTPDataUnit) / pPubMapInfo->packetFrameSizeBytes : 0;
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+
+		// Use the data block counter to find where this packet belongs.
+		if (pPvtData->rxDbcValid) {
+			U8 dbcGap = dbc - pPvtData->rxNextDbc;
+			if (dbcGap >= 0x80 && pPvtData->rxLateCount < UNCMP_MAX_LATE_PACKETS) {
+				// Late or duplicate packet. Its place in the media queue has already been filled.
+				pPvtData->rxLateCount++;
+				IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("Dropped late or duplicate packet (dbc %u, expected %u)", dbc, pPvtData->rxNextDbc);
+				AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+				return TRUE;
+			}
+			if (dbcGap > 0 && dbcGap < 0x80 && packetFrames > 0) {
+				if (pPvtData->concealment != AVB_AUDIO_CONCEAL_NONE
+						&& dbcGap <= pPvtData->maxConcealPackets * pPubMapInfo->framesPerPacket) {
+					if (!x_rxConceal(pMediaQ, dbcGap, pAVTPDataUnit)) {
+						AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+						return FALSE;   // Media queue full
+					}
+				}
+				else {
+					IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("%u frames lost, gap not concealed", dbcGap);
+				}
+			}
+		}
+		pPvtData->rxLateCount = 0;
+		pPvtData->rxDbcValid = TRUE;
+		pPvtData->rxNextDbc = dbc + packetFrames;
+		if (tsValid && dbcIdx == 0) {
+			pPvtData->rxNextTimestamp = ntohl(*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]));
+			pPvtData->rxNextTimestampValid = TRUE;
+		}
+		if (pPvtData->rxNextTimestampValid) {
+			pPvtData->rxNextTimestamp += (U32)((packetFrames * NANOSECONDS_PER_SECOND) / pPubMapInfo->audioRate);
+		}
 
 		while (((pAVTPDataUnit + pPubMapInfo->packetFrameSizeBytes) <= pAVTPDataUnitEnd)) {
 			// Get item pointer in media queue
@@ -663,7 +889,6 @@ bool openavbMapUncmpAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 
 				// Get the timestamp
 				U32 timestamp = ntohl(*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]));
-				pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
 				if ((pPvtData->audioMcr != AVB_MCR_NONE) && tsValid && !tsUncertain) {
 					// MCR mode set and timestamp is valid, and timestamp uncertain is not set
 					openavbAvtpTimePushMCR(pMediaQItem->pAvtpTime, timestamp);
@@ -691,27 +916,29 @@ bool openavbMapUncmpAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 				while (((pAVTPDataUnit + pPubMapInfo->packetFrameSizeBytes) <= pAVTPDataUnitEnd) && ((pItemData + pPubMapInfo->itemFrameSizeBytes) <= pItemDataEnd)) {
 					int i1;
 					for (i1 = 0; i1 < pPubMapInfo->audioChannels; i1++) {
-						if (pPubMapInfo->itemSampleSizeBytes == 2) {
-							S32 sample = ntohl(*(S32 *)pAVTPDataUnit);
-							sample = sample * 1;
-							*(S16 *)(pItemData) = (sample & 0x00ffffff) >> 8;
-							pAVTPDataUnit += 4;
-							pItemData += 2;
-							itemSizeWritten += 2;
+						U32 sample = ntohl(*(U32 *)pAVTPDataUnit);
+						if (sampleSize == 2) {
+							*(U16 *)(pItemData) = (sample & 0x00ffffff) >> 8;
 						}
 						else {
-							S32 sample = ntohl(*(S32 *)pAVTPDataUnit);
-							sample = sample * 1;
-							*(S32 *)(pItemData) = sample & 0x00ffffff;
-							pAVTPDataUnit += 4;
-							pItemData += 3;
-							itemSizeWritten += 3;
+							pItemData[0] = sample & 0xFF;
+							pItemData[1] = (sample >> 8) & 0xFF;
+							pItemData[2] = (sample >> 16) & 0xFF;
 						}
+						pAVTPDataUnit += 4;
+						pItemData += sampleSize;
 					}
+					itemSizeWritten += pPubMapInfo->itemFrameSizeBytes;
 				}
 
 				pMediaQItem->dataLen += itemSizeWritten;
 
+				if (pPvtData->pRxLastData && itemSizeWritten > 0) {
+					// Keep the frames for repeat and interpolation concealment.
+					memcpy(pPvtData->pRxLastData, pItemData - itemSizeWritten, itemSizeWritten);
+					pPvtData->rxLastFrames = itemSizeWritten / pPubMapInfo->itemFrameSizeBytes;
+				}
+
 				if (pMediaQItem->dataLen < pMediaQItem->itemSize) {
 					// More data can be written to the item
 					openavbMediaQHeadUnlock(pMediaQ);
@@ -737,11 +964,39 @@ bool openavbMapUncmpAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 	return FALSE;
 }
 
+static bool x_rxCB16(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
+{
+	return x_rxPacket(pMediaQ, pData, dataLen, 2);
+}
+
+static bool x_rxCB24(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
+{
+	return x_rxPacket(pMediaQ, pData, dataLen, 3);
+}
+
+// This callback occurs when running as a listener and data is available.
+// RX init replaces it with the routine for the configured sample size.
+bool openavbMapUncmpAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
+{
+	if (!pMediaQ) {
+		return FALSE;
+	}
+	media_q_pub_map_uncmp_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	return x_rxPacket(pMediaQ, pData, dataLen, pPubMapInfo->itemSampleSizeBytes == 2 ? 2 : 3);
+}
+
 // This callback will be called when the mapping module needs to be closed.
 // All cleanup should occur in this function.
 void openavbMapUncmpAudioEndCB(media_q_t *pMediaQ)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (pPvtData) {
+			free(pPvtData->pRxLastData);
+			pPvtData->pRxLastData = NULL;
+		}
+	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
@@ -767,6 +1022,7 @@ extern DLL_EXPORT bool openavbMapUncmpAudioInitialize(media_q_t *pMediaQ, openav
 		}
 
 		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		pPvtData->pMapCB = pMapCB;
 
 		pMapCB->map_cfg_cb = openavbMapUncmpAudioCfgCB;
 		pMapCB->map_subtype_cb = openavbMapUncmpAudioSubtypeCB;
@@ -790,6 +1046,8 @@ extern DLL_EXPORT bool openavbMapUncmpAudioInitialize(media_q_t *pMediaQ, openav
 		pPvtData->maxTransitUsec = inMaxTransitUsec;
 		pPvtData->DBC = 0;
 		pPvtData->audioMcr = AVB_MCR_NONE;
+		pPvtData->concealment = AVB_AUDIO_CONCEAL_NONE;
+		pPvtData->maxConcealPackets = 8;
 
 		openavbMediaQSetMaxLatency(pMediaQ, inMaxTransitUsec);
 	}
@@ -0,0 +1,198 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Capture clock estimation for media sampled by a free running device
+*/
+
+#include <string.h>
+#include <float.h>
+#include "openavb_platform_pub.h"
+#include "openavb_types_pub.h"
+#include "openavb_cce.h"
+
+// The origin moves forward when the mean frame position passes this
+#define CCE_REBASE_FRAMES			(1 << 30)
+// Observations the residual mean square is averaged over
+#define CCE_RESVAR_WINDOW			256.0
+// Blocks the delay floor is averaged over
+#define CCE_FLOOR_WINDOW			8.0
+
+static double x_cceSlope(const cce_t *captureClock)
+{
+	double slope, bound;
+
+	if (!openavbCceLocked(captureClock) || captureClock->covXX <= 0) {
+		return captureClock->nsPerFrame;
+	}
+
+	slope = captureClock->covXY / captureClock->covXX;
+	bound = captureClock->nsPerFrame * CCE_MAX_PPM * 1e-6;
+	if (slope > captureClock->nsPerFrame + bound) {
+		slope = captureClock->nsPerFrame + bound;
+	}
+	else if (slope < captureClock->nsPerFrame - bound) {
+		slope = captureClock->nsPerFrame - bound;
+	}
+	return slope;
+}
+
+// Offset from the fit to the least delayed observations, zero or less
+static double x_cceFloor(const cce_t *captureClock)
+{
+	return captureClock->floorBlocks ? captureClock->floorNS : captureClock->floorCur;
+}
+
+static void x_cceAnchor(cce_t *captureClock, U64 framePos, U64 timeNS)
+{
+	captureClock->started = TRUE;
+	captureClock->framePos0 = framePos;
+	captureClock->timeNS0 = timeNS;
+	captureClock->weight = 1.0;
+	captureClock->meanX = 0;
+	captureClock->meanY = 0;
+	captureClock->covXX = 0;
+	captureClock->covXY = 0;
+	// Until residuals are known anything within the minimum is accepted
+	captureClock->resVar = 0;
+	// The fit runs through the anchor
+	captureClock->floorCur = 0;
+	captureClock->floorNS = 0;
+	captureClock->floorCount = 1;
+	captureClock->floorBlocks = 0;
+	captureClock->obsCount = 1;
+	captureClock->rejectRun = 0;
+}
+
+// Move the origin to the integer part of the means. Co-moments do not change.
+static void x_cceRebase(cce_t *captureClock)
+{
+	S64 dx = (S64)captureClock->meanX;
+	S64 dy = (S64)captureClock->meanY;
+
+	captureClock->framePos0 += dx;
+	captureClock->timeNS0 += dy;
+	captureClock->meanX -= (double)dx;
+	captureClock->meanY -= (double)dy;
+}
+
+void openavbCceInit(cce_t *captureClock, U32 sampleRate, U32 window)
+{
+	memset(captureClock, 0, sizeof(*captureClock));
+	captureClock->nsPerFrame = (double)NANOSECONDS_PER_SECOND / (sampleRate ? sampleRate : 1);
+	captureClock->forget = 1.0 - 1.0 / (window ? window : CCE_WINDOW);
+}
+
+void openavbCceReset(cce_t *captureClock)
+{
+	if (captureClock->started) {
+		captureClock->restartCount++;
+	}
+	captureClock->started = FALSE;
+	captureClock->obsCount = 0;
+	captureClock->rejectRun = 0;
+}
+
+bool openavbCceObserve(cce_t *captureClock, U64 framePos, U64 timeNS)
+{
+	double x, y, dx, res, limit;
+
+	if (!captureClock->started) {
+		x_cceAnchor(captureClock, framePos, timeNS);
+		return TRUE;
+	}
+
+	x = (double)(S64)(framePos - captureClock->framePos0);
+	y = (double)(S64)(timeNS - captureClock->timeNS0);
+	res = y - (captureClock->meanY + x_cceSlope(captureClock) * (x - captureClock->meanX));
+
+	if (openavbCceLocked(captureClock)) {
+		// Compared squared, no square root per observation
+		limit = CCE_REJECT_SIGMA * CCE_REJECT_SIGMA * captureClock->resVar;
+		if (limit < (double)CCE_REJECT_MIN_NS * CCE_REJECT_MIN_NS) {
+			limit = (double)CCE_REJECT_MIN_NS * CCE_REJECT_MIN_NS;
+		}
+		if (res * res > limit) {
+			captureClock->rejectCount++;
+			if (++captureClock->rejectRun >= CCE_REJECT_RUN) {
+				// The clock jumped, start over from here
+				captureClock->restartCount++;
+				x_cceAnchor(captureClock, framePos, timeNS);
+			}
+			return FALSE;
+		}
+	}
+	captureClock->rejectRun = 0;
+	captureClock->resVar += (res * res - captureClock->resVar) / CCE_RESVAR_WINDOW;
+
+	if (res < captureClock->floorCur) {
+		captureClock->floorCur = res;
+	}
+	if (++captureClock->floorCount >= CCE_FLOOR_BLOCK) {
+		if (captureClock->floorBlocks++ == 0) {
+			captureClock->floorNS = captureClock->floorCur;
+		}
+		else {
+			captureClock->floorNS += (captureClock->floorCur - captureClock->floorNS) / CCE_FLOOR_WINDOW;
+		}
+		captureClock->floorCur = DBL_MAX;
+		captureClock->floorCount = 0;
+	}
+
+	// Exponentially weighted update of the means and co-moments
+	captureClock->weight = captureClock->weight * captureClock->forget + 1.0;
+	dx = x - captureClock->meanX;
+	captureClock->meanX += dx / captureClock->weight;
+	captureClock->meanY += (y - captureClock->meanY) / captureClock->weight;
+	captureClock->covXX = captureClock->covXX * captureClock->forget + dx * (x - captureClock->meanX);
+	captureClock->covXY = captureClock->covXY * captureClock->forget + dx * (y - captureClock->meanY);
+	captureClock->obsCount++;
+
+	if (captureClock->meanX > CCE_REBASE_FRAMES) {
+		x_cceRebase(captureClock);
+	}
+	return TRUE;
+}
+
+U64 openavbCceTimeAt(const cce_t *captureClock, U64 framePos)
+{
+	double x = (double)(S64)(framePos - captureClock->framePos0);
+	double y = captureClock->meanY + x_cceSlope(captureClock) * (x - captureClock->meanX) + x_cceFloor(captureClock);
+
+	return captureClock->timeNS0 + (S64)(y < 0 ? y - 0.5 : y + 0.5);
+}
+
+S32 openavbCceRatePPB(const cce_t *captureClock)
+{
+	double ppb = (captureClock->nsPerFrame / x_cceSlope(captureClock) - 1.0) * 1e9;
+
+	return (S32)(ppb < 0 ? ppb - 0.5 : ppb + 0.5);
+}
@@ -0,0 +1,123 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Capture clock estimation for media sampled by a free running device
+*/
+
+#ifndef OPENAVB_CCE_H
+#define OPENAVB_CCE_H
+
+// A capture device such as a sound card samples on its own clock. Each time
+// the interface module reads from it, it can observe the position of the
+// newest captured frame and the gPTP time at which that frame was captured,
+// plus the delay of the observation. The estimator fits a line (frame
+// position to gPTP time) through the observations with exponentially
+// weighted least squares and gives the capture time of any frame from it,
+// which removes the scatter of the individual observations. The fit runs
+// through the mean delay, so the estimate is moved down onto the least
+// delayed observations; a delay can't be negative.
+
+// Number of observations the fit effectively spans. At one observation per
+// item and 8000 items per second this is about half a second.
+#define CCE_WINDOW					4096
+// Observations before the fitted rate is used, the nominal rate before that
+#define CCE_WARMUP					64
+// Bound on the fitted rate against the nominal sample rate
+#define CCE_MAX_PPM					1000
+// Observations further than CCE_REJECT_SIGMA standard deviations (and at
+// least CCE_REJECT_MIN_NS) from the fit are not used, they were delayed
+#define CCE_REJECT_SIGMA			4
+#define CCE_REJECT_MIN_NS			(20 * NANOSECONDS_PER_USEC)
+// This many rejected observations in a row means the clock jumped (for
+// example an overrun dropped frames); the estimator starts over
+#define CCE_REJECT_RUN				64
+// The lowest residual of each CCE_FLOOR_BLOCK observations, averaged over
+// the blocks, is taken as the delay floor
+#define CCE_FLOOR_BLOCK				256
+
+typedef struct {
+	// Settings
+	double nsPerFrame;
+	double forget;
+
+	// Observations are kept relative to this origin to keep the precision
+	// of the doubles
+	bool started;
+	U64 framePos0;
+	U64 timeNS0;
+
+	// Weighted means and co-moments of frame position (x) and time (y)
+	double weight;
+	double meanX;
+	double meanY;
+	double covXX;
+	double covXY;
+	// Weighted mean square of the residuals of the used observations
+	double resVar;
+	// Lowest residual of the used observations in the current block, and
+	// the average of the lowest residuals of the completed blocks
+	double floorCur;
+	double floorNS;
+	U32 floorCount;
+	U32 floorBlocks;
+
+	U32 obsCount;
+	U32 rejectRun;
+	U32 rejectCount;
+	U32 restartCount;
+} cce_t;
+
+// Set up the estimator for a device running at sampleRate frames per second.
+// window is the number of observations the fit spans, 0 selects CCE_WINDOW.
+void openavbCceInit(cce_t *captureClock, U32 sampleRate, U32 window);
+
+// Forget all observations, for example after the device was restarted.
+void openavbCceReset(cce_t *captureClock);
+
+// Add an observation: the frame at framePos was captured at timeNS (gPTP).
+// Returns FALSE if the observation was rejected as delayed.
+bool openavbCceObserve(cce_t *captureClock, U64 framePos, U64 timeNS);
+
+// Estimated gPTP capture time of the frame at framePos. Only valid once there
+// has been an observation.
+U64 openavbCceTimeAt(const cce_t *captureClock, U64 framePos);
+
+// Fitted rate of the device against gPTP time in parts per billion.
+S32 openavbCceRatePPB(const cce_t *captureClock);
+
+// TRUE once the fitted rate is in use.
+static inline bool openavbCceLocked(const cce_t *captureClock)
+{
+	return captureClock->obsCount >= CCE_WARMUP;
+}
+
+#endif
@@ -33,45 +33,190 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 * MODULE SUMMARY : Media clock timestamp synthesis for stored or generated media
 */
 
+#include <string.h>
 #include "openavb_platform_pub.h"
 #include "openavb_types_pub.h"
 #include "openavb_log_pub.h"
 #include "openavb_mcs.h"
 
-void openavbMcsInit(mcs_t *mediaClockSynth, U64 nsPerAdvance, S32 correctionAmount, U32 correctionInterval)
+// 2^32 / NANOSECONDS_PER_SECOND, to turn ns * ppb into a 32.32 fixed point ns value
+#define MCS_ADJ_SCALE	4.294967296
+
+static double x_mcsPeriodNS(mcs_t *mediaClockSynth)
+{
+	return (double)mediaClockSynth->nsPerAdvance
+		+ (double)mediaClockSynth->fracPerAdvance / (double)mediaClockSynth->fracDen;
+}
+
+static void x_mcsSetRate(mcs_t *mediaClockSynth, S32 ratePPB)
+{
+	double adj = x_mcsPeriodNS(mediaClockSynth) * (double)ratePPB * MCS_ADJ_SCALE;
+
+	mediaClockSynth->ratePPB = ratePPB;
+	mediaClockSynth->adjPerAdvance = (S64)(adj < 0 ? adj - 0.5 : adj + 0.5);
+}
+
+static void x_mcsAnchor(mcs_t *mediaClockSynth, U64 nowNS)
+{
+	mediaClockSynth->edgeTime = nowNS;
+	mediaClockSynth->fracAccum = 0;
+	mediaClockSynth->adjAccum = 0;
+	mediaClockSynth->servoCountdown = mediaClockSynth->servoInterval;
+	mediaClockSynth->phaseErrValid = FALSE;
+}
+
+static S32 x_mcsClamp(S64 val, S64 limit)
+{
+	if (val > limit)
+		return limit;
+	if (val < -limit)
+		return -limit;
+	return val;
+}
+
+// PI loop on the phase of the edges against gPTP time. The phase error is
+// expressed as the rate error that would build it up over one update interval,
+// so the gains do not depend on the edge period or the update interval.
+static void x_mcsServoUpdate(mcs_t *mediaClockSynth)
+{
+	S64 phaseErr = mediaClockSynth->phaseErrMax;
+	S64 freqErrPPB, delta, target, step;
+	U32 shift;
+
+	mediaClockSynth->phaseErrValid = FALSE;
+	mediaClockSynth->phaseErr = phaseErr;
+
+	if (phaseErr > MCS_SERVO_RELOCK_NS || phaseErr < -MCS_SERVO_RELOCK_NS) {
+		// Too far off to slew back in a reasonable time
+		AVB_LOGF_WARNING("Media clock phase error %lld ns, re-anchoring", (long long)phaseErr);
+		mediaClockSynth->edgeTime -= phaseErr;
+		mediaClockSynth->phaseErr = 0;
+		mediaClockSynth->servoGear = 0;
+		mediaClockSynth->servoGearCount = 0;
+		mediaClockSynth->relockCount++;
+		return;
+	}
+
+	freqErrPPB = (S64)((double)phaseErr * NANOSECONDS_PER_SECOND
+		/ ((double)mediaClockSynth->servoInterval * x_mcsPeriodNS(mediaClockSynth)));
+
+	// Critically damped PI (Ki = Kp^2/4). The loop starts with a time constant
+	// of about 16 updates to pull in the source rate quickly and is slowed down
+	// by a factor of two per gear to average out the caller's jitter.
+	shift = 3 + mediaClockSynth->servoGear;
+	// The integrator moves by a fraction of the step limit at most, so a caller
+	// stalled through a whole sample window does not wind it up.
+	delta = x_mcsClamp(freqErrPPB / (4 << (2 * shift)), mediaClockSynth->servoMaxStepPPB / 8);
+	mediaClockSynth->integralPPB = x_mcsClamp(mediaClockSynth->integralPPB - delta, mediaClockSynth->servoMaxPPB);
+	target = x_mcsClamp(mediaClockSynth->integralPPB - freqErrPPB / (1 << shift), mediaClockSynth->servoMaxPPB);
+	if (mediaClockSynth->servoGear < MCS_SERVO_GEARS - 1 && ++mediaClockSynth->servoGearCount >= (32U << mediaClockSynth->servoGear)) {
+		mediaClockSynth->servoGear++;
+		mediaClockSynth->servoGearCount = 0;
+	}
+
+	step = x_mcsClamp(target - mediaClockSynth->ratePPB, mediaClockSynth->servoMaxStepPPB);
+	if (step != 0) {
+		x_mcsSetRate(mediaClockSynth, mediaClockSynth->ratePPB + step);
+	}
+
+	IF_LOG_INTERVAL(600) {
+		AVB_LOGF_INFO("Media clock phase error %lld ns, rate %d ppb", (long long)phaseErr, mediaClockSynth->ratePPB);
+	}
+}
+
+void openavbMcsInit(mcs_t *mediaClockSynth, U64 periodNum, U32 periodDen)
 {
+	if (periodDen == 0) {
+		periodDen = 1;
+	}
+
+	memset(mediaClockSynth, 0, sizeof(*mediaClockSynth));
 	mediaClockSynth->firstTimeSet = FALSE;
-	mediaClockSynth->nsPerAdvance = nsPerAdvance;
-	mediaClockSynth->correctionAmount = correctionAmount;
-	mediaClockSynth->correctionInterval = correctionInterval;
-	mediaClockSynth->startTime = 0;
-	mediaClockSynth->tickCount = 0;
-	mediaClockSynth->edgeTime = 0;
+	mediaClockSynth->nsPerAdvance = periodNum / periodDen;
+	mediaClockSynth->fracPerAdvance = periodNum % periodDen;
+	mediaClockSynth->fracDen = periodDen;
 }
 
-void openavbMcsAdvance(mcs_t *mediaClockSynth)
+void openavbMcsServoInit(mcs_t *mediaClockSynth, U64 updateNS, S32 initialPPB, S32 maxPPB)
+{
+	U64 periodScaled = mediaClockSynth->nsPerAdvance * mediaClockSynth->fracDen + mediaClockSynth->fracPerAdvance;
+	U64 interval;
+
+	if (updateNS == 0) {
+		updateNS = MCS_SERVO_UPDATE_NS;
+	}
+	if (maxPPB <= 0) {
+		maxPPB = MCS_SERVO_MAX_PPB;
+	}
+
+	interval = periodScaled ? updateNS * mediaClockSynth->fracDen / periodScaled : 0;
+	if (interval < 2 * MCS_SERVO_SAMPLES) {
+		interval = 2 * MCS_SERVO_SAMPLES;
+	}
+
+	mediaClockSynth->servoInterval = interval;
+	mediaClockSynth->servoCountdown = interval;
+	mediaClockSynth->servoMaxPPB = maxPPB;
+	mediaClockSynth->servoMaxStepPPB = MCS_SERVO_MAX_STEP_PPB;
+	mediaClockSynth->integralPPB = x_mcsClamp(initialPPB, maxPPB);
+	x_mcsSetRate(mediaClockSynth, mediaClockSynth->integralPPB);
+}
+
+void openavbMcsAdvanceAt(mcs_t *mediaClockSynth, U64 nowNS)
 {
 	if (mediaClockSynth->firstTimeSet == FALSE) {
-		CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &mediaClockSynth->edgeTime);
-		if (mediaClockSynth->edgeTime) {
+		if (nowNS) {
+			x_mcsAnchor(mediaClockSynth, nowNS);
 			mediaClockSynth->firstTimeSet = TRUE;
-			mediaClockSynth->startTime = mediaClockSynth->edgeTime;
+			mediaClockSynth->startTime = nowNS;
 		}
+		return;
+	}
+
+	mediaClockSynth->edgeTime += mediaClockSynth->nsPerAdvance;
+	mediaClockSynth->fracAccum += mediaClockSynth->fracPerAdvance;
+	if (mediaClockSynth->fracAccum >= mediaClockSynth->fracDen) {
+		mediaClockSynth->fracAccum -= mediaClockSynth->fracDen;
+		mediaClockSynth->edgeTime++;
 	}
-	else
-	{
-		mediaClockSynth->edgeTime += mediaClockSynth->nsPerAdvance;
-		mediaClockSynth->tickCount++;
-		if (mediaClockSynth->tickCount % mediaClockSynth->correctionInterval == 0) {
-			mediaClockSynth->edgeTime += mediaClockSynth->correctionAmount;
+	if (mediaClockSynth->adjPerAdvance) {
+		mediaClockSynth->adjAccum += mediaClockSynth->adjPerAdvance;
+		mediaClockSynth->edgeTime += mediaClockSynth->adjAccum >> 32;
+		mediaClockSynth->adjAccum &= 0xFFFFFFFFLL;
+	}
+	mediaClockSynth->tickCount++;
+
+	if (mediaClockSynth->servoInterval) {
+		if (mediaClockSynth->servoCountdown <= MCS_SERVO_SAMPLES) {
+			S64 phaseErr = (S64)(mediaClockSynth->edgeTime - nowNS);
+			if (!mediaClockSynth->phaseErrValid || phaseErr > mediaClockSynth->phaseErrMax) {
+				mediaClockSynth->phaseErrMax = phaseErr;
+				mediaClockSynth->phaseErrValid = TRUE;
+			}
 		}
+		if (--mediaClockSynth->servoCountdown == 0) {
+			mediaClockSynth->servoCountdown = mediaClockSynth->servoInterval;
+			x_mcsServoUpdate(mediaClockSynth);
+		}
+	}
+}
+
+void openavbMcsAdvance(mcs_t *mediaClockSynth)
+{
+	U64 nowNS = 0;
+
+	if (openavbMcsNeedsTime(mediaClockSynth)) {
+		CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNS);
+	}
+	openavbMcsAdvanceAt(mediaClockSynth, nowNS);
+
 #if !IGB_LAUNCHTIME_ENABLED && !ATL_LAUNCHTIME_ENABLED
+	if (mediaClockSynth->servoInterval == 0 && mediaClockSynth->tickCount) {
 		IF_LOG_INTERVAL(8000) {
-			U64 nowNS;
 			CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNS);
 			S64 fixedRealDelta = mediaClockSynth->edgeTime - nowNS;
 			AVB_LOGF_INFO("Fixed/Real TS Delta: %lld", fixedRealDelta);
 		}
-#endif
 	}
+#endif
 }
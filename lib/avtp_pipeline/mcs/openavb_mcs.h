@@ -36,17 +36,82 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #ifndef OPENAVB_MCS_H
 #define OPENAVB_MCS_H
 
+// Servo defaults, used when openavbMcsServoInit() is passed zeros.
+// The phase of the synthesized edges is compared against gPTP time about every
+// MCS_SERVO_UPDATE_NS and the rate is trimmed by at most MCS_SERVO_MAX_STEP_PPB
+// per update, within +/- MCS_SERVO_MAX_PPB of nominal.
+#define MCS_SERVO_UPDATE_NS			(100 * NANOSECONDS_PER_MSEC)
+#define MCS_SERVO_MAX_PPB			(250 * 1000)
+#define MCS_SERVO_MAX_STEP_PPB		(10 * 1000)
+// Number of ticks at the end of each update interval that are compared against
+// gPTP time. The smallest lag among them is used, which rejects most of the
+// scheduling delay of the caller.
+#define MCS_SERVO_SAMPLES			32
+// The servo starts with a wide loop bandwidth to pull in the source rate and
+// halves it on each gear change until the last of MCS_SERVO_GEARS is reached.
+#define MCS_SERVO_GEARS				3
+// A phase error larger than this is treated as a discontinuity (stalled source
+// or a gPTP time jump) and the synthesizer is re-anchored instead of slewed.
+#define MCS_SERVO_RELOCK_NS			(20 * NANOSECONDS_PER_MSEC)
+
 typedef struct {
 	bool firstTimeSet;
-	U64 nsPerAdvance;
 	U64 startTime;
 	U64 tickCount;
-	S32 correctionAmount;
-	U32 correctionInterval;
 	U64 edgeTime;
+
+	// Nominal edge period is nsPerAdvance + fracPerAdvance/fracDen nanoseconds,
+	// exactly. fracAccum carries the sub-nanosecond remainder (< fracDen).
+	U64 nsPerAdvance;
+	U32 fracPerAdvance;
+	U32 fracDen;
+	U32 fracAccum;
+
+	// Servo rate trim, applied as a signed 32.32 fixed point nanosecond
+	// increment per tick on top of the nominal period.
+	S64 adjPerAdvance;
+	S64 adjAccum;
+
+	// Servo state. servoInterval of 0 leaves the synthesizer free running.
+	U32 servoInterval;
+	U32 servoCountdown;
+	S32 servoMaxPPB;
+	S32 servoMaxStepPPB;
+	U32 servoGear;
+	U32 servoGearCount;
+	S32 ratePPB;
+	S64 integralPPB;
+	bool phaseErrValid;
+	S64 phaseErrMax;
+	// Edge minus gPTP time as of the last servo update, in ns
+	S64 phaseErr;
+	U32 relockCount;
 } mcs_t;
 
-void openavbMcsInit(mcs_t *mediaClockSynth, U64 nsPerAdvance, S32 correctionAmount, U32 correctionInterval);
+// Set up the synthesizer for an edge period of periodNum/periodDen nanoseconds.
+// For audio, periodNum = NANOSECONDS_PER_SECOND * framesPerItem and
+// periodDen = sample rate gives an exact period with no accumulated rounding.
+void openavbMcsInit(mcs_t *mediaClockSynth, U64 periodNum, U32 periodDen);
+
+// Discipline the edges to gPTP time. updateNS is the approximate time between
+// servo updates, initialPPB a known rate offset of the media source (for
+// example a measured sound card skew), maxPPB the bound on the rate trim.
+// Zero for updateNS or maxPPB selects the defaults above.
+void openavbMcsServoInit(mcs_t *mediaClockSynth, U64 updateNS, S32 initialPPB, S32 maxPPB);
+
+// Produce the next edge in mediaClockSynth->edgeTime. The first call anchors
+// the synthesizer to the current gPTP time.
 void openavbMcsAdvance(mcs_t *mediaClockSynth);
 
+// As openavbMcsAdvance() with the gPTP time supplied by the caller. nowNS is
+// only used when openavbMcsNeedsTime() is TRUE for this tick.
+void openavbMcsAdvanceAt(mcs_t *mediaClockSynth, U64 nowNS);
+
+// TRUE when the next advance will anchor the synthesizer or sample the phase.
+static inline bool openavbMcsNeedsTime(const mcs_t *mediaClockSynth)
+{
+	return !mediaClockSynth->firstTimeSet
+		|| (mediaClockSynth->servoInterval && mediaClockSynth->servoCountdown <= MCS_SERVO_SAMPLES);
+}
+
 #endif
@@ -36,6 +36,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_platform.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include "openavb_types_pub.h"
 #include "openavb_trace.h"
 #include "openavb_mediaq.h"
@@ -51,6 +52,18 @@ static MUTEX_HANDLE(gMediaQMutex);
 //#define DUMP_HEAD_PUSH 		1
 //#define DUMP_TAIL_PULL 		1
 
+// Presentation times this close before a slot boundary belong to the next slot.
+// Allows for rounding in the timestamps of the data placed into slots.
+#define MEDIAQ_SLOT_TOLERANCE_NSEC	1000
+
+typedef enum {
+	MEDIAQ_SLOT_EMPTY = 0,
+	MEDIAQ_SLOT_WRITING,
+	MEDIAQ_SLOT_PARTIAL,
+	MEDIAQ_SLOT_COMPLETE,
+	MEDIAQ_SLOT_RELEASED,
+} media_q_slot_state_t;
+
 #if  DUMP_HEAD_PUSH
 FILE *pFileHeadPush = 0;
 #endif
@@ -89,6 +102,49 @@ typedef struct {
 	// Maximum stale tail
 	U32 maxStaleTailUsec;
 
+	// Presentation time ordered mode. See openavbMediaQSlotModeOn()
+	bool slotMode;
+
+	// Slot duration is slotDurationNsecNum / slotDurationDen nanoseconds
+	U64 slotDurationNsecNum;
+	U32 slotDurationDen;
+
+	// Presentation time of slot number slotStartNumber. Zero until a slot is locked.
+	U64 slotStartNsec;
+	U64 slotStartNumber;
+
+	// Number of slots released by the tail. Only changed by the tail.
+	U64 slotReleased;
+
+	// Per item slot state (media_q_slot_state_t) and the slot number held by the item.
+	U32 *pSlotState;
+	U64 *pSlotNumber;
+
+	// Zero copy receive. See openavbMediaQRxFrameRefModeOn()
+	bool rxFrameRefMode;
+	openavb_media_q_rx_frame_rel_cb_t rxFrameRelCB;
+	void *pRxFrameRelCtx;
+	U32 rxFrameMaxRefs;
+
+	// Frames referenced by items or detached by the interface. Updated atomically
+	// because detached frames may be released from another thread.
+	U32 rxFrameRefs;
+
+	// Frame being passed to the map RX callback and whether an item took it.
+	void *pRxFrameCur;
+	bool rxFrameCurRef;
+
+	// Storage owned by each item, restored when the item drops its frame.
+	void **pItemPubData;
+
+	// Zero copy transmit. See openavbMediaQTxFrameRefModeOn()
+	bool txFrameRefMode;
+
+	// Frame being filled by the interface and map TX callbacks and the item referencing it.
+	U8 *pTxFrameCur;
+	U32 txFrameCurLen;
+	media_q_item_t *pTxFrameItem;
+
 } media_q_info_t;
 
 static void x_openavbMediaQIncrementHead(media_q_info_t *pMediaQInfo)	
@@ -153,8 +209,192 @@ static void x_openavbMediaQIncrementTail(media_q_info_t *pMediaQInfo)
 	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
 }
 
-	
-// CORE_TODO: May need to add mutex protection when merging with OSAL/HAL branch.
+
+// Drop the frame referenced by an item and give the item its own storage back.
+// Returns the frame which the caller must release.
+static void *x_openavbMediaQItemUnrefRxFrame(media_q_info_t *pMediaQInfo, media_q_item_t *pItem)
+{
+	void *pRxFrame = pItem->pRxFrame;
+	if (pRxFrame) {
+		pItem->pPubData = pMediaQInfo->pItemPubData[pItem - pMediaQInfo->pItems];
+		pItem->itemSize = pMediaQInfo->itemSize;
+		pItem->pRxFrame = NULL;
+	}
+	return pRxFrame;
+}
+
+// Drop the transmit frame referenced by an item and give the item its own storage back.
+static void x_openavbMediaQItemUnrefTxFrame(media_q_info_t *pMediaQInfo, media_q_item_t *pItem)
+{
+	if (pItem->pTxFrame) {
+		pItem->pPubData = pMediaQInfo->pItemPubData[pItem - pMediaQInfo->pItems];
+		pItem->itemSize = pMediaQInfo->itemSize;
+		pItem->pTxFrame = NULL;
+		if (pMediaQInfo->pTxFrameItem == pItem) {
+			pMediaQInfo->pTxFrameItem = NULL;
+		}
+	}
+}
+
+// Remember the storage of each item before items start pointing into frames.
+static bool x_openavbMediaQSaveItemPubData(media_q_info_t *pMediaQInfo)
+{
+	if (!pMediaQInfo->pItemPubData) {
+		pMediaQInfo->pItemPubData = calloc(pMediaQInfo->itemCount, sizeof(void *));
+		if (pMediaQInfo->pItemPubData) {
+			int i1;
+			for (i1 = 0; i1 < pMediaQInfo->itemCount; i1++) {
+				pMediaQInfo->pItemPubData[i1] = pMediaQInfo->pItems[i1].pPubData;
+			}
+		}
+	}
+	return pMediaQInfo->pItemPubData != NULL;
+}
+
+static void x_openavbMediaQRelRxFrame(media_q_info_t *pMediaQInfo, void *pRxFrame)
+{
+	if (pRxFrame) {
+		openavb_media_q_rx_frame_rel_cb_t relCB = pMediaQInfo->rxFrameRelCB;
+		if (relCB) {
+			relCB(pMediaQInfo->pRxFrameRelCtx, pRxFrame);
+		}
+		__sync_fetch_and_sub(&pMediaQInfo->rxFrameRefs, 1);
+	}
+}
+
+// Presentation time of a slot number
+static U64 x_openavbMediaQSlotTime(media_q_info_t *pMediaQInfo, U64 slotNumber)
+{
+	U64 slots = slotNumber - pMediaQInfo->slotStartNumber;
+	U64 den = pMediaQInfo->slotDurationDen;
+
+	return pMediaQInfo->slotStartNsec
+		+ (slots / den) * pMediaQInfo->slotDurationNsecNum
+		+ ((slots % den) * pMediaQInfo->slotDurationNsecNum) / den;
+}
+
+// True if the tail slot has reached its presentation time
+static bool x_openavbMediaQSlotTailIsPast(media_q_info_t *pMediaQInfo)
+{
+	U64 nowNsec;
+	CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNsec);
+	return nowNsec >= x_openavbMediaQSlotTime(pMediaQInfo, pMediaQInfo->slotReleased);
+}
+
+// Once every slot is empty and the tail is stale the stream has stopped. Forget
+// the presentation time so the next data locked starts the queue again.
+static bool x_openavbMediaQSlotIdle(media_q_info_t *pMediaQInfo)
+{
+	if (pMediaQInfo->maxStaleTailUsec == 0) {
+		return FALSE;
+	}
+
+	U64 nowNsec;
+	CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNsec);
+	if (nowNsec < x_openavbMediaQSlotTime(pMediaQInfo, pMediaQInfo->slotReleased)
+			+ (U64)pMediaQInfo->maxStaleTailUsec * NANOSECONDS_PER_USEC) {
+		return FALSE;
+	}
+
+	int i1;
+	for (i1 = 0; i1 < pMediaQInfo->itemCount; i1++) {
+		if (pMediaQInfo->pSlotState[i1] != MEDIAQ_SLOT_EMPTY) {
+			return FALSE;
+		}
+	}
+
+	AVB_LOG_DEBUG("MediaQ slots idle, waiting for new presentation time");
+	pMediaQInfo->slotStartNumber = pMediaQInfo->slotReleased;
+	__sync_synchronize();
+	pMediaQInfo->slotStartNsec = 0;
+	return TRUE;
+}
+
+static media_q_item_t *x_openavbMediaQSlotTailLock(media_q_info_t *pMediaQInfo, bool ignoreTimestamp)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	if (pMediaQInfo->slotStartNsec == 0) {
+		AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+		return NULL;
+	}
+
+	media_q_item_t *pTail = &pMediaQInfo->pItems[pMediaQInfo->tail];
+	U32 state = pMediaQInfo->pSlotState[pMediaQInfo->tail];
+
+	if (state != MEDIAQ_SLOT_RELEASED) {
+		if (state == MEDIAQ_SLOT_WRITING) {
+			// Being written, try again later
+			AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+			return NULL;
+		}
+
+		// Incomplete slots are only released once their presentation time is reached.
+		if (!ignoreTimestamp || state != MEDIAQ_SLOT_COMPLETE) {
+			if (!x_openavbMediaQSlotTailIsPast(pMediaQInfo)) {
+				AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+				return NULL;
+			}
+			if (state == MEDIAQ_SLOT_EMPTY && x_openavbMediaQSlotIdle(pMediaQInfo)) {
+				AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+				return NULL;
+			}
+		}
+
+		if (!__sync_bool_compare_and_swap(&pMediaQInfo->pSlotState[pMediaQInfo->tail], state, MEDIAQ_SLOT_RELEASED)) {
+			// A writer locked the slot first
+			AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+			return NULL;
+		}
+
+		if (state != MEDIAQ_SLOT_COMPLETE) {
+			if (state == MEDIAQ_SLOT_EMPTY) {
+				memset(pTail->pPubData, 0, pTail->itemSize);
+				openavbAvtpTimeSetToTimestampNS(pTail->pAvtpTime,
+					x_openavbMediaQSlotTime(pMediaQInfo, pMediaQInfo->slotReleased));
+			}
+			pTail->dataLen = pTail->itemSize;
+			pTail->readIdx = 0;
+			pTail->missing = TRUE;
+		}
+	}
+
+	pMediaQInfo->tailLocked = TRUE;
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+	return pTail;
+}
+
+static bool x_openavbMediaQSlotTailPull(media_q_info_t *pMediaQInfo)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	int tail = pMediaQInfo->tail;
+	if (pMediaQInfo->pSlotState[tail] != MEDIAQ_SLOT_RELEASED) {
+		// Tail must be locked before it is pulled
+		AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+		return FALSE;
+	}
+
+	media_q_item_t *pTail = &pMediaQInfo->pItems[tail];
+	pTail->readIdx = 0;
+	pTail->dataLen = 0;
+	pTail->missing = FALSE;
+
+	// Recycle the item for the slot one queue length later
+	pMediaQInfo->pSlotNumber[tail] = pMediaQInfo->slotReleased + pMediaQInfo->itemCount;
+	__sync_synchronize();
+	pMediaQInfo->pSlotState[tail] = MEDIAQ_SLOT_EMPTY;
+	__sync_fetch_and_add(&pMediaQInfo->slotReleased, 1);
+
+	if (++pMediaQInfo->tail >= pMediaQInfo->itemCount) {
+		pMediaQInfo->tail = 0;
+	}
+	pMediaQInfo->tailLocked = FALSE;
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+	return TRUE;
+}
+
 void x_openavbMediaQPurgeStaleTail(media_q_t *pMediaQ)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
@@ -163,11 +403,16 @@ void x_openavbMediaQPurgeStaleTail(media_q_t *pMediaQ)
 		if (pMediaQ->pPvtMediaQInfo) {
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
 
-			if (pMediaQInfo->maxStaleTailUsec > 0) {
+			// Slot mode releases stale slots from the tail as missing instead.
+			if (pMediaQInfo->maxStaleTailUsec > 0 && !pMediaQInfo->slotMode) {
 				bool bFirst = TRUE;
 				bool bMore = TRUE;
 				while (bMore) {
 					bMore = FALSE;
+					if (pMediaQInfo->threadSafeOn) {
+						// Released by openavbMediaQTailPull() or below
+						MEDIAQ_LOCK();
+					}
 					if (pMediaQInfo->itemCount > 0) {
 						if (pMediaQInfo->tail > -1) {
 							media_q_item_t *pTail = &pMediaQInfo->pItems[pMediaQInfo->tail];
@@ -206,6 +451,9 @@ void x_openavbMediaQPurgeStaleTail(media_q_t *pMediaQ)
 							}
 						}
 					}
+					if (!bMore && pMediaQInfo->threadSafeOn) {
+						MEDIAQ_UNLOCK();
+					}
 				}
 			}
 		}
@@ -433,6 +681,9 @@ bool openavbMediaQDelete(media_q_t *pMediaQ)
 						AVB_LOG_ERROR("Deleting MediaQ with an item TAKEN. The item will be orphaned.");
 					}
 					else {
+						// Frames still referenced belong to a raw socket that is already closed
+						x_openavbMediaQItemUnrefRxFrame(pMediaQInfo, &pMediaQInfo->pItems[i1]);
+						x_openavbMediaQItemUnrefTxFrame(pMediaQInfo, &pMediaQInfo->pItems[i1]);
 						openavbAvtpTimeDelete(pMediaQInfo->pItems[i1].pAvtpTime);
 						if (pMediaQInfo->pItems[i1].pPubData) {
 							free(pMediaQInfo->pItems[i1].pPubData);
@@ -455,6 +706,18 @@ bool openavbMediaQDelete(media_q_t *pMediaQ)
 				free(pMediaQInfo->pItems);
 				pMediaQInfo->pItems = NULL;
 			}
+			if (pMediaQInfo->pSlotState) {
+				free(pMediaQInfo->pSlotState);
+				pMediaQInfo->pSlotState = NULL;
+			}
+			if (pMediaQInfo->pSlotNumber) {
+				free(pMediaQInfo->pSlotNumber);
+				pMediaQInfo->pSlotNumber = NULL;
+			}
+			if (pMediaQInfo->pItemPubData) {
+				free(pMediaQInfo->pItemPubData);
+				pMediaQInfo->pItemPubData = NULL;
+			}
 			free(pMediaQ->pPvtMediaQInfo);
 			pMediaQ->pPvtMediaQInfo = NULL;
 
@@ -515,6 +778,123 @@ void openavbMediaQSetMaxStaleTail(media_q_t *pMediaQ, U32 maxStaleTailUsec)
 	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
 }
 
+bool openavbMediaQSlotModeOn(media_q_t *pMediaQ, U64 slotDurationNsecNum, U32 slotDurationDen)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
+
+	if (pMediaQ && slotDurationNsecNum > 0 && slotDurationDen > 0) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (pMediaQInfo->pItems) {
+				if (!pMediaQInfo->pSlotState) {
+					pMediaQInfo->pSlotState = calloc(pMediaQInfo->itemCount, sizeof(U32));
+				}
+				if (!pMediaQInfo->pSlotNumber) {
+					pMediaQInfo->pSlotNumber = calloc(pMediaQInfo->itemCount, sizeof(U64));
+				}
+				if (pMediaQInfo->pSlotState && pMediaQInfo->pSlotNumber) {
+					int i1;
+					for (i1 = 0; i1 < pMediaQInfo->itemCount; i1++) {
+						pMediaQInfo->pSlotState[i1] = MEDIAQ_SLOT_EMPTY;
+						pMediaQInfo->pSlotNumber[i1] = i1;
+						pMediaQInfo->pItems[i1].readIdx = 0;
+						pMediaQInfo->pItems[i1].dataLen = 0;
+						pMediaQInfo->pItems[i1].missing = FALSE;
+					}
+					pMediaQInfo->slotDurationNsecNum = slotDurationNsecNum;
+					pMediaQInfo->slotDurationDen = slotDurationDen;
+					pMediaQInfo->slotStartNsec = 0;
+					pMediaQInfo->slotStartNumber = 0;
+					pMediaQInfo->slotReleased = 0;
+					pMediaQInfo->head = -1;
+					pMediaQInfo->tail = 0;
+					pMediaQInfo->slotMode = TRUE;
+
+					AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+					return TRUE;
+				}
+				AVB_LOG_ERROR("Out of memory enabling MediaQ slot mode");
+			}
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+	return FALSE;
+}
+
+media_q_item_t *openavbMediaQSlotLock(media_q_t *pMediaQ, U64 presentationNsec)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	if (pMediaQ && presentationNsec > 0) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (pMediaQInfo->slotMode) {
+				// The first data locked sets the presentation time of the queue
+				__sync_bool_compare_and_swap(&pMediaQInfo->slotStartNsec, 0, presentationNsec);
+
+				U64 released = __sync_fetch_and_add(&pMediaQInfo->slotReleased, 0);
+				U64 baseNsec = x_openavbMediaQSlotTime(pMediaQInfo, released);
+				U64 endNsec = x_openavbMediaQSlotTime(pMediaQInfo, released + pMediaQInfo->itemCount);
+				U64 nsec = presentationNsec + MEDIAQ_SLOT_TOLERANCE_NSEC;
+
+				if (nsec >= baseNsec && nsec < endNsec) {
+					U64 slotNumber = released
+						+ ((nsec - baseNsec) * pMediaQInfo->slotDurationDen) / pMediaQInfo->slotDurationNsecNum;
+					if (slotNumber >= released + pMediaQInfo->itemCount) {
+						slotNumber = released + pMediaQInfo->itemCount - 1;
+					}
+					int idx = slotNumber % pMediaQInfo->itemCount;
+					U32 state = pMediaQInfo->pSlotState[idx];
+
+					if ((state == MEDIAQ_SLOT_EMPTY || state == MEDIAQ_SLOT_PARTIAL)
+							&& __sync_bool_compare_and_swap(&pMediaQInfo->pSlotState[idx], state, MEDIAQ_SLOT_WRITING)) {
+						if (pMediaQInfo->pSlotNumber[idx] == slotNumber) {
+							media_q_item_t *pItem = &pMediaQInfo->pItems[idx];
+							if (state == MEDIAQ_SLOT_EMPTY) {
+								memset(pItem->pPubData, 0, pItem->itemSize);
+								pItem->readIdx = 0;
+								pItem->dataLen = 0;
+								pItem->missing = FALSE;
+								openavbAvtpTimeSetToTimestampNS(pItem->pAvtpTime, x_openavbMediaQSlotTime(pMediaQInfo, slotNumber));
+							}
+							AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+							return pItem;
+						}
+
+						// The tail released the slot while it was being looked up
+						pMediaQInfo->pSlotState[idx] = state;
+					}
+				}
+			}
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+	return NULL;
+}
+
+void openavbMediaQSlotUnlock(media_q_t *pMediaQ, media_q_item_t *pItem, bool complete)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	if (pMediaQ && pItem) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (pMediaQInfo->slotMode) {
+				int idx = pItem - pMediaQInfo->pItems;
+				if (idx >= 0 && idx < pMediaQInfo->itemCount) {
+					// Make the item data visible before the state
+					__sync_synchronize();
+					pMediaQInfo->pSlotState[idx] = complete ? MEDIAQ_SLOT_COMPLETE : MEDIAQ_SLOT_PARTIAL;
+				}
+			}
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+}
+
 media_q_item_t *openavbMediaQHeadLock(media_q_t *pMediaQ)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
@@ -527,6 +907,12 @@ media_q_item_t *openavbMediaQHeadLock(media_q_t *pMediaQ)
 			}
 			if (pMediaQInfo->itemCount > 0) {
 				if (pMediaQInfo->head > -1) {
+					media_q_item_t *pHead = &pMediaQInfo->pItems[pMediaQInfo->head];
+					if (pHead->pRxFrame) {
+						// Referenced by an earlier lock that was not pushed
+						x_openavbMediaQRelRxFrame(pMediaQInfo, x_openavbMediaQItemUnrefRxFrame(pMediaQInfo, pHead));
+					}
+					x_openavbMediaQItemUnrefTxFrame(pMediaQInfo, pHead);
 					pMediaQInfo->headLocked = TRUE;
 					AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
 					// Mutex (LOCK()) if acquired stays locked
@@ -624,6 +1010,10 @@ media_q_item_t* openavbMediaQTailLock(media_q_t *pMediaQ, bool ignoreTimestamp)
 	if (pMediaQ) {
 		if (pMediaQ->pPvtMediaQInfo) {
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (pMediaQInfo->slotMode) {
+				AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+				return x_openavbMediaQSlotTailLock(pMediaQInfo, ignoreTimestamp);
+			}
 			if (pMediaQInfo->threadSafeOn) {
 				MEDIAQ_LOCK();
 			}
@@ -665,7 +1055,11 @@ void openavbMediaQTailUnlock(media_q_t *pMediaQ)
 	if (pMediaQ) {
 		if (pMediaQ->pPvtMediaQInfo) {
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
-			if (pMediaQInfo->itemCount > 0) {
+			if (pMediaQInfo->slotMode) {
+				// The slot stays released and is returned by the next tail lock
+				pMediaQInfo->tailLocked = FALSE;
+			}
+			else if (pMediaQInfo->itemCount > 0) {
 				if (pMediaQInfo->tail > -1) {
 					pMediaQInfo->tailLocked = FALSE;
 					if (pMediaQInfo->threadSafeOn) {
@@ -685,6 +1079,11 @@ bool openavbMediaQTailPull(media_q_t *pMediaQ)
 	if (pMediaQ) {
 		if (pMediaQ->pPvtMediaQInfo) {
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (pMediaQInfo->slotMode) {
+				bool ret = x_openavbMediaQSlotTailPull(pMediaQInfo);
+				AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+				return ret;
+			}
 			if (pMediaQInfo->itemCount > 0) {
 				if (pMediaQInfo->tail > -1) {
 					media_q_item_t *pTail = &pMediaQInfo->pItems[pMediaQInfo->tail];
@@ -711,6 +1110,11 @@ bool openavbMediaQTailPull(media_q_t *pMediaQ)
 					pTail->readIdx = 0;		// Reset read index
 					pTail->dataLen = 0;		// Clears out the data
 
+					if (pTail->pRxFrame) {
+						x_openavbMediaQRelRxFrame(pMediaQInfo, x_openavbMediaQItemUnrefRxFrame(pMediaQInfo, pTail));
+					}
+					x_openavbMediaQItemUnrefTxFrame(pMediaQInfo, pTail);
+
 					x_openavbMediaQIncrementTail(pMediaQInfo);
 
 					pMediaQInfo->tailLocked = FALSE;
@@ -736,7 +1140,10 @@ bool openavbMediaQTailItemTake(media_q_t *pMediaQ, media_q_item_t* pItem)
 	if (pMediaQ && pItem) {
 		if (pMediaQ->pPvtMediaQInfo) {
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
-			if (pMediaQInfo->itemCount > 0) {
+			if (pMediaQInfo->slotMode) {
+				AVB_LOG_ERROR("MediaQ items can not be taken in slot mode");
+			}
+			else if (pMediaQInfo->itemCount > 0) {
 				if (pMediaQInfo->tail > -1) {
 
 					x_openavbMediaQIncrementTail(pMediaQInfo);
@@ -773,6 +1180,10 @@ bool openavbMediaQTailItemGive(media_q_t *pMediaQ, media_q_item_t* pItem)
 				if (pMediaQInfo->threadSafeOn) {
 					MEDIAQ_LOCK();
 				}
+				if (pItem->pRxFrame) {
+					x_openavbMediaQRelRxFrame(pMediaQInfo, x_openavbMediaQItemUnrefRxFrame(pMediaQInfo, pItem));
+				}
+				x_openavbMediaQItemUnrefTxFrame(pMediaQInfo, pItem);
 				if (pMediaQInfo->itemCount > 0) {
 					if (pMediaQInfo->head == -1) {
 						// Transition from full mediaq to an available item slot. Find this item that was just give back
@@ -807,6 +1218,24 @@ bool openavbMediaQUsecTillTail(media_q_t *pMediaQ, U32 *pUsecTill)
 	if (pMediaQ && pUsecTill) {
 		if (pMediaQ->pPvtMediaQInfo) {
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (pMediaQInfo->slotMode) {
+				if (pMediaQInfo->slotStartNsec == 0) {
+					AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+					return FALSE;
+				}
+
+				// Slots are released at their presentation time whether or not they are complete
+				U64 nowNsec;
+				U64 tailNsec = x_openavbMediaQSlotTime(pMediaQInfo, pMediaQInfo->slotReleased);
+				CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNsec);
+				*pUsecTill = (tailNsec > nowNsec) ? (tailNsec - nowNsec) / NANOSECONDS_PER_USEC : 0;
+				AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+				return *pUsecTill <= MICROSECONDS_PER_SECOND * 5;
+			}
+			bool bRet = FALSE;
+			if (pMediaQInfo->threadSafeOn) {
+				MEDIAQ_LOCK();
+			}
 			if (pMediaQInfo->itemCount > 0) {
 				if (pMediaQInfo->tail > -1) {
 					media_q_item_t *pTail = &pMediaQInfo->pItems[pMediaQInfo->tail];
@@ -815,10 +1244,15 @@ bool openavbMediaQUsecTillTail(media_q_t *pMediaQ, U32 *pUsecTill)
 					
 					if (openavbAvtpTimeUsecTill(pTail->pAvtpTime, &usecTill)) {
 						*pUsecTill = usecTill;
-						return TRUE;
+						bRet = TRUE;
 					}
 				}
 			}
+			if (pMediaQInfo->threadSafeOn) {
+				MEDIAQ_UNLOCK();
+			}
+			AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+			return bRet;
 		}
 	}
 
@@ -914,7 +1348,22 @@ U32 openavbMediaQCountItems(media_q_t *pMediaQ, bool ignoreTimestamp)
 	if (pMediaQ) {
 		if (pMediaQ->pPvtMediaQInfo) {
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
-			if (pMediaQInfo->itemCount > 0) {
+			if (pMediaQInfo->slotMode) {
+				// Count the slots holding data, or only those at their presentation time
+				U64 nowNsec;
+				CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNsec);
+				int i1;
+				for (i1 = 0; i1 < pMediaQInfo->itemCount && pMediaQInfo->slotStartNsec; i1++) {
+					int idx = (pMediaQInfo->tail + i1) % pMediaQInfo->itemCount;
+					if (!ignoreTimestamp && x_openavbMediaQSlotTime(pMediaQInfo, pMediaQInfo->slotReleased + i1) > nowNsec) {
+						break;
+					}
+					if (pMediaQInfo->pSlotState[idx] != MEDIAQ_SLOT_EMPTY) {
+						itemCnt++;
+					}
+				}
+			}
+			else if (pMediaQInfo->itemCount > 0) {
 				if (pMediaQInfo->tail > -1) {
 					// Check if tail item is ready.
 					int tailIdx = pMediaQInfo->tail;
@@ -977,6 +1426,14 @@ bool openavbMediaQAnyReadyItems(media_q_t *pMediaQ, bool ignoreTimestamp)
 	if (pMediaQ) {
 		if (pMediaQ->pPvtMediaQInfo) {
 			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (pMediaQInfo->slotMode) {
+				// The tail slot is released at its presentation time even if incomplete
+				bool ready = pMediaQInfo->slotStartNsec
+					&& (x_openavbMediaQSlotTailIsPast(pMediaQInfo)
+						|| (ignoreTimestamp && pMediaQInfo->pSlotState[pMediaQInfo->tail] == MEDIAQ_SLOT_COMPLETE));
+				AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+				return ready;
+			}
 			if (pMediaQInfo->itemCount > 0) {
 				if (pMediaQInfo->tail > -1) {
 					// Check if tail item is ready.
@@ -1011,3 +1468,264 @@ bool openavbMediaQAnyReadyItems(media_q_t *pMediaQ, bool ignoreTimestamp)
 	return FALSE;
 }
 
+bool openavbMediaQRxFrameRefModeOn(media_q_t *pMediaQ, openavb_media_q_rx_frame_rel_cb_t relCB, void *pRelCtx, U32 maxRefs)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
+
+	if (pMediaQ && relCB && maxRefs > 0) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (pMediaQInfo->slotMode) {
+				AVB_LOG_ERROR("Zero copy receive is not available in slot mode");
+			}
+			else if (pMediaQInfo->pItems) {
+				if (x_openavbMediaQSaveItemPubData(pMediaQInfo)) {
+					pMediaQInfo->rxFrameRelCB = relCB;
+					pMediaQInfo->pRxFrameRelCtx = pRelCtx;
+					pMediaQInfo->rxFrameMaxRefs = maxRefs;
+					pMediaQInfo->rxFrameRefs = 0;
+					pMediaQInfo->pRxFrameCur = NULL;
+					pMediaQInfo->rxFrameCurRef = FALSE;
+					pMediaQInfo->rxFrameRefMode = TRUE;
+
+					AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+					return TRUE;
+				}
+				AVB_LOG_ERROR("Out of memory enabling MediaQ zero copy receive");
+			}
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+	return FALSE;
+}
+
+void openavbMediaQRxFrameRefModeOff(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
+
+	if (pMediaQ) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (pMediaQInfo->rxFrameRefMode) {
+				pMediaQInfo->rxFrameRefMode = FALSE;
+
+				if (pMediaQInfo->threadSafeOn) {
+					MEDIAQ_LOCK();
+				}
+				int i1;
+				for (i1 = 0; i1 < pMediaQInfo->itemCount; i1++) {
+					media_q_item_t *pItem = &pMediaQInfo->pItems[i1];
+					if (pItem->pRxFrame && !pItem->taken) {
+						x_openavbMediaQRelRxFrame(pMediaQInfo, x_openavbMediaQItemUnrefRxFrame(pMediaQInfo, pItem));
+					}
+				}
+				if (pMediaQInfo->threadSafeOn) {
+					MEDIAQ_UNLOCK();
+				}
+
+				// Anything still referenced is never handed back to the raw socket
+				pMediaQInfo->rxFrameRelCB = NULL;
+				if (pMediaQInfo->rxFrameRefs > 0) {
+					AVB_LOGF_WARNING("%u received frames still referenced when zero copy receive stopped", pMediaQInfo->rxFrameRefs);
+				}
+			}
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+}
+
+void openavbMediaQRxFrameBegin(media_q_t *pMediaQ, void *pRxFrame)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	if (pMediaQ) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			pMediaQInfo->pRxFrameCur = pRxFrame;
+			pMediaQInfo->rxFrameCurRef = FALSE;
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+}
+
+bool openavbMediaQRxFrameEnd(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	bool bRef = FALSE;
+	if (pMediaQ) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			bRef = pMediaQInfo->rxFrameCurRef;
+			pMediaQInfo->pRxFrameCur = NULL;
+			pMediaQInfo->rxFrameCurRef = FALSE;
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+	return bRef;
+}
+
+bool openavbMediaQHeadRefRxFrame(media_q_t *pMediaQ, media_q_item_t *pItem, U8 *pData, U32 dataLen)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	if (pMediaQ && pItem && pData) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (pMediaQInfo->rxFrameRefMode && pMediaQInfo->pRxFrameCur && !pMediaQInfo->rxFrameCurRef) {
+				if (pMediaQInfo->rxFrameRefs < pMediaQInfo->rxFrameMaxRefs) {
+					__sync_fetch_and_add(&pMediaQInfo->rxFrameRefs, 1);
+					pItem->pRxFrame = pMediaQInfo->pRxFrameCur;
+					pItem->pPubData = pData;
+					pItem->itemSize = dataLen;
+					pItem->dataLen = dataLen;
+					pMediaQInfo->rxFrameCurRef = TRUE;
+
+					AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+					return TRUE;
+				}
+				IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("All %u zero copy receive frames in use, copying", pMediaQInfo->rxFrameMaxRefs);
+			}
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+	return FALSE;
+}
+
+void *openavbMediaQTailDetachRxFrame(media_q_t *pMediaQ, media_q_item_t *pItem, U8 **ppData)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	void *pRxFrame = NULL;
+	if (pMediaQ && pItem && pItem->pRxFrame) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (ppData) {
+				*ppData = pItem->pPubData;
+			}
+			pRxFrame = x_openavbMediaQItemUnrefRxFrame(pMediaQInfo, pItem);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+	return pRxFrame;
+}
+
+void openavbMediaQRxFrameRelease(media_q_t *pMediaQ, void *pRxFrame)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	if (pMediaQ && pRxFrame) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			x_openavbMediaQRelRxFrame(pMediaQInfo, pRxFrame);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+}
+
+bool openavbMediaQTxFrameRefModeOn(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ);
+
+	if (pMediaQ) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (pMediaQInfo->slotMode) {
+				AVB_LOG_ERROR("Zero copy transmit is not available in slot mode");
+			}
+			else if (pMediaQInfo->pItems) {
+				if (x_openavbMediaQSaveItemPubData(pMediaQInfo)) {
+					pMediaQInfo->pTxFrameCur = NULL;
+					pMediaQInfo->txFrameCurLen = 0;
+					pMediaQInfo->pTxFrameItem = NULL;
+					pMediaQInfo->txFrameRefMode = TRUE;
+
+					AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+					return TRUE;
+				}
+				AVB_LOG_ERROR("Out of memory enabling MediaQ zero copy transmit");
+			}
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ);
+	return FALSE;
+}
+
+void openavbMediaQTxFrameBegin(media_q_t *pMediaQ, U8 *pFrame, U32 frameLen)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	if (pMediaQ) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			pMediaQInfo->pTxFrameCur = pFrame;
+			pMediaQInfo->txFrameCurLen = frameLen;
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+}
+
+void openavbMediaQTxFrameEnd(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	if (pMediaQ) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			if (pMediaQInfo->threadSafeOn) {
+				MEDIAQ_LOCK();
+			}
+			media_q_item_t *pItem = pMediaQInfo->pTxFrameItem;
+			if (pItem) {
+				// Not sent in this frame. The raw socket refills the frame on the next
+				// call, so the item keeps a copy in its own storage.
+				U8 *pData = pItem->pPubData;
+				x_openavbMediaQItemUnrefTxFrame(pMediaQInfo, pItem);
+				memcpy(pItem->pPubData, pData, pItem->dataLen);
+			}
+			pMediaQInfo->pTxFrameCur = NULL;
+			pMediaQInfo->txFrameCurLen = 0;
+			if (pMediaQInfo->threadSafeOn) {
+				MEDIAQ_UNLOCK();
+			}
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+}
+
+bool openavbMediaQHeadRefTxFrame(media_q_t *pMediaQ, media_q_item_t *pItem)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MEDIAQ_DETAIL);
+
+	if (pMediaQ && pItem) {
+		if (pMediaQ->pPvtMediaQInfo) {
+			media_q_info_t *pMediaQInfo = (media_q_info_t *)(pMediaQ->pPvtMediaQInfo);
+			// Only an item that the map TX callback pulls next may share the frame,
+			// otherwise the callback would copy another item over it.
+			if (pMediaQInfo->txFrameRefMode && pMediaQInfo->pTxFrameCur && !pMediaQInfo->pTxFrameItem
+				&& pMediaQInfo->tail == -1 && pItem->dataLen == 0) {
+				pItem->pTxFrame = pMediaQInfo->pTxFrameCur;
+				pItem->pPubData = pMediaQInfo->pTxFrameCur;
+				// Never more than the item's own storage so that an unsent item can be copied back
+				pItem->itemSize = pMediaQInfo->txFrameCurLen < pMediaQInfo->itemSize ? pMediaQInfo->txFrameCurLen : pMediaQInfo->itemSize;
+				pMediaQInfo->pTxFrameItem = pItem;
+
+				AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+				return TRUE;
+			}
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MEDIAQ_DETAIL);
+	return FALSE;
+}
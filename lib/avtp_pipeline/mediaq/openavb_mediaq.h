@@ -52,10 +52,49 @@ void openavbMediaQSetMaxStaleTail(media_q_t *pMediaQ, U32 maxStaleTailUsec);
 media_q_item_t *openavbMediaQHeadLock(media_q_t *pMediaQ);
 void openavbMediaQHeadUnlock(media_q_t *pMediaQ);
 bool openavbMediaQHeadPush(media_q_t *pMediaQ);
+bool openavbMediaQSlotModeOn(media_q_t *pMediaQ, U64 slotDurationNsecNum, U32 slotDurationDen);
+media_q_item_t *openavbMediaQSlotLock(media_q_t *pMediaQ, U64 presentationNsec);
+void openavbMediaQSlotUnlock(media_q_t *pMediaQ, media_q_item_t *pItem, bool complete);
 media_q_item_t* openavbMediaQTailLock(media_q_t *pMediaQ, bool ignoreTimestamp);
 void openavbMediaQTailUnlock(media_q_t *pMediaQ);
 bool openavbMediaQTailPull(media_q_t *pMediaQ);
 bool openavbMediaQUsecTillTail(media_q_t *pMediaQ, U32 *pUsecTill);
 bool openavbMediaQIsAvailableBytes(media_q_t *pMediaQ, U32 bytes, bool ignoreTimestamp);
+bool openavbMediaQHeadRefRxFrame(media_q_t *pMediaQ, media_q_item_t *pItem, U8 *pData, U32 dataLen);
+void *openavbMediaQTailDetachRxFrame(media_q_t *pMediaQ, media_q_item_t *pItem, U8 **ppData);
+void openavbMediaQRxFrameRelease(media_q_t *pMediaQ, void *pRxFrame);
+bool openavbMediaQHeadRefTxFrame(media_q_t *pMediaQ, media_q_item_t *pItem);
+
+// Zero copy receive. Used by AVTP only.
+
+// Returns a frame referenced by the media queue to the raw socket it came from.
+typedef void (*openavb_media_q_rx_frame_rel_cb_t)(void *pRelCtx, void *pRxFrame);
+
+// Enable zero copy receive. Mapping modules may then reference the frame passed to their
+// RX callback with openavbMediaQHeadRefRxFrame(), up to maxRefs frames at a time including
+// frames detached by the interface. Must be called after openavbMediaQSetSize().
+bool openavbMediaQRxFrameRefModeOn(media_q_t *pMediaQ, openavb_media_q_rx_frame_rel_cb_t relCB, void *pRelCtx, U32 maxRefs);
+
+// Release every frame still referenced by queued items and stop calling relCB.
+// Must be called before the raw socket is closed.
+void openavbMediaQRxFrameRefModeOff(media_q_t *pMediaQ);
+
+// Bracket the map RX callback. End returns TRUE if an item now references the frame,
+// in which case the caller must not release it.
+void openavbMediaQRxFrameBegin(media_q_t *pMediaQ, void *pRxFrame);
+bool openavbMediaQRxFrameEnd(media_q_t *pMediaQ);
+
+// Zero copy transmit. Used by AVTP only.
+
+// Enable zero copy transmit. Interface modules may then fill the frame being prepared
+// by the map TX callback with openavbMediaQHeadRefTxFrame(). Must be called after
+// openavbMediaQSetSize().
+bool openavbMediaQTxFrameRefModeOn(media_q_t *pMediaQ);
+
+// Bracket the interface and map TX callbacks with the AVTP frame, after its Ethernet
+// header, that the map TX callback fills. End copies an item that was not sent out of
+// the frame.
+void openavbMediaQTxFrameBegin(media_q_t *pMediaQ, U8 *pFrame, U32 frameLen);
+void openavbMediaQTxFrameEnd(media_q_t *pMediaQ);
 
 #endif  // OPENAVB_MEDIA_Q_H
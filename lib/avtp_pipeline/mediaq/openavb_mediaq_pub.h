@@ -70,6 +70,11 @@ typedef struct {
 	/// Flag indicating mediaQ item has been taken by a call to openavbMediaQTailItemTake()
 	bool taken;
 
+	/// In presentation time ordered mode, set on an item released by the tail
+	/// that was not completed by its presentation time. Any part of the item
+	/// that was not written is zero.
+	bool missing;
+
 	/// Public extra map data
 	void *pPubMapData;
 
@@ -78,6 +83,16 @@ typedef struct {
 
 	/// For use internally by the interface. Often may not be used.
 	void *pPvtIntfData;
+
+	/// Receive frame referenced by the item in zero copy receive mode. When set
+	/// pPubData points into the frame instead of the item's own storage.
+	/// See openavbMediaQHeadRefRxFrame()
+	void *pRxFrame;
+
+	/// Transmit frame referenced by the item in zero copy transmit mode. When set
+	/// pPubData points into the frame instead of the item's own storage.
+	/// See openavbMediaQHeadRefTxFrame()
+	void *pTxFrame;
 } media_q_item_t;
 
 /** Media Queue structure.
@@ -221,6 +236,51 @@ void openavbMediaQSetMaxLatency(media_q_t *pMediaQ, U32 maxLatencyUsec);
  */
 void openavbMediaQSetMaxStaleTail(media_q_t *pMediaQ, U32 maxStaleTailUsec);
 
+/** Enable presentation time ordered mode.
+ * In this mode each media queue item is a slot holding a fixed duration of
+ * media, and consecutive items hold consecutive presentation times. A listener
+ * mapping module places data with openavbMediaQSlotLock() into the slot that
+ * matches its presentation time, so data that arrives out of order can be
+ * stored without waiting for earlier slots to complete. The tail releases
+ * slots strictly in presentation time order; a slot that is not complete by
+ * its presentation time is released with the missing flag set.
+ *
+ * Slot state is kept per item and updated with atomic operations, so the
+ * mapping module and the interface module never hold a lock across slots.
+ * openavbMediaQHeadLock() and openavbMediaQTailItemTake() are not available
+ * in this mode. Must be called after openavbMediaQSetSize().
+ * \param pMediaQ A pointer to the media_q_t structure
+ * \param slotDurationNsecNum Slot duration numerator in nanoseconds
+ * \param slotDurationDen Slot duration denominator. The slot duration is
+ *        slotDurationNsecNum / slotDurationDen nanoseconds which allows exact
+ *        durations such as 6 frames at 44.1KHz.
+ * \return TRUE on success or FALSE on failure
+ */
+bool openavbMediaQSlotModeOn(media_q_t *pMediaQ, U64 slotDurationNsecNum, U32 slotDurationDen);
+
+/** Lock the slot for a presentation time.
+ * Finds the slot holding presentationNsec and locks it for writing. The first
+ * slot locked sets the presentation time of the queue. When a slot is locked
+ * for the first time its data is cleared and its pAvtpTime is set to the start
+ * of the slot; the caller places data at the offset of presentationNsec from
+ * that time and maintains dataLen.
+ * \param pMediaQ A pointer to the media_q_t structure.
+ * \param presentationNsec Presentation time of the data to be written.
+ * \return A pointer to the media queue item for the slot. Returns NULL if the
+ *         slot has already been released (data is late), is beyond the size
+ *         of the queue, is complete or is locked.
+ */
+media_q_item_t *openavbMediaQSlotLock(media_q_t *pMediaQ, U64 presentationNsec);
+
+/** Unlock a slot.
+ * Unlock a slot previously locked with openavbMediaQSlotLock.
+ * \param pMediaQ A pointer to the media_q_t structure.
+ * \param pItem The item returned by openavbMediaQSlotLock.
+ * \param complete TRUE if the slot holds all of its data and can be released
+ *        to the tail at its presentation time.
+ */
+void openavbMediaQSlotUnlock(media_q_t *pMediaQ, media_q_item_t *pItem, bool complete);
+
 /** Get pointer to the head item and lock it.
  *
  * Get the storage location for the next item that can be added to the circle
@@ -320,6 +380,69 @@ bool openavbMediaQTailItemTake(media_q_t *pMediaQ, media_q_item_t* pItem);
  */
 bool openavbMediaQTailItemGive(media_q_t *pMediaQ, media_q_item_t* pItem);
 
+/** Reference the received frame from the head item.
+ *
+ * Used by a listener mapping module in place of copying a payload into the
+ * locked head item. When zero copy receive is enabled for the stream the item
+ * keeps the raw socket frame being processed and pPubData, itemSize and dataLen
+ * are set to the payload within it. The frame is returned to the raw socket
+ * when the item is pulled from the tail or given back. A frame can back only
+ * one item.
+ *
+ * \param pMediaQ A pointer to the media_q_t structure.
+ * \param pItem The head item returned by openavbMediaQHeadLock().
+ * \param pData Payload within the frame passed to the map RX callback.
+ * \param dataLen Length of the payload.
+ * \return TRUE if the item references the frame. FALSE if zero copy receive
+ *         is off or the reference limit is reached, in which case the mapping
+ *         module copies the payload as usual.
+ */
+bool openavbMediaQHeadRefRxFrame(media_q_t *pMediaQ, media_q_item_t *pItem, U8 *pData, U32 dataLen);
+
+/** Let the head item use the transmit frame as its storage.
+ *
+ * Used by a talker interface module that produces complete frames, such as
+ * those for a mapping module passing the AVTP header through, in place of
+ * filling the item's own storage. When zero copy transmit is enabled for the
+ * stream and the media queue holds no other pushed item, pPubData and itemSize
+ * are set to the AVTP frame being prepared for the raw socket. The mapping
+ * module then sends the item without copying it. If the item is not sent by
+ * the end of the interface and mapping TX callbacks its data is copied into its
+ * own storage. Must be called from the interface TX callback right after
+ * openavbMediaQHeadLock() and before any data is written to the item. The item
+ * must not be taken with openavbMediaQTailItemTake().
+ *
+ * \param pMediaQ A pointer to the media_q_t structure.
+ * \param pItem The head item returned by openavbMediaQHeadLock().
+ * \return TRUE if pPubData now points into the transmit frame. FALSE if zero
+ *         copy transmit is off or the frame is not available, in which case the
+ *         interface module fills the item as usual.
+ */
+bool openavbMediaQHeadRefTxFrame(media_q_t *pMediaQ, media_q_item_t *pItem);
+
+/** Detach the received frame from the locked tail item.
+ *
+ * Lets an interface module keep using the payload of an item after the item
+ * is pulled, for example while a downstream buffer wraps it. The item gets its
+ * own storage back and the caller owns the frame until it calls
+ * openavbMediaQRxFrameRelease().
+ *
+ * \param pMediaQ A pointer to the media_q_t structure.
+ * \param pItem The tail item returned by openavbMediaQTailLock().
+ * \param ppData Set to the payload pointer the item held.
+ * \return The frame, or NULL if the item does not reference a frame.
+ */
+void *openavbMediaQTailDetachRxFrame(media_q_t *pMediaQ, media_q_item_t *pItem, U8 **ppData);
+
+/** Release a frame detached with openavbMediaQTailDetachRxFrame().
+ *
+ * May be called from any thread.
+ *
+ * \param pMediaQ A pointer to the media_q_t structure.
+ * \param pRxFrame The frame returned by openavbMediaQTailDetachRxFrame().
+ */
+void openavbMediaQRxFrameRelease(media_q_t *pMediaQ, void *pRxFrame);
+
 /** Get microseconds until tail is ready.
  *
  * \param pMediaQ A pointer to the media_q_t structure.
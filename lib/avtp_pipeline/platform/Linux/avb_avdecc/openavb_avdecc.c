@@ -78,6 +78,10 @@ void openavbAvdeccHostUsage(char *programName)
 		"Usage: %s [options] file...\n"
 		"  -I val     Use given (val) interface globally, can be overriden by giving the ifname= option to the config line.\n"
 		"  -l val     Filename of the log file to use.  If not specified, results will be logged to stderr.\n"
+		"  -g val     Write the entity model built from the ini files to the C source file (val) and exit.\n"
+		"             Build with AVB_AEM_COMPILED_MODEL set to this file to compile the model into openavb_avdecc.\n"
+		"  -c         Build the entity model from the ini files at runtime and from the compiled model, log the\n"
+		"             build time and memory of both, check that they serve the same descriptors and exit.\n"
 		"\n"
 		"Examples:\n"
 		"  %s talker.ini\n"
@@ -86,8 +90,12 @@ void openavbAvdeccHostUsage(char *programName)
 		"    Control 2 streams with data from the ini files.\n\n"
 		"  %s -I eth0 talker1.ini listener2.ini\n"
 		"    Control 2 streams with data from the ini files, using the eth0 interface.\n\n"
+		"  %s -I eth0 -g aem_model.c talker1.ini listener2.ini\n"
+		"    Generate a compiled entity model for the 2 streams.\n\n"
+		"  %s -I eth0 -c talker1.ini listener2.ini\n"
+		"    Check the compiled entity model against the 2 streams.\n\n"
 		,
-		programName, programName, programName, programName);
+		programName, programName, programName, programName, programName, programName);
 }
 
 /**********************************************
@@ -100,6 +108,8 @@ int main(int argc, char *argv[])
 	char *programName;
 	char *optIfnameGlobal = NULL;
 	char *optLogFileName = NULL;
+	char *optModelFileName = NULL;
+	bool optCheckModel = FALSE;
 
 	programName = strrchr(argv[0], '/');
 	programName = programName ? programName + 1 : argv[0];
@@ -112,7 +122,7 @@ int main(int argc, char *argv[])
 	// Process command line
 	bool optDone = FALSE;
 	while (!optDone) {
-		int opt = getopt(argc, argv, "hI:l:");
+		int opt = getopt(argc, argv, "hI:l:g:c");
 		if (opt != EOF) {
 			switch (opt) {
 				case 'I':
@@ -121,6 +131,12 @@ int main(int argc, char *argv[])
 				case 'l':
 					optLogFileName = strdup(optarg);
 					break;
+				case 'g':
+					optModelFileName = strdup(optarg);
+					break;
+				case 'c':
+					optCheckModel = TRUE;
+					break;
 				case 'h':
 				default:
 					openavbAvdeccHostUsage(programName);
@@ -135,6 +151,16 @@ int main(int argc, char *argv[])
 	int iniIdx = optind;
 	int tlCount = argc - iniIdx;
 
+	if (optCheckModel) {
+		bool ok = osalAvdeccCheckModel(optLogFileName, optIfnameGlobal, (const char **) (argv + iniIdx), tlCount);
+		exit(ok ? 0 : -1);
+	}
+
+	if (optModelFileName) {
+		bool ok = osalAvdeccGenerateModel(optLogFileName, optIfnameGlobal, (const char **) (argv + iniIdx), tlCount, optModelFileName);
+		exit(ok ? 0 : -1);
+	}
+
 	if (!osalAvdeccInitialize(optLogFileName, optIfnameGlobal, (const char **) (argv + iniIdx), tlCount)) {
 		osalAvdeccFinalize();
 		exit(-1);
@@ -0,0 +1,309 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+
+
+/*
+* MODULE SUMMARY : Capture clock estimator simulation.
+*
+* Feeds the capture clock estimator (cce) with the observations an interface
+* module makes of a sound card: the position of the newest captured frame,
+* which the card only updates once per period, and the time of that update,
+* late by a random delay. The card runs at a ppm offset from gPTP with a slow
+* wander, and overruns drop frames now and then. The estimated capture time of
+* the last frame of every item is compared with the true one, and after the
+* estimator has settled the mean and the scatter are checked against a bound.
+* The observation delay is not known to the estimator; a mean error near the
+* mean delay means it dated the frames by the delayed observations.
+*
+* A trace of "framePos timeNS [trueTimeNS]" lines can be replayed instead. The
+* true capture time column is optional; without it only the scatter of the
+* item to item intervals is reported.
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "openavb_types_pub.h"
+#include "openavb_cce.h"
+#include "openavb_clock_sim.h"
+
+#define	AVB_LOG_COMPONENT	"CCE Sim"
+#include "openavb_log_pub.h"
+
+// Time allowed for the estimator to settle before the output is checked
+#define SIM_SETTLE_SEC			10
+// An overrun drops SIM_OVERRUN_FRAMES every SIM_OVERRUN_EVERY_SEC
+#define SIM_OVERRUN_EVERY_SEC	127
+#define SIM_OVERRUN_FRAMES		480
+
+typedef struct {
+	clock_sim_cfg_t clk;
+	double minutes;
+	U32 periodFrames;
+	U32 window;
+	char *traceFile;
+} sim_cfg_t;
+
+typedef struct {
+	U64 items;
+	// Estimated minus the true capture time, after settling. The step is the change from the last item.
+	clock_sim_stats_t err;
+	// Observed minus the true capture time
+	clock_sim_stats_t raw;
+	double nsPerCall;
+} sim_result_t;
+
+static void x_resultInit(sim_result_t *pRes)
+{
+	memset(pRes, 0, sizeof(*pRes));
+	openavbClockSimStatsInit(&pRes->err);
+	openavbClockSimStatsInit(&pRes->raw);
+}
+
+static U64 x_nowNS(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (U64)ts.tv_sec * NANOSECONDS_PER_SECOND + ts.tv_nsec;
+}
+
+// Synthetic sound card. Frame n of the card is captured at trueTime(n).
+static void x_runSim(const sim_cfg_t *pCfg, sim_result_t *pRes)
+{
+	const clock_sim_cfg_t *pClk = &pCfg->clk;
+	const long double nsPerFrame = (long double)NANOSECONDS_PER_SECOND / pClk->audioRate;
+	const U64 totalItems = (U64)(pCfg->minutes * 60.0 * pClk->audioRate / pClk->framesPerItem);
+	const U64 settleItems = (U64)SIM_SETTLE_SEC * pClk->audioRate / pClk->framesPerItem;
+	const U64 overrunEvery = (U64)SIM_OVERRUN_EVERY_SEC * pClk->audioRate / pClk->framesPerItem;
+	long double trueTime = 3600.0L * NANOSECONDS_PER_SECOND;
+	U64 framePos = 0, lastSettle = 0, k, clocks = 0, calls = 0;
+	double prevErr = 0;
+	cce_t cce;
+
+	openavbClockSimSeed(pClk->seed);
+	x_resultInit(pRes);
+	openavbCceInit(&cce, pClk->audioRate, pCfg->window);
+
+	for (k = 0; k < totalItems; k++) {
+		U64 itemEnd, hwPos, obsTime, stamp, t0;
+		long double hwTime, itemTime;
+		double secs = (double)(trueTime - 3600.0L * NANOSECONDS_PER_SECOND) / NANOSECONDS_PER_SECOND;
+		double ppm = openavbClockSimPPM(pClk, secs);
+		long double framePeriod = nsPerFrame / (1.0L + ppm * 1e-6L);
+
+		if (overrunEvery && k % overrunEvery == overrunEvery - 1) {
+			// The frames are captured but never read, positions jump ahead
+			trueTime += framePeriod * SIM_OVERRUN_FRAMES;
+			openavbCceReset(&cce);
+			lastSettle = k;
+		}
+
+		// The item is complete once its last frame is captured
+		itemEnd = framePos + pClk->framesPerItem;
+		itemTime = trueTime + framePeriod * pClk->framesPerItem;
+
+		// The card reports the end of the last whole period, on the period
+		// interrupt, and the reader sees that timestamp late
+		hwPos = ((framePos + pClk->framesPerItem) / pCfg->periodFrames) * pCfg->periodFrames;
+		hwTime = itemTime - framePeriod * (long double)(itemEnd - hwPos);
+		obsTime = (U64)hwTime + openavbClockSimDelayNS(pClk->jitterUsec);
+
+		t0 = x_nowNS();
+		openavbCceObserve(&cce, hwPos, obsTime);
+		stamp = openavbCceTimeAt(&cce, itemEnd);
+		clocks += x_nowNS() - t0;
+		calls++;
+
+		if (k >= lastSettle + settleItems) {
+			double err = (double)((long double)stamp - itemTime);
+			double raw = (double)((long double)obsTime - hwTime);
+			openavbClockSimStatsAdd(&pRes->err, err, pRes->err.count ? err - prevErr : 0);
+			openavbClockSimStatsAdd(&pRes->raw, raw, 0);
+			prevErr = err;
+		}
+
+		framePos = itemEnd;
+		trueTime = itemTime;
+		pRes->items++;
+	}
+
+	pRes->nsPerCall = calls ? (double)clocks / calls : 0;
+}
+
+// Replay a recorded trace. Without a true time column the error is taken
+// against a straight line through the trace, the step still shows scatter.
+static bool x_runTrace(const sim_cfg_t *pCfg, sim_result_t *pRes)
+{
+	FILE *pFile = fopen(pCfg->traceFile, "r");
+	unsigned long long pos, ts, truth;
+	U64 lines = 0, prevPos = 0, prevStamp = 0;
+	double nsPerFrame = (double)NANOSECONDS_PER_SECOND / pCfg->clk.audioRate;
+	double prevErr = 0;
+	char line[256];
+	cce_t cce;
+
+	if (!pFile) {
+		AVB_LOGF_ERROR("Unable to open trace %s", pCfg->traceFile);
+		return FALSE;
+	}
+
+	x_resultInit(pRes);
+	openavbCceInit(&cce, pCfg->clk.audioRate, pCfg->window);
+	while (fgets(line, sizeof(line), pFile)) {
+		int cnt = sscanf(line, "%llu %llu %llu", &pos, &ts, &truth);
+		U64 stamp;
+
+		if (cnt < 2) {
+			continue;
+		}
+		openavbCceObserve(&cce, pos, ts);
+		stamp = openavbCceTimeAt(&cce, pos);
+		lines++;
+
+		if (lines > (U64)SIM_SETTLE_SEC * pCfg->clk.audioRate / pCfg->periodFrames) {
+			double err, raw;
+			if (cnt == 3) {
+				err = (double)stamp - (double)truth;
+				raw = (double)ts - (double)truth;
+			}
+			else {
+				// Interval error against the fitted rate
+				double expect = (double)(pos - prevPos) * nsPerFrame * (1.0 - openavbCceRatePPB(&cce) * 1e-9);
+				err = (double)(stamp - prevStamp) - expect;
+				raw = 0;
+			}
+			openavbClockSimStatsAdd(&pRes->err, err, pRes->err.count ? err - prevErr : 0);
+			openavbClockSimStatsAdd(&pRes->raw, raw, 0);
+			prevErr = err;
+		}
+		prevPos = pos;
+		prevStamp = stamp;
+		pRes->items++;
+	}
+	fclose(pFile);
+	return TRUE;
+}
+
+static const sim_cfg_t simDefaults = { { 48000, 6, 37.5, 2.0, 20, 1, 1000 }, 30.0, 48, 0, NULL };
+
+static void openavbCceSimUsage(char *programName)
+{
+	printf(
+		"\n"
+		"Usage: %s [options]\n"
+		"  -h         Prints this message.\n"
+		"  -m val     Minutes of capture to simulate (default 30).\n"
+		"  -P val     Frames per sound card period (default 48).\n"
+		,
+		programName);
+	openavbClockSimUsage(&simDefaults.clk, "sound card", "delay of the observed timestamps");
+	printf(
+		"  -W val     Estimator window in observations (default %u).\n"
+		"  -e val     Bound in ns; the run fails if the mean error or the RMS\n"
+		"             scatter of the estimated capture times exceeds it\n"
+		"             (default 1000).\n"
+		"  -t file    Replay a trace of \"framePos timeNS [trueTimeNS]\" lines\n"
+		"             instead of the synthetic sound card.\n"
+		"\n"
+		"Examples:\n"
+		"  %s -r 44100 -P 441 -j 100\n"
+		"    A 44.1 kHz card with 10 ms periods read with up to 100 us of delay.\n\n"
+		,
+		CCE_WINDOW, programName);
+}
+
+int main(int argc, char *argv[])
+{
+	sim_cfg_t cfg = simDefaults;
+	sim_result_t res;
+	bool pass;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "hm:P:W:t:" CLOCK_SIM_OPTIONS)) != -1) {
+		if (openavbClockSimOption(&cfg.clk, opt, optarg)) {
+			continue;
+		}
+		switch (opt) {
+			case 'm':
+				cfg.minutes = strtod(optarg, NULL);
+				break;
+			case 'P':
+				cfg.periodFrames = strtoul(optarg, NULL, 10);
+				break;
+			case 'W':
+				cfg.window = strtoul(optarg, NULL, 10);
+				break;
+			case 't':
+				cfg.traceFile = optarg;
+				break;
+			case 'h':
+			default:
+				openavbCceSimUsage(argv[0]);
+				return opt == 'h' ? 0 : -1;
+		}
+	}
+	if (cfg.minutes * 60.0 <= SIM_SETTLE_SEC || cfg.clk.audioRate < 100 || cfg.clk.framesPerItem < 1 || cfg.periodFrames < 1) {
+		openavbCceSimUsage(argv[0]);
+		return -1;
+	}
+
+	avbLogInit();
+
+	if (cfg.traceFile) {
+		if (!x_runTrace(&cfg, &res)) {
+			avbLogExit();
+			return -1;
+		}
+		printf("trace %s, %u Hz\n", cfg.traceFile, cfg.clk.audioRate);
+	}
+	else {
+		x_runSim(&cfg, &res);
+		printf("%.1f min, %u Hz, %u frames/item, %u frames/period, card %+.3f ppm (+/- %.3f), delay < %u us\n",
+			cfg.minutes, cfg.clk.audioRate, cfg.clk.framesPerItem, cfg.periodFrames, cfg.clk.ppm, cfg.clk.wanderPPM, cfg.clk.jitterUsec);
+	}
+	printf("%-10s %12s %12s %12s %12s %12s %12s\n", "", "items", "mean", "min", "max", "rms scatter", "max step");
+	printf("%-10s %12llu %12.0f %12.0f %12.0f %12.1f %12.1f  (ns)\n", "estimate",
+		(unsigned long long)res.items, openavbClockSimStatsMean(&res.err), res.err.min, res.err.max,
+		openavbClockSimStatsScatter(&res.err), res.err.stepMax);
+	if (!cfg.traceFile || res.raw.max > res.raw.min) {
+		printf("%-10s %12s %12s %12.0f %12.0f  (ns)\n", "observed", "", "", res.raw.min, res.raw.max);
+	}
+	if (res.nsPerCall > 0) {
+		printf("%.1f ns per observation and estimate\n", res.nsPerCall);
+	}
+
+	pass = res.err.count > 0 && fabs(openavbClockSimStatsMean(&res.err)) <= cfg.clk.boundNS
+		&& openavbClockSimStatsScatter(&res.err) <= cfg.clk.boundNS;
+	return openavbClockSimDone(pass);
+}
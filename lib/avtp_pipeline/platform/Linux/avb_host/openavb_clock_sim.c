@@ -0,0 +1,159 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+
+
+/*
+* MODULE SUMMARY : Helpers shared by the clock simulations.
+*
+* The simulated clock, the random delays, the error statistics and the
+* command line options that the media clock synthesizer and the capture clock
+* estimator simulations have in common.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "openavb_clock_sim.h"
+
+#define	AVB_LOG_COMPONENT	"Clock Sim"
+#include "openavb_log_pub.h"
+
+static U32 clockSimRand = 1;
+
+void openavbClockSimSeed(U32 seed)
+{
+	clockSimRand = seed ? seed : 1;
+}
+
+U64 openavbClockSimDelayNS(U32 maxUsec)
+{
+	if (!maxUsec) {
+		return 0;
+	}
+
+	// xorshift32
+	clockSimRand ^= clockSimRand << 13;
+	clockSimRand ^= clockSimRand >> 17;
+	clockSimRand ^= clockSimRand << 5;
+	return clockSimRand % (maxUsec * NANOSECONDS_PER_USEC);
+}
+
+double openavbClockSimPPM(const clock_sim_cfg_t *pCfg, double secs)
+{
+	return pCfg->ppm + pCfg->wanderPPM * sin(2.0 * M_PI * secs / CLOCK_SIM_WANDER_PERIOD_SEC);
+}
+
+void openavbClockSimStatsInit(clock_sim_stats_t *pStats)
+{
+	memset(pStats, 0, sizeof(*pStats));
+	pStats->min = 1e30;
+	pStats->max = -1e30;
+}
+
+void openavbClockSimStatsAdd(clock_sim_stats_t *pStats, double err, double step)
+{
+	pStats->count++;
+	pStats->sum += err;
+	pStats->sumSq += err * err;
+	pStats->last = err;
+	if (err < pStats->min) {
+		pStats->min = err;
+	}
+	if (err > pStats->max) {
+		pStats->max = err;
+	}
+	if (fabs(step) > pStats->stepMax) {
+		pStats->stepMax = fabs(step);
+	}
+}
+
+double openavbClockSimStatsMean(const clock_sim_stats_t *pStats)
+{
+	return pStats->count ? pStats->sum / pStats->count : 0;
+}
+
+double openavbClockSimStatsScatter(const clock_sim_stats_t *pStats)
+{
+	double mean = openavbClockSimStatsMean(pStats);
+	return pStats->count ? sqrt(pStats->sumSq / pStats->count - mean * mean) : 0;
+}
+
+bool openavbClockSimOption(clock_sim_cfg_t *pCfg, int opt, const char *arg)
+{
+	switch (opt) {
+		case 'r':
+			pCfg->audioRate = strtoul(arg, NULL, 10);
+			return TRUE;
+		case 'f':
+			pCfg->framesPerItem = strtoul(arg, NULL, 10);
+			return TRUE;
+		case 'p':
+			pCfg->ppm = strtod(arg, NULL);
+			return TRUE;
+		case 'w':
+			pCfg->wanderPPM = strtod(arg, NULL);
+			return TRUE;
+		case 'j':
+			pCfg->jitterUsec = strtoul(arg, NULL, 10);
+			return TRUE;
+		case 's':
+			pCfg->seed = strtoul(arg, NULL, 10);
+			return TRUE;
+		case 'e':
+			pCfg->boundNS = strtoul(arg, NULL, 10);
+			return TRUE;
+		default:
+			return FALSE;
+	}
+}
+
+void openavbClockSimUsage(const clock_sim_cfg_t *pDefaults, const char *clockName, const char *delayName)
+{
+	printf(
+		"  -r val     Audio sample rate (default %u).\n"
+		"  -f val     Frames per item (default %u).\n"
+		"  -p val     Rate offset of the %s from gPTP in ppm (default %g).\n"
+		"  -w val     Amplitude of the %s rate wander in ppm (default %g).\n"
+		"  -j val     Maximum %s in usec (default %u).\n"
+		"  -s val     Random seed (default %u).\n"
+		,
+		pDefaults->audioRate, pDefaults->framesPerItem, clockName, pDefaults->ppm,
+		clockName, pDefaults->wanderPPM, delayName, pDefaults->jitterUsec, pDefaults->seed);
+}
+
+int openavbClockSimDone(bool pass)
+{
+	printf("%s\n", pass ? "PASS" : "FAIL");
+	avbLogExit();
+	return pass ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+
+
+/*
+* MODULE SUMMARY : Helpers shared by the clock simulations.
+*/
+
+#ifndef OPENAVB_CLOCK_SIM_H
+#define OPENAVB_CLOCK_SIM_H
+
+#include "openavb_types_pub.h"
+
+// Period of the simulated clock rate wander
+#define CLOCK_SIM_WANDER_PERIOD_SEC	900.0
+
+// getopt() string of the options handled by openavbClockSimOption()
+#define CLOCK_SIM_OPTIONS			"r:f:p:w:j:s:e:"
+
+// Settings of the simulated clock and the check, common to the simulations
+typedef struct {
+	U32 audioRate;
+	U32 framesPerItem;
+	// Rate offset of the simulated clock from gPTP, and the amplitude of its wander
+	double ppm;
+	double wanderPPM;
+	// Largest random delay added to the observed times
+	U32 jitterUsec;
+	U32 seed;
+	U32 boundNS;
+} clock_sim_cfg_t;
+
+// Statistics of a series of errors, in ns
+typedef struct {
+	U64 count;
+	double min;
+	double max;
+	double sum;
+	double sumSq;
+	double stepMax;
+	double last;
+} clock_sim_stats_t;
+
+// Restart the random sequence. Runs with the same seed see the same delays.
+void openavbClockSimSeed(U32 seed);
+
+// Random delay below maxUsec, in ns
+U64 openavbClockSimDelayNS(U32 maxUsec);
+
+// Rate offset of the simulated clock from gPTP in ppm, secs into the run
+double openavbClockSimPPM(const clock_sim_cfg_t *pCfg, double secs);
+
+void openavbClockSimStatsInit(clock_sim_stats_t *pStats);
+
+// Record one error, and its change from the previous one
+void openavbClockSimStatsAdd(clock_sim_stats_t *pStats, double err, double step);
+
+double openavbClockSimStatsMean(const clock_sim_stats_t *pStats);
+
+// RMS of the errors around their mean
+double openavbClockSimStatsScatter(const clock_sim_stats_t *pStats);
+
+// Handle one of the CLOCK_SIM_OPTIONS. Returns FALSE for any other option.
+bool openavbClockSimOption(clock_sim_cfg_t *pCfg, int opt, const char *arg);
+
+// Print the usage of the CLOCK_SIM_OPTIONS except -e, whose meaning depends on the simulation.
+// clockName names the simulated clock and delayName the delay added by -j.
+void openavbClockSimUsage(const clock_sim_cfg_t *pDefaults, const char *clockName, const char *delayName);
+
+// Print the verdict and close the log. Returns the exit code of the simulation.
+int openavbClockSimDone(bool pass);
+
+#endif // OPENAVB_CLOCK_SIM_H
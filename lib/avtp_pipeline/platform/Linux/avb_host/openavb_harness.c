@@ -74,6 +74,7 @@ extern bool openavbIntfViewerInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *p
 
 // Linux interface modules
 extern bool openavbIntfAlsaInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfFifoInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 extern bool openavbIntfMpeg2tsFileInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 extern bool openavbIntfWavFileInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 #ifdef AVB_FEATURE_GSTREAMER
@@ -213,6 +214,7 @@ int main(int argc, char *argv[])
 	registerStaticIntfModule(openavbIntfToneGenInitialize);
 	registerStaticIntfModule(openavbIntfViewerInitialize);
 	registerStaticIntfModule(openavbIntfAlsaInitialize);
+	registerStaticIntfModule(openavbIntfFifoInitialize);
 	registerStaticIntfModule(openavbIntfMpeg2tsFileInitialize);
 	registerStaticIntfModule(openavbIntfWavFileInitialize);
 #ifdef AVB_FEATURE_GSTREAMER
@@ -465,6 +467,11 @@ int main(int argc, char *argv[])
 										openavbTLStat(tlHandleList[i1], TL_STAT_TX_FRAMES),
 										openavbTLStat(tlHandleList[i1], TL_STAT_TX_LATE),
 										openavbTLStat(tlHandleList[i1], TL_STAT_TX_BYTES));
+									printf("     Talker catch-up: events=%" PRIu64 ", recovered=%" PRIu64 ", skipped=%" PRIu64 ", purged=%" PRIu64 "\n",
+										openavbTLStat(tlHandleList[i1], TL_STAT_TX_CATCHUP),
+										openavbTLStat(tlHandleList[i1], TL_STAT_TX_RECOVERED),
+										openavbTLStat(tlHandleList[i1], TL_STAT_TX_SKIPPED),
+										openavbTLStat(tlHandleList[i1], TL_STAT_TX_PURGED));
 								}
 								else if (openavbTLGetRole(tlHandleList[i1]) == AVB_ROLE_LISTENER) {
 									printf("     Listener totals: calls=%" PRIu64 ", frames=%" PRIu64 ", lost=%" PRIu64 ", bytes=%" PRIu64 "\n",
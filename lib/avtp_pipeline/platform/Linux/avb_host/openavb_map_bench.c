@@ -0,0 +1,1124 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+
+/*
+* MODULE SUMMARY : Mapping module packet routine benchmark.
+*
+* Runs the talker and listener packet callbacks of the audio mapping modules
+* in a loop, without a network or interface module, and reports the time
+* spent per packet. The media queue is filled and drained outside of the
+* timed sections.
+*
+* The pipe mapping module talker is timed in pull_header mode with and without
+* zero copy transmit, building each item the way an interface module does.
+* Zero copy transmit of an item the mapping module doesn't send right away is
+* checked as well.
+*
+* Pipe fragmentation (map_nv_max_item_size) is checked by passing items from a
+* talker to a listener, dropping one fragment of every tenth item, and
+* comparing what the listener pushed. An item purged as stale between two of
+* its fragments must not leave the talker sending the next one from the
+* middle.
+*
+* AAF listener loss concealment is checked by dropping packets between the
+* talker and the listener, and comparing the listener output with what each
+* concealment mode should produce. A late packet is fed as well and must be
+* dropped. AAF slot mode is checked with packets that each straddle two
+* media queue items.
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include "openavb_types_pub.h"
+#include "openavb_osal_pub.h"
+#include "openavb_os_services_osal.h"
+#include "openavb_trace_pub.h"
+#include "openavb_mediaq_pub.h"
+#include "openavb_mediaq.h"
+#include "openavb_map_pub.h"
+#include "openavb_avtp_time_pub.h"
+#include "openavb_map_uncmp_audio_pub.h"
+#include "openavb_map_aaf_audio_pub.h"
+
+#define	AVB_LOG_COMPONENT	"Map Bench"
+#include "openavb_log_pub.h"
+
+extern bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapUncmpAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapPipeInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+
+#define BENCH_MAX_TRANSIT_USEC	2000
+#define BENCH_AUDIO_RATE		AVB_AUDIO_RATE_48KHZ
+#define BENCH_PIPE_PAYLOAD_SIZE	1480
+// Whole AVTP frame built by the interface module in pull_header mode
+#define BENCH_PIPE_FRAME_LEN	1476
+// AVTP and AAF headers ahead of the AAF payload
+#define BENCH_AAF_HEADER_SIZE	24
+#define BENCH_CONCEAL_PACKETS	64
+// Every Nth packet is dropped on its way to the listener
+#define BENCH_CONCEAL_DROP_INTERVAL	10
+#define BENCH_SLOT_PACKETS		16
+// AVTP and pipe mapping headers, and the fragment information in them
+#define BENCH_PIPE_HEADER_SIZE	24
+#define BENCH_PIPE_FRAG_INFO_OFFSET	22
+// Pipe fragmentation: payload per frame and largest item
+#define BENCH_FRAG_PAYLOAD_SIZE	256
+#define BENCH_FRAG_MAX_ITEM_SIZE	4096
+#define BENCH_FRAG_ITEMS		40
+// One fragment of every Nth item is dropped on its way to the listener
+#define BENCH_FRAG_DROP_INTERVAL	10
+// Short max_stale for the talker, so an item goes stale within the check
+#define BENCH_FRAG_MAX_STALE_USEC	1000
+
+typedef struct {
+	const char *name;
+	openavb_map_initialize_fn_t initFn;
+	// Talker and listener bit depth. They differ for AAF format conversion.
+	avb_audio_bit_depth_t txBitDepth;
+	avb_audio_bit_depth_t rxBitDepth;
+	avb_audio_channels_t channels;
+	// AAF only
+	bool lowLatency;
+	bool sparseMode;
+} bench_case_t;
+
+typedef struct {
+	media_q_t *pMediaQ;
+	openavb_map_cb_t mapCB;
+} bench_map_t;
+
+// AAF int16 packets built by the talker, each holding a single sample value
+typedef struct {
+	U8 *pPackets;
+	U32 *pLens;
+	avtp_stream_hdr_t *pHdrs;
+	U32 maxDataSize;
+	U32 payloadSize;
+} bench_aaf_packets_t;
+
+static const bench_case_t benchCases[] = {
+	{ "aaf int16 2ch",            openavbMapAVTPAudioInitialize,  AVB_AUDIO_BIT_DEPTH_16BIT, AVB_AUDIO_BIT_DEPTH_16BIT, AVB_AUDIO_CHANNELS_2, FALSE, FALSE },
+	{ "aaf int24 2ch",            openavbMapAVTPAudioInitialize,  AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_CHANNELS_2, FALSE, FALSE },
+	{ "aaf int32 2ch",            openavbMapAVTPAudioInitialize,  AVB_AUDIO_BIT_DEPTH_32BIT, AVB_AUDIO_BIT_DEPTH_32BIT, AVB_AUDIO_CHANNELS_2, FALSE, FALSE },
+	{ "aaf int16 8ch",            openavbMapAVTPAudioInitialize,  AVB_AUDIO_BIT_DEPTH_16BIT, AVB_AUDIO_BIT_DEPTH_16BIT, AVB_AUDIO_CHANNELS_8, FALSE, FALSE },
+	{ "aaf int24 8ch",            openavbMapAVTPAudioInitialize,  AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_CHANNELS_8, FALSE, FALSE },
+	{ "aaf int32 8ch",            openavbMapAVTPAudioInitialize,  AVB_AUDIO_BIT_DEPTH_32BIT, AVB_AUDIO_BIT_DEPTH_32BIT, AVB_AUDIO_CHANNELS_8, FALSE, FALSE },
+	{ "aaf int24 8ch sparse",     openavbMapAVTPAudioInitialize,  AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_CHANNELS_8, FALSE, TRUE },
+	{ "aaf int24 8ch low latency", openavbMapAVTPAudioInitialize, AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_CHANNELS_8, TRUE,  FALSE },
+	{ "aaf int16->int24 8ch",     openavbMapAVTPAudioInitialize,  AVB_AUDIO_BIT_DEPTH_16BIT, AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_CHANNELS_8, FALSE, FALSE },
+	{ "aaf int24->int16 8ch",     openavbMapAVTPAudioInitialize,  AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_BIT_DEPTH_16BIT, AVB_AUDIO_CHANNELS_8, FALSE, FALSE },
+	{ "aaf int32->int24 8ch",     openavbMapAVTPAudioInitialize,  AVB_AUDIO_BIT_DEPTH_32BIT, AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_CHANNELS_8, FALSE, FALSE },
+	{ "61883-6 16bit 2ch",        openavbMapUncmpAudioInitialize, AVB_AUDIO_BIT_DEPTH_16BIT, AVB_AUDIO_BIT_DEPTH_16BIT, AVB_AUDIO_CHANNELS_2, FALSE, FALSE },
+	{ "61883-6 24bit 2ch",        openavbMapUncmpAudioInitialize, AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_CHANNELS_2, FALSE, FALSE },
+	{ "61883-6 16bit 8ch",        openavbMapUncmpAudioInitialize, AVB_AUDIO_BIT_DEPTH_16BIT, AVB_AUDIO_BIT_DEPTH_16BIT, AVB_AUDIO_CHANNELS_8, FALSE, FALSE },
+	{ "61883-6 24bit 8ch",        openavbMapUncmpAudioInitialize, AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_BIT_DEPTH_24BIT, AVB_AUDIO_CHANNELS_8, FALSE, FALSE },
+};
+
+typedef struct {
+	const char *name;
+	bool zeroCopy;
+} bench_pipe_case_t;
+
+static const bench_pipe_case_t benchPipeCases[] = {
+	{ "pipe pull_header",           FALSE },
+	{ "pipe pull_header zero copy", TRUE },
+};
+
+typedef struct {
+	const char *name;
+	avb_audio_concealment_t concealment;
+} bench_conceal_case_t;
+
+static const bench_conceal_case_t benchConcealCases[] = {
+	{ "aaf conceal silence",      AVB_AUDIO_CONCEAL_SILENCE },
+	{ "aaf conceal repeat",       AVB_AUDIO_CONCEAL_REPEAT },
+	{ "aaf conceal interpolate",  AVB_AUDIO_CONCEAL_INTERPOLATE },
+};
+
+static U64 x_nowNS(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((U64)now.tv_sec * NANOSECONDS_PER_SECOND) + now.tv_nsec;
+}
+
+// Set up a mapping module the way the talker/listener does, for a media queue
+// large enough to hold every packet of the run.
+static bool x_openMap(bench_map_t *pMap, const bench_case_t *pCase, bool isTalker, U32 packets, U32 txRate,
+	avb_audio_concealment_t concealment)
+{
+	char value[32];
+
+	memset(pMap, 0, sizeof(*pMap));
+	pMap->pMediaQ = openavbMediaQCreate();
+	if (!pMap->pMediaQ || !pCase->initFn(pMap->pMediaQ, &pMap->mapCB, BENCH_MAX_TRANSIT_USEC)) {
+		AVB_LOG_ERROR("Unable to create mapping module");
+		return FALSE;
+	}
+
+	snprintf(value, sizeof(value), "%u", packets + 1);
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_item_count", value);
+	snprintf(value, sizeof(value), "%u", txRate);
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_tx_rate", value);
+	if (pCase->initFn == openavbMapAVTPAudioInitialize) {
+		pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_low_latency", pCase->lowLatency ? "1" : "0");
+		pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_sparse_mode", pCase->sparseMode ? "1" : "0");
+	}
+	snprintf(value, sizeof(value), "%u", concealment);
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_loss_concealment", value);
+
+	// Normally set by the interface module.
+	media_q_pub_map_uncmp_audio_info_t *pPubMapInfo = pMap->pMediaQ->pPubMapInfo;
+	pPubMapInfo->audioRate = BENCH_AUDIO_RATE;
+	pPubMapInfo->audioType = AVB_AUDIO_TYPE_INT;
+	pPubMapInfo->audioBitDepth = isTalker ? pCase->txBitDepth : pCase->rxBitDepth;
+	pPubMapInfo->audioEndian = AVB_AUDIO_ENDIAN_LITTLE;
+	pPubMapInfo->audioChannels = pCase->channels;
+
+	pMap->mapCB.map_gen_init_cb(pMap->pMediaQ);
+	if (isTalker) {
+		pMap->mapCB.map_tx_init_cb(pMap->pMediaQ);
+	}
+	else {
+		pMap->mapCB.map_rx_init_cb(pMap->pMediaQ);
+	}
+	return TRUE;
+}
+
+static void x_closeMap(bench_map_t *pMap)
+{
+	if (pMap->pMediaQ) {
+		if (pMap->mapCB.map_end_cb) {
+			pMap->mapCB.map_end_cb(pMap->pMediaQ);
+		}
+		if (pMap->mapCB.map_gen_end_cb) {
+			pMap->mapCB.map_gen_end_cb(pMap->pMediaQ);
+		}
+		openavbMediaQDelete(pMap->pMediaQ);
+		pMap->pMediaQ = NULL;
+	}
+}
+
+// Fill every free media queue item with a ramp, as an interface module would.
+static void x_fillMediaQ(media_q_t *pMediaQ, U64 *pTimeNS)
+{
+	media_q_pub_map_uncmp_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	media_q_item_t *pMediaQItem;
+	U32 itemNS = (U32)(((U64)pPubMapInfo->framesPerItem * NANOSECONDS_PER_SECOND) / pPubMapInfo->audioRate);
+
+	while ((pMediaQItem = openavbMediaQHeadLock(pMediaQ)) != NULL) {
+		U8 *pItemData = pMediaQItem->pPubData;
+		U32 i1;
+		for (i1 = 0; i1 < pMediaQItem->itemSize; i1++) {
+			pItemData[i1] = i1;
+		}
+		pMediaQItem->dataLen = pMediaQItem->itemSize;
+		openavbAvtpTimeSetToTimestampNS(pMediaQItem->pAvtpTime, *pTimeNS);
+		openavbAvtpTimeSetTimestampValid(pMediaQItem->pAvtpTime, TRUE);
+		*pTimeNS += itemNS;
+		openavbMediaQHeadPush(pMediaQ);
+	}
+}
+
+static void x_drainMediaQ(media_q_t *pMediaQ)
+{
+	while (openavbMediaQTailLock(pMediaQ, TRUE)) {
+		openavbMediaQTailPull(pMediaQ);
+	}
+}
+
+// Decode the AVTP common stream header, as AVTP does before calling the listener.
+static void x_decodeHdr(const U8 *pPacket, avtp_stream_hdr_t *pHdr)
+{
+	pHdr->subtype = pPacket[0] & 0x7F;
+	pHdr->version = (pPacket[1] >> 4) & 0x07;
+	pHdr->sequenceNum = pPacket[2];
+	pHdr->mr = (pPacket[1] & 0x08) ? TRUE : FALSE;
+	pHdr->gv = (pPacket[1] & 0x02) ? TRUE : FALSE;
+	pHdr->tv = (pPacket[1] & 0x01) ? TRUE : FALSE;
+	pHdr->tu = (pPacket[3] & 0x01) ? TRUE : FALSE;
+	pHdr->timestamp = ntohl(*(U32 *)(pPacket + 12));
+	pHdr->streamDataLen = ntohs(*(U16 *)(pPacket + 20));
+}
+
+// Set up the pipe mapping module as a pull_header talker, with zero copy transmit as
+// AVTP enables it for tx_zero_copy.
+static bool x_openPipeTalker(bench_map_t *pMap, bool zeroCopy, U32 txRate)
+{
+	char value[32];
+
+	memset(pMap, 0, sizeof(*pMap));
+	pMap->pMediaQ = openavbMediaQCreate();
+	if (!pMap->pMediaQ || !openavbMapPipeInitialize(pMap->pMediaQ, &pMap->mapCB, BENCH_MAX_TRANSIT_USEC)) {
+		AVB_LOG_ERROR("Unable to create mapping module");
+		return FALSE;
+	}
+
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_item_count", "4");
+	snprintf(value, sizeof(value), "%u", BENCH_PIPE_PAYLOAD_SIZE);
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_max_payload_size", value);
+	snprintf(value, sizeof(value), "%u", txRate);
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_tx_rate", value);
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_pull_header", "1");
+
+	pMap->mapCB.map_gen_init_cb(pMap->pMediaQ);
+	pMap->mapCB.map_tx_init_cb(pMap->pMediaQ);
+	if (zeroCopy && !openavbMediaQTxFrameRefModeOn(pMap->pMediaQ)) {
+		AVB_LOG_ERROR("Unable to enable zero copy transmit");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+// Frames the interface module passes through, already built by its source. The frame of
+// packet pkt starts pkt % 256 bytes in, which tells packets apart.
+static U8 pipeFrames[BENCH_PIPE_FRAME_LEN + 256];
+
+static void x_initPipeFrames(void)
+{
+	U32 i1;
+	for (i1 = 0; i1 < sizeof(pipeFrames); i1++) {
+		pipeFrames[i1] = i1 * 7;
+	}
+}
+
+static bool x_checkPipeFrame(const U8 *pFrame, U32 pkt)
+{
+	return memcmp(pFrame, pipeFrames + (pkt % 256), BENCH_PIPE_FRAME_LEN) == 0;
+}
+
+// Queue the frame for packet pkt as the interface TX callback does. With zero copy transmit
+// the item is built in the frame AVTP passed to openavbMediaQTxFrameBegin().
+static bool x_pushPipeFrame(media_q_t *pMediaQ, bool zeroCopy, U32 pkt)
+{
+	media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+	if (!pMediaQItem) {
+		return FALSE;
+	}
+	if (zeroCopy && !openavbMediaQHeadRefTxFrame(pMediaQ, pMediaQItem)) {
+		openavbMediaQHeadUnlock(pMediaQ);
+		return FALSE;
+	}
+	memcpy(pMediaQItem->pPubData, pipeFrames + (pkt % 256), BENCH_PIPE_FRAME_LEN);
+	pMediaQItem->dataLen = BENCH_PIPE_FRAME_LEN;
+	openavbMediaQHeadPush(pMediaQ);
+	return TRUE;
+}
+
+// Time one packet through the interface and map TX callbacks, as AVTP calls them. The
+// media queue is empty at every packet, which zero copy transmit needs to use the frame.
+static bool x_runPipeCase(const bench_pipe_case_t *pCase, U32 packets, U32 txRate, double *pTxNS)
+{
+	bench_map_t talker;
+	U64 startNS;
+	U32 frameLen;
+	U32 pkt;
+	bool ok = TRUE;
+
+	if (!x_openPipeTalker(&talker, pCase->zeroCopy, txRate)) {
+		x_closeMap(&talker);
+		return FALSE;
+	}
+	frameLen = talker.mapCB.map_max_data_size_cb(talker.pMediaQ);
+	U8 *pFrame = calloc(1, frameLen);
+	if (!pFrame) {
+		AVB_LOG_ERROR("Out of memory");
+		x_closeMap(&talker);
+		return FALSE;
+	}
+
+	startNS = x_nowNS();
+	for (pkt = 0; pkt < packets && ok; pkt++) {
+		U32 dataLen = frameLen;
+		if (pCase->zeroCopy) {
+			openavbMediaQTxFrameBegin(talker.pMediaQ, pFrame, frameLen);
+		}
+		ok = x_pushPipeFrame(talker.pMediaQ, pCase->zeroCopy, pkt)
+			&& talker.mapCB.map_tx_cb(talker.pMediaQ, pFrame, &dataLen) == TX_CB_RET_PACKET_READY
+			&& dataLen == BENCH_PIPE_FRAME_LEN;
+		if (pCase->zeroCopy) {
+			openavbMediaQTxFrameEnd(talker.pMediaQ);
+		}
+	}
+	*pTxNS = (double)(x_nowNS() - startNS) / pkt;
+
+	// The frame handed to the raw socket last holds the last item built.
+	ok = ok && x_checkPipeFrame(pFrame, pkt - 1);
+	if (!ok) {
+		AVB_LOGF_ERROR("%s: packet %u not sent as built", pCase->name, pkt - 1);
+	}
+
+	free(pFrame);
+	x_closeMap(&talker);
+	return ok;
+}
+
+// An item built in the transmit frame that the map TX callback doesn't send must be
+// copied out before the raw socket reuses the frame. While it is queued, the next item
+// can't use the frame, since it is sent after it.
+static bool x_checkPipeTxCopyBack(U32 txRate)
+{
+	bench_map_t talker;
+	media_q_item_t *pMediaQItem;
+	U32 frameLen, dataLen;
+	bool ok;
+
+	if (!x_openPipeTalker(&talker, TRUE, txRate)) {
+		x_closeMap(&talker);
+		return FALSE;
+	}
+	frameLen = talker.mapCB.map_max_data_size_cb(talker.pMediaQ);
+	U8 *pFrame = calloc(1, frameLen);
+	U8 *pNextFrame = calloc(1, frameLen);
+	if (!pFrame || !pNextFrame) {
+		AVB_LOG_ERROR("Out of memory");
+		free(pFrame);
+		free(pNextFrame);
+		x_closeMap(&talker);
+		return FALSE;
+	}
+
+	// Item 1 is built in the frame, but the map TX callback isn't called for it.
+	openavbMediaQTxFrameBegin(talker.pMediaQ, pFrame, frameLen);
+	ok = x_pushPipeFrame(talker.pMediaQ, TRUE, 1);
+	openavbMediaQTxFrameEnd(talker.pMediaQ);
+	memset(pFrame, 0xee, frameLen);
+
+	// Item 2 is queued behind item 1, so it can't take the frame and is copied as usual.
+	openavbMediaQTxFrameBegin(talker.pMediaQ, pNextFrame, frameLen);
+	pMediaQItem = openavbMediaQHeadLock(talker.pMediaQ);
+	ok = ok && pMediaQItem && !openavbMediaQHeadRefTxFrame(talker.pMediaQ, pMediaQItem);
+	if (pMediaQItem) {
+		openavbMediaQHeadUnlock(talker.pMediaQ);
+	}
+	ok = ok && x_pushPipeFrame(talker.pMediaQ, FALSE, 2);
+	dataLen = frameLen;
+	ok = ok && talker.mapCB.map_tx_cb(talker.pMediaQ, pNextFrame, &dataLen) == TX_CB_RET_PACKET_READY
+		&& dataLen == BENCH_PIPE_FRAME_LEN && x_checkPipeFrame(pNextFrame, 1);
+	openavbMediaQTxFrameEnd(talker.pMediaQ);
+
+	dataLen = frameLen;
+	ok = ok && talker.mapCB.map_tx_cb(talker.pMediaQ, pFrame, &dataLen) == TX_CB_RET_PACKET_READY
+		&& dataLen == BENCH_PIPE_FRAME_LEN && x_checkPipeFrame(pFrame, 2);
+
+	free(pFrame);
+	free(pNextFrame);
+	x_closeMap(&talker);
+	return ok;
+}
+
+// Set up the pipe mapping module to fragment items larger than BENCH_FRAG_PAYLOAD_SIZE.
+static bool x_openPipeFragMap(bench_map_t *pMap, bool isTalker, U32 itemCount)
+{
+	char value[32];
+
+	memset(pMap, 0, sizeof(*pMap));
+	pMap->pMediaQ = openavbMediaQCreate();
+	if (!pMap->pMediaQ || !openavbMapPipeInitialize(pMap->pMediaQ, &pMap->mapCB, BENCH_MAX_TRANSIT_USEC)) {
+		AVB_LOG_ERROR("Unable to create mapping module");
+		return FALSE;
+	}
+
+	snprintf(value, sizeof(value), "%u", itemCount);
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_item_count", value);
+	snprintf(value, sizeof(value), "%u", BENCH_FRAG_PAYLOAD_SIZE);
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_max_payload_size", value);
+	snprintf(value, sizeof(value), "%u", BENCH_FRAG_MAX_ITEM_SIZE);
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_max_item_size", value);
+
+	pMap->mapCB.map_gen_init_cb(pMap->pMediaQ);
+	if (isTalker) {
+		pMap->mapCB.map_tx_init_cb(pMap->pMediaQ);
+	}
+	else {
+		pMap->mapCB.map_rx_init_cb(pMap->pMediaQ);
+	}
+	return TRUE;
+}
+
+// Size of item idx. Every item that loses a fragment has at least three, so the first,
+// a middle and the last fragment can each be dropped.
+static U32 x_fragItemSize(U32 idx)
+{
+	if (idx % BENCH_FRAG_DROP_INTERVAL == BENCH_FRAG_DROP_INTERVAL / 2) {
+		return 3 * BENCH_FRAG_PAYLOAD_SIZE + idx;
+	}
+	return 1 + (idx * 211) % BENCH_FRAG_MAX_ITEM_SIZE;
+}
+
+static U8 x_fragItemByte(U32 idx, U32 offset)
+{
+	return (U8)(idx * 31 + offset * 7);
+}
+
+// Queue item idx as an interface module would, to be presented at timeNS.
+static bool x_pushFragItem(media_q_t *pMediaQ, U32 idx, U32 size, U64 timeNS)
+{
+	media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+	U32 i1;
+
+	if (!pMediaQItem) {
+		return FALSE;
+	}
+	for (i1 = 0; i1 < size; i1++) {
+		((U8 *)pMediaQItem->pPubData)[i1] = x_fragItemByte(idx, i1);
+	}
+	pMediaQItem->dataLen = size;
+	openavbAvtpTimeSetToTimestampNS(pMediaQItem->pAvtpTime, timeNS);
+	openavbAvtpTimeSetTimestampValid(pMediaQItem->pAvtpTime, TRUE);
+	openavbMediaQHeadPush(pMediaQ);
+	return TRUE;
+}
+
+// Check the items the listener has pushed against the next expected ones, skipping
+// the items that lost a fragment. Returns the number of items checked.
+static U32 x_checkFragOutput(media_q_t *pMediaQ, U32 *pNextIdx, U32 endIdx, bool *pOk)
+{
+	media_q_item_t *pMediaQItem;
+	U32 items = 0;
+
+	while ((pMediaQItem = openavbMediaQTailLock(pMediaQ, TRUE)) != NULL) {
+		U32 idx = *pNextIdx;
+		U32 i1;
+		while (idx < endIdx && idx % BENCH_FRAG_DROP_INTERVAL == BENCH_FRAG_DROP_INTERVAL / 2) {
+			idx++;
+		}
+		if (idx >= endIdx || pMediaQItem->dataLen != x_fragItemSize(idx)) {
+			AVB_LOGF_ERROR("pipe fragment: item of %u bytes out, expected item %u", pMediaQItem->dataLen, idx);
+			*pOk = FALSE;
+		}
+		for (i1 = 0; i1 < pMediaQItem->dataLen && *pOk; i1++) {
+			if (((U8 *)pMediaQItem->pPubData)[i1] != x_fragItemByte(idx, i1)) {
+				AVB_LOGF_ERROR("pipe fragment: item %u differs at byte %u", idx, i1);
+				*pOk = FALSE;
+			}
+		}
+		*pNextIdx = idx + 1;
+		items++;
+		openavbMediaQTailPull(pMediaQ);
+	}
+	return items;
+}
+
+// Pass fragmented items from a talker to a listener. Every BENCH_FRAG_DROP_INTERVAL item
+// loses its first, a middle or its last fragment in turn, and only that item may be
+// missing from the listener output.
+static bool x_checkPipeFragLoopback(void)
+{
+	bench_map_t talker, listener;
+	U64 nowNS;
+	U32 idx, nextIdx = 0, items = 0, expectItems = 0;
+	bool ok;
+
+	memset(&listener, 0, sizeof(listener));
+	ok = x_openPipeFragMap(&talker, TRUE, 2) && x_openPipeFragMap(&listener, FALSE, 2);
+	U32 frameLen = ok ? talker.mapCB.map_max_data_size_cb(talker.pMediaQ) : 0;
+	U8 *pFrame = ok ? calloc(1, frameLen) : NULL;
+	ok = ok && pFrame && CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNS);
+
+	for (idx = 0; idx < BENCH_FRAG_ITEMS && ok; idx++) {
+		U32 size = x_fragItemSize(idx);
+		U32 frags = (size + BENCH_FRAG_PAYLOAD_SIZE - 1) / BENCH_FRAG_PAYLOAD_SIZE;
+		U32 dropFrag = frags;
+		U32 frag = 0;
+
+		if (idx % BENCH_FRAG_DROP_INTERVAL == BENCH_FRAG_DROP_INTERVAL / 2) {
+			U32 turn = (idx / BENCH_FRAG_DROP_INTERVAL) % 3;
+			dropFrag = (turn == 0) ? 0 : (turn == 1) ? frags / 2 : frags - 1;
+		}
+		else {
+			expectItems++;
+		}
+
+		// Presentation times a little ahead of now, so no item is purged as stale.
+		ok = x_pushFragItem(talker.pMediaQ, idx, size, nowNS + 100000000 + (U64)idx * 1000000);
+		while (ok) {
+			U32 dataLen = frameLen;
+			if (talker.mapCB.map_tx_cb(talker.pMediaQ, pFrame, &dataLen) != TX_CB_RET_PACKET_READY) {
+				break;
+			}
+			if (frag++ != dropFrag) {
+				listener.mapCB.map_rx_cb(listener.pMediaQ, pFrame, dataLen);
+			}
+			items += x_checkFragOutput(listener.pMediaQ, &nextIdx, BENCH_FRAG_ITEMS, &ok);
+		}
+		if (ok && frag != frags) {
+			AVB_LOGF_ERROR("pipe fragment loopback: item %u of %u bytes sent in %u frames, expected %u", idx, size, frag, frags);
+			ok = FALSE;
+		}
+	}
+	if (ok && items != expectItems) {
+		AVB_LOGF_ERROR("pipe fragment loopback: %u items out, expected %u", items, expectItems);
+		ok = FALSE;
+	}
+
+	free(pFrame);
+	x_closeMap(&talker);
+	x_closeMap(&listener);
+	return ok;
+}
+
+// An item purged as stale after its first fragment was sent is followed by a shorter
+// one. With one media queue item the next one reuses the slot, with two it is the
+// next slot. Either way it must be sent whole, starting at its first byte.
+static bool x_checkPipeFragStaleTail(U32 itemCount)
+{
+	bench_map_t talker, listener;
+	U32 frameLen, dataLen;
+	U64 nowNS;
+	U16 fragInfo = 0;
+	U32 nextIdx = 1;
+	bool ok;
+
+	memset(&listener, 0, sizeof(listener));
+	ok = x_openPipeFragMap(&talker, TRUE, itemCount) && x_openPipeFragMap(&listener, FALSE, itemCount);
+	frameLen = ok ? talker.mapCB.map_max_data_size_cb(talker.pMediaQ) : 0;
+	U8 *pFrame = ok ? calloc(1, frameLen) : NULL;
+	ok = ok && pFrame && CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNS);
+	if (ok) {
+		openavbMediaQSetMaxStaleTail(talker.pMediaQ, BENCH_FRAG_MAX_STALE_USEC);
+	}
+
+	// Item 0 takes four frames; only its first is sent before it goes stale.
+	ok = ok && x_pushFragItem(talker.pMediaQ, 0, 3 * BENCH_FRAG_PAYLOAD_SIZE + 1, nowNS);
+	dataLen = frameLen;
+	ok = ok && talker.mapCB.map_tx_cb(talker.pMediaQ, pFrame, &dataLen) == TX_CB_RET_PACKET_READY;
+	if (ok) {
+		listener.mapCB.map_rx_cb(listener.pMediaQ, pFrame, dataLen);
+		SLEEP_MSEC(((BENCH_MAX_TRANSIT_USEC + BENCH_FRAG_MAX_STALE_USEC) / MICROSECONDS_PER_MSEC + 2));
+		ok = CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNS);
+	}
+
+	// Item 1 is shorter than what was sent of item 0, and due within the transit time,
+	// so the purge keeps it. The stale purge runs when the media queue is checked
+	// against the presentation times, here for ready items.
+	if (ok && itemCount > 1) {
+		ok = x_pushFragItem(talker.pMediaQ, 1, x_fragItemSize(1), nowNS + BENCH_MAX_TRANSIT_USEC / 2 * NANOSECONDS_PER_USEC);
+	}
+	if (ok) {
+		openavbMediaQAnyReadyItems(talker.pMediaQ, FALSE);
+	}
+	if (ok && openavbMediaQAnyReadyItems(talker.pMediaQ, TRUE) != (itemCount > 1)) {
+		AVB_LOG_ERROR("pipe fragment stale tail: stale item not purged");
+		ok = FALSE;
+	}
+	if (ok && itemCount == 1) {
+		ok = x_pushFragItem(talker.pMediaQ, 1, x_fragItemSize(1), nowNS + BENCH_MAX_TRANSIT_USEC / 2 * NANOSECONDS_PER_USEC);
+	}
+
+	dataLen = frameLen;
+	ok = ok && talker.mapCB.map_tx_cb(talker.pMediaQ, pFrame, &dataLen) == TX_CB_RET_PACKET_READY;
+	if (ok) {
+		memcpy(&fragInfo, pFrame + BENCH_PIPE_FRAG_INFO_OFFSET, sizeof(U16));
+		fragInfo = ntohs(fragInfo);
+	}
+	if (ok && (fragInfo != 0 || dataLen != BENCH_PIPE_HEADER_SIZE + x_fragItemSize(1))) {
+		AVB_LOGF_ERROR("pipe fragment stale tail: frame of %u bytes, fragment info 0x%04x", dataLen, fragInfo);
+		ok = FALSE;
+	}
+
+	// The listener gives up on item 0 and pushes item 1 as sent.
+	if (ok) {
+		listener.mapCB.map_rx_cb(listener.pMediaQ, pFrame, dataLen);
+		if (x_checkFragOutput(listener.pMediaQ, &nextIdx, 2, &ok) != 1 && ok) {
+			AVB_LOG_ERROR("pipe fragment stale tail: item 1 not received");
+			ok = FALSE;
+		}
+	}
+	dataLen = frameLen;
+	if (ok && talker.mapCB.map_tx_cb(talker.pMediaQ, pFrame, &dataLen) != TX_CB_RET_PACKET_NOT_READY) {
+		AVB_LOG_ERROR("pipe fragment stale tail: frame sent after the last item");
+		ok = FALSE;
+	}
+
+	free(pFrame);
+	x_closeMap(&talker);
+	x_closeMap(&listener);
+	return ok;
+}
+
+// Run one case. Returns FALSE if the talker or the listener could not be set up.
+static bool x_runCase(const bench_case_t *pCase, U32 packets, U32 txRate, double *pTxNS, double *pRxNS)
+{
+	bench_map_t talker, listener;
+	U64 timeNS = 0;
+	U64 startNS;
+	U32 maxDataSize;
+	U32 pkt;
+
+	memset(&listener, 0, sizeof(listener));
+	if (!x_openMap(&talker, pCase, TRUE, packets, txRate, AVB_AUDIO_CONCEAL_NONE)) {
+		x_closeMap(&talker);
+		return FALSE;
+	}
+	maxDataSize = talker.mapCB.map_max_data_size_cb(talker.pMediaQ);
+
+	U8 *pPackets = calloc(packets, maxDataSize);
+	U32 *pLens = calloc(packets, sizeof(U32));
+	avtp_stream_hdr_t *pHdrs = calloc(packets, sizeof(avtp_stream_hdr_t));
+	if (!pPackets || !pLens || !pHdrs) {
+		AVB_LOG_ERROR("Out of memory");
+		free(pPackets);
+		free(pLens);
+		free(pHdrs);
+		x_closeMap(&talker);
+		return FALSE;
+	}
+	// Fault the packet buffers in before timing.
+	memset(pPackets, 0xff, packets * maxDataSize);
+
+	// Talker
+	x_fillMediaQ(talker.pMediaQ, &timeNS);
+	startNS = x_nowNS();
+	for (pkt = 0; pkt < packets; pkt++) {
+		U8 *pPacket = pPackets + (pkt * maxDataSize);
+		pPacket[2] = pkt;		// Sequence number, set by AVTP
+		pLens[pkt] = maxDataSize;
+		if (talker.mapCB.map_tx_cb(talker.pMediaQ, pPacket, &pLens[pkt]) != TX_CB_RET_PACKET_READY) {
+			break;
+		}
+	}
+	*pTxNS = (double)(x_nowNS() - startNS) / (pkt ? pkt : 1);
+	x_closeMap(&talker);
+	packets = pkt;
+
+	for (pkt = 0; pkt < packets; pkt++) {
+		x_decodeHdr(pPackets + (pkt * maxDataSize), &pHdrs[pkt]);
+	}
+
+	// Listener
+	*pRxNS = 0;
+	if (packets > 0 && x_openMap(&listener, pCase, FALSE, packets, txRate, AVB_AUDIO_CONCEAL_NONE)) {
+		startNS = x_nowNS();
+		if (listener.mapCB.map_rx_hdr_cb) {
+			for (pkt = 0; pkt < packets; pkt++) {
+				listener.mapCB.map_rx_hdr_cb(listener.pMediaQ, &pHdrs[pkt], pPackets + (pkt * maxDataSize), pLens[pkt]);
+			}
+		}
+		else {
+			for (pkt = 0; pkt < packets; pkt++) {
+				listener.mapCB.map_rx_cb(listener.pMediaQ, pPackets + (pkt * maxDataSize), pLens[pkt]);
+			}
+		}
+		*pRxNS = (double)(x_nowNS() - startNS) / packets;
+		x_drainMediaQ(listener.pMediaQ);
+	}
+	x_closeMap(&listener);
+
+	free(pPackets);
+	free(pLens);
+	free(pHdrs);
+	return packets > 0;
+}
+
+// Sample value the talker sends in packet pkt. It rises from packet to packet so
+// interpolated samples can be told from repeated ones.
+static S16 x_concealSample(U32 pkt)
+{
+	return (S16)((pkt + 1) * 100);
+}
+
+static S16 x_concealOutSample(const U8 *pData)
+{
+	return (S16)(((U16)pData[0] << 8) | pData[1]);
+}
+
+static void x_freeAafPackets(bench_aaf_packets_t *pSet)
+{
+	free(pSet->pPackets);
+	free(pSet->pLens);
+	free(pSet->pHdrs);
+	memset(pSet, 0, sizeof(*pSet));
+}
+
+// Build AAF int16 2ch packets with the talker. Every sample of packet pkt is x_concealSample(pkt).
+static bool x_makeAafPackets(bench_aaf_packets_t *pSet, U32 packets, U32 txRate)
+{
+	bench_map_t talker;
+	U64 timeNS = 0;
+	U32 pkt, i1;
+	bool ok = TRUE;
+
+	memset(pSet, 0, sizeof(*pSet));
+	if (!x_openMap(&talker, &benchCases[0], TRUE, packets, txRate, AVB_AUDIO_CONCEAL_NONE)) {
+		x_closeMap(&talker);
+		return FALSE;
+	}
+	pSet->maxDataSize = talker.mapCB.map_max_data_size_cb(talker.pMediaQ);
+	pSet->pPackets = calloc(packets, pSet->maxDataSize);
+	pSet->pLens = calloc(packets, sizeof(U32));
+	pSet->pHdrs = calloc(packets, sizeof(avtp_stream_hdr_t));
+	if (!pSet->pPackets || !pSet->pLens || !pSet->pHdrs) {
+		AVB_LOG_ERROR("Out of memory");
+		ok = FALSE;
+	}
+
+	if (ok) {
+		x_fillMediaQ(talker.pMediaQ, &timeNS);
+	}
+	for (pkt = 0; pkt < packets && ok; pkt++) {
+		U8 *pPacket = pSet->pPackets + (pkt * pSet->maxDataSize);
+		pPacket[2] = pkt;		// Sequence number, set by AVTP
+		pSet->pLens[pkt] = pSet->maxDataSize;
+		ok = talker.mapCB.map_tx_cb(talker.pMediaQ, pPacket, &pSet->pLens[pkt]) == TX_CB_RET_PACKET_READY;
+		if (ok) {
+			S16 sample = x_concealSample(pkt);
+			pSet->payloadSize = pSet->pLens[pkt] - BENCH_AAF_HEADER_SIZE;
+			for (i1 = BENCH_AAF_HEADER_SIZE; i1 < pSet->pLens[pkt]; i1 += 2) {
+				pPacket[i1] = (U16)sample >> 8;
+				pPacket[i1 + 1] = (U16)sample & 0xff;
+			}
+			x_decodeHdr(pPacket, &pSet->pHdrs[pkt]);
+		}
+	}
+	x_closeMap(&talker);
+
+	if (!ok) {
+		x_freeAafPackets(pSet);
+	}
+	return ok;
+}
+
+static void x_rxAafPacket(bench_map_t *pListener, bench_aaf_packets_t *pSet, U32 pkt)
+{
+	pListener->mapCB.map_rx_hdr_cb(pListener->pMediaQ, &pSet->pHdrs[pkt],
+		pSet->pPackets + (pkt * pSet->maxDataSize), pSet->pLens[pkt]);
+}
+
+// Collect the data of every item the listener has released. Returns the number of bytes.
+static U32 x_collectOutput(media_q_t *pMediaQ, U8 *pOut, U32 outSize)
+{
+	media_q_item_t *pMediaQItem;
+	U32 outLen = 0;
+
+	while ((pMediaQItem = openavbMediaQTailLock(pMediaQ, TRUE)) != NULL) {
+		if (outLen + pMediaQItem->dataLen <= outSize) {
+			memcpy(pOut + outLen, pMediaQItem->pPubData, pMediaQItem->dataLen);
+		}
+		outLen += pMediaQItem->dataLen;
+		openavbMediaQTailPull(pMediaQ);
+	}
+	return outLen;
+}
+
+// Pass AAF int16 packets to a listener using the given concealment, dropping every
+// BENCH_CONCEAL_DROP_INTERVAL packet, and check what the listener pushed.
+static bool x_checkConcealment(const bench_conceal_case_t *pCase, U32 txRate)
+{
+	const U32 packets = BENCH_CONCEAL_PACKETS;
+	bench_aaf_packets_t set;
+	bench_map_t listener;
+	U32 pkt, i1;
+
+	if (!x_makeAafPackets(&set, packets, txRate)) {
+		return FALSE;
+	}
+	U32 outSize = packets * set.payloadSize;
+	U8 *pOut = calloc(1, outSize);
+	bool ok = (pOut != NULL);
+
+	// Listener. The packet after the first drop is followed by a late copy of the one before it.
+	memset(&listener, 0, sizeof(listener));
+	ok = ok && x_openMap(&listener, &benchCases[0], FALSE, packets, txRate, pCase->concealment);
+	for (pkt = 0; pkt < packets && ok; pkt++) {
+		if (pkt % BENCH_CONCEAL_DROP_INTERVAL == BENCH_CONCEAL_DROP_INTERVAL / 2) {
+			continue;
+		}
+		x_rxAafPacket(&listener, &set, pkt);
+		if (pkt == BENCH_CONCEAL_DROP_INTERVAL / 2 + 1) {
+			x_rxAafPacket(&listener, &set, pkt - 2);
+		}
+	}
+	U32 outLen = ok ? x_collectOutput(listener.pMediaQ, pOut, outSize) : 0;
+	x_closeMap(&listener);
+
+	// Every packet sent, lost or not, takes its place in the output once.
+	if (ok && outLen != outSize) {
+		AVB_LOGF_ERROR("%s: %u bytes out, expected %u", pCase->name, outLen, outSize);
+		ok = FALSE;
+	}
+	for (pkt = 0; pkt < packets && ok; pkt++) {
+		bool lost = (pkt % BENCH_CONCEAL_DROP_INTERVAL == BENCH_CONCEAL_DROP_INTERVAL / 2);
+		for (i1 = 0; i1 < set.payloadSize && ok; i1 += 2) {
+			S16 sample = x_concealOutSample(pOut + (pkt * set.payloadSize) + i1);
+			if (!lost) {
+				ok = (sample == x_concealSample(pkt));
+			}
+			else if (pCase->concealment == AVB_AUDIO_CONCEAL_SILENCE) {
+				ok = (sample == 0);
+			}
+			else if (pCase->concealment == AVB_AUDIO_CONCEAL_REPEAT) {
+				ok = (sample == x_concealSample(pkt - 1));
+			}
+			else {
+				ok = (sample > x_concealSample(pkt - 1) && sample < x_concealSample(pkt + 1));
+			}
+			if (!ok) {
+				AVB_LOGF_ERROR("%s: packet %u%s, sample %u is %d", pCase->name, pkt, lost ? " (lost)" : "", i1 / 2, sample);
+			}
+		}
+	}
+
+	free(pOut);
+	x_freeAafPackets(&set);
+	return ok;
+}
+
+// In slot mode each item holds one packet. After a first packet that sets the slot times,
+// every packet is presented half a packet later than the slot grid, so it must be split
+// across two items.
+static bool x_checkSlotStraddle(U32 txRate)
+{
+	const U32 packets = BENCH_SLOT_PACKETS + 1;
+	bench_aaf_packets_t set;
+	bench_map_t listener;
+	timespec_t now;
+	U32 pkt, i1;
+
+	if (!x_makeAafPackets(&set, packets, txRate) || !CLOCK_GETTIME(OPENAVB_CLOCK_WALLTIME, &now)) {
+		x_freeAafPackets(&set);
+		return FALSE;
+	}
+
+	// Presentation times a little ahead of now, so none of them is taken as past.
+	U32 packetNS = (U32)(((U64)(set.payloadSize / 4) * NANOSECONDS_PER_SECOND) / BENCH_AUDIO_RATE);
+	U32 baseTS = (U32)(((U64)now.tv_sec * NANOSECONDS_PER_SECOND) + now.tv_nsec + 100000000);
+	for (pkt = 0; pkt < packets; pkt++) {
+		set.pHdrs[pkt].tv = TRUE;
+		set.pHdrs[pkt].timestamp = baseTS + (pkt ? (pkt - 1) * packetNS + packetNS / 2 : 0);
+	}
+
+	U32 outSize = BENCH_SLOT_PACKETS * set.payloadSize;
+	U8 *pOut = calloc(1, outSize);
+	bool ok = (pOut != NULL);
+
+	memset(&listener, 0, sizeof(listener));
+	ok = ok && x_openMap(&listener, &benchCases[0], FALSE, packets, txRate, AVB_AUDIO_CONCEAL_NONE);
+	if (ok) {
+		listener.mapCB.map_cfg_cb(listener.pMediaQ, "map_nv_rx_slot_mode", "1");
+		listener.mapCB.map_rx_init_cb(listener.pMediaQ);
+	}
+	for (pkt = 0; pkt < packets && ok; pkt++) {
+		x_rxAafPacket(&listener, &set, pkt);
+	}
+	// The second half of the last packet leaves its item incomplete, so it isn't released.
+	U32 outLen = ok ? x_collectOutput(listener.pMediaQ, pOut, outSize) : 0;
+	x_closeMap(&listener);
+
+	if (ok && outLen != outSize) {
+		AVB_LOGF_ERROR("aaf slot straddle: %u bytes out, expected %u", outLen, outSize);
+		ok = FALSE;
+	}
+	for (i1 = 0; i1 < outSize && ok; i1 += 4) {
+		U32 frame = i1 / 4;
+		U32 framesPerPacket = set.payloadSize / 4;
+		U32 expectPkt = 0;
+		if (frame >= framesPerPacket) {
+			expectPkt = (frame - framesPerPacket / 2) / framesPerPacket + 1;
+		}
+		S16 sample = x_concealOutSample(pOut + i1);
+		ok = (sample == x_concealSample(expectPkt)) && (x_concealOutSample(pOut + i1 + 2) == sample);
+		if (!ok) {
+			AVB_LOGF_ERROR("aaf slot straddle: frame %u is %d, expected %d", frame, sample, x_concealSample(expectPkt));
+		}
+	}
+
+	free(pOut);
+	x_freeAafPackets(&set);
+	return ok;
+}
+
+static void openavbMapBenchUsage(char *programName)
+{
+	printf(
+		"\n"
+		"Usage: %s [options]\n"
+		"  -h         Prints this message.\n"
+		"  -n val     Packets per run (default 4000).\n"
+		"  -r val     Runs per case; the fastest run is reported (default 5).\n"
+		"  -t val     Packet rate passed as map_nv_tx_rate (default 8000).\n"
+		"  -m val     Only run cases whose name contains val.\n"
+		"  -l val     Filename of the log file to use.  If not specified, results will be logged to stderr.\n"
+		"\n"
+		"Examples:\n"
+		"  %s -m aaf\n"
+		"    Time the AAF talker and listener packet routines.\n\n"
+		,
+		programName, programName);
+}
+
+int main(int argc, char *argv[])
+{
+	U32 optPackets = 4000;
+	U32 optRuns = 5;
+	U32 optTxRate = 8000;
+	char *optMatch = NULL;
+	char *optLogFileName = NULL;
+	FILE *logFile = NULL;
+	bool failed = FALSE;
+	int opt;
+	U32 i1;
+
+	while ((opt = getopt(argc, argv, "hn:r:t:m:l:")) != -1) {
+		switch (opt) {
+			case 'n':
+				optPackets = strtoul(optarg, NULL, 10);
+				break;
+			case 'r':
+				optRuns = strtoul(optarg, NULL, 10);
+				break;
+			case 't':
+				optTxRate = strtoul(optarg, NULL, 10);
+				break;
+			case 'm':
+				optMatch = optarg;
+				break;
+			case 'l':
+				optLogFileName = optarg;
+				break;
+			case 'h':
+			default:
+				openavbMapBenchUsage(argv[0]);
+				return opt == 'h' ? 0 : -1;
+		}
+	}
+	if (optPackets < 1 || optRuns < 1 || optTxRate < 1) {
+		openavbMapBenchUsage(argv[0]);
+		return -1;
+	}
+
+	if (optLogFileName) {
+		logFile = fopen(optLogFileName, "w");
+		if (!logFile) {
+			fprintf(stderr, "Error opening log file: %s\n", optLogFileName);
+		}
+	}
+	avbLogInitEx(logFile);
+	x_initPipeFrames();
+	if (!osalAVBTimeInit()) {
+		printf("gPTP not available; listener times include failed clock lookups\n");
+	}
+
+	printf("%-28s %12s %12s\n", "case", "tx ns/pkt", "rx ns/pkt");
+	for (i1 = 0; i1 < sizeof(benchCases) / sizeof(benchCases[0]); i1++) {
+		const bench_case_t *pCase = &benchCases[i1];
+		double bestTxNS = 0, bestRxNS = 0;
+		bool ok = TRUE;
+		U32 run;
+
+		if (optMatch && !strstr(pCase->name, optMatch)) {
+			continue;
+		}
+		for (run = 0; run < optRuns && ok; run++) {
+			double txNS, rxNS;
+			ok = x_runCase(pCase, optPackets, optTxRate, &txNS, &rxNS);
+			if (run == 0 || txNS < bestTxNS) {
+				bestTxNS = txNS;
+			}
+			if (run == 0 || rxNS < bestRxNS) {
+				bestRxNS = rxNS;
+			}
+		}
+		if (ok) {
+			printf("%-28s %12.1f %12.1f\n", pCase->name, bestTxNS, bestRxNS);
+		}
+		else {
+			printf("%-28s %12s %12s\n", pCase->name, "failed", "failed");
+		}
+	}
+
+	for (i1 = 0; i1 < sizeof(benchPipeCases) / sizeof(benchPipeCases[0]); i1++) {
+		const bench_pipe_case_t *pCase = &benchPipeCases[i1];
+		double bestTxNS = 0;
+		bool ok = TRUE;
+		U32 run;
+
+		if (optMatch && !strstr(pCase->name, optMatch)) {
+			continue;
+		}
+		for (run = 0; run < optRuns && ok; run++) {
+			double txNS = 0;
+			ok = x_runPipeCase(pCase, optPackets, optTxRate, &txNS);
+			if (run == 0 || txNS < bestTxNS) {
+				bestTxNS = txNS;
+			}
+		}
+		if (ok) {
+			printf("%-28s %12.1f %12s\n", pCase->name, bestTxNS, "-");
+		}
+		else {
+			printf("%-28s %12s %12s\n", pCase->name, "failed", "-");
+			failed = TRUE;
+		}
+	}
+	if (!optMatch || strstr("pipe zero copy unsent item", optMatch)) {
+		bool ok = x_checkPipeTxCopyBack(optTxRate);
+		printf("%-28s %12s %12s\n", "pipe zero copy unsent item", ok ? "ok" : "failed", "-");
+		failed = failed || !ok;
+	}
+	if (!optMatch || strstr("pipe fragment loopback", optMatch)) {
+		bool ok = x_checkPipeFragLoopback();
+		printf("%-28s %12s %12s\n", "pipe fragment loopback", "-", ok ? "ok" : "failed");
+		failed = failed || !ok;
+	}
+	if (!optMatch || strstr("pipe fragment stale tail", optMatch)) {
+		bool ok = x_checkPipeFragStaleTail(1) && x_checkPipeFragStaleTail(2);
+		printf("%-28s %12s %12s\n", "pipe fragment stale tail", ok ? "ok" : "failed", "-");
+		failed = failed || !ok;
+	}
+
+	for (i1 = 0; i1 < sizeof(benchConcealCases) / sizeof(benchConcealCases[0]); i1++) {
+		const bench_conceal_case_t *pCase = &benchConcealCases[i1];
+		if (optMatch && !strstr(pCase->name, optMatch)) {
+			continue;
+		}
+		bool ok = x_checkConcealment(pCase, optTxRate);
+		printf("%-28s %12s %12s\n", pCase->name, "-", ok ? "ok" : "failed");
+		failed = failed || !ok;
+	}
+	if (!optMatch || strstr("aaf slot straddle", optMatch)) {
+		bool ok = x_checkSlotStraddle(optTxRate);
+		printf("%-28s %12s %12s\n", "aaf slot straddle", "-", ok ? "ok" : "failed");
+		failed = failed || !ok;
+	}
+
+	osalAVBTimeClose();
+	avbLogExit();
+	if (logFile) {
+		fclose(logFile);
+	}
+	return failed ? -1 : 0;
+}
@@ -0,0 +1,250 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+
+
+/*
+* MODULE SUMMARY : Media clock synthesizer simulation.
+*
+* Runs the media clock synthesizer (mcs) against a simulated gPTP clock for
+* hours of edges in a few seconds. The media source runs at a ppm offset from
+* gPTP with a slow wander, and the synthesizer is called the way an interface
+* module calls it: late by a random scheduling delay, optionally in bursts,
+* with an occasional long stall. After the servo has settled, the phase of the
+* synthesized edges against the true media clock edges and the largest
+* edge-to-edge step are reported and checked against a bound.
+*
+* The same run is repeated with the previous fixed correction scheme (integer
+* period plus a correction every 10 edges, free running) for comparison.
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "openavb_types_pub.h"
+#include "openavb_mcs.h"
+#include "openavb_clock_sim.h"
+
+#define	AVB_LOG_COMPONENT	"MCS Sim"
+#include "openavb_log_pub.h"
+
+// Time allowed for the servo to lock before the phase is checked
+#define SIM_SETTLE_SEC			120
+// An interface stall of SIM_STALL_USEC every SIM_STALL_EVERY_SEC
+#define SIM_STALL_EVERY_SEC		37
+#define SIM_STALL_USEC			3000
+
+typedef struct {
+	clock_sim_cfg_t clk;
+	double hours;
+	U32 burst;
+} sim_cfg_t;
+
+typedef struct {
+	U64 edges;
+	// Phase of the synthesized edges after settling. The step is the difference
+	// between the synthesized and the true edge interval.
+	clock_sim_stats_t phase;
+	U32 relocks;
+	S32 rateMin;
+	S32 rateMax;
+} sim_result_t;
+
+// Run the simulation. With legacy set, the synthesizer is replaced by the
+// integer period and every-10-edges correction used before the servo.
+static void x_runSim(const sim_cfg_t *pCfg, bool legacy, sim_result_t *pRes)
+{
+	const clock_sim_cfg_t *pClk = &pCfg->clk;
+	const long double periodNS = (long double)NANOSECONDS_PER_SECOND * pClk->framesPerItem / pClk->audioRate;
+	const U64 totalEdges = (U64)(pCfg->hours * 3600.0 * NANOSECONDS_PER_SECOND / (double)periodNS);
+	const U64 settleEdges = (U64)(SIM_SETTLE_SEC * (double)NANOSECONDS_PER_SECOND / (double)periodNS);
+	const U64 stallEvery = (U64)(SIM_STALL_EVERY_SEC * (double)NANOSECONDS_PER_SECOND / (double)periodNS);
+	U64 legacyInterval = 0, legacyRem = 0;
+	long double trueEdge, prevTrueEdge = 0;
+	U64 prevEdge = 0, lastNow = 0, k;
+	mcs_t mcs;
+
+	openavbClockSimSeed(pClk->seed);
+	memset(pRes, 0, sizeof(*pRes));
+	openavbClockSimStatsInit(&pRes->phase);
+
+	if (legacy) {
+		// As the interface modules computed it before
+		U32 per = MICROSECONDS_PER_SECOND * pClk->framesPerItem * 10;
+		U32 rate = pClk->audioRate / 100;
+		legacyInterval = per / rate;
+		legacyRem = per % rate;
+		if (legacyRem != 0) {
+			legacyRem *= 10;
+			legacyRem /= rate;
+		}
+	}
+	else {
+		openavbMcsInit(&mcs, (U64)NANOSECONDS_PER_SECOND * pClk->framesPerItem, pClk->audioRate);
+		openavbMcsServoInit(&mcs, 0, 0, 0);
+	}
+
+	// Start an hour into the gPTP timeline
+	trueEdge = 3600.0L * NANOSECONDS_PER_SECOND;
+	for (k = 0; k <= totalEdges; k++) {
+		double secs = (double)k * (double)periodNS / NANOSECONDS_PER_SECOND;
+		double ppm = openavbClockSimPPM(pClk, secs);
+		U64 now, edge;
+
+		if (k > 0) {
+			trueEdge += periodNS * (1.0L + ppm * 1e-6L);
+		}
+
+		// The item is handed over once the last edge of its burst is available,
+		// plus a scheduling delay. Time never runs backwards for the caller.
+		now = (U64)(trueEdge + (long double)periodNS * (pCfg->burst - 1 - (k % pCfg->burst)));
+		now += openavbClockSimDelayNS(pClk->jitterUsec);
+		if (stallEvery && k % stallEvery == stallEvery - 1) {
+			now += SIM_STALL_USEC * NANOSECONDS_PER_USEC;
+		}
+		if (now < lastNow) {
+			now = lastNow;
+		}
+		lastNow = now;
+
+		if (legacy) {
+			if (k == 0) {
+				edge = now;
+			}
+			else {
+				edge = prevEdge + legacyInterval;
+				if (k % 10 == 0) {
+					edge += legacyRem;
+				}
+			}
+		}
+		else {
+			openavbMcsAdvanceAt(&mcs, now);
+			edge = mcs.edgeTime;
+			if (k >= settleEdges) {
+				if (mcs.ratePPB < pRes->rateMin || pRes->rateMin == 0) {
+					pRes->rateMin = mcs.ratePPB;
+				}
+				if (mcs.ratePPB > pRes->rateMax || pRes->rateMax == 0) {
+					pRes->rateMax = mcs.ratePPB;
+				}
+			}
+		}
+
+		if (k > 0) {
+			pRes->edges++;
+			if (k >= settleEdges) {
+				double err = (double)((long double)edge - trueEdge);
+				double step = (double)(((long double)edge - (long double)prevEdge) - (trueEdge - prevTrueEdge));
+				openavbClockSimStatsAdd(&pRes->phase, err, step);
+			}
+		}
+		prevEdge = edge;
+		prevTrueEdge = trueEdge;
+	}
+
+	if (!legacy) {
+		pRes->relocks = mcs.relockCount;
+	}
+}
+
+static const sim_cfg_t simDefaults = { { 48000, 6, 37.5, 2.0, 50, 1, 5000 }, 4.0, 1 };
+
+static void openavbMcsSimUsage(char *programName)
+{
+	printf(
+		"\n"
+		"Usage: %s [options]\n"
+		"  -h         Prints this message.\n"
+		"  -H val     Hours of media clock to simulate (default 4).\n"
+		,
+		programName);
+	openavbClockSimUsage(&simDefaults.clk, "media source", "scheduling delay of the caller");
+	printf(
+		"  -b val     Items handed over per burst (default 1).\n"
+		"  -e val     Phase bound in ns; the run fails if the peak to peak phase\n"
+		"             error or any step after settling exceeds it (default 5000).\n"
+		"\n"
+		"Examples:\n"
+		"  %s -H 8 -r 44100 -f 7\n"
+		"    Eight hours of 44.1 kHz items of 7 frames, a period of 158730.158... ns.\n\n"
+		,
+		programName);
+}
+
+int main(int argc, char *argv[])
+{
+	sim_cfg_t cfg = simDefaults;
+	sim_result_t res, legacyRes;
+	bool pass;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "hH:b:" CLOCK_SIM_OPTIONS)) != -1) {
+		if (openavbClockSimOption(&cfg.clk, opt, optarg)) {
+			continue;
+		}
+		switch (opt) {
+			case 'H':
+				cfg.hours = strtod(optarg, NULL);
+				break;
+			case 'b':
+				cfg.burst = strtoul(optarg, NULL, 10);
+				break;
+			case 'h':
+			default:
+				openavbMcsSimUsage(argv[0]);
+				return opt == 'h' ? 0 : -1;
+		}
+	}
+	if (cfg.hours * 3600.0 <= SIM_SETTLE_SEC || cfg.clk.audioRate < 100 || cfg.clk.framesPerItem < 1 || cfg.burst < 1) {
+		openavbMcsSimUsage(argv[0]);
+		return -1;
+	}
+
+	avbLogInit();
+
+	x_runSim(&cfg, FALSE, &res);
+	x_runSim(&cfg, TRUE, &legacyRes);
+
+	printf("%.2f h, %u Hz, %u frames/item, source %+.3f ppm (+/- %.3f), delay < %u us, burst %u\n",
+		cfg.hours, cfg.clk.audioRate, cfg.clk.framesPerItem, cfg.clk.ppm, cfg.clk.wanderPPM, cfg.clk.jitterUsec, cfg.burst);
+	printf("%-10s %12s %12s %12s %12s %12s\n", "", "edges", "phase min", "phase max", "max step", "final");
+	printf("%-10s %12llu %12.0f %12.0f %12.1f %12.0f  (ns, rate %d..%d ppb, %u relocks)\n", "servo",
+		(unsigned long long)res.edges, res.phase.min, res.phase.max, res.phase.stepMax, res.phase.last,
+		res.rateMin, res.rateMax, res.relocks);
+	printf("%-10s %12llu %12.0f %12.0f %12.1f %12.0f  (ns)\n", "fixed",
+		(unsigned long long)legacyRes.edges, legacyRes.phase.min, legacyRes.phase.max, legacyRes.phase.stepMax, legacyRes.phase.last);
+
+	pass = (res.phase.max - res.phase.min) <= cfg.clk.boundNS && res.phase.stepMax <= cfg.clk.boundNS && res.relocks == 0;
+	return openavbClockSimDone(pass);
+}
@@ -0,0 +1,229 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+
+
+/*
+* MODULE SUMMARY : Talker wake up benchmark.
+*
+* Runs the three ways a non blocking talker can wait for its next interval
+* (spin_wait in the stream ini) on a fixed interval grid and reports how late
+* each wake up is and how much CPU the waiting thread uses:
+*   sleep   SLEEP_UNTIL_NSEC(), spin_wait = 0
+*   spin    SPIN_UNTIL_NSEC() with a guard as long as the interval, so the
+*           thread never sleeps
+*   guard   SPIN_UNTIL_NSEC() with spin_wait_guard_usec, spin_wait = 1
+* The thread does no work between wake ups, so the CPU figure is the cost of
+* the wait alone. Run it with the priority and CPU affinity the talker gets.
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include "openavb_platform_pub.h"
+#include "openavb_types_pub.h"
+#include "openavb_time_osal_pub.h"
+#include "openavb_os_services_osal.h"
+
+#define	AVB_LOG_COMPONENT	"Wake Bench"
+#include "openavb_log_pub.h"
+
+typedef enum {
+	BENCH_WAKE_SLEEP,
+	BENCH_WAKE_SPIN,
+	BENCH_WAKE_GUARD,
+	BENCH_WAKE_MODES
+} bench_wake_mode_t;
+
+static const char *benchWakeModeNames[BENCH_WAKE_MODES] = { "sleep", "spin", "guard" };
+
+typedef struct {
+	U32 intervalUsec;
+	U32 guardUsec;
+	U32 seconds;
+	bool wallTime;
+} bench_cfg_t;
+
+typedef struct {
+	U32 wakes;
+	double cpuPercent;
+	double avgUsec;
+	double p50Usec;
+	double p99Usec;
+	double maxUsec;
+} bench_result_t;
+
+static U64 x_threadCpuNSec(void)
+{
+	struct timespec tmpTime;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tmpTime);
+	return ((U64)tmpTime.tv_sec * NANOSECONDS_PER_SECOND) + tmpTime.tv_nsec;
+}
+
+static int x_cmpU32(const void *a, const void *b)
+{
+	U32 x = *(const U32 *)a, y = *(const U32 *)b;
+	return x < y ? -1 : x > y;
+}
+
+// Wake up every interval for the configured time and collect how late each wake up was
+static bool x_runMode(const bench_cfg_t *pCfg, bench_wake_mode_t mode, bench_result_t *pRes)
+{
+	U64 intervalNS = (U64)pCfg->intervalUsec * NANOSECONDS_PER_USEC;
+	U64 guardNS = (mode == BENCH_WAKE_SPIN) ? intervalNS : (U64)pCfg->guardUsec * NANOSECONDS_PER_USEC;
+	U32 wakes = (U32)(((U64)pCfg->seconds * NANOSECONDS_PER_SECOND) / intervalNS);
+	U32 *pLateNS = calloc(wakes, sizeof(U32));
+	spin_wait_t wait;
+	U64 nextNS, nowNS, startNS, cpuNS, sumNS = 0;
+	U32 i;
+
+	if (!pLateNS) {
+		AVB_LOG_ERROR("Out of memory");
+		return FALSE;
+	}
+	memset(&wait, 0, sizeof(wait));
+	if (!pCfg->wallTime) {
+		// Never resync; the spin modes then wait on CLOCK_MONOTONIC with a zero offset
+		wait.nextResyncNS = (U64)-1;
+	}
+
+	if (mode == BENCH_WAKE_SLEEP) {
+		CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
+	}
+	else {
+		nowNS = WALLTIME_CACHED_NSEC(&wait);
+	}
+	startNS = nowNS;
+	nextNS = nowNS + intervalNS;
+	cpuNS = x_threadCpuNSec();
+
+	for (i = 0; i < wakes; i++) {
+		if (mode == BENCH_WAKE_SLEEP) {
+			SLEEP_UNTIL_NSEC(nextNS);
+			CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
+		}
+		else {
+			nowNS = SPIN_UNTIL_NSEC(&wait, nextNS, guardNS);
+		}
+		pLateNS[i] = nowNS > nextNS ? (U32)(nowNS - nextNS) : 0;
+		sumNS += pLateNS[i];
+		nextNS += intervalNS;
+		// Stay on the grid after a wake up later than a whole interval, as the talker does
+		if (nowNS > nextNS) {
+			nextNS += ((nowNS - nextNS) / intervalNS + 1) * intervalNS;
+		}
+	}
+
+	cpuNS = x_threadCpuNSec() - cpuNS;
+	pRes->wakes = wakes;
+	pRes->cpuPercent = 100.0 * (double)cpuNS / (double)(nowNS - startNS);
+
+	qsort(pLateNS, wakes, sizeof(U32), x_cmpU32);
+	pRes->avgUsec = (double)sumNS / wakes / NANOSECONDS_PER_USEC;
+	pRes->p50Usec = (double)pLateNS[wakes / 2] / NANOSECONDS_PER_USEC;
+	pRes->p99Usec = (double)pLateNS[(U64)wakes * 99 / 100] / NANOSECONDS_PER_USEC;
+	pRes->maxUsec = (double)pLateNS[wakes - 1] / NANOSECONDS_PER_USEC;
+
+	free(pLateNS);
+	return TRUE;
+}
+
+static const bench_cfg_t benchDefaults = { 125, 50, 5, FALSE };
+
+static void openavbWakeBenchUsage(char *programName)
+{
+	printf(
+		"\n"
+		"Usage: %s [options]\n"
+		"  -h         Prints this message.\n"
+		"  -i val     Wake up interval in usec (default %u, 8000 per second).\n"
+		"  -g val     Guard in usec for the guard mode (default %u).\n"
+		"  -s val     Seconds to run each mode (default %u).\n"
+		"\n"
+		"Examples:\n"
+		"  chrt -f 80 taskset -c 1 %s -g 20\n"
+		"    Measure with a 20 usec guard on an isolated core at the talker priority.\n\n"
+		,
+		programName, benchDefaults.intervalUsec, benchDefaults.guardUsec, benchDefaults.seconds, programName);
+}
+
+int main(int argc, char *argv[])
+{
+	bench_cfg_t cfg = benchDefaults;
+	bench_result_t res;
+	bench_wake_mode_t mode;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "hi:g:s:")) != -1) {
+		switch (opt) {
+			case 'i':
+				cfg.intervalUsec = strtoul(optarg, NULL, 10);
+				break;
+			case 'g':
+				cfg.guardUsec = strtoul(optarg, NULL, 10);
+				break;
+			case 's':
+				cfg.seconds = strtoul(optarg, NULL, 10);
+				break;
+			case 'h':
+			default:
+				openavbWakeBenchUsage(argv[0]);
+				return opt == 'h' ? 0 : -1;
+		}
+	}
+	if (cfg.intervalUsec < 1 || cfg.seconds < 1) {
+		openavbWakeBenchUsage(argv[0]);
+		return -1;
+	}
+
+	avbLogInit();
+	cfg.wallTime = osalAVBTimeInit();
+	if (!cfg.wallTime) {
+		printf("gPTP time not available, the spin modes run without the wall time offset\n");
+	}
+
+	printf("%u usec interval, %u usec guard, %u s per mode\n", cfg.intervalUsec, cfg.guardUsec, cfg.seconds);
+	printf("%-8s %10s %8s %10s %10s %10s %10s\n", "mode", "wakes", "cpu %", "avg late", "p50", "p99", "max");
+	for (mode = BENCH_WAKE_SLEEP; mode < BENCH_WAKE_MODES; mode++) {
+		if (!x_runMode(&cfg, mode, &res)) {
+			break;
+		}
+		printf("%-8s %10u %8.1f %10.1f %10.1f %10.1f %10.1f  (us)\n", benchWakeModeNames[mode],
+			res.wakes, res.cpuPercent, res.avgUsec, res.p50Usec, res.p99Usec, res.maxUsec);
+	}
+
+	if (cfg.wallTime) {
+		osalAVBTimeClose();
+	}
+	avbLogExit();
+	return mode == BENCH_WAKE_MODES ? 0 : -1;
+}
@@ -31,11 +31,13 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #include <stdlib.h>
 #include <string.h>
+#include <sys/wait.h>
 #include "openavb_platform.h"
 #include "openavb_trace.h"
 #include "openavb_avdecc_cfg.h"
 #include "openavb_avdecc_read_ini_pub.h"
 #include "openavb_avdecc_msg.h"
+#include "openavb_aem.h"
 #include "openavb_list.h"
 
 #define	AVB_LOG_COMPONENT	"AVDECC"
@@ -53,19 +55,62 @@ static void* avdeccServerThread(void *arg);
 
 static bool avdeccInitSucceeded;
 
-bool startAvdecc(const char* ifname, const char **inifiles, int numfiles)
+static void freeAvdeccConfig(void)
 {
-	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC);
-	LOG_EAVB_CORE_VERSION();
+	// Free the INI file items.
+	while (streamList) {
+		openavb_tl_data_cfg_t * del = streamList;
+		streamList = streamList->next;
+		free(del);
+	}
+}
 
-	// Ensure that we're running as root
-	//  (need to be root to use raw sockets)
-	uid_t euid = geteuid();
-	if (euid != (uid_t)0) {
-		fprintf(stderr, "Error: needs to run as root\n\n");
-		goto error;
+// FNV-1a over a block of configuration data
+static U32 hashAvdeccBytes(U32 hash, const void *pData, size_t len)
+{
+	size_t i1;
+	for (i1 = 0; i1 < len; i1++) {
+		hash = (hash ^ ((const U8 *) pData)[i1]) * 16777619u;
 	}
+	return hash;
+}
 
+static U32 hashAvdeccString(U32 hash, const char *pStr, size_t size)
+{
+	// Include the terminator, so moving a character between two strings changes the hash.
+	return hashAvdeccBytes(hash, pStr, strnlen(pStr, size) + 1);
+}
+
+// Hash of the configuration the compiled descriptors are built from. A compiled model
+// generated from a configuration with the same hash holds the descriptors this one would
+// build. Only the settings those descriptors read are hashed, so changing any other
+// setting (interface, stream formats, entity strings, ...) keeps the model valid:
+//   LOCALE, STRINGS                  locale_identifier, vendor_name and model_name
+//   CONFIGURATION descriptor counts  the role of each stream, in order
+//   CLOCK_SOURCE                     the role of each stream and the stream_addr of listeners
+// The other compiled types are the same for every configuration.
+static U32 hashAvdeccConfig(void)
+{
+	U32 hash = 2166136261u;
+
+	hash = hashAvdeccString(hash, gAvdeccCfg.locale_identifier, sizeof(gAvdeccCfg.locale_identifier));
+	hash = hashAvdeccString(hash, gAvdeccCfg.vendor_name, sizeof(gAvdeccCfg.vendor_name));
+	hash = hashAvdeccString(hash, gAvdeccCfg.model_name, sizeof(gAvdeccCfg.model_name));
+
+	openavb_tl_data_cfg_t *pStream;
+	for (pStream = streamList; pStream; pStream = pStream->next) {
+		U8 role = (U8) pStream->role;
+		hash = hashAvdeccBytes(hash, &role, sizeof(role));
+		if (pStream->role == AVB_ROLE_LISTENER) {
+			hash = hashAvdeccBytes(hash, pStream->stream_addr.buffer.ether_addr_octet, ETH_ALEN);
+		}
+	}
+
+	return hash;
+}
+
+static bool readAvdeccConfig(const char* ifname, const char **inifiles, int numfiles)
+{
 	// Get the AVDECC configuration
 	memset(&gAvdeccCfg, 0, sizeof(openavb_avdecc_cfg_t));
 	openavbReadAvdeccConfig(DEFAULT_AVDECC_INI_FILE, &gAvdeccCfg);
@@ -107,6 +152,34 @@ bool startAvdecc(const char* ifname, const char **inifiles, int numfiles)
 		prevStream = newStream;
 	}
 
+	return true;
+
+error:
+	return false;
+}
+
+bool startAvdecc(const char* ifname, const char **inifiles, int numfiles)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC);
+	LOG_EAVB_CORE_VERSION();
+
+	// Ensure that we're running as root
+	//  (need to be root to use raw sockets)
+	uid_t euid = geteuid();
+	if (euid != (uid_t)0) {
+		fprintf(stderr, "Error: needs to run as root\n\n");
+		goto error;
+	}
+
+	if (!readAvdeccConfig(ifname, inifiles, numfiles)) {
+		goto error;
+	}
+
+#if AVB_FEATURE_AEM_COMPILED
+	// Serve the fixed descriptors from the model compiled into this binary, if it was generated from these ini files.
+	openavbAemSetCompiledModel(&openavbAemCompiledModel, hashAvdeccConfig());
+#endif
+
 	/* Run AVDECC in its own thread. */
 	avdeccRunning = TRUE;
 	avdeccInitSucceeded = FALSE;
@@ -142,14 +215,284 @@ void stopAvdecc()
 
 	AVB_LOG_INFO("Shutting down");
 
-	// Free the INI file items.
-	while (streamList) {
-		openavb_tl_data_cfg_t * del = streamList;
-		streamList = streamList->next;
-		free(del);
+	freeAvdeccConfig();
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+}
+
+// Build the entity model from the INI files the same way startAvdecc() does and write
+// the descriptors that can be compiled as C source. Always uses the runtime model, so
+// a binary built with a compiled model can regenerate it.
+bool generateAvdeccModel(const char* ifname, const char **inifiles, int numfiles, const char *outfile)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC);
+
+	bool ret = false;
+	FILE *pFile = NULL;
+
+	openavbAemSetCompiledModel(NULL, 0);
+
+	if (!readAvdeccConfig(ifname, inifiles, numfiles)) {
+		goto done;
+	}
+	U32 configHash = hashAvdeccConfig();
+
+	if (!openavbAvdeccInitialize()) {
+		AVB_LOG_ERROR("Failed to initialize AVDECC");
+		goto cleanup;
 	}
 
+	pFile = fopen(outfile, "w");
+	if (!pFile) {
+		AVB_LOGF_ERROR("Unable to open %s: %s", outfile, strerror(errno));
+		goto cleanup;
+	}
+
+	ret = IS_OPENAVB_SUCCESS(openavbAemWriteCompiledModel(pFile, configHash));
+	if (fclose(pFile) != 0) {
+		ret = false;
+	}
+	if (ret) {
+		AVB_LOGF_INFO("Wrote compiled entity model to %s", outfile);
+	}
+
+cleanup:
+	openavbAvdeccCleanup();
+done:
+	freeAvdeccConfig();
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+	return ret;
+}
+
+// Number of times each model is built by checkAvdeccModel()
+#define AVDECC_CHECK_RUNS 101
+// Highest descriptor index of a type checkAvdeccModel() reads back
+#define AVDECC_CHECK_MAX_INDEX 256
+
+typedef struct {
+	U32 buildUSec;
+	U32 descriptorCount;
+	U32 descriptorBytes;
+	U32 rssKB;
+	U32 servedCount;
+} avdecc_check_result_t;
+
+typedef struct {
+	U16 descriptorType;
+	U16 descriptorIdx;
+	U16 length;
+	U8 image[OPENAVB_AEM_COMPILED_MAX_DESCRIPTOR];
+} avdecc_check_descriptor_t;
+
+static bool checkAvdeccRead(int fd, void *pBuf, size_t len)
+{
+	while (len) {
+		ssize_t n = read(fd, pBuf, len);
+		if (n <= 0) {
+			return false;
+		}
+		pBuf = (U8 *) pBuf + n;
+		len -= n;
+	}
+	return true;
+}
+
+// Build the model in a child process, so every build starts from a fresh process like
+// openavb_avdecc does. The child sends the build stats, then every descriptor
+// READ_DESCRIPTOR would serve. Returns the number of descriptors read into pDescriptors.
+static int checkAvdeccBuild(const openavb_aem_compiled_model_t *pCompiledModel, U32 configHash,
+	avdecc_check_result_t *pResult, avdecc_check_descriptor_t *pDescriptors)
+{
+	int fds[2];
+	pid_t pid;
+	int status, ret = -1;
+
+	if (pipe(fds) != 0) {
+		AVB_LOGF_ERROR("pipe failed: %s", strerror(errno));
+		return -1;
+	}
+	pid = fork();
+	if (pid < 0) {
+		AVB_LOGF_ERROR("fork failed: %s", strerror(errno));
+		close(fds[0]);
+		close(fds[1]);
+		return -1;
+	}
+
+	if (pid == 0) {
+		avdecc_check_result_t result;
+		U64 startNS, endNS;
+		FILE *pStatm;
+		unsigned long sizePages, rssPages = 0;
+		U16 type, idx;
+
+		close(fds[0]);
+		memset(&result, 0, sizeof(result));
+		if (!openavbAemSetCompiledModel(pCompiledModel, configHash)) {
+			_exit(1);
+		}
+		CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &startNS);
+		if (!openavbAvdeccInitialize()) {
+			_exit(1);
+		}
+		CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &endNS);
+		result.buildUSec = (endNS - startNS) / NANOSECONDS_PER_USEC;
+		result.descriptorCount = openavbAemGetModel()->descriptorCount;
+		result.descriptorBytes = openavbAemGetModel()->descriptorBytes;
+		pStatm = fopen("/proc/self/statm", "r");
+		if (pStatm) {
+			if (fscanf(pStatm, "%lu %lu", &sizePages, &rssPages) != 2) {
+				rssPages = 0;
+			}
+			fclose(pStatm);
+		}
+		result.rssKB = rssPages * (sysconf(_SC_PAGESIZE) / 1024);
+
+		// Count the descriptors first, as the stats go ahead of them.
+		avdecc_check_descriptor_t descriptor;
+		for (type = 0; type < OPENAVB_AEM_DESCRIPTOR_COUNT; type++) {
+			for (idx = 0; idx < AVDECC_CHECK_MAX_INDEX &&
+					IS_OPENAVB_SUCCESS(openavbAemSerializeDescriptor(0, type, idx, sizeof(descriptor.image), descriptor.image, &descriptor.length)); idx++) {
+				result.servedCount++;
+			}
+		}
+		if (write(fds[1], &result, sizeof(result)) != sizeof(result)) {
+			_exit(1);
+		}
+		for (type = 0; type < OPENAVB_AEM_DESCRIPTOR_COUNT; type++) {
+			for (idx = 0; idx < AVDECC_CHECK_MAX_INDEX; idx++) {
+				memset(&descriptor, 0, sizeof(descriptor));
+				descriptor.descriptorType = type;
+				descriptor.descriptorIdx = idx;
+				if (IS_OPENAVB_FAILURE(openavbAemSerializeDescriptor(0, type, idx, sizeof(descriptor.image), descriptor.image, &descriptor.length))) {
+					break;
+				}
+				if (write(fds[1], &descriptor, sizeof(descriptor)) != sizeof(descriptor)) {
+					_exit(1);
+				}
+			}
+		}
+		_exit(0);
+	}
+
+	close(fds[1]);
+	if (checkAvdeccRead(fds[0], pResult, sizeof(*pResult)) && pResult->servedCount <= OPENAVB_AEM_COMPILED_MAX_DESCRIPTORS &&
+			checkAvdeccRead(fds[0], pDescriptors, pResult->servedCount * sizeof(*pDescriptors))) {
+		ret = pResult->servedCount;
+	}
+	close(fds[0]);
+	if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		ret = -1;
+	}
+	return ret;
+}
+
+static int checkAvdeccCompareU32(const void *a, const void *b)
+{
+	U32 x = *(const U32 *) a, y = *(const U32 *) b;
+	return x < y ? -1 : x > y;
+}
+
+// Build the model AVDECC_CHECK_RUNS times and log the median build time and the memory used.
+// Returns the number of descriptors the last build serves, -1 if a build failed.
+static int checkAvdeccModelRuns(const char *pName, const openavb_aem_compiled_model_t *pCompiledModel, U32 configHash,
+	avdecc_check_descriptor_t *pDescriptors)
+{
+	avdecc_check_result_t result;
+	U32 buildUSec[AVDECC_CHECK_RUNS];
+	int run, count = -1;
+
+	for (run = 0; run < AVDECC_CHECK_RUNS; run++) {
+		count = checkAvdeccBuild(pCompiledModel, configHash, &result, pDescriptors);
+		if (count < 0) {
+			AVB_LOGF_ERROR("Building the %s entity model failed", pName);
+			return -1;
+		}
+		buildUSec[run] = result.buildUSec;
+	}
+	qsort(buildUSec, AVDECC_CHECK_RUNS, sizeof(U32), checkAvdeccCompareU32);
+
+	AVB_LOGF_INFO("%s model: built in %u usec (median of %u), %u descriptors, %u bytes allocated, %u kB RSS, %d descriptors served",
+		pName, buildUSec[AVDECC_CHECK_RUNS / 2], AVDECC_CHECK_RUNS, result.descriptorCount, result.descriptorBytes, result.rssKB, count);
+	return count;
+}
+
+// Build the entity model from the INI files at runtime and, if this binary holds a compiled
+// model, with the compiled model. Logs the build time and memory of each, and checks that
+// both serve the same bytes for every descriptor.
+bool checkAvdeccModel(const char* ifname, const char **inifiles, int numfiles)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC);
+
+	bool ret = false;
+	avdecc_check_descriptor_t *pRuntime = NULL, *pCompiled = NULL;
+	int runtimeCount;
+
+	openavbAemSetCompiledModel(NULL, 0);
+
+	if (!readAvdeccConfig(ifname, inifiles, numfiles)) {
+		goto done;
+	}
+	U32 configHash = hashAvdeccConfig();
+
+	pRuntime = calloc(OPENAVB_AEM_COMPILED_MAX_DESCRIPTORS, sizeof(*pRuntime));
+	pCompiled = calloc(OPENAVB_AEM_COMPILED_MAX_DESCRIPTORS, sizeof(*pCompiled));
+	if (!pRuntime || !pCompiled) {
+		AVB_LOG_ERROR("Out of memory");
+		goto done;
+	}
+
+	runtimeCount = checkAvdeccModelRuns("Runtime", NULL, configHash, pRuntime);
+	if (runtimeCount < 0) {
+		goto done;
+	}
+
+#if AVB_FEATURE_AEM_COMPILED
+	if (openavbAemCompiledModel.configHash != configHash) {
+		AVB_LOGF_ERROR("Compiled entity model doesn't match the configuration (0x%08x, expected 0x%08x)",
+			openavbAemCompiledModel.configHash, configHash);
+		goto done;
+	}
+	AVB_LOGF_INFO("Compiled model: %u descriptors, %u bytes read-only",
+		openavbAemCompiledModel.descriptorCount, openavbAemCompiledModel.imageLength);
+
+	int compiledCount = checkAvdeccModelRuns("Compiled", &openavbAemCompiledModel, configHash, pCompiled);
+	if (compiledCount < 0) {
+		goto done;
+	}
+
+	ret = true;
+	int i1;
+	if (compiledCount != runtimeCount) {
+		AVB_LOGF_ERROR("The runtime model serves %d descriptors, the compiled model %d", runtimeCount, compiledCount);
+		ret = false;
+	}
+	for (i1 = 0; i1 < runtimeCount && i1 < compiledCount; i1++) {
+		if (pRuntime[i1].descriptorType != pCompiled[i1].descriptorType ||
+				pRuntime[i1].descriptorIdx != pCompiled[i1].descriptorIdx ||
+				pRuntime[i1].length != pCompiled[i1].length ||
+				memcmp(pRuntime[i1].image, pCompiled[i1].image, pRuntime[i1].length) != 0) {
+			AVB_LOGF_ERROR("Descriptor 0x%04x/%u differs between the runtime and compiled models",
+				pRuntime[i1].descriptorType, pRuntime[i1].descriptorIdx);
+			ret = false;
+		}
+	}
+	if (ret) {
+		AVB_LOGF_INFO("All %d descriptors are the same in the runtime and compiled models", runtimeCount);
+	}
+#else
+	AVB_LOG_INFO("No compiled entity model in this build. Build with AVB_AEM_COMPILED_MODEL to compare against one.");
+	ret = true;
+#endif
+
+done:
+	free(pRuntime);
+	free(pCompiled);
+	freeAvdeccConfig();
+
 	AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+	return ret;
 }
 
 static void* avdeccServerThread(void *arg)
@@ -41,5 +41,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 bool startAvdecc(const char* ifname, const char *inifiles[], int numfiles);
 void stopAvdecc();
+bool generateAvdeccModel(const char* ifname, const char *inifiles[], int numfiles, const char *outfile);
+bool checkAvdeccModel(const char* ifname, const char *inifiles[], int numfiles);
 
 #endif // OSAL_AVDECC_H
@@ -37,6 +37,10 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_avdecc_pipeline_interaction_pub.h"
 #include "openavb_avdecc_msg_server.h"
 
+#include <stdio.h>
+
+extern openavb_avdecc_cfg_t gAvdeccCfg;
+
 
 bool openavbAVDECCRunListener(openavb_aem_descriptor_stream_io_t *pDescriptorStreamInput, U16 configIdx, openavb_acmp_ListenerStreamInfo_t *pListenerStreamInfo)
 {
@@ -459,6 +463,29 @@ void openavbAVDECCPauseStream(openavb_aem_descriptor_stream_io_t *pDescriptor, b
 	AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
 }
 
+// Read a counter the kernel keeps for the AVB interface from /sys/class/net/<ifname>/<name>.
+// Returns FALSE if the kernel doesn't provide it.
+static bool x_getInterfaceCounter(const char *name, U32 *pValue)
+{
+	// Skip the socket type prefix (e.g. "simple:eth0").
+	const char *ifonly = strchr(gAvdeccCfg.ifname, ':');
+	ifonly = (ifonly ? ifonly + 1 : gAvdeccCfg.ifname);
+
+	char path[128];
+	snprintf(path, sizeof(path), "/sys/class/net/%s/%s", ifonly, name);
+	FILE *pFile = fopen(path, "r");
+	if (!pFile) {
+		return FALSE;
+	}
+	unsigned long long value;
+	bool bRead = (fscanf(pFile, "%llu", &value) == 1);
+	fclose(pFile);
+
+	// The counters wrap at 32 bits, as IEEE 1722.1 counters do.
+	if (bRead && pValue) { *pValue = (U32)value; }
+	return bRead;
+}
+
 // Get the current counter value in pValue.  Returns TRUE if the counter is supported, FALSE otherwise.
 bool openavbAVDECCGetCounterValue(void *pDescriptor, U16 descriptorType, U32 counterFlag, U32 *pValue)
 {
@@ -476,20 +503,59 @@ bool openavbAVDECCGetCounterValue(void *pDescriptor, U16 descriptorType, U32 cou
 		break;
 
 	case OPENAVB_AEM_DESCRIPTOR_AVB_INTERFACE:
-		// AVDECC_TODO - Get the LINK_UP, LINK_DOWN, FRAMES_TX, FRAMES_RX, RX_CRC_ERROR. and GPTP_GM_CHANGED counts from the gPTP daemon.
-		break;
+		{
+			// The kernel counts link changes and frames for the interface.
+			// GPTP_GM_CHANGED is not supported, as the gPTP daemon doesn't count grandmaster changes.
+			bool bSupported = FALSE;
+			switch (counterFlag) {
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_AVB_INTERFACE_COUNTER_LINK_UP:
+				bSupported = x_getInterfaceCounter("carrier_up_count", pValue);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_AVB_INTERFACE_COUNTER_LINK_DOWN:
+				bSupported = x_getInterfaceCounter("carrier_down_count", pValue);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_AVB_INTERFACE_COUNTER_FRAMES_TX:
+				bSupported = x_getInterfaceCounter("statistics/tx_packets", pValue);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_AVB_INTERFACE_COUNTER_FRAMES_RX:
+				bSupported = x_getInterfaceCounter("statistics/rx_packets", pValue);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_AVB_INTERFACE_COUNTER_RX_CRC_ERROR:
+				bSupported = x_getInterfaceCounter("statistics/rx_crc_errors", pValue);
+				break;
+			default:
+				break;
+			}
+			AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+			return bSupported;
+		}
 
 	case OPENAVB_AEM_DESCRIPTOR_CLOCK_DOMAIN:
 		{
+			// The clock source of a Listener is its input stream, so the domain locks and unlocks
+			// with the media of the stream. A Talker uses its internal clock, which is always locked.
+			// (See openavbAemDescriptorClockSourceInitialize.)
+			openavb_aem_descriptor_stream_io_t *pDescriptorStreamInput =
+				openavbAemGetDescriptor(openavbAemGetConfigIdx(), OPENAVB_AEM_DESCRIPTOR_STREAM_INPUT, 0);
 			switch (counterFlag) {
 			case OPENAVB_AEM_GET_COUNTERS_COMMAND_CLOCK_DOMAIN_COUNTER_LOCKED:
-				AVB_LOG_ERROR("OPENAVB_AEM_GET_COUNTERS_COMMAND_CLOCK_DOMAIN_COUNTER_LOCKED Not Implemented!");
+				if (pDescriptorStreamInput) {
+					AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+					return openavbAVDECCGetCounterValue(pDescriptorStreamInput, OPENAVB_AEM_DESCRIPTOR_STREAM_INPUT,
+						OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_MEDIA_LOCKED, pValue);
+				}
 				if (pValue) { *pValue = 1; }
+				AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
 				return TRUE;
 
 			case OPENAVB_AEM_GET_COUNTERS_COMMAND_CLOCK_DOMAIN_COUNTER_UNLOCKED:
-				AVB_LOG_ERROR("OPENAVB_AEM_GET_COUNTERS_COMMAND_CLOCK_DOMAIN_COUNTER_UNLOCKED Not Implemented!");
-				if (pValue) { *pValue = 1; }
+				if (pDescriptorStreamInput) {
+					AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+					return openavbAVDECCGetCounterValue(pDescriptorStreamInput, OPENAVB_AEM_DESCRIPTOR_STREAM_INPUT,
+						OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_MEDIA_UNLOCKED, pValue);
+				}
+				if (pValue) { *pValue = 0; }
+				AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
 				return TRUE;
 
 			default:
@@ -499,10 +565,63 @@ bool openavbAVDECCGetCounterValue(void *pDescriptor, U16 descriptorType, U32 cou
 		}
 
 	case OPENAVB_AEM_DESCRIPTOR_STREAM_INPUT:
-		// AVDECC_TODO - Get the MEDIA_LOCKED, MEDIA_UNLOCKED, STREAM_RESET, SEQ_NUM_MISMATCH, MEDIA_RESET,
-		//     TIMESTAMP_UNCERTAIN, TIMESTAMP_VALID, TIMESTAMP_NOT_VALID, UNSUPPORTED_FORMAT,
-		//     LATE_TIMESTAMP, EARLY_TIMESTAMP, FRAMES_RX, and FRAMES_TX counts.
-		break;
+		{
+			// The Listener publishes its counters in shared memory, so they are read directly.
+			// STREAM_RESET and FRAMES_TX are not supported.
+			openavb_aem_descriptor_stream_io_t *pDescriptorStreamInput = pDescriptor;
+			if (!pDescriptorStreamInput->stream || !pDescriptorStreamInput->stream->client) {
+				break;
+			}
+			const avtp_rx_counters_t *pCounters =
+				openavbAvdeccMsgSrvrGetRxCounters(pDescriptorStreamInput->stream->client->avdeccMsgHandle);
+			if (!pCounters) {
+				break;
+			}
+
+			U32 value;
+			switch (counterFlag) {
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_MEDIA_LOCKED:
+				value = AVTP_RX_COUNTER_GET(pCounters, mediaLocked);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_MEDIA_UNLOCKED:
+				value = AVTP_RX_COUNTER_GET(pCounters, mediaUnlocked);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_SEQ_NUM_MISMATCH:
+				value = AVTP_RX_COUNTER_GET(pCounters, seqMismatch);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_MEDIA_RESET:
+				value = AVTP_RX_COUNTER_GET(pCounters, mediaReset);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_TIMESTAMP_UNCERTAIN:
+				value = AVTP_RX_COUNTER_GET(pCounters, tsUncertain);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_TIMESTAMP_VALID:
+				value = AVTP_RX_COUNTER_GET(pCounters, tsValid);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_TIMESTAMP_NOT_VALID:
+				value = AVTP_RX_COUNTER_GET(pCounters, tsNotValid);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_UNSUPPORTED_FORMAT:
+				value = AVTP_RX_COUNTER_GET(pCounters, unsupportedFormat);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_LATE_TIMESTAMP:
+				value = AVTP_RX_COUNTER_GET(pCounters, lateTimestamp);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_EARLY_TIMESTAMP:
+				value = AVTP_RX_COUNTER_GET(pCounters, earlyTimestamp);
+				break;
+			case OPENAVB_AEM_GET_COUNTERS_COMMAND_STREAM_INPUT_COUNTER_FRAMES_RX:
+				value = AVTP_RX_COUNTER_GET(pCounters, framesRx);
+				break;
+			default:
+				AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+				return FALSE;
+			}
+
+			if (pValue) { *pValue = value; }
+			AVB_TRACE_EXIT(AVB_TRACE_AVDECC);
+			return TRUE;
+		}
 
 	default:
 		break;
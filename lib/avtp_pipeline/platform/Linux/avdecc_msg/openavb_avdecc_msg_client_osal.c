@@ -178,4 +178,53 @@ bool openavbAvdeccMsgClntService(int socketHandle, int timeout)
 	return rc;
 }
 
+openavbAvdeccMsgCounters_t * openavbAvdeccMsgClntCountersOpen(const char * friendly_name)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
+	char name[NAME_MAX];
+	openavbAvdeccMsgCountersName(name, sizeof(name), friendly_name, getpid());
+
+	// Anything left under this name belongs to an earlier process that had the same id.
+	shm_unlink(name);
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (fd < 0) {
+		AVB_LOGF_ERROR("Failed to open counters %s: %s", name, strerror(errno));
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return NULL;
+	}
+	if (ftruncate(fd, sizeof(openavbAvdeccMsgCounters_t)) != 0) {
+		AVB_LOGF_ERROR("Failed to size counters %s: %s", name, strerror(errno));
+		close(fd);
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return NULL;
+	}
+	void *pMem = mmap(NULL, sizeof(openavbAvdeccMsgCounters_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (pMem == MAP_FAILED) {
+		AVB_LOGF_ERROR("Failed to map counters %s: %s", name, strerror(errno));
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return NULL;
+	}
+
+	// The new object is zero filled; mark it valid once the size is set.
+	openavbAvdeccMsgCounters_t *pCounters = pMem;
+	pCounters->size = sizeof(openavbAvdeccMsgCounters_t);
+	__atomic_store_n(&pCounters->magic, AVB_AVDECC_MSG_COUNTERS_MAGIC, __ATOMIC_RELEASE);
+
+	AVB_LOGF_DEBUG("Publishing counters in %s", name);
+	AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+	return pCounters;
+}
+
+void openavbAvdeccMsgClntCountersClose(openavbAvdeccMsgCounters_t * pCounters, const char * friendly_name)
+{
+	// The server keeps its mapping until the client disconnects, so the object can go now.
+	if (pCounters) {
+		char name[NAME_MAX];
+		openavbAvdeccMsgCountersName(name, sizeof(name), friendly_name, getpid());
+		munmap(pCounters, sizeof(openavbAvdeccMsgCounters_t));
+		shm_unlink(name);
+	}
+}
+
 #endif // OPENAVB_AVDECC_MSG_CLIENT_OSAL_C
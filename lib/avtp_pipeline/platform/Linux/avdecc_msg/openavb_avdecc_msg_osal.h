@@ -38,6 +38,10 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include <net/if.h>
 #include <unistd.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 typedef struct {
 	openavbAvdeccMsgType_t	type;
@@ -268,4 +268,71 @@ void openavbAvdeccMsgServerClose(void)
 	AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
 }
 
+int openavbAvdeccMsgSrvrGetClientPid(int avdeccMsgHandle)
+{
+	struct ucred cred;
+	socklen_t len = sizeof(cred);
+
+	if (avdeccMsgHandle < 0 || avdeccMsgHandle >= POLL_FD_COUNT || avdeccMsgHandle == AVB_AVDECC_LISTEN_FDS
+			|| fds[avdeccMsgHandle].fd == SOCK_INVALID) {
+		return -1;
+	}
+	if (getsockopt(fds[avdeccMsgHandle].fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) {
+		AVB_LOGF_ERROR("Failed to get client %d credentials: %s", avdeccMsgHandle, strerror(errno));
+		return -1;
+	}
+	return cred.pid;
+}
+
+const openavbAvdeccMsgCounters_t * openavbAvdeccMsgSrvrCountersOpen(const char * friendly_name, int pid)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
+	char name[NAME_MAX];
+
+	if (pid < 0) {
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return NULL;
+	}
+	openavbAvdeccMsgCountersName(name, sizeof(name), friendly_name, pid);
+
+	int fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0) {
+		// Client has not published counters.
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return NULL;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(openavbAvdeccMsgCounters_t)) {
+		close(fd);
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return NULL;
+	}
+	void *pMem = mmap(NULL, sizeof(openavbAvdeccMsgCounters_t), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (pMem == MAP_FAILED) {
+		AVB_LOGF_ERROR("Failed to map counters %s: %s", name, strerror(errno));
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return NULL;
+	}
+
+	const openavbAvdeccMsgCounters_t *pCounters = pMem;
+	if (__atomic_load_n(&pCounters->magic, __ATOMIC_ACQUIRE) != AVB_AVDECC_MSG_COUNTERS_MAGIC
+			|| pCounters->size != sizeof(openavbAvdeccMsgCounters_t)) {
+		AVB_LOGF_WARNING("Ignoring counters %s of a different version", name);
+		munmap(pMem, sizeof(openavbAvdeccMsgCounters_t));
+		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+		return NULL;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+	return pCounters;
+}
+
+void openavbAvdeccMsgSrvrCountersClose(const openavbAvdeccMsgCounters_t * pCounters)
+{
+	if (pCounters) {
+		munmap((void *)pCounters, sizeof(openavbAvdeccMsgCounters_t));
+	}
+}
+
 #endif // OPENAVB_AVDECC_MSG_SERVER_OSAL_C
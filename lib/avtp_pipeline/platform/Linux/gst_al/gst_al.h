@@ -42,6 +42,12 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 typedef GstFlowReturn (*GstAlCallback)(GstAppSink *sink, gpointer pv);
 
+/** Most buffers taken from a sink by one gst_al_pull_*buffers call */
+#define GST_AL_PULL_BATCH 32
+
+/** Releases externally owned memory wrapped by gst_al_wrap_rtp_buffer */
+typedef void (*GstAlReleaseFunc)(gpointer owner, gpointer mem);
+
 /**
  * \brief - Gstreamer Abstraction Layer buffer
  */
@@ -84,6 +90,28 @@ void gst_al_set_callback(GstAppSinkCallbacks *cbfns, GstAlCallback callback);
  * \return - a buffer taken from a sink
  */
 GstAlBuf* gst_al_pull_buffer(GstAppSink *sink);
+/**
+ * \brief - pulls several buffers from a sink into caller storage
+ *
+ * Nothing is allocated per buffer. The sink blocks when it has fewer
+ * buffers ready than asked for, so callers ask only for what the
+ * new buffer callback has announced.
+ *
+ * \param sink - a sink to pull buffers from
+ * \param bufs - storage for at most count buffers
+ * \param count - number of buffers to pull
+ *
+ * \return - number of buffers pulled, less than count if the sink
+ *           stopped (EOS or flushing)
+ */
+guint gst_al_pull_buffers(GstAppSink *sink, GstAlBuf *bufs, guint count);
+/**
+ * \brief - releases buffers taken by gst_al_pull_buffers
+ *
+ * \param bufs - buffers to release
+ * \param count - number of buffers
+ */
+void gst_al_buffers_release(GstAlBuf *bufs, guint count);
 /**
  * \brief - pushes a buffer to source
  *
@@ -112,6 +140,25 @@ void gst_al_buffer_unref(GstAlBuf *buf);
  * \return - a buffer taken from sink
  */
 GstAlBuf* gst_al_pull_rtp_buffer(GstAppSink *sink);
+/**
+ * \brief - pulls several RTP buffers from a sink into caller storage
+ *
+ * Same rules as gst_al_pull_buffers.
+ *
+ * \param sink - a sink to pull buffers from
+ * \param bufs - storage for at most count buffers
+ * \param count - number of buffers to pull
+ *
+ * \return - number of buffers pulled
+ */
+guint gst_al_pull_rtp_buffers(GstAppSink *sink, GstAlBuf *bufs, guint count);
+/**
+ * \brief - releases RTP buffers taken by gst_al_pull_rtp_buffers
+ *
+ * \param bufs - buffers to release
+ * \param count - number of buffers
+ */
+void gst_al_rtp_buffers_release(GstAlBuf *bufs, guint count);
 /**
  * \brief - gets a RTP buffer marker
  *
@@ -162,9 +209,50 @@ GstFlowReturn gst_al_push_rtp_buffer(GstAppSrc *src, GstAlBuf *buf);
  * \return - a newly allocated RTP buffer
  */
 GstAlBuf* gst_al_alloc_rtp_buffer(guint packet_len, guint8 pad_len, guint8 csrc_count);
+/**
+ * \brief - wraps existing memory as a RTP buffer without copying it
+ *
+ * The first 12 bytes of the packet are overwritten with a bare RTP
+ * header, the payload must follow them. The release function is called
+ * once gstreamer drops its last reference to the memory.
+ *
+ * \param packet - RTP header space followed by the payload
+ * \param packet_len - length of the header space and the payload
+ * \param release - called to give the memory back to its owner
+ * \param owner - first argument of the release function
+ * \param mem - second argument of the release function
+ *
+ * \return - a RTP buffer over the memory, NULL on failure (the memory
+ *           has not been released in that case)
+ */
+GstAlBuf* gst_al_wrap_rtp_buffer(gpointer packet, guint packet_len,
+                                 GstAlReleaseFunc release, gpointer owner, gpointer mem);
 /**
  * \brief - unrefs a RTP buffer
  *
  * \param buf - a RTP buffer to unref
  */
 void gst_al_rtp_buffer_unref(GstAlBuf *buf);
+/**
+ * \brief - adds a pipeline description to the process wide pipeline
+ *
+ * All the streams that use the shared pipeline run against one clock
+ * and one bus, whose messages are logged from a single thread. The
+ * description is parsed as a bin without ghost pads, its elements keep
+ * their names within the bin. The bin is added in the NULL state, the
+ * caller sets it to PLAYING once its elements are configured.
+ *
+ * \param desc - pipeline description, as for gst_parse_launch
+ * \param error - set on parse errors
+ *
+ * \return - the bin, NULL on failure
+ */
+GstElement* gst_al_shared_pipeline_add(const gchar *desc, GError **error);
+/**
+ * \brief - stops a bin and takes it out of the process wide pipeline
+ *
+ * The pipeline, its bus and its thread go away with the last bin.
+ *
+ * \param bin - a bin returned by gst_al_shared_pipeline_add
+ */
+void gst_al_shared_pipeline_remove(GstElement *bin);
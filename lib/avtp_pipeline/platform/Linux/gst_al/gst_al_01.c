@@ -34,8 +34,32 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
  *  for version 0.10
  */
 
+#include <string.h>
 #include "gst_al.h"
 
+typedef struct
+{
+	GstAlReleaseFunc release;
+	gpointer owner;
+	gpointer mem;
+}
+GstAlWrapCtx;
+
+static void gst_al_wrap_release(gpointer data)
+{
+	GstAlWrapCtx *ctx = (GstAlWrapCtx *)data;
+	if(ctx->release)
+		ctx->release(ctx->owner, ctx->mem);
+	g_slice_free(GstAlWrapCtx, ctx);
+}
+
+static void gst_al_wrap_rtp_header(guint8 *packet)
+{
+	// bare RTP version 2 header, the rest is set by gst_al_rtp_buffer_set_params
+	memset(packet, 0, 12);
+	packet[0] = 0x80;
+}
+
 void gst_al_set_callback(GstAppSinkCallbacks *cbfns, GstAlCallback callback)
 {
 	cbfns->new_buffer = callback;
@@ -50,6 +74,28 @@ GstAlBuf* gst_al_pull_buffer(GstAppSink *sink)
 	return buf;
 }
 
+guint gst_al_pull_buffers(GstAppSink *sink, GstAlBuf *bufs, guint count)
+{
+	guint i;
+	for(i = 0; i < count; i++)
+	{
+		GstAlBuf *buf = &bufs[i];
+		buf->m_buffer = gst_app_sink_pull_buffer(sink);
+		if(!buf->m_buffer)
+			break;
+		buf->m_dptr = GST_BUFFER_DATA(buf->m_buffer);
+		buf->m_dlen = GST_BUFFER_SIZE(buf->m_buffer);
+	}
+	return i;
+}
+
+void gst_al_buffers_release(GstAlBuf *bufs, guint count)
+{
+	guint i;
+	for(i = 0; i < count; i++)
+		gst_buffer_unref(bufs[i].m_buffer);
+}
+
 GstAlBuf* gst_al_alloc_buffer(gint len)
 {
 	GstAlBuf *buf = g_new(GstAlBuf,1);
@@ -81,6 +127,26 @@ GstAlBuf* gst_al_pull_rtp_buffer(GstAppSink *sink)
 	return buf;
 }
 
+guint gst_al_pull_rtp_buffers(GstAppSink *sink, GstAlBuf *bufs, guint count)
+{
+	guint i;
+	for(i = 0; i < count; i++)
+	{
+		GstAlBuf *buf = &bufs[i];
+		buf->m_buffer = gst_app_sink_pull_buffer(sink);
+		if(!buf->m_buffer)
+			break;
+		buf->m_dptr = gst_rtp_buffer_get_payload(buf->m_buffer);
+		buf->m_dlen = gst_rtp_buffer_get_payload_len(buf->m_buffer);
+	}
+	return i;
+}
+
+void gst_al_rtp_buffers_release(GstAlBuf *bufs, guint count)
+{
+	gst_al_buffers_release(bufs, count);
+}
+
 gboolean gst_al_rtp_buffer_get_marker(GstAlBuf *buf)
 {
 	return gst_rtp_buffer_get_marker(buf->m_buffer);
@@ -117,6 +183,29 @@ GstAlBuf* gst_al_alloc_rtp_buffer(guint payload_len, guint8 pad_len, guint8 csrc
 	return buf;
 }
 
+GstAlBuf* gst_al_wrap_rtp_buffer(gpointer packet, guint packet_len,
+                                 GstAlReleaseFunc release, gpointer owner, gpointer mem)
+{
+	if(packet_len < 12)
+		return NULL;
+
+	GstAlBuf *buf = g_new(GstAlBuf,1);
+	GstAlWrapCtx *ctx = g_slice_new(GstAlWrapCtx);
+	ctx->release = release;
+	ctx->owner = owner;
+	ctx->mem = mem;
+
+	gst_al_wrap_rtp_header(packet);
+	buf->m_buffer = gst_buffer_new();
+	GST_BUFFER_DATA(buf->m_buffer) = packet;
+	GST_BUFFER_SIZE(buf->m_buffer) = packet_len;
+	GST_BUFFER_MALLOCDATA(buf->m_buffer) = (guint8 *)ctx;
+	GST_BUFFER_FREE_FUNC(buf->m_buffer) = gst_al_wrap_release;
+	buf->m_dptr = gst_rtp_buffer_get_payload(buf->m_buffer);
+	buf->m_dlen = gst_rtp_buffer_get_payload_len(buf->m_buffer);
+	return buf;
+}
+
 void gst_al_rtp_buffer_unref(GstAlBuf *buf)
 {
 	gst_buffer_unref(buf->m_buffer);
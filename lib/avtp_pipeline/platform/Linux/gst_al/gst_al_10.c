@@ -33,19 +33,43 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
  *  Gstreamer abstraction layer implementation
  *  for version 1.0
  */
+#include <string.h>
 #include "gst_al.h"
 
+typedef struct
+{
+	GstAlReleaseFunc release;
+	gpointer owner;
+	gpointer mem;
+}
+GstAlWrapCtx;
+
+static void gst_al_wrap_release(gpointer data)
+{
+	GstAlWrapCtx *ctx = (GstAlWrapCtx *)data;
+	if(ctx->release)
+		ctx->release(ctx->owner, ctx->mem);
+	g_slice_free(GstAlWrapCtx, ctx);
+}
+
+static void gst_al_wrap_rtp_header(guint8 *packet)
+{
+	// bare RTP version 2 header, the rest is set by gst_al_rtp_buffer_set_params
+	memset(packet, 0, 12);
+	packet[0] = 0x80;
+}
+
 void gst_al_set_callback(GstAppSinkCallbacks *cbfns, GstAlCallback callback)
 {
 	cbfns->new_sample = callback;
 }
 
-GstAlBuf* gst_al_pull_buffer(GstAppSink *sink)
+static gboolean gst_al_pull_into(GstAppSink *sink, GstAlBuf *buf)
 {
-	GstAlBuf *buf = g_new0(GstAlBuf,1);
 	GstMemory *memory;
 	GstBuffer * buffer;
 	GstSample *sample = gst_app_sink_pull_sample(sink);
+	memset(buf, 0, sizeof(*buf));
 	buf->m_sample = sample;
 	if(sample)
 	{
@@ -62,19 +86,85 @@ GstAlBuf* gst_al_pull_buffer(GstAppSink *sink)
 				{
 					buf->m_dptr = info->data;
 					buf->m_dlen = info->size;
-					goto pull_success;
+					return TRUE;
 				}
 				gst_memory_unref(memory);
 			}
 		}
 		gst_sample_unref(sample);
 	}
-	g_free(buf);
-	buf = NULL;
-pull_success:
+	return FALSE;
+}
+
+static void gst_al_release(GstAlBuf *buf)
+{
+	gst_memory_unmap(buf->m_memory, &buf->m_info);
+	gst_memory_unref(buf->m_memory);
+	gst_sample_unref(buf->m_sample);
+}
+
+static gboolean gst_al_pull_rtp_into(GstAppSink *sink, GstAlBuf *buf)
+{
+	GstBuffer *buffer;
+	GstSample *sample = gst_app_sink_pull_sample(sink);
+	memset(buf, 0, sizeof(*buf));
+	buf->m_sample = sample;
+
+	if(sample)
+	{
+		buffer = gst_sample_get_buffer(sample);
+		buf->m_buffer = buffer;
+
+		if(buffer)
+		{
+			GstRTPBuffer *rtpbuf = &buf->m_rtpbuf;
+			if( gst_rtp_buffer_map(buffer, GST_MAP_READ, rtpbuf))
+			{
+				buf->m_dptr = gst_rtp_buffer_get_payload(rtpbuf);
+				buf->m_dlen = gst_rtp_buffer_get_payload_len(rtpbuf);
+				return TRUE;
+			}
+		}
+		gst_sample_unref(sample);
+	}
+	return FALSE;
+}
+
+static void gst_al_rtp_release(GstAlBuf *buf)
+{
+	gst_rtp_buffer_unmap(&buf->m_rtpbuf);
+	gst_sample_unref(buf->m_sample);
+}
+
+GstAlBuf* gst_al_pull_buffer(GstAppSink *sink)
+{
+	GstAlBuf *buf = g_new0(GstAlBuf,1);
+	if(!gst_al_pull_into(sink, buf))
+	{
+		g_free(buf);
+		buf = NULL;
+	}
 	return buf;
 }
 
+guint gst_al_pull_buffers(GstAppSink *sink, GstAlBuf *bufs, guint count)
+{
+	guint i;
+	for(i = 0; i < count; i++)
+	{
+		if(!gst_al_pull_into(sink, &bufs[i]))
+			break;
+	}
+	return i;
+}
+
+void gst_al_buffers_release(GstAlBuf *bufs, guint count)
+{
+	guint i;
+	for(i = 0; i < count; i++)
+		gst_al_release(&bufs[i]);
+}
+
 GstAlBuf* gst_al_alloc_buffer(gint len)
 {
 	GstAlBuf *buf = g_new0(GstAlBuf,1);
@@ -115,43 +205,39 @@ GstFlowReturn gst_al_push_buffer(GstAppSrc *src, GstAlBuf *buf)
 
 void gst_al_buffer_unref(GstAlBuf *buf)
 {
-	gst_memory_unmap(buf->m_memory, &buf->m_info);
-	gst_memory_unref(buf->m_memory);
-	gst_sample_unref(buf->m_sample);
+	gst_al_release(buf);
 	g_free(buf);
 }
 
 GstAlBuf* gst_al_pull_rtp_buffer(GstAppSink *sink)
 {
-
 	GstAlBuf *buf = g_new0(GstAlBuf,1);
-	GstBuffer *buffer;
-	GstSample *sample = gst_app_sink_pull_sample(sink);
-	buf->m_sample = sample;
-
-	if(sample)
+	if(!gst_al_pull_rtp_into(sink, buf))
 	{
-		buffer = gst_sample_get_buffer(sample);
-		buf->m_buffer = buffer;
-
-		if(buffer)
-		{
-			GstRTPBuffer *rtpbuf = &buf->m_rtpbuf;
-			if( gst_rtp_buffer_map(buffer, GST_MAP_READ, rtpbuf))
-			{
-				buf->m_dptr = gst_rtp_buffer_get_payload(rtpbuf);
-				buf->m_dlen = gst_rtp_buffer_get_payload_len(rtpbuf);
-				goto pull_rtp_success;
-			}
-		}
-		gst_sample_unref(sample);
+		g_free(buf);
+		buf = NULL;
 	}
-	g_free(buf);
-	buf = NULL;
-pull_rtp_success:
 	return buf;
 }
 
+guint gst_al_pull_rtp_buffers(GstAppSink *sink, GstAlBuf *bufs, guint count)
+{
+	guint i;
+	for(i = 0; i < count; i++)
+	{
+		if(!gst_al_pull_rtp_into(sink, &bufs[i]))
+			break;
+	}
+	return i;
+}
+
+void gst_al_rtp_buffers_release(GstAlBuf *bufs, guint count)
+{
+	guint i;
+	for(i = 0; i < count; i++)
+		gst_al_rtp_release(&bufs[i]);
+}
+
 GstAlBuf* gst_al_alloc_rtp_buffer(guint payload_len,
                                   guint8 pad_len, guint8 csrc_count)
 {
@@ -175,6 +261,43 @@ alloc_rtp_success:
 	return buf;
 }
 
+GstAlBuf* gst_al_wrap_rtp_buffer(gpointer packet, guint packet_len,
+                                 GstAlReleaseFunc release, gpointer owner, gpointer mem)
+{
+	if(packet_len < 12)
+		return NULL;
+
+	GstAlBuf *buf = g_new0(GstAlBuf, 1);
+	GstAlWrapCtx *ctx = g_slice_new(GstAlWrapCtx);
+	ctx->release = release;
+	ctx->owner = owner;
+	ctx->mem = mem;
+
+	gst_al_wrap_rtp_header(packet);
+	GstBuffer *buffer = gst_buffer_new_wrapped_full(0, packet, packet_len, 0, packet_len,
+	                                                ctx, gst_al_wrap_release);
+	buf->m_buffer = buffer;
+	if(buffer)
+	{
+		GstRTPBuffer *rtpbuf = &buf->m_rtpbuf;
+		if( gst_rtp_buffer_map(buffer, GST_MAP_WRITE, rtpbuf))
+		{
+			buf->m_dptr = gst_rtp_buffer_get_payload(rtpbuf);
+			buf->m_dlen = gst_rtp_buffer_get_payload_len(rtpbuf);
+			return buf;
+		}
+		// keep the memory with the caller
+		ctx->release = NULL;
+		gst_buffer_unref(buffer);
+	}
+	else
+	{
+		g_slice_free(GstAlWrapCtx, ctx);
+	}
+	g_free(buf);
+	return NULL;
+}
+
 gboolean gst_al_rtp_buffer_get_marker(GstAlBuf *buf)
 {
 	return gst_rtp_buffer_get_marker(&buf->m_rtpbuf);
@@ -211,7 +334,6 @@ GstFlowReturn gst_al_push_rtp_buffer(GstAppSrc *src, GstAlBuf *buf)
 
 void gst_al_rtp_buffer_unref(GstAlBuf *buf)
 {
-	gst_rtp_buffer_unmap(&buf->m_rtpbuf);
-	gst_sample_unref(buf->m_sample);
+	gst_al_rtp_release(buf);
 	g_free(buf);
 }
@@ -0,0 +1,223 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+ *  Gstreamer abstraction layer process wide pipeline,
+ *  same code for version 0.10 and 1.0
+ */
+
+#include <pthread.h>
+#include "gst_al.h"
+
+#define	AVB_LOG_COMPONENT	"GStreamer"
+#include "openavb_log_pub.h"
+
+#define SHARED_PIPELINE_NAME "avbshared"
+
+static pthread_mutex_t sharedMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static struct
+{
+	GstElement *pipe;
+	GstBus *bus;
+	GMainContext *context;
+	GMainLoop *loop;
+	GSource *watch;
+	pthread_t thread;
+	guint bins;
+} shared;
+
+static gboolean sharedBusMessage(GstBus *bus, GstMessage *message, gpointer pv)
+{
+	GError *err = NULL;
+	gchar *dbg_info = NULL;
+
+	switch (GST_MESSAGE_TYPE(message))
+	{
+		case GST_MESSAGE_ERROR:
+			gst_message_parse_error(message, &err, &dbg_info);
+			AVB_LOGF_ERROR("GStreamer ERROR message from element %s: %s (%s)",
+			               GST_OBJECT_NAME(message->src), err->message,
+			               (dbg_info) ? dbg_info : "none");
+			break;
+		case GST_MESSAGE_WARNING:
+			gst_message_parse_warning(message, &err, &dbg_info);
+			AVB_LOGF_WARNING("GStreamer WARNING message from element %s: %s (%s)",
+			                 GST_OBJECT_NAME(message->src), err->message,
+			                 (dbg_info) ? dbg_info : "none");
+			break;
+		case GST_MESSAGE_EOS:
+			AVB_LOG_INFO("EOS received");
+			break;
+		default:
+			break;
+	}
+
+	if (err)
+		g_error_free(err);
+	g_free(dbg_info);
+	return TRUE;
+}
+
+static void *sharedBusThreadFn(void *pv)
+{
+	g_main_context_push_thread_default(shared.context);
+	g_main_loop_run(shared.loop);
+	g_main_context_pop_thread_default(shared.context);
+	return NULL;
+}
+
+static gboolean sharedBusQuit(gpointer pv)
+{
+	g_main_loop_quit(shared.loop);
+	return FALSE;
+}
+
+static void sharedPipelineDestroy(void)
+{
+	if (shared.loop)
+	{
+		// Quit from inside the loop, it may not be running yet
+		GSource *quit = g_idle_source_new();
+		g_source_set_callback(quit, sharedBusQuit, NULL, NULL);
+		g_source_attach(quit, shared.context);
+		g_source_unref(quit);
+		pthread_join(shared.thread, NULL);
+		g_main_loop_unref(shared.loop);
+		shared.loop = NULL;
+	}
+	if (shared.watch)
+	{
+		g_source_destroy(shared.watch);
+		g_source_unref(shared.watch);
+		shared.watch = NULL;
+	}
+	if (shared.context)
+	{
+		g_main_context_unref(shared.context);
+		shared.context = NULL;
+	}
+	if (shared.bus)
+	{
+		gst_object_unref(shared.bus);
+		shared.bus = NULL;
+	}
+	if (shared.pipe)
+	{
+		gst_element_set_state(shared.pipe, GST_STATE_NULL);
+		gst_object_unref(shared.pipe);
+		shared.pipe = NULL;
+	}
+}
+
+static gboolean sharedPipelineCreate(void)
+{
+	shared.pipe = gst_pipeline_new(SHARED_PIPELINE_NAME);
+	if (!shared.pipe)
+	{
+		AVB_LOG_ERROR("Unable to create shared pipeline");
+		return FALSE;
+	}
+
+	// Bus messages of every stream are handled here, in a context of our own
+	shared.bus = gst_pipeline_get_bus(GST_PIPELINE(shared.pipe));
+	shared.context = g_main_context_new();
+	shared.loop = g_main_loop_new(shared.context, FALSE);
+	shared.watch = gst_bus_create_watch(shared.bus);
+	g_source_set_callback(shared.watch, (GSourceFunc)sharedBusMessage, NULL, NULL);
+	g_source_attach(shared.watch, shared.context);
+
+	if (pthread_create(&shared.thread, NULL, sharedBusThreadFn, NULL) != 0)
+	{
+		AVB_LOG_ERROR("Unable to start shared pipeline bus thread");
+		g_main_loop_unref(shared.loop);
+		shared.loop = NULL;
+		sharedPipelineDestroy();
+		return FALSE;
+	}
+
+	// Empty, so this picks the clock that every stream added later runs on
+	gst_element_set_state(shared.pipe, GST_STATE_PLAYING);
+	AVB_LOG_INFO("Shared pipeline created");
+	return TRUE;
+}
+
+GstElement* gst_al_shared_pipeline_add(const gchar *desc, GError **error)
+{
+	GstElement *bin = NULL;
+
+	pthread_mutex_lock(&sharedMutex);
+
+	if (shared.bins || sharedPipelineCreate())
+	{
+		bin = gst_parse_bin_from_description(desc, FALSE, error);
+		if (bin)
+		{
+			// one reference for the caller, the floating one goes to the pipeline
+			gst_object_ref(bin);
+			if (gst_bin_add(GST_BIN(shared.pipe), bin))
+			{
+				shared.bins++;
+			}
+			else
+			{
+				AVB_LOG_ERROR("Unable to add bin to shared pipeline");
+				gst_object_unref(bin);
+				bin = NULL;
+			}
+		}
+		if (!shared.bins)
+		{
+			sharedPipelineDestroy();
+		}
+	}
+
+	pthread_mutex_unlock(&sharedMutex);
+	return bin;
+}
+
+void gst_al_shared_pipeline_remove(GstElement *bin)
+{
+	pthread_mutex_lock(&sharedMutex);
+
+	gst_element_set_state(bin, GST_STATE_NULL);
+	if (shared.pipe && gst_bin_remove(GST_BIN(shared.pipe), bin))
+	{
+		if (--shared.bins == 0)
+		{
+			sharedPipelineDestroy();
+			AVB_LOG_INFO("Shared pipeline destroyed");
+		}
+	}
+	gst_object_unref(bin);
+
+	pthread_mutex_unlock(&sharedMutex);
+}
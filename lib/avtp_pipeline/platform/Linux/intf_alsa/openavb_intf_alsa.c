@@ -44,6 +44,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_map_aaf_audio_pub.h"
 #include "openavb_intf_pub.h"
 #include "openavb_mcs.h"
+#include "openavb_cce.h"
 
 #define	AVB_LOG_COMPONENT	"ALSA Interface"
 #include "openavb_log_pub.h"
@@ -106,6 +107,18 @@ typedef struct {
 
 	// Use Media Clock Synth module instead of timestamps taken during Tx callback
 	bool fixedTimestampEnabled;
+
+	// intf_nv_capture_clock: stamp items from an estimate of the capture clock
+	bool captureClockEnabled;
+
+	// Capture clock estimation
+	cce_t cce;
+
+	// Frames read from the device since it was started
+	U64 framesRead;
+
+	// Hardware timestamps are in CLOCK_MONOTONIC, otherwise the delay is used
+	bool captureHwTimestamp;
 } pvt_data_t;
 
 
@@ -395,6 +408,16 @@ void openavbIntfAlsaCfgCB(media_q_t *pMediaQ, const char *name, const char *valu
 			pPvtData->clockSkewPPB = strtol(value, &pEnd, 10);
 		}
 
+		else if (strcmp(name, "intf_nv_capture_clock") == 0) {
+			tmp = strtol(value, &pEnd, 10);
+			if (*pEnd == '\0' && (tmp == 0 || tmp == 1)) {
+				pPvtData->captureClockEnabled = (tmp == 1);
+			}
+			else {
+				AVB_LOG_ERROR("Invalid value for intf_nv_capture_clock, use 0 or 1.");
+			}
+		}
+
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
@@ -406,6 +429,60 @@ void openavbIntfAlsaGenInitCB(media_q_t *pMediaQ)
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
 }
 
+// Turn on hardware timestamps of the capture position, in CLOCK_MONOTONIC.
+// Without them the capture clock is observed through snd_pcm_delay().
+static bool x_captureClockHwTimestamps(pvt_data_t *pPvtData)
+{
+	snd_pcm_sw_params_t *swParams;
+	bool ok = FALSE;
+
+	if (snd_pcm_sw_params_malloc(&swParams) < 0) {
+		return FALSE;
+	}
+	if (snd_pcm_sw_params_current(pPvtData->pcmHandle, swParams) >= 0
+		&& snd_pcm_sw_params_set_tstamp_mode(pPvtData->pcmHandle, swParams, SND_PCM_TSTAMP_ENABLE) >= 0
+		&& snd_pcm_sw_params_set_tstamp_type(pPvtData->pcmHandle, swParams, SND_PCM_TSTAMP_TYPE_MONOTONIC) >= 0
+		&& snd_pcm_sw_params(pPvtData->pcmHandle, swParams) >= 0) {
+		ok = TRUE;
+	}
+	snd_pcm_sw_params_free(swParams);
+	return ok;
+}
+
+// Observe the position of the newest captured frame and its gPTP capture time.
+static void x_captureClockObserve(pvt_data_t *pPvtData)
+{
+	U64 framePos, timeNS, monoNS;
+
+	if (pPvtData->captureHwTimestamp) {
+		snd_pcm_uframes_t avail;
+		snd_htimestamp_t tstamp;
+
+		if (snd_pcm_htimestamp(pPvtData->pcmHandle, &avail, &tstamp) < 0
+			|| (tstamp.tv_sec == 0 && tstamp.tv_nsec == 0)) {
+			return;
+		}
+		// Move the timestamp from CLOCK_MONOTONIC to gPTP time
+		if (!CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &timeNS)
+			|| !CLOCK_GETTIME64(OPENAVB_CLOCK_MONOTONIC, &monoNS)) {
+			return;
+		}
+		timeNS = timeNS - monoNS + (U64)tstamp.tv_sec * NANOSECONDS_PER_SECOND + tstamp.tv_nsec;
+		framePos = pPvtData->framesRead + avail;
+	}
+	else {
+		snd_pcm_sframes_t delay;
+
+		if (snd_pcm_delay(pPvtData->pcmHandle, &delay) < 0
+			|| !CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &timeNS)) {
+			return;
+		}
+		framePos = pPvtData->framesRead + delay;
+	}
+
+	openavbCceObserve(&pPvtData->cce, framePos, timeNS);
+}
+
 // A call to this callback indicates that this interface module will be
 // a talker. Any talker initialization can be done in this function.
 void openavbIntfAlsaTxInitCB(media_q_t *pMediaQ)
@@ -554,6 +631,14 @@ void openavbIntfAlsaTxInitCB(media_q_t *pMediaQ)
 		snd_pcm_dump(pPvtData->pcmHandle, out);
 		snd_output_close(out);
 
+		if (pPvtData->captureClockEnabled) {
+			openavbCceInit(&pPvtData->cce, pPvtData->audioRate, 0);
+			pPvtData->framesRead = 0;
+			pPvtData->captureHwTimestamp = x_captureClockHwTimestamps(pPvtData);
+			AVB_LOGF_INFO("Capture clock estimation enabled, observed through %s",
+				pPvtData->captureHwTimestamp ? "hardware timestamps" : "snd_pcm_delay()");
+		}
+
 		// Start capture
 		snd_pcm_start(pPvtData->pcmHandle);
 		{
@@ -603,6 +688,10 @@ bool openavbIntfAlsaTxCB(media_q_t *pMediaQ)
 					switch(rslt) {
 					case -EPIPE:
 						AVB_LOGF_ERROR("snd_pcm_readi() error: %s", snd_strerror(rslt));
+						// Captured frames were dropped, the positions no longer line up
+						if (pPvtData->captureClockEnabled) {
+							openavbCceReset(&pPvtData->cce);
+						}
 						rslt = snd_pcm_recover(pPvtData->pcmHandle, rslt, 0);
 						if (rslt < 0) {
 							AVB_LOGF_ERROR("snd_pcm_recover: %s", snd_strerror(rslt));
@@ -623,17 +712,31 @@ bool openavbIntfAlsaTxCB(media_q_t *pMediaQ)
 				}
 
 				pMediaQItem->dataLen += rslt * pPubMapUncmpAudioInfo->itemFrameSizeBytes;
+				pPvtData->framesRead += rslt;
 				if (pMediaQItem->dataLen != pPubMapUncmpAudioInfo->itemSize) {
 					openavbMediaQHeadUnlock(pMediaQ);
 				}
 				else {
 					// Always get the timestamp.  Protocols such as AAF can choose to ignore them if not needed.
-					if (!pPvtData->fixedTimestampEnabled) {
-						openavbAvtpTimeSetToWallTime(pMediaQItem->pAvtpTime);
-					} else {
+					if (pPvtData->fixedTimestampEnabled) {
 						openavbMcsAdvance(&pPvtData->mcs);
 						openavbAvtpTimeSetToTimestampNS(pMediaQItem->pAvtpTime, pPvtData->mcs.edgeTime);
 					}
+					else if (pPvtData->captureClockEnabled) {
+						// Capture time of the last frame of the item, as the wall time
+						// stamp below is, without the delay of this callback
+						x_captureClockObserve(pPvtData);
+						if (pPvtData->cce.started) {
+							openavbAvtpTimeSetToTimestampNS(pMediaQItem->pAvtpTime, openavbCceTimeAt(&pPvtData->cce, pPvtData->framesRead));
+						}
+						else {
+							openavbAvtpTimeSetToWallTime(pMediaQItem->pAvtpTime);
+						}
+						IF_LOG_INTERVAL(8000 * 60) AVB_LOGF_INFO("Capture clock %d ppb, %u rejected, %u restarts", openavbCceRatePPB(&pPvtData->cce), pPvtData->cce.rejectCount, pPvtData->cce.restartCount);
+					}
+					else {
+						openavbAvtpTimeSetToWallTime(pMediaQItem->pAvtpTime);
+					}
 					openavbMediaQHeadPush(pMediaQ);
 				}
 			}
@@ -1060,22 +1163,14 @@ void openavbIntfAlsaEnableFixedTimestamp(media_q_t *pMediaQ, bool enabled, U32 t
 
 		pPvtData->fixedTimestampEnabled = enabled;
 		if (pPvtData->fixedTimestampEnabled) {
-			U32 per, rate, rem;
-			S32 skewEst = pPvtData->clockSkewPPB;
 			/* Ignore passed in transmit interval and use framesPerItem and audioRate so
-			   we work with both AAF and 61883-6 */
-			/* Carefully scale values to avoid U32 overflow or loss of precision */
-			per = MICROSECONDS_PER_SECOND * pPubMapUncmpAudioInfo->framesPerItem * 10;
-			per += (skewEst/10);
-			rate = pPvtData->audioRate/100;
-			transmitInterval = per/rate;
-			rem = per % rate;
-			if (rem != 0) {
-				rem *= 10;
-				rem /= rate;
-			}
-			openavbMcsInit(&pPvtData->mcs, transmitInterval, rem, 10);
-			AVB_LOGF_INFO("Fixed timestamping enabled: %d %d/%d", transmitInterval, rem, 10);
+			   we work with both AAF and 61883-6. The period is kept as an exact fraction
+			   and the servo follows the sound card against gPTP time, starting from the
+			   configured skew estimate. */
+			openavbMcsInit(&pPvtData->mcs, (U64)NANOSECONDS_PER_SECOND * pPubMapUncmpAudioInfo->framesPerItem, pPvtData->audioRate);
+			openavbMcsServoInit(&pPvtData->mcs, 0, pPvtData->clockSkewPPB, 0);
+			AVB_LOGF_INFO("Fixed timestamping enabled: %llu %u/%u ns, skew %d ppb", (unsigned long long)pPvtData->mcs.nsPerAdvance,
+				pPvtData->mcs.fracPerAdvance, pPvtData->mcs.fracDen, pPvtData->clockSkewPPB);
 		}
 
 	}
@@ -1118,6 +1213,7 @@ extern DLL_EXPORT bool openavbIntfAlsaInitialize(media_q_t *pMediaQ, openavb_int
 
 		pPvtData->fixedTimestampEnabled = FALSE;
 		pPvtData->clockSkewPPB = 0;
+		pPvtData->captureClockEnabled = FALSE;
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
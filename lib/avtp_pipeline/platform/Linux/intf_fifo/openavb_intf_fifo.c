@@ -0,0 +1,627 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : FIFO interface module.
+*
+* Streams bytes from stdin, a pipe or a named pipe (FIFO) on the talker and
+* writes them to stdout or a FIFO on the listener. Works with any mapping that
+* takes a byte stream, such as MPEG2 TS, pipe or the audio mappings.
+*
+* The talker reads the source in large non-blocking batches into a staging
+* buffer and fills one media queue item per transmit callback from it, so a
+* source such as ffmpeg costs one read per batch instead of one per AVTP
+* packet. The listener gathers the items it pulls and writes them once per
+* callback.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "openavb_types_pub.h"
+#include "openavb_trace_pub.h"
+#include "openavb_mediaq_pub.h"
+#include "openavb_map_uncmp_audio_pub.h"
+#include "openavb_map_aaf_audio_pub.h"
+#include "openavb_intf_pub.h"
+
+#define	AVB_LOG_COMPONENT	"FIFO Interface"
+#include "openavb_log_pub.h"
+
+#define FIFO_DEFAULT_BATCH_SIZE		(64 * 1024)
+
+typedef struct {
+	/////////////
+	// Config data
+	/////////////
+	// intf_nv_file_name: FIFO, pipe or file to read on the talker or write on the
+	// listener. NULL means stdin / stdout.
+	char *pFileName;
+
+	// intf_nv_batch_size: Bytes read or written with one system call
+	U32 batchSize;
+
+	// intf_nv_pipe_size: Kernel buffer size requested for the pipe, 0 to keep the default
+	U32 pipeSize;
+
+	// intf_nv_reopen: Keep waiting for a new writer when the writer of a FIFO goes away
+	bool reopen;
+
+	// intf_nv_ignore_timestamp: Ignore timestamp at listener.
+	bool ignoreTimestamp;
+
+	// intf_nv_audio_rate, intf_nv_audio_bit_depth, intf_nv_audio_channels
+	avb_audio_rate_t audioRate;
+	avb_audio_bit_depth_t audioBitDepth;
+	avb_audio_channels_t audioChannels;
+
+	/////////////
+	// Variable data
+	/////////////
+	int fd;
+	bool bOwnFd;
+	bool bFifo;
+
+	// Staging buffer. Valid data is between rdIdx and wrIdx.
+	U8 *pBuf;
+	U32 rdIdx;
+	U32 wrIdx;
+
+	// Bytes per item. Audio mappings need whole items, others take what is there.
+	U32 itemBytes;
+	bool bWholeItems;
+
+	// Audio mappings take one item per packing factor transmit intervals
+	U32 packingFactor;
+	U32 intervalCounter;
+
+	// Bytes moved and the reads or writes it took
+	U64 nCalls;
+	U64 nBytes;
+	U32 nOverruns;
+} pvt_data_t;
+
+static bool x_fifoIsAudio(media_q_t *pMediaQ)
+{
+	return pMediaQ->pMediaQDataFormat
+		&& (strcmp(pMediaQ->pMediaQDataFormat, MapUncmpAudioMediaQDataFormat) == 0
+			|| strcmp(pMediaQ->pMediaQDataFormat, MapAVTPAudioMediaQDataFormat) == 0);
+}
+
+// The audio mappings size their items from these in their gen init callback,
+// which runs before ours, so they are passed on as soon as they are configured.
+static void x_fifoPassAudioParams(media_q_t *pMediaQ, pvt_data_t *pPvtData)
+{
+	if (x_fifoIsAudio(pMediaQ) && pMediaQ->pPubMapInfo) {
+		media_q_pub_map_uncmp_audio_info_t *pPubMapUncmpAudioInfo = pMediaQ->pPubMapInfo;
+		pPubMapUncmpAudioInfo->audioRate = pPvtData->audioRate;
+		pPubMapUncmpAudioInfo->audioBitDepth = pPvtData->audioBitDepth;
+		pPubMapUncmpAudioInfo->audioChannels = pPvtData->audioChannels;
+	}
+}
+
+// Each configuration name value pair for this mapping will result in this callback being called.
+void openavbIntfFifoCfgCB(media_q_t *pMediaQ, const char *name, const char *value)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		char *pEnd;
+		unsigned long tmp;
+		bool nameOK = TRUE, valueOK = FALSE;
+
+		if (strcmp(name, "intf_nv_file_name") == 0) {
+			if (pPvtData->pFileName)
+				free(pPvtData->pFileName);
+			pPvtData->pFileName = strdup(value);
+			valueOK = TRUE;
+		}
+		else if (strcmp(name, "intf_nv_batch_size") == 0) {
+			tmp = strtoul(value, &pEnd, 0);
+			if (*pEnd == '\0' && pEnd != value && tmp > 0 && tmp <= 0x4000000) {
+				pPvtData->batchSize = tmp;
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_pipe_size") == 0) {
+			tmp = strtoul(value, &pEnd, 0);
+			if (*pEnd == '\0' && pEnd != value && tmp <= 0x4000000) {
+				pPvtData->pipeSize = tmp;
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_reopen") == 0) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && pEnd != value && (tmp == 0 || tmp == 1)) {
+				pPvtData->reopen = (tmp == 1);
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_ignore_timestamp") == 0) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && pEnd != value && (tmp == 0 || tmp == 1)) {
+				pPvtData->ignoreTimestamp = (tmp == 1);
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_audio_rate") == 0) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && pEnd != value && tmp >= AVB_AUDIO_RATE_8KHZ && tmp <= AVB_AUDIO_RATE_192KHZ) {
+				pPvtData->audioRate = tmp;
+				x_fifoPassAudioParams(pMediaQ, pPvtData);
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_audio_bit_depth") == 0) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && pEnd != value && tmp >= AVB_AUDIO_BIT_DEPTH_1BIT && tmp <= AVB_AUDIO_BIT_DEPTH_64BIT) {
+				pPvtData->audioBitDepth = tmp;
+				x_fifoPassAudioParams(pMediaQ, pPvtData);
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_audio_channels") == 0) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && pEnd != value && tmp >= AVB_AUDIO_CHANNELS_1 && tmp <= AVB_AUDIO_CHANNELS_8) {
+				pPvtData->audioChannels = tmp;
+				x_fifoPassAudioParams(pMediaQ, pPvtData);
+				valueOK = TRUE;
+			}
+		}
+		else {
+			AVB_LOGF_WARNING("Unknown configuration item: %s", name);
+			nameOK = FALSE;
+		}
+
+		if (nameOK && !valueOK) {
+			AVB_LOGF_WARNING("Bad value for configuration item: %s = %s", name, value);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+void openavbIntfFifoGenInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+// Open the configured file, or use stdFd. The talker never blocks on the source.
+static bool x_fifoOpen(pvt_data_t *pPvtData, bool bTalker, int stdFd)
+{
+	struct stat st;
+
+	if (!pPvtData->pFileName) {
+		AVB_LOGF_INFO("Using %s", bTalker ? "stdin" : "stdout");
+		pPvtData->pFileName = strdup(bTalker ? "stdin" : "stdout");
+		pPvtData->fd = stdFd;
+		pPvtData->bOwnFd = FALSE;
+	}
+	else {
+		// Opening a FIFO for writing waits for a reader, like the file interfaces do.
+		// O_TRUNC replaces the contents of a regular file and is ignored for a FIFO.
+		pPvtData->fd = open(pPvtData->pFileName, bTalker ? (O_RDONLY | O_NONBLOCK) : (O_WRONLY | O_CREAT | O_TRUNC), 0644);
+		if (pPvtData->fd < 0) {
+			AVB_LOGF_ERROR("Unable to open %s: %s", pPvtData->pFileName, strerror(errno));
+			return FALSE;
+		}
+		pPvtData->bOwnFd = TRUE;
+	}
+
+	if (bTalker) {
+		int flags = fcntl(pPvtData->fd, F_GETFL);
+		if (flags < 0 || fcntl(pPvtData->fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+			AVB_LOGF_WARNING("Unable to make %s non-blocking: %s", pPvtData->pFileName, strerror(errno));
+		}
+	}
+
+	pPvtData->bFifo = (fstat(pPvtData->fd, &st) == 0 && S_ISFIFO(st.st_mode));
+	if (pPvtData->bFifo && pPvtData->pipeSize) {
+		// A larger pipe lets the other end run ahead while we sleep between intervals
+		int size = fcntl(pPvtData->fd, F_SETPIPE_SZ, pPvtData->pipeSize);
+		if (size < 0) {
+			AVB_LOGF_WARNING("Unable to set pipe size of %s to %u: %s", pPvtData->pFileName, pPvtData->pipeSize, strerror(errno));
+		}
+		else {
+			AVB_LOGF_INFO("Pipe size of %s is %d", pPvtData->pFileName, size);
+		}
+	}
+
+	pPvtData->rdIdx = pPvtData->wrIdx = 0;
+	return TRUE;
+}
+
+static void x_fifoClose(pvt_data_t *pPvtData)
+{
+	if (pPvtData->fd >= 0) {
+		if (pPvtData->bOwnFd) {
+			close(pPvtData->fd);
+		}
+		pPvtData->fd = -1;
+	}
+}
+
+// A call to this callback indicates that this interface module will be
+// a talker. Any talker initialization can be done in this function.
+void openavbIntfFifoTxInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		pPvtData->packingFactor = 1;
+		pPvtData->intervalCounter = 0;
+		pPvtData->bWholeItems = FALSE;
+		pPvtData->itemBytes = 0;
+		if (x_fifoIsAudio(pMediaQ)) {
+			media_q_pub_map_uncmp_audio_info_t *pPubMapUncmpAudioInfo = pMediaQ->pPubMapInfo;
+			pPvtData->itemBytes = pPubMapUncmpAudioInfo->itemSize;
+			pPvtData->packingFactor = pPubMapUncmpAudioInfo->packingFactor ? pPubMapUncmpAudioInfo->packingFactor : 1;
+			pPvtData->bWholeItems = TRUE;
+		}
+		else {
+			// Other mappings take items of any length up to the media queue item size
+			media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+			if (pMediaQItem) {
+				pPvtData->itemBytes = pMediaQItem->itemSize;
+				openavbMediaQHeadUnlock(pMediaQ);
+			}
+		}
+
+		if (pPvtData->itemBytes == 0) {
+			AVB_LOG_ERROR("Media queue item size not set by the mapping module.");
+			AVB_TRACE_EXIT(AVB_TRACE_INTF);
+			return;
+		}
+
+		// Room for a whole batch behind a partial item left from the previous one
+		pPvtData->pBuf = malloc(pPvtData->batchSize + pPvtData->itemBytes);
+		if (!pPvtData->pBuf) {
+			AVB_LOG_ERROR("Unable to allocate FIFO staging buffer.");
+			AVB_TRACE_EXIT(AVB_TRACE_INTF);
+			return;
+		}
+
+		if (!x_fifoOpen(pPvtData, TRUE, STDIN_FILENO)) {
+			AVB_TRACE_EXIT(AVB_TRACE_INTF);
+			return;
+		}
+		AVB_LOGF_INFO("Reading %s in batches of up to %u bytes, %u bytes per item", pPvtData->pFileName, pPvtData->batchSize, pPvtData->itemBytes);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+// Refill the staging buffer with one read. Returns FALSE once the source is gone.
+static bool x_fifoFill(pvt_data_t *pPvtData)
+{
+	U32 avail = pPvtData->wrIdx - pPvtData->rdIdx;
+
+	// Move the partial item to the front so that the next read gets a whole batch
+	if (pPvtData->rdIdx > 0) {
+		if (avail > 0) {
+			memmove(pPvtData->pBuf, pPvtData->pBuf + pPvtData->rdIdx, avail);
+		}
+		pPvtData->rdIdx = 0;
+		pPvtData->wrIdx = avail;
+	}
+
+	ssize_t n = read(pPvtData->fd, pPvtData->pBuf + pPvtData->wrIdx, pPvtData->batchSize);
+	if (n > 0) {
+		pPvtData->wrIdx += n;
+		pPvtData->nCalls++;
+		pPvtData->nBytes += n;
+		return TRUE;
+	}
+	if (n < 0) {
+		if (errno == EAGAIN || errno == EINTR) {
+			return TRUE;
+		}
+		AVB_LOGF_ERROR("Error reading %s: %s", pPvtData->pFileName, strerror(errno));
+		return FALSE;
+	}
+
+	// End of file. A FIFO opened here returns EOF until another writer opens it.
+	if (pPvtData->bFifo && pPvtData->bOwnFd && pPvtData->reopen) {
+		return TRUE;
+	}
+	AVB_LOGF_INFO("EOF on %s after %" PRIu64 " bytes in %" PRIu64 " reads", pPvtData->pFileName, pPvtData->nBytes, pPvtData->nCalls);
+	return FALSE;
+}
+
+// This callback will be called for each AVB transmit interval. Commonly this will be
+// 4000 or 8000 times  per second.
+bool openavbIntfFifoTxCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF_DETAIL);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return FALSE;
+		}
+
+		if (pPvtData->fd < 0 || !pPvtData->pBuf) {
+			// input already closed
+			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+			return FALSE;
+		}
+
+		if (pPvtData->intervalCounter++ % pPvtData->packingFactor != 0) {
+			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+			return TRUE;
+		}
+
+		U32 avail = pPvtData->wrIdx - pPvtData->rdIdx;
+		if (avail < pPvtData->itemBytes) {
+			bool bOpen = x_fifoFill(pPvtData);
+			avail = pPvtData->wrIdx - pPvtData->rdIdx;
+			if (!bOpen) {
+				x_fifoClose(pPvtData);
+				if (pPvtData->bWholeItems || avail == 0) {
+					AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+					return FALSE;
+				}
+				// Send the short item left at the end of the input
+			}
+		}
+
+		if (avail == 0 || (pPvtData->bWholeItems && avail < pPvtData->itemBytes)) {
+			if (pPvtData->bWholeItems) {
+				IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("%s not keeping up, %u intervals without data", pPvtData->pFileName, ++pPvtData->nOverruns);
+			}
+			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+			return FALSE;
+		}
+
+		media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+		if (!pMediaQItem) {
+			IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("Media queue full");
+			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+			return FALSE;
+		}
+
+		U32 len = avail < pPvtData->itemBytes ? avail : pPvtData->itemBytes;
+		if (len > pMediaQItem->itemSize) {
+			len = pMediaQItem->itemSize;
+		}
+		memcpy(pMediaQItem->pPubData, pPvtData->pBuf + pPvtData->rdIdx, len);
+		pPvtData->rdIdx += len;
+		if (pPvtData->rdIdx == pPvtData->wrIdx) {
+			pPvtData->rdIdx = pPvtData->wrIdx = 0;
+		}
+
+		pMediaQItem->dataLen = len;
+		openavbAvtpTimeSetToWallTime(pMediaQItem->pAvtpTime);
+		openavbMediaQHeadPush(pMediaQ);
+
+		AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+		return TRUE;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+	return FALSE;
+}
+
+// A call to this callback indicates that this interface module will be
+// a listener. Any listener initialization can be done in this function.
+void openavbIntfFifoRxInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		pPvtData->pBuf = malloc(pPvtData->batchSize);
+		if (!pPvtData->pBuf) {
+			AVB_LOG_ERROR("Unable to allocate FIFO staging buffer.");
+			AVB_TRACE_EXIT(AVB_TRACE_INTF);
+			return;
+		}
+
+		x_fifoOpen(pPvtData, FALSE, STDOUT_FILENO);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+// Write all of pData. Closes the output if the reader is gone.
+static void x_fifoWrite(pvt_data_t *pPvtData, const U8 *pData, U32 len)
+{
+	U32 off = 0;
+	while (pPvtData->fd >= 0 && off < len) {
+		ssize_t n = write(pPvtData->fd, pData + off, len - off);
+		if (n > 0) {
+			off += n;
+		}
+		else if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		else {
+			AVB_LOGF_ERROR("Error writing %s: %s", pPvtData->pFileName, strerror(errno));
+			x_fifoClose(pPvtData);
+		}
+	}
+	if (off) {
+		pPvtData->nCalls++;
+		pPvtData->nBytes += off;
+	}
+}
+
+static void x_fifoFlush(pvt_data_t *pPvtData)
+{
+	x_fifoWrite(pPvtData, pPvtData->pBuf, pPvtData->wrIdx);
+	pPvtData->wrIdx = 0;
+}
+
+// This callback is called when acting as a listener.
+bool openavbIntfFifoRxCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF_DETAIL);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return FALSE;
+		}
+
+		media_q_item_t *pMediaQItem;
+		while ((pMediaQItem = openavbMediaQTailLock(pMediaQ, pPvtData->ignoreTimestamp)) != NULL) {
+			if (pPvtData->fd >= 0 && pPvtData->pBuf) {
+				U32 len = pMediaQItem->dataLen;
+				if (pPvtData->wrIdx + len > pPvtData->batchSize) {
+					x_fifoFlush(pPvtData);
+				}
+				if (len > pPvtData->batchSize) {
+					// Larger than a batch, no point gathering it
+					x_fifoWrite(pPvtData, pMediaQItem->pPubData, len);
+				}
+				else {
+					memcpy(pPvtData->pBuf + pPvtData->wrIdx, pMediaQItem->pPubData, len);
+					pPvtData->wrIdx += len;
+				}
+			}
+			openavbMediaQTailPull(pMediaQ);
+		}
+		if (pPvtData->pBuf) {
+			x_fifoFlush(pPvtData);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+	return TRUE;
+}
+
+// This callback will be called when the interface needs to be closed. All shutdown should
+// occur in this function.
+void openavbIntfFifoEndCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		if (pPvtData->nCalls) {
+			AVB_LOGF_INFO("%s: %" PRIu64 " bytes in %" PRIu64 " system calls", pPvtData->pFileName, pPvtData->nBytes, pPvtData->nCalls);
+		}
+		x_fifoClose(pPvtData);
+		if (pPvtData->pBuf) {
+			free(pPvtData->pBuf);
+			pPvtData->pBuf = NULL;
+		}
+		pPvtData->rdIdx = pPvtData->wrIdx = 0;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+void openavbIntfFifoGenEndCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		if (pPvtData->pFileName) {
+			free(pPvtData->pFileName);
+			pPvtData->pFileName = NULL;
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+// Main initialization entry point into the interface module
+extern DLL_EXPORT bool openavbIntfFifoInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pMediaQ->pPvtIntfInfo = calloc(1, sizeof(pvt_data_t));		// Memory freed by the media queue when the media queue is destroyed.
+
+		if (!pMediaQ->pPvtIntfInfo) {
+			AVB_LOG_ERROR("Unable to allocate memory for AVTP interface module.");
+			return FALSE;
+		}
+
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+
+		pIntfCB->intf_cfg_cb = openavbIntfFifoCfgCB;
+		pIntfCB->intf_gen_init_cb = openavbIntfFifoGenInitCB;
+		pIntfCB->intf_tx_init_cb = openavbIntfFifoTxInitCB;
+		pIntfCB->intf_tx_cb = openavbIntfFifoTxCB;
+		pIntfCB->intf_rx_init_cb = openavbIntfFifoRxInitCB;
+		pIntfCB->intf_rx_cb = openavbIntfFifoRxCB;
+		pIntfCB->intf_end_cb = openavbIntfFifoEndCB;
+		pIntfCB->intf_gen_end_cb = openavbIntfFifoGenEndCB;
+
+		pPvtData->fd = -1;
+		pPvtData->batchSize = FIFO_DEFAULT_BATCH_SIZE;
+		pPvtData->pipeSize = 0;
+		pPvtData->reopen = FALSE;
+		pPvtData->ignoreTimestamp = FALSE;
+		pPvtData->audioRate = AVB_AUDIO_RATE_48KHZ;
+		pPvtData->audioBitDepth = AVB_AUDIO_BIT_DEPTH_24BIT;
+		pPvtData->audioChannels = AVB_AUDIO_CHANNELS_2;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+	return TRUE;
+}
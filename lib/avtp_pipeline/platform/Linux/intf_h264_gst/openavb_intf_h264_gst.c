@@ -53,11 +53,15 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #define NBUFS 256
 
+// Space taken from the AVTP header in front of a zero copy payload
+#define RTP_HEADER_SIZE 12
+
 typedef struct pvt_data_t
 {
 	char *pPipelineStr;
 
 	bool ignoreTimestamp;
+	bool sharedPipeline;
 
 	GstElement       *pipe;
 	GstAppSink       *appsink;
@@ -71,6 +75,10 @@ typedef struct pvt_data_t
 	bool blockingRx;
 
 	gint			nWaiting;
+	// talker: pulled buffers, txBufIdx is the next one to queue
+	GstAlBuf txBufs[GST_AL_PULL_BATCH];
+	U32 txBufCnt;
+	U32 txBufIdx;
 	bool firstSample;
 	U16 stream_uid;
 } pvt_data_t;
@@ -128,6 +136,18 @@ void openavbIntfH264RtpGstCfgCB(media_q_t *pMediaQ, const char *name, const char
 			pPvtData->ignoreTimestamp = (tmp == 1);
 		}
 	}
+	else if (strcmp(name, "intf_nv_gst_shared_pipeline") == 0)
+	{
+		tmp = strtol(value, &pEnd, 10);
+		if (*pEnd == '\0' && pEnd != value && (tmp == 0 || tmp == 1))
+		{
+			pPvtData->sharedPipeline = (tmp == 1);
+		}
+		else
+		{
+			AVB_LOGF_WARNING("Bad value for configuration item: %s = %s", name, value);
+		}
+	}
 }
 
 void openavbIntfH264RtpGstGenInitCB(media_q_t *pMediaQ)
@@ -174,14 +194,33 @@ static int openavbMediaQGetItemSize(media_q_t *pMediaQ)
 	return itemSize;
 }
 
-static void createTxPipeline(media_q_t *pMediaQ)
+static GstElement *createPipeline(pvt_data_t *pPvtData)
 {
-	pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
 	GError *error = NULL;
-	pPvtData->pipe = gst_parse_launch(pPvtData->pPipelineStr, &error);
+	GstElement *pipe;
+	if (pPvtData->sharedPipeline)
+	{
+		pipe = gst_al_shared_pipeline_add(pPvtData->pPipelineStr, &error);
+	}
+	else
+	{
+		pipe = gst_parse_launch(pPvtData->pPipelineStr, &error);
+	}
 	if (error)
 	{
 		AVB_LOGF_ERROR("Unable to create pipeline: %s", error->message);
+		g_error_free(error);
+	}
+	return pipe;
+}
+
+static void createTxPipeline(media_q_t *pMediaQ)
+{
+	pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+	pPvtData->pipe = createPipeline(pPvtData);
+	if (!pPvtData->pipe)
+	{
+		return;
 	}
 
 	AVB_LOGF_INFO("Pipeline: %s", pPvtData->pPipelineStr);
@@ -189,6 +228,7 @@ static void createTxPipeline(media_q_t *pMediaQ)
 	if (!pPvtData->appsink)
 	{
 		AVB_LOG_ERROR("Failed to find appsink element");
+		return;
 	}
 
 	// Setup callback function to handle new buffers delivered to sink
@@ -222,9 +262,19 @@ static void destroyPipeline(media_q_t *pMediaQ)
 {
 	pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
 
+	// Buffers not queued yet go with the pipeline
+	if (pPvtData->txBufIdx < pPvtData->txBufCnt)
+	{
+		gst_al_rtp_buffers_release(&pPvtData->txBufs[pPvtData->txBufIdx], pPvtData->txBufCnt - pPvtData->txBufIdx);
+	}
+	pPvtData->txBufIdx = pPvtData->txBufCnt = 0;
+
 	if (pPvtData->pipe)
 	{
-		gst_element_set_state(pPvtData->pipe, GST_STATE_NULL);
+		if (!pPvtData->sharedPipeline)
+		{
+			gst_element_set_state(pPvtData->pipe, GST_STATE_NULL);
+		}
 		if (pPvtData->appsink)
 		{
 			gst_object_unref(pPvtData->appsink);
@@ -235,9 +285,17 @@ static void destroyPipeline(media_q_t *pMediaQ)
 			gst_object_unref(pPvtData->appsrc);
 			pPvtData->appsrc = NULL;
 		}
-		gst_object_unref(pPvtData->pipe);
+		if (pPvtData->sharedPipeline)
+		{
+			gst_al_shared_pipeline_remove(pPvtData->pipe);
+		}
+		else
+		{
+			gst_object_unref(pPvtData->pipe);
+		}
 		pPvtData->pipe = NULL;
 	}
+	g_atomic_int_set(&pPvtData->nWaiting, 0);
 }
 
 // A call to this callback indicates that this interface module will be
@@ -289,70 +347,79 @@ bool openavbIntfH264RtpGstTxCB(media_q_t *pMediaQ)
 		return FALSE;
 	}
 
-	if (gst_app_sink_is_eos(GST_APP_SINK(pPvtData->appsink))) {
+	if (!pPvtData->appsink)
+	{
+		AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+		return FALSE;
+	}
+
+	if (pPvtData->txBufIdx == pPvtData->txBufCnt && gst_app_sink_is_eos(GST_APP_SINK(pPvtData->appsink))) {
 		AVB_LOG_INFO("Rewinding stream...");
 		destroyPipeline(pMediaQ);
 		createTxPipeline(pMediaQ);
 	}
 
-	while (g_atomic_int_get(&pPvtData->nWaiting) > 0)
+	while (TRUE)
 	{
-		//Transmit data --BEGIN--
-		media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
-		if (pMediaQItem)
+		if (pPvtData->txBufIdx == pPvtData->txBufCnt)
 		{
-			U32 paySize = 0;
-
-			GstAlBuf *txBuf = NULL;
-
-			txBuf = gst_al_pull_rtp_buffer(GST_APP_SINK(pPvtData->appsink));
-
-			if (!txBuf)
+			// Batch used up, take everything appsink has announced since
+			gint nWaiting = g_atomic_int_get(&pPvtData->nWaiting);
+			if (nWaiting <= 0)
+			{
+				break;
+			}
+			guint count = MIN(nWaiting, GST_AL_PULL_BATCH);
+			pPvtData->txBufIdx = 0;
+			pPvtData->txBufCnt = gst_al_pull_rtp_buffers(GST_APP_SINK(pPvtData->appsink), pPvtData->txBufs, count);
+			if (!pPvtData->txBufCnt)
 			{
-				pMediaQItem->dataLen = 0;
-				openavbMediaQHeadUnlock(pMediaQ);
 				AVB_LOG_ERROR("Gstreamer buffer pull problem");
-				AVB_TRACE_EXIT(AVB_TRACE_INTF);
+				AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
 				return FALSE;
 			}
+			g_atomic_int_add(&pPvtData->nWaiting, -(gint)pPvtData->txBufCnt);
+		}
 
-			g_atomic_int_add(&pPvtData->nWaiting, -1);
-			paySize = GST_AL_BUF_SIZE(txBuf);
+		//Transmit data --BEGIN--
+		media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+		if (!pMediaQItem)
+		{
+			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+			//AVB_LOG_INFO("MediaQ full");
+			return FALSE;	// Media queue full, the rest of the batch goes out next time
+		}
 
-			if(paySize > pMediaQItem->itemSize){
+		GstAlBuf *txBuf = &pPvtData->txBufs[pPvtData->txBufIdx++];
+		U32 paySize = GST_AL_BUF_SIZE(txBuf);
 
-				AVB_LOGF_ERROR("PaySize (%d) exceeds pMediaQItem itemSize (%d).", paySize, pMediaQItem->itemSize);
+		if(paySize > pMediaQItem->itemSize){
 
-				pMediaQItem->dataLen = 0;
-				openavbMediaQHeadUnlock(pMediaQ);
-				gst_al_rtp_buffer_unref(txBuf);
+			AVB_LOGF_ERROR("PaySize (%d) exceeds pMediaQItem itemSize (%d).", paySize, pMediaQItem->itemSize);
 
-				return FALSE;
-			}
+			pMediaQItem->dataLen = 0;
+			openavbMediaQHeadUnlock(pMediaQ);
+			gst_al_rtp_buffers_release(txBuf, 1);
 
-			pMediaQItem->dataLen = paySize;
-			memcpy(pMediaQItem->pPubData, GST_AL_BUF_DATA(txBuf), paySize);
-			if (gst_al_rtp_buffer_get_marker(txBuf))
-			{
-				((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->lastPacket = TRUE;
-			}
-			else
-			{
-				((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->lastPacket = FALSE;
-			}
-			((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->timestamp =
-					gst_al_rtp_buffer_get_timestamp(txBuf);
-			openavbAvtpTimeSetToWallTime(pMediaQItem->pAvtpTime);
-			openavbMediaQHeadPush(pMediaQ);
+			return FALSE;
+		}
 
-			gst_al_rtp_buffer_unref(txBuf);
+		pMediaQItem->dataLen = paySize;
+		memcpy(pMediaQItem->pPubData, GST_AL_BUF_DATA(txBuf), paySize);
+		if (gst_al_rtp_buffer_get_marker(txBuf))
+		{
+			((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->lastPacket = TRUE;
 		}
 		else
 		{
-			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
-			//AVB_LOG_INFO("MediaQ full");
-			return FALSE;	// Media queue full
+			((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->lastPacket = FALSE;
 		}
+		((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->timestamp =
+				gst_al_rtp_buffer_get_timestamp(txBuf);
+		openavbAvtpTimeSetToWallTime(pMediaQItem->pAvtpTime);
+		openavbMediaQHeadPush(pMediaQ);
+
+		gst_al_rtp_buffers_release(txBuf, 1);
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
@@ -444,11 +511,10 @@ void openavbIntfH264RtpGstRxInitCB(media_q_t *pMediaQ)
 
 	pPvtData->firstSample = true;
 
-	GError *error = NULL;
-	pPvtData->pipe = gst_parse_launch(pPvtData->pPipelineStr, &error);
-	if (error)
+	pPvtData->pipe = createPipeline(pPvtData);
+	if (!pPvtData->pipe)
 	{
-		AVB_LOGF_ERROR("Unable to create pipeline: %s", error->message);
+		return;
 	}
 
 	AVB_LOGF_INFO("Pipeline: %s", pPvtData->pPipelineStr);
@@ -486,6 +552,29 @@ void openavbIntfH264RtpGstRxInitCB(media_q_t *pMediaQ)
 	}
 }
 
+// Called by gstreamer once it is done with a buffer wrapping a received frame.
+static void rxFrameRelease(gpointer owner, gpointer mem)
+{
+	openavbMediaQRxFrameRelease((media_q_t *)owner, mem);
+}
+
+// Wraps the received frame referenced by the media queue item as a RTP buffer.
+// The RTP header overwrites the already parsed tail of the AVTP header.
+static GstAlBuf *wrapRxFrame(media_q_t *pMediaQ, media_q_item_t *pMediaQItem)
+{
+	U8 *pPayload = NULL;
+	U32 payloadLen = pMediaQItem->dataLen;
+	void *pRxFrame = openavbMediaQTailDetachRxFrame(pMediaQ, pMediaQItem, &pPayload);
+	if (!pRxFrame)
+		return NULL;
+
+	GstAlBuf *rxBuf = gst_al_wrap_rtp_buffer(pPayload - RTP_HEADER_SIZE, payloadLen + RTP_HEADER_SIZE,
+		rxFrameRelease, pMediaQ, pRxFrame);
+	if (!rxBuf)
+		openavbMediaQRxFrameRelease(pMediaQ, pRxFrame);
+	return rxBuf;
+}
+
 // This callback is called when acting as a listener.
 bool openavbIntfH264RtpGstRxCB(media_q_t *pMediaQ)
 {
@@ -537,15 +626,29 @@ bool openavbIntfH264RtpGstRxCB(media_q_t *pMediaQ)
 				continue;
 			}
 		}
-		GstAlBuf *rxBuf = gst_al_alloc_rtp_buffer(pMediaQItem->dataLen, 0,0);
-
-		if (!rxBuf)
+		GstAlBuf *rxBuf;
+		if (pMediaQItem->pRxFrame)
 		{
-			AVB_LOG_ERROR("gst_rtp_buffer_allocate failed!");
-			openavbMediaQTailUnlock(pMediaQ);
-			return FALSE;
+			rxBuf = wrapRxFrame(pMediaQ, pMediaQItem);
+			if (!rxBuf)
+			{
+				AVB_LOG_ERROR("Wrapping received frame failed!");
+				openavbMediaQTailPull(pMediaQ);
+				continue;
+			}
+		}
+		else
+		{
+			rxBuf = gst_al_alloc_rtp_buffer(pMediaQItem->dataLen, 0,0);
+
+			if (!rxBuf)
+			{
+				AVB_LOG_ERROR("gst_rtp_buffer_allocate failed!");
+				openavbMediaQTailUnlock(pMediaQ);
+				return FALSE;
+			}
+			memcpy(GST_AL_BUF_DATA(rxBuf), pMediaQItem->pPubData, pMediaQItem->dataLen);
 		}
-		memcpy(GST_AL_BUF_DATA(rxBuf), pMediaQItem->pPubData, pMediaQItem->dataLen);
 
 		//GST_AL_BUFFER_TIMESTAMP(rxBuf) = GST_CLOCK_TIME_NONE;
 		GST_AL_BUFFER_TIMESTAMP(rxBuf) = ((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->timestamp;
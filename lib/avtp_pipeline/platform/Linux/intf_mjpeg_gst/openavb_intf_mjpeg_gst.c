@@ -61,6 +61,7 @@ typedef struct pvt_data_t
 	char *pPipelineStr;
 
 	bool ignoreTimestamp;
+	bool sharedPipeline;
 
 	GstElement       *pipe;
 	GstElement       *appsink;
@@ -73,6 +74,13 @@ typedef struct pvt_data_t
 	bool asyncRx;
 	bool blockingRx;
 
+	// talker: buffers announced by appsink and not pulled yet
+	gint nWaiting;
+	// talker: pulled buffers, txBufIdx is the next one to queue
+	GstAlBuf txBufs[GST_AL_PULL_BATCH];
+	U32 txBufCnt;
+	U32 txBufIdx;
+
 	bool get_avtp_timestamp;        /*<! this flag indicates whether
                                         an avtp timestamp should be taken */
 	U32 frame_timestamp;            /*<! this is a timestamp of a video frame */
@@ -131,6 +139,48 @@ void openavbIntfMjpegGstCfgCB(media_q_t *pMediaQ, const char *name, const char *
 			pPvtData->ignoreTimestamp = (tmp == 1);
 		}
 	}
+	else if (strcmp(name, "intf_nv_gst_shared_pipeline") == 0)
+	{
+		tmp = strtol(value, &pEnd, 10);
+		if (*pEnd == '\0' && pEnd != value && (tmp == 0 || tmp == 1))
+		{
+			pPvtData->sharedPipeline = (tmp == 1);
+		}
+		else
+		{
+			AVB_LOGF_WARNING("Bad value for configuration item: %s = %s", name, value);
+		}
+	}
+}
+
+static GstElement *createPipeline(pvt_data_t *pPvtData)
+{
+	GError *error = NULL;
+	GstElement *pipe;
+	if (pPvtData->sharedPipeline)
+	{
+		pipe = gst_al_shared_pipeline_add(pPvtData->pPipelineStr, &error);
+	}
+	else
+	{
+		pipe = gst_parse_launch(pPvtData->pPipelineStr, &error);
+	}
+	if (error)
+	{
+		AVB_LOGF_ERROR("Unable to create pipeline: %s", error->message);
+		g_error_free(error);
+	}
+	return pipe;
+}
+
+static GstFlowReturn sinkNewBufferSample(GstAppSink *sink, gpointer pv)
+{
+	media_q_t *pMediaQ = (media_q_t *)pv;
+	pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+
+	g_atomic_int_add(&pPvtData->nWaiting, 1);
+
+	return GST_FLOW_OK;
 }
 
 void openavbIntfMjpegGstGenInitCB(media_q_t *pMediaQ)
@@ -165,11 +215,11 @@ void openavbIntfMjpegGstTxInitCB(media_q_t *pMediaQ)
 		return;
 	}
 
-	GError *error = NULL;
-	pPvtData->pipe = gst_parse_launch(pPvtData->pPipelineStr, &error);
-	if (error)
+	pPvtData->pipe = createPipeline(pPvtData);
+	if (!pPvtData->pipe)
 	{
-		AVB_LOGF_ERROR("Unable to create pipeline: %s", error->message);
+		AVB_TRACE_EXIT(AVB_TRACE_INTF);
+		return;
 	}
 
 	AVB_LOGF_INFO("Pipeline: %s", pPvtData->pPipelineStr);
@@ -177,7 +227,16 @@ void openavbIntfMjpegGstTxInitCB(media_q_t *pMediaQ)
 	if (!pPvtData->appsink)
 	{
 		AVB_LOG_ERROR("Failed to find appsink element");
+		AVB_TRACE_EXIT(AVB_TRACE_INTF);
+		return;
 	}
+
+	// Count the buffers as they arrive so the tx callback never blocks in a pull
+	GstAppSinkCallbacks cbfns;
+	memset(&cbfns, 0, sizeof(GstAppSinkCallbacks));
+	gst_al_set_callback(&cbfns, sinkNewBufferSample);
+	gst_app_sink_set_callbacks(GST_APP_SINK(pPvtData->appsink), &cbfns, (gpointer)(pMediaQ), NULL);
+
 	//No limits for internal sink buffers. This may cause large memory consumption.
 	g_object_set(pPvtData->appsink, "max-buffers", 0, "drop", 0, NULL);
 	//FIXME: Check if state change was successful
@@ -208,25 +267,61 @@ bool openavbIntfMjpegGstTxCB(media_q_t *pMediaQ)
 		return FALSE;
 	}
 
-	U32 paySize = 0;
-
-	GstAlBuf *txBuf = NULL;
-
-	txBuf = gst_al_pull_rtp_buffer(GST_APP_SINK(pPvtData->appsink));
-
-	if (!txBuf)
+	if (!pPvtData->appsink)
 	{
-		AVB_LOG_ERROR("Gstreamer buffer pull problem");
-		AVB_TRACE_EXIT(AVB_TRACE_INTF);
+		AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
 		return FALSE;
 	}
 
-	paySize = GST_AL_BUF_SIZE(txBuf);
-
-	//Transmit data --BEGIN--
-	media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
-	if (pMediaQItem)
+	while (TRUE)
 	{
+		if (pPvtData->txBufIdx == pPvtData->txBufCnt)
+		{
+			// Batch used up, take everything appsink has announced since
+			gint nWaiting = g_atomic_int_get(&pPvtData->nWaiting);
+			if (nWaiting <= 0)
+			{
+				break;
+			}
+			guint count = MIN(nWaiting, GST_AL_PULL_BATCH);
+			pPvtData->txBufIdx = 0;
+			pPvtData->txBufCnt = gst_al_pull_rtp_buffers(GST_APP_SINK(pPvtData->appsink), pPvtData->txBufs, count);
+			if (pPvtData->txBufCnt < count)
+			{
+				AVB_LOG_INFO("GStreamer returned NULL buffer, pipeline stopped");
+				g_atomic_int_set(&pPvtData->nWaiting, 0);
+				if (!pPvtData->txBufCnt)
+				{
+					AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+					return FALSE;
+				}
+			}
+			else
+			{
+				g_atomic_int_add(&pPvtData->nWaiting, -(gint)count);
+			}
+		}
+
+		//Transmit data --BEGIN--
+		media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+		if (!pMediaQItem)
+		{
+			// Media queue full, the rest of the batch goes out next time
+			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+			return FALSE;
+		}
+
+		GstAlBuf *txBuf = &pPvtData->txBufs[pPvtData->txBufIdx++];
+		U32 paySize = GST_AL_BUF_SIZE(txBuf);
+		if (paySize > pMediaQItem->itemSize)
+		{
+			AVB_LOGF_ERROR("PaySize (%d) exceeds pMediaQItem itemSize (%d).", paySize, pMediaQItem->itemSize);
+			pMediaQItem->dataLen = 0;
+			openavbMediaQHeadUnlock(pMediaQ);
+			gst_al_rtp_buffers_release(txBuf, 1);
+			continue;
+		}
+
 		pMediaQItem->dataLen = paySize;
 		memcpy(pMediaQItem->pPubData, GST_AL_BUF_DATA(txBuf), paySize);
 		if (gst_al_rtp_buffer_get_marker(txBuf))
@@ -248,21 +343,9 @@ bool openavbIntfMjpegGstTxCB(media_q_t *pMediaQ)
 		}
 		openavbMediaQHeadPush(pMediaQ);
 
-		gst_al_rtp_buffer_unref(txBuf);
-
-		AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
-		return TRUE;
+		gst_al_rtp_buffers_release(txBuf, 1);
 	}
-	else
-	{
-		gst_al_rtp_buffer_unref(txBuf);
-		AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
-		AVB_LOG_INFO("GStreamer returned NULL buffer, pipeline stopped");
-		return FALSE;	// Media queue full
-	}
-	// never here....
-	openavbMediaQHeadUnlock(pMediaQ);
-	pMediaQItem->dataLen = 0;
+
 	AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
 	return TRUE;
 }
@@ -350,11 +433,10 @@ void openavbIntfMjpegGstRxInitCB(media_q_t *pMediaQ)
 		return;
 	}
 
-	GError *error = NULL;
-	pPvtData->pipe = gst_parse_launch(pPvtData->pPipelineStr, &error);
-	if (error)
+	pPvtData->pipe = createPipeline(pPvtData);
+	if (!pPvtData->pipe)
 	{
-		AVB_LOGF_ERROR("Unable to create pipeline: %s", error->message);
+		return;
 	}
 
 	AVB_LOGF_INFO("Pipeline: %s", pPvtData->pPipelineStr);
@@ -510,9 +592,17 @@ void openavbIntfMjpegGstEndCB(media_q_t *pMediaQ)
 		AVB_LOG_ERROR("Private interface module data not allocated.");
 		return;
 	}
+	if (pPvtData->txBufIdx < pPvtData->txBufCnt)
+	{
+		gst_al_rtp_buffers_release(&pPvtData->txBufs[pPvtData->txBufIdx], pPvtData->txBufCnt - pPvtData->txBufIdx);
+	}
+	pPvtData->txBufIdx = pPvtData->txBufCnt = 0;
 	if (pPvtData->pipe)
 	{
-		gst_element_set_state(pPvtData->pipe, GST_STATE_NULL);
+		if (!pPvtData->sharedPipeline)
+		{
+			gst_element_set_state(pPvtData->pipe, GST_STATE_NULL);
+		}
 		if (pPvtData->appsink)
 		{
 			gst_object_unref(pPvtData->appsink);
@@ -523,7 +613,14 @@ void openavbIntfMjpegGstEndCB(media_q_t *pMediaQ)
 			gst_object_unref(pPvtData->appsrc);
 			pPvtData->appsrc = NULL;
 		}
-		gst_object_unref(pPvtData->pipe);
+		if (pPvtData->sharedPipeline)
+		{
+			gst_al_shared_pipeline_remove(pPvtData->pipe);
+		}
+		else
+		{
+			gst_object_unref(pPvtData->pipe);
+		}
 		pPvtData->pipe = NULL;
 	}
 	if (pPvtData->asyncRx)
@@ -59,6 +59,9 @@ typedef struct
 
 	bool ignoreTimestamp;
 
+	// add the pipeline to the process wide one
+	bool sharedPipeline;
+
 	/////////////
 	// Variable data
 	/////////////
@@ -69,6 +72,10 @@ typedef struct
 
 	// talker: number of gstreamer buffers waiting to be pulled
 	gint			nWaiting;
+	// talker: pulled buffers, txBufIdx is the next one to queue
+	GstAlBuf		txBufs[GST_AL_PULL_BATCH];
+	U32				txBufCnt;
+	U32				txBufIdx;
 	// listener: whether gstreamer wants more pushed data now
 	bool			srcPaused;
 
@@ -109,6 +116,15 @@ void openavbIntfMpeg2tsGstCfgCB(media_q_t *pMediaQ, const char *name, const char
 				valueOK = TRUE;
 			}
 		}
+		else if (strcmp(name, "intf_nv_gst_shared_pipeline") == 0)
+		{
+			tmp = strtol(value, &pEnd, 10);
+			if (*pEnd == '\0' && pEnd != value && (tmp == 0 || tmp == 1))
+			{
+				pPvtData->sharedPipeline = (tmp == 1);
+				valueOK = TRUE;
+			}
+		}
 		else
 		{
 			AVB_LOGF_WARNING("Unknown configuration item: %s", name);
@@ -205,6 +221,49 @@ bus_message(GstBus *bus, GstMessage *message, void *pv)
 	return TRUE;
 }
 
+static bool createPipeline(media_q_t *pMediaQ)
+{
+	pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+	GError *error = NULL;
+
+	if (pPvtData->sharedPipeline)
+	{
+		// The shared pipeline has a bus of its own
+		pPvtData->pipe = gst_al_shared_pipeline_add(pPvtData->pPipelineStr, &error);
+	}
+	else
+	{
+		pPvtData->pipe = gst_parse_launch(pPvtData->pPipelineStr, &error);
+	}
+	if (error)
+	{
+		AVB_LOGF_ERROR("Error creating pipeline: %s", error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+	if (!pPvtData->pipe)
+	{
+		return FALSE;
+	}
+
+	AVB_LOGF_INFO("Pipeline: %s", pPvtData->pPipelineStr);
+
+	if (!pPvtData->sharedPipeline)
+	{
+		// create bus
+		pPvtData->bus = gst_pipeline_get_bus(GST_PIPELINE(pPvtData->pipe));
+		if (!pPvtData->bus)
+		{
+			AVB_LOG_ERROR("Failed to create bus");
+			return FALSE;
+		}
+
+		/* add callback for bus messages */
+		gst_bus_add_watch(pPvtData->bus, (GstBusFunc)bus_message, pMediaQ);
+	}
+	return TRUE;
+}
+
 // This callback triggers when appsrc needs data.
 static void srcStartFeed (GstAppSrc *source, guint size, gpointer pv)
 {
@@ -262,16 +321,13 @@ void openavbIntfMpeg2tsGstTxInitCB(media_q_t *pMediaQ)
 		pPvtData->appsrc = (GstAppSrc*)NULL;
 		pPvtData->bus = (GstBus*)NULL;
 		pPvtData->nWaiting = 0;
+		pPvtData->txBufCnt = pPvtData->txBufIdx = 0;
 
-		GError *error = NULL;
-		pPvtData->pipe = gst_parse_launch(pPvtData->pPipelineStr, &error);
-		if (error)
+		if (!createPipeline(pMediaQ))
 		{
-			AVB_LOGF_ERROR("Error creating pipeline: %s", error->message);
 			return;
 		}
 
-		AVB_LOGF_INFO("Pipeline: %s", pPvtData->pPipelineStr);
 		pPvtData->appsink = GST_APP_SINK(gst_bin_get_by_name(GST_BIN(pPvtData->pipe), APPSINK_NAME));
 		if (!pPvtData->appsink)
 		{
@@ -279,17 +335,6 @@ void openavbIntfMpeg2tsGstTxInitCB(media_q_t *pMediaQ)
 			return;
 		}
 
-		// create bus
-		pPvtData->bus = gst_pipeline_get_bus(GST_PIPELINE(pPvtData->pipe));
-		if (!pPvtData->bus)
-		{
-			AVB_LOG_ERROR("Failed to create bus");
-			return;
-		}
-
-		/* add callback for bus messages */
-		gst_bus_add_watch(pPvtData->bus, (GstBusFunc)bus_message, pMediaQ);
-
 		// Setup callback function to handle new buffers delivered to sink
 		GstAppSinkCallbacks cbfns;
 		memset(&cbfns, 0, sizeof(GstAppSinkCallbacks));
@@ -336,51 +381,57 @@ bool openavbIntfMpeg2tsGstTxCB(media_q_t *pMediaQ)
 	media_q_item_t *pMediaQItem;
 	GstAlBuf *txBuf;
 
-	while (g_atomic_int_get(&pPvtData->nWaiting) > 0)
+	while (TRUE)
 	{
+		if (pPvtData->txBufIdx == pPvtData->txBufCnt)
+		{
+			// Batch used up, take everything appsink has announced since
+			gint nWaiting = g_atomic_int_get(&pPvtData->nWaiting);
+			if (nWaiting <= 0)
+				break;
+
+			guint count = MIN(nWaiting, GST_AL_PULL_BATCH);
+			pPvtData->txBufIdx = 0;
+			pPvtData->txBufCnt = gst_al_pull_buffers(pPvtData->appsink, pPvtData->txBufs, count);
+			if (pPvtData->txBufCnt < count)
+			{
+				AVB_LOG_ERROR("GStreamer buffer pull failed");
+				// assume the pipeline is empty
+				g_atomic_int_set(&pPvtData->nWaiting, 0);
+				if (!pPvtData->txBufCnt)
+					break;
+			}
+			else
+			{
+				g_atomic_int_add(&pPvtData->nWaiting, -(gint)count);
+			}
+		}
 
 		// Get a mediaQItem to hold the buffered data
 		pMediaQItem = openavbMediaQHeadLock(pMediaQ);
 		if (!pMediaQItem)
 		{
+			// the rest of the batch goes out next time
 			IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("Media queue full");
 			break;
 		}
 
-		/* Retrieve the buffer
-		 */
-		txBuf = gst_al_pull_buffer(pPvtData->appsink);
-
-		if (txBuf)
+		txBuf = &pPvtData->txBufs[pPvtData->txBufIdx++];
+		if ( GST_AL_BUF_SIZE(txBuf) > pMediaQItem->itemSize )
 		{
-			g_atomic_int_add(&pPvtData->nWaiting, -1);
-			if ( GST_AL_BUF_SIZE(txBuf) > pMediaQItem->itemSize )
-			{
-				AVB_LOGF_ERROR("GStreamer buffer too large (size=%d) for mediaQ item (dataLen=%d)",
-				               GST_AL_BUF_SIZE(txBuf), pMediaQItem->itemSize);
-				pMediaQItem->dataLen = 0;
-				openavbMediaQHeadUnlock(pMediaQ);
-			}
-			else
-			{
-				memcpy(pMediaQItem->pPubData, GST_AL_BUF_DATA(txBuf), GST_AL_BUF_SIZE(txBuf));
-				pMediaQItem->dataLen = GST_AL_BUF_SIZE(txBuf);
-				openavbAvtpTimeSetToWallTime(pMediaQItem->pAvtpTime);
-				openavbMediaQHeadPush(pMediaQ);
-			}
-			gst_al_buffer_unref(txBuf);
+			AVB_LOGF_ERROR("GStreamer buffer too large (size=%d) for mediaQ item (dataLen=%d)",
+			               GST_AL_BUF_SIZE(txBuf), pMediaQItem->itemSize);
+			pMediaQItem->dataLen = 0;
+			openavbMediaQHeadUnlock(pMediaQ);
 		}
 		else
 		{
-			AVB_LOG_ERROR("GStreamer buffer pull failed");
-			// assume the pipeline is empty
-			g_atomic_int_set(&pPvtData->nWaiting, 0);
-			// abandon the mediaq item
-			pMediaQItem->dataLen = 0;
-			openavbMediaQHeadUnlock(pMediaQ);
-			// and get out
-			break;
+			memcpy(pMediaQItem->pPubData, GST_AL_BUF_DATA(txBuf), GST_AL_BUF_SIZE(txBuf));
+			pMediaQItem->dataLen = GST_AL_BUF_SIZE(txBuf);
+			openavbAvtpTimeSetToWallTime(pMediaQItem->pAvtpTime);
+			openavbMediaQHeadPush(pMediaQ);
 		}
+		gst_al_buffers_release(txBuf, 1);
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
@@ -409,15 +460,11 @@ void openavbIntfMpeg2tsGstRxInitCB(media_q_t *pMediaQ)
 		pPvtData->bus = (GstBus*)NULL;
 		pPvtData->srcPaused = FALSE;
 
-		GError *error = NULL;
-		pPvtData->pipe = gst_parse_launch(pPvtData->pPipelineStr, &error);
-		if (error)
+		if (!createPipeline(pMediaQ))
 		{
-			AVB_LOGF_ERROR("Error creating pipeline: %s", error->message);
 			return;
 		}
 
-		AVB_LOGF_INFO("Pipeline: %s", pPvtData->pPipelineStr);
 		pPvtData->appsrc = GST_APP_SRC(gst_bin_get_by_name(GST_BIN(pPvtData->pipe), APPSRC_NAME));
 		if (!pPvtData->appsrc)
 		{
@@ -428,17 +475,6 @@ void openavbIntfMpeg2tsGstRxInitCB(media_q_t *pMediaQ)
 		// Make appsrc non-blocking
 		g_object_set(G_OBJECT(pPvtData->appsrc), "block", FALSE, NULL);
 
-		// create bus
-		pPvtData->bus = gst_pipeline_get_bus(GST_PIPELINE(pPvtData->pipe));
-		if (!pPvtData->bus)
-		{
-			AVB_LOG_ERROR("Failed to create bus");
-			return;
-		}
-
-		/* add callback for bus messages */
-		gst_bus_add_watch(pPvtData->bus, (GstBusFunc)bus_message, pMediaQ);
-
 		// Setup callback function to handle request from src to pause/start data flow
 		GstAppSrcCallbacks cbfns;
 		memset(&cbfns, 0, sizeof(GstAppSrcCallbacks));
@@ -541,9 +577,18 @@ void openavbIntfMpeg2tsGstEndCB(media_q_t *pMediaQ)
 			return;
 		}
 
+		if (pPvtData->txBufIdx < pPvtData->txBufCnt)
+		{
+			gst_al_buffers_release(&pPvtData->txBufs[pPvtData->txBufIdx], pPvtData->txBufCnt - pPvtData->txBufIdx);
+		}
+		pPvtData->txBufIdx = pPvtData->txBufCnt = 0;
+
 		if (pPvtData->pipe)
 		{
-			gst_element_set_state(GST_ELEMENT(pPvtData->pipe), GST_STATE_NULL);
+			if (!pPvtData->sharedPipeline)
+			{
+				gst_element_set_state(GST_ELEMENT(pPvtData->pipe), GST_STATE_NULL);
+			}
 			if (pPvtData->bus)
 			{
 				gst_object_unref(pPvtData->bus);
@@ -559,7 +604,14 @@ void openavbIntfMpeg2tsGstEndCB(media_q_t *pMediaQ)
 				gst_object_unref(pPvtData->appsrc);
 				pPvtData->appsrc = NULL;
 			}
-			gst_object_unref(pPvtData->pipe);
+			if (pPvtData->sharedPipeline)
+			{
+				gst_al_shared_pipeline_remove(pPvtData->pipe);
+			}
+			else
+			{
+				gst_object_unref(pPvtData->pipe);
+			}
 			pPvtData->pipe = NULL;
 		}
 	}
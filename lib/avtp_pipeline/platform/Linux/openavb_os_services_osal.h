@@ -66,25 +66,85 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define SLEEP(sec)  							   sleep(sec)
 #define SLEEP_MSEC(mSec)						   usleep(mSec * 1000)
 #define SLEEP_NSEC(nSec)						   usleep(nSec / 1000)
-#define SLEEP_UNTIL_NSEC(nSec)  				   xSleepUntilNSec(nSec)
-inline static void xSleepUntilNSec(U64 nSec)
+// Pause hint used inside busy wait loops
+#if defined(__i386__) || defined(__x86_64__)
+#define SPIN_PAUSE()							__builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define SPIN_PAUSE()							__asm__ __volatile__("yield" ::: "memory")
+#else
+#define SPIN_PAUSE()							__asm__ __volatile__("" ::: "memory")
+#endif
+
+// How often the cached OPENAVB_CLOCK_WALLTIME to CLOCK_MONOTONIC offset is refreshed
+#define SPIN_WAIT_RESYNC_NSEC					(10 * NANOSECONDS_PER_MSEC)
+
+// State kept between calls of SPIN_UNTIL_NSEC() or WALLTIME_CACHED_NSEC(). Zero initialize before first use.
+typedef struct {
+	S64 wallOffsetNS;
+	U64 nextResyncNS;
+} spin_wait_t;
+
+// Read CLOCK_MONOTONIC, refreshing the cached OPENAVB_CLOCK_WALLTIME offset if it is due.
+inline static U64 xSpinWaitMonoNSec(spin_wait_t *pWait)
 {
 	struct timespec tmpTime;
-	tmpTime.tv_sec = nSec / NANOSECONDS_PER_SECOND;
-	tmpTime.tv_nsec = nSec % NANOSECONDS_PER_SECOND;
-	clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tmpTime, NULL);
+	U64 monoNS;
+
+	clock_gettime(CLOCK_MONOTONIC, &tmpTime);
+	monoNS = ((U64)tmpTime.tv_sec * NANOSECONDS_PER_SECOND) + tmpTime.tv_nsec;
+	if (monoNS >= pWait->nextResyncNS) {
+		U64 wallNS;
+		if (CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &wallNS)) {
+			clock_gettime(CLOCK_MONOTONIC, &tmpTime);
+			monoNS = ((U64)tmpTime.tv_sec * NANOSECONDS_PER_SECOND) + tmpTime.tv_nsec;
+			pWait->wallOffsetNS = (S64)(wallNS - monoNS);
+			pWait->nextResyncNS = monoNS + SPIN_WAIT_RESYNC_NSEC;
+		}
+	}
+	return monoNS;
 }
 
-#define SPIN_UNTIL_NSEC(nsec)					xSpinUntilNSec(nsec)
-inline static void xSpinUntilNSec(U64 nSec)
+// OPENAVB_CLOCK_WALLTIME time from CLOCK_MONOTONIC and the cached offset. The gPTP time
+// is only read every SPIN_WAIT_RESYNC_NSEC, so per packet callers rarely take the gPTP
+// shared memory lock.
+#define WALLTIME_CACHED_NSEC(pWait)				xWalltimeCachedNSec(pWait)
+inline static U64 xWalltimeCachedNSec(spin_wait_t *pWait)
 {
+	// The offset must be read after the resync that may update it.
+	U64 monoNS = xSpinWaitMonoNSec(pWait);
+	return monoNS + pWait->wallOffsetNS;
+}
+
+// Wait until an absolute OPENAVB_CLOCK_WALLTIME time. The thread sleeps until guardNSec
+// before the deadline and then spins on CLOCK_MONOTONIC. The gPTP time is only read every
+// SPIN_WAIT_RESYNC_NSEC to refresh the cached offset so the loop never takes the gPTP
+// shared memory lock. Returns the OPENAVB_CLOCK_WALLTIME time at wake up.
+#define SPIN_UNTIL_NSEC(pWait, nSec, guardNSec)	xSpinUntilNSec(pWait, nSec, guardNSec)
+inline static U64 xSpinUntilNSec(spin_wait_t *pWait, U64 nSec, U64 guardNSec)
+{
+	struct timespec tmpTime;
+	U64 monoNS = xSpinWaitMonoNSec(pWait);
+
+	// Deadline expressed in the CLOCK_MONOTONIC domain
+	U64 untilNS = nSec - pWait->wallOffsetNS;
+
+	if (untilNS > monoNS + guardNSec) {
+		U64 sleepNS = untilNS - guardNSec;
+		tmpTime.tv_sec = sleepNS / NANOSECONDS_PER_SECOND;
+		tmpTime.tv_nsec = sleepNS % NANOSECONDS_PER_SECOND;
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tmpTime, NULL);
+	}
+
 	do {
-		U64 spinNowNS;
-		CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &spinNowNS);
-		if (spinNowNS > nSec)
+		clock_gettime(CLOCK_MONOTONIC, &tmpTime);
+		monoNS = ((U64)tmpTime.tv_sec * NANOSECONDS_PER_SECOND) + tmpTime.tv_nsec;
+		if (monoNS > untilNS)
 			break;
+		SPIN_PAUSE();
 	}
 	while (1);
+
+	return monoNS + pWait->wallOffsetNS;
 }
 
 #define RAND()  								   random()
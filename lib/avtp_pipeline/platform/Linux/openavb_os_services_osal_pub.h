@@ -55,6 +55,16 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define THREAD_SELF()							   pthread_self()
 #define GET_PID()								   getpid() 	
 
+// Sleep until an absolute OPENAVB_TIMER_CLOCK time
+#define SLEEP_UNTIL_NSEC(nSec)  				   xSleepUntilNSec(nSec)
+inline static void xSleepUntilNSec(U64 nSec)
+{
+	struct timespec tmpTime;
+	tmpTime.tv_sec = nSec / NANOSECONDS_PER_SECOND;
+	tmpTime.tv_nsec = nSec % NANOSECONDS_PER_SECOND;
+	clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tmpTime, NULL);
+}
+
 
 // Funky struct to hold a configurable ethernet address (MAC).
 // The "mac" pointer is null if no config value was supplied,
@@ -61,6 +61,68 @@ extern DLL_EXPORT bool osalAvdeccInitialize(const char* logfilename, const char*
 	return TRUE;
 }
 
+extern DLL_EXPORT bool osalAvdeccGenerateModel(const char* logfilename, const char* ifname, const char **inifiles, int numfiles, const char *outfile)
+{
+	bool ret;
+
+	// Open the log file, if requested.
+	if (s_logfile) {
+		fclose(s_logfile);
+		s_logfile = NULL;
+	}
+	if (logfilename) {
+		s_logfile = fopen(logfilename, "w");
+		if (s_logfile == NULL) {
+			fprintf(stderr, "Error opening log file: %s\n", logfilename);
+		}
+	}
+
+	avbLogInitEx(s_logfile);
+	osalAVBTimeInit();
+	ret = generateAvdeccModel(ifname, inifiles, numfiles, outfile);
+	osalAVBTimeClose();
+	avbLogExit();
+
+	// Done with the log file.
+	if (s_logfile) {
+		fclose(s_logfile);
+		s_logfile = NULL;
+	}
+
+	return ret;
+}
+
+extern DLL_EXPORT bool osalAvdeccCheckModel(const char* logfilename, const char* ifname, const char **inifiles, int numfiles)
+{
+	bool ret;
+
+	// Open the log file, if requested.
+	if (s_logfile) {
+		fclose(s_logfile);
+		s_logfile = NULL;
+	}
+	if (logfilename) {
+		s_logfile = fopen(logfilename, "w");
+		if (s_logfile == NULL) {
+			fprintf(stderr, "Error opening log file: %s\n", logfilename);
+		}
+	}
+
+	avbLogInitEx(s_logfile);
+	osalAVBTimeInit();
+	ret = checkAvdeccModel(ifname, inifiles, numfiles);
+	osalAVBTimeClose();
+	avbLogExit();
+
+	// Done with the log file.
+	if (s_logfile) {
+		fclose(s_logfile);
+		s_logfile = NULL;
+	}
+
+	return ret;
+}
+
 extern DLL_EXPORT bool osalAvdeccFinalize(void)
 {
 	stopAvdecc();
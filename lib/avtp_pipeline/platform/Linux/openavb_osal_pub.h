@@ -46,5 +46,9 @@ bool osalAvdeccInitialize(const char* logfilename, const char *ifname, const cha
 
 bool osalAvdeccFinalize(void);
 
+bool osalAvdeccGenerateModel(const char* logfilename, const char *ifname, const char **inifiles, int numfiles, const char *outfile);
+
+bool osalAvdeccCheckModel(const char* logfilename, const char *ifname, const char **inifiles, int numfiles);
+
 #endif // _OPENAVB_OSAL_PUB_H
 
@@ -71,6 +71,12 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 //task ListenerThread
 #define listenerThread_THREAD_STK_SIZE 						THREAD_STACK_SIZE
 
+//task rxNetThread. Listener RX pipeline network receive
+#define rxNetThread_THREAD_STK_SIZE							THREAD_STACK_SIZE
+
+//task rxDeliveryThread. Listener RX pipeline interface delivery
+#define rxDeliveryThread_THREAD_STK_SIZE					THREAD_STACK_SIZE
+
 //task avdeccMsgThread
 #define avdeccMsgThread_THREAD_STK_SIZE						THREAD_STACK_SIZE
 
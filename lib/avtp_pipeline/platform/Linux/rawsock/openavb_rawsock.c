@@ -32,6 +32,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "sendmmsg_rawsock.h"
 #include "simple_rawsock.h"
 #include "ring_rawsock.h"
+#include "shared_rawsock.h"
 #if AVB_FEATURE_PCAP
 #include "pcap_rawsock.h"
 #if AVB_FEATURE_IGB
@@ -194,3 +195,23 @@ void *openavbRawsockOpen(const char *ifname_uri, bool rx_mode, bool tx_mode, U16
 	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
 	return pvRawsock;
 }
+
+// Open a TX rawsock that shares its socket and ring with other streams
+void *openavbRawsockOpenShared(const char *ifname_uri, U8 priority, int mark, U16 ethertype, U32 frame_size, U32 num_frames, U32 shared_frames)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	// allocate memory for rawsock object
+	shared_rawsock_t *rawsock = calloc(1, sizeof(shared_rawsock_t));
+	if (!rawsock) {
+		AVB_LOG_ERROR("Creating rawsock; malloc failed");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return NULL;
+	}
+
+	// call constructor
+	void *pvRawsock = sharedRawsockOpen(rawsock, ifname_uri, priority, mark, ethertype, frame_size, num_frames, shared_frames);
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return pvRawsock;
+}
@@ -0,0 +1,230 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+#include "./openavb_rawsock.h"
+#include "openavb_log.h"
+
+// Checks that RX frames held by the client (rx_zero_copy) survive the ring wrapping
+// around to them: a held frame must not be handed out again, must be released only
+// once, and the ring must stay in sync after the release.
+//
+// Common usage: ./rawsock_hold_test -i lo
+
+#define HOLD_TEST_FRAMES		8
+// Small frames, as the default follows the MTU, which is 64k on lo
+#define HOLD_TEST_FRAME_SIZE	256
+#define HOLD_TEST_TIMEOUT_USEC	100000
+#define HOLD_TEST_IDLE_USEC		10000
+
+static char* interface = NULL;
+static int ethertype = 0x88B5;
+static int numFrames = HOLD_TEST_FRAMES;
+
+static GOptionEntry entries[] =
+{
+  { "interface", 'i', 0, G_OPTION_ARG_STRING, &interface, "network interface",                        "NAME" },
+  { "ethertype", 't', 0, G_OPTION_ARG_INT,    &ethertype, "ethernet protocol",                        "NUM" },
+  { "frames",    'n', 0, G_OPTION_ARG_INT,    &numFrames, "RX ring frames",                           "NUM" },
+  { NULL }
+};
+
+static void *txSock, *rxSock;
+static int nErrors = 0;
+
+#define HOLD_TEST_FAIL(fmt, ...) do { printf("FAIL: " fmt "\n", __VA_ARGS__); nErrors++; } while (0)
+
+// Send a frame carrying a sequence number
+static bool sendSeq(U32 seq)
+{
+	U8 *pBuf, *pData;
+	U32 buflen, hdrlen;
+
+	pBuf = (U8*)openavbRawsockGetTxFrame(txSock, TRUE, &buflen);
+	if (!pBuf) {
+		printf("error: failed to get TX frame buffer\n");
+		return FALSE;
+	}
+	openavbRawsockTxFillHdr(txSock, pBuf, &hdrlen);
+	pData = pBuf + hdrlen;
+	pData[0] = 0x7F;		// Experimental subtype
+	pData[1] = 0x00;
+	memcpy(pData + 2, &seq, sizeof(seq));
+	openavbRawsockTxFrameReady(txSock, pBuf, hdrlen + 2 + sizeof(seq), 0);
+	openavbRawsockSend(txSock);
+	return TRUE;
+}
+
+// Receive a frame; returns its sequence number, or -1 if none arrived
+static S64 recvSeq(U32 timeoutUsec, U8 **ppBuf)
+{
+	U32 offset, len, seq;
+	hdr_info_t hdr;
+	int hdrlen;
+
+	*ppBuf = openavbRawsockGetRxFrame(rxSock, timeoutUsec, &offset, &len);
+	if (!*ppBuf)
+		return -1;
+	hdrlen = openavbRawsockRxParseHdr(rxSock, *ppBuf, &hdr);
+	memcpy(&seq, *ppBuf + offset + hdrlen + 2, sizeof(seq));
+	return seq;
+}
+
+// Send a frame and expect it back
+static bool sendRecv(U32 seq, U8 **ppBuf)
+{
+	S64 got;
+
+	if (!sendSeq(seq))
+		return FALSE;
+	got = recvSeq(HOLD_TEST_TIMEOUT_USEC, ppBuf);
+	if (got != seq) {
+		HOLD_TEST_FAIL("expected frame %u, got %lld", seq, (long long)got);
+		if (*ppBuf)
+			openavbRawsockRelRxFrame(rxSock, *ppBuf);
+		*ppBuf = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+// Send frames the kernel has to drop because the next slot is held and check none is returned
+static void sendHeld(U32 seq, int count)
+{
+	U8 *pBuf;
+	S64 got;
+	int i1;
+
+	for (i1 = 0; i1 < count; i1++)
+		sendSeq(seq + i1);
+	got = recvSeq(HOLD_TEST_IDLE_USEC, &pBuf);
+	if (got >= 0) {
+		HOLD_TEST_FAIL("frame %lld received while its slot is held", (long long)got);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	GError *error = NULL;
+	GOptionContext *context;
+	char ifname[IFNAMSIZ + 10];
+	U8 *pHeld0 = NULL, *pHeld2 = NULL, *pBuf;
+	U32 seq = 0;
+	int ringFrames, i1;
+
+	context = g_option_context_new("- rawsock RX ring hold test");
+	g_option_context_add_main_entries(context, entries, NULL);
+	if (!g_option_context_parse(context, &argc, &argv, &error))
+	{
+		printf("error: %s\n", error->message);
+		exit(1);
+	}
+
+	if (interface == NULL || numFrames < 3) {
+		printf("error: must specify network interface and at least 3 frames\n");
+		exit(2);
+	}
+
+	avbLogInit();
+
+	snprintf(ifname, sizeof(ifname), "ring:%s", interface);
+	rxSock = openavbRawsockOpen(ifname, TRUE, FALSE, ethertype, HOLD_TEST_FRAME_SIZE, numFrames);
+	snprintf(ifname, sizeof(ifname), "simple:%s", interface);
+	txSock = openavbRawsockOpen(ifname, FALSE, TRUE, ethertype, HOLD_TEST_FRAME_SIZE, 4);
+	if (!rxSock || !txSock) {
+		printf("error: failed to open raw socket (are you root?)\n");
+		exit(3);
+	}
+
+	hdr_info_t hdr;
+	memset(&hdr, 0, sizeof(hdr_info_t));
+	openavbRawsockTxSetHdr(txSock, &hdr);
+
+	// The ring is rounded up to whole blocks
+	ringFrames = openavbRawsockRxHoldLimit(rxSock);
+	printf("%d frame RX ring on %s\n", ringFrames, interface);
+
+	// Fill the ring once, holding the frames in slots 0 and 2
+	for (i1 = 0; i1 < ringFrames; i1++, seq++) {
+		if (!sendRecv(seq, &pBuf))
+			goto done;
+		if (i1 == 0)
+			pHeld0 = pBuf;
+		else if (i1 == 2)
+			pHeld2 = pBuf;
+		else
+			openavbRawsockRelRxFrame(rxSock, pBuf);
+	}
+
+	// The ring wrapped to slot 0, which is still held
+	sendHeld(seq, 3);
+	seq += 3;
+
+	openavbRawsockRelRxFrame(rxSock, pHeld0);
+	if (openavbRawsockRelRxFrame(rxSock, pHeld0)) {
+		HOLD_TEST_FAIL("%s", "frame in slot 0 released twice");
+	}
+	pHeld0 = NULL;
+
+	// Slots 0 and 1 are free again, then the reader stops at slot 2
+	for (i1 = 0; i1 < 2; i1++, seq++) {
+		if (!sendRecv(seq, &pBuf))
+			goto done;
+		openavbRawsockRelRxFrame(rxSock, pBuf);
+	}
+	sendHeld(seq, 1);
+	seq += 1;
+
+	openavbRawsockRelRxFrame(rxSock, pHeld2);
+	pHeld2 = NULL;
+
+	// Two more cycles with nothing held; the reader and the kernel must stay in step
+	for (i1 = 0; i1 < 2 * ringFrames; i1++, seq++) {
+		if (!sendRecv(seq, &pBuf))
+			goto done;
+		openavbRawsockRelRxFrame(rxSock, pBuf);
+	}
+
+done:
+	if (pHeld0)
+		openavbRawsockRelRxFrame(rxSock, pHeld0);
+	if (pHeld2)
+		openavbRawsockRelRxFrame(rxSock, pHeld2);
+	openavbRawsockClose(txSock);
+	openavbRawsockClose(rxSock);
+	avbLogExit();
+
+	printf("%s\n", nErrors ? "FAIL" : "PASS");
+	return nErrors ? -1 : 0;
+}
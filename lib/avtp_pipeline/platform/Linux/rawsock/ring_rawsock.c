@@ -146,6 +146,16 @@ void* ringRawsockOpen(ring_rawsock_t *rawsock, const char *ifname, bool rx_mode,
 	// Initialize the memory
 	memset(rawsock->pMem, 0, rawsock->memSize);
 
+	if (rawsock->base.rxMode) {
+		rawsock->pRxHeld = calloc((rawsock->frameCount + 31) / 32, sizeof(U32));
+		if (!rawsock->pRxHeld) {
+			AVB_LOG_ERROR("Creating rawsock; malloc failed");
+			ringRawsockClose(rawsock);
+			AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+			return NULL;
+		}
+	}
+
 	// Initialize the state of the ring
 	rawsock->blockIndex = 0;
 	rawsock->bufferIndex = 0;
@@ -164,6 +174,7 @@ void* ringRawsockOpen(ring_rawsock_t *rawsock, const char *ifname, bool rx_mode,
 	cb->getRxFrame = ringRawsockGetRxFrame;
 	cb->rxParseHdr = ringRawsockRxParseHdr;
 	cb->relRxFrame = ringRawsockRelRxFrame;
+	cb->rxHoldLimit = ringRawsockRxHoldLimit;
 	cb->getTXOutOfBuffers = ringRawsockGetTXOutOfBuffers;
 	cb->getTXOutOfBuffersCyclic = ringRawsockGetTXOutOfBuffersCyclic;
 
@@ -183,6 +194,8 @@ void ringRawsockClose(void *pvRawsock)
 			munmap(rawsock->pMem, rawsock->memSize);
 			rawsock->pMem = (void*)(-1);
 		}
+		free(rawsock->pRxHeld);
+		rawsock->pRxHeld = NULL;
 	}
 
 	simpleRawsockClose(pvRawsock);
@@ -462,6 +475,25 @@ int ringRawsockRxBufLevel(void *pvRawsock)
 	return nInUse;
 }
 
+// Index in the ring of the slot that holds a frame
+static inline int x_rxSlot(ring_rawsock_t *rawsock, volatile struct tpacket2_hdr *pHdr)
+{
+	int offset = (U8*)pHdr - rawsock->pMem;
+	return (offset / rawsock->blockSize) * (rawsock->blockSize / rawsock->bufferSize)
+		+ (offset % rawsock->blockSize) / rawsock->bufferSize;
+}
+
+// A slot has a frame for the client once the kernel filled it. A frame the client
+// still holds also shows TP_STATUS_USER, so it must not be handed out again when
+// the ring wraps. The kernel stops at a held slot until it is released.
+static inline bool x_rxSlotReady(ring_rawsock_t *rawsock, volatile struct tpacket2_hdr *pHdr)
+{
+	int slot = x_rxSlot(rawsock, pHdr);
+	if (__atomic_load_n(&rawsock->pRxHeld[slot / 32], __ATOMIC_ACQUIRE) & (1U << (slot % 32)))
+		return FALSE;
+	return (pHdr->tp_status & TP_STATUS_USER) != 0;
+}
+
 // Get a RX frame
 U8* ringRawsockGetRxFrame(void *pvRawsock, U32 timeout, unsigned int *offset, unsigned int *len)
 {
@@ -491,7 +523,7 @@ U8* ringRawsockGetRxFrame(void *pvRawsock, U32 timeout, unsigned int *offset, un
 
 	// Check if buffer ready for user
 	// In receive mode, we want TP_STATUS_USER flag set
-	if ((pHdr->tp_status & TP_STATUS_USER) == 0)
+	if (!x_rxSlotReady(rawsock, pHdr))
 	{
 		struct timespec ts, *pts = NULL;
 		struct pollfd pfd;
@@ -524,7 +556,14 @@ U8* ringRawsockGetRxFrame(void *pvRawsock, U32 timeout, unsigned int *offset, un
 			return NULL;
 		}
 
-		if ((pHdr->tp_status & TP_STATUS_USER) == 0) {
+		if (!x_rxSlotReady(rawsock, pHdr)) {
+			if (pHdr->tp_status & TP_STATUS_USER) {
+				// The client still holds the frame in this slot. poll reports the
+				// held frames as ready, so wait for the release.
+				AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+				return NULL;
+			}
+
 			// Hmmm, this is unexpected.  poll indicated that the
 			// socket was ready to read, but the slot in the TX ring
 			// that we're looking for the kernel to fill isn't filled.
@@ -597,8 +636,11 @@ U8* ringRawsockGetRxFrame(void *pvRawsock, U32 timeout, unsigned int *offset, un
 		}
 	}
 
-	// Remember that the client has another buffer
-	rawsock->buffersOut += 1;
+	// Remember that the client has another buffer.
+	// RX frames may be released from another thread, see ringRawsockRxHoldLimit()
+	int slot = x_rxSlot(rawsock, pHdr);
+	__sync_fetch_and_or(&rawsock->pRxHeld[slot / 32], 1U << (slot % 32));
+	__sync_fetch_and_add(&rawsock->buffersOut, 1);
 
 	if (pHdr->tp_snaplen < pHdr->tp_len) {
 #if (AVB_LOG_LEVEL >= AVB_LOG_LEVEL_VERBOSE)
@@ -673,13 +715,41 @@ bool ringRawsockRelRxFrame(void *pvRawsock, U8 *pBuffer)
 	volatile struct tpacket2_hdr *pHdr = (struct tpacket2_hdr*)(pBuffer - rawsock->bufHdrSize);
 	AVB_LOGF_VERBOSE("ringRawsockRelRxFrame: pBuffer=%p, pHdr=%p", pBuffer, pHdr);
 
+	int slot = x_rxSlot(rawsock, pHdr);
+	if (!(__atomic_load_n(&rawsock->pRxHeld[slot / 32], __ATOMIC_ACQUIRE) & (1U << (slot % 32)))) {
+		AVB_LOGF_ERROR("Releasing RX frame; frame %p not held", pBuffer);
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+		return FALSE;
+	}
+
+	// Finish any reads of the frame before the kernel may reuse it. The slot
+	// is handed back to the kernel before it is marked free, so the reader
+	// never sees it free with the old frame still in it.
+	__sync_synchronize();
 	pHdr->tp_status = TP_STATUS_KERNEL;
-	rawsock->buffersOut -= 1;
+	__sync_fetch_and_and(&rawsock->pRxHeld[slot / 32], ~(1U << (slot % 32)));
+	__sync_fetch_and_sub(&rawsock->buffersOut, 1);
 
 	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
 	return TRUE;
 }
 
+// RX frames stay in the ring until released, so the client can keep any number of
+// them. The kernel drops frames while the slot it wants to fill is still held.
+int ringRawsockRxHoldLimit(void *pvRawsock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+	ring_rawsock_t *rawsock = (ring_rawsock_t*)pvRawsock;
+	int limit = 0;
+
+	if (VALID_RX_RAWSOCK(rawsock)) {
+		limit = rawsock->frameCount;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return limit;
+}
+
 unsigned long ringRawsockGetTXOutOfBuffers(void *pvRawsock)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
@@ -64,6 +64,8 @@ typedef struct {
 
 	// Number of buffers held by client
 	int buffersOut;
+	// Bit per slot of the RX ring, set while the client holds the frame in it
+	U32 *pRxHeld;
 	// Buffers marked ready, but not yet sent
 	int buffersReady;
 
@@ -109,6 +111,9 @@ int ringRawsockRxParseHdr(void *pvRawsock, U8 *pBuffer, hdr_info_t *pInfo);
 // Release a RX frame held by the client
 bool ringRawsockRelRxFrame(void *pvRawsock, U8 *pBuffer);
 
+// Number of RX frames the client may hold while getting new ones
+int ringRawsockRxHoldLimit(void *pvRawsock);
+
 unsigned long ringRawsockGetTXOutOfBuffers(void *pvRawsock);
 
 unsigned long ringRawsockGetTXOutOfBuffersCyclic(void *pvRawsock);
@@ -0,0 +1,416 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+#include "shared_rawsock.h"
+
+#include "openavb_trace.h"
+
+#define	AVB_LOG_COMPONENT	"Raw Socket"
+#include "openavb_log.h"
+
+// Ring frames of a shared socket must hold the largest frame of any stream
+#define SHARED_MIN_FRAME_SIZE (ETH_FRAME_LEN + VLAN_HLEN)
+// Wait for the kernel to free a ring frame at most this long before dropping
+#define SHARED_TX_BUSY_USEC 50
+#define SHARED_TX_BUSY_TRIES 20
+
+static pthread_mutex_t sharedMuxListLock = PTHREAD_MUTEX_INITIALIZER;
+static shared_rawsock_mux_t *sharedMuxList = NULL;
+
+static void sharedMuxLogStats(shared_rawsock_mux_t *mux)
+{
+	AVB_LOGF_INFO("Shared TX socket %s prio %u: streams=%d (max %d), frames=%lu, send calls=%lu, sends=%lu",
+		mux->ifname, mux->priority, mux->streams, mux->streamsMax,
+		mux->framesSent, mux->sendRequests, mux->sends);
+	AVB_LOGF_INFO("Shared TX socket %s prio %u: ring=%lu bytes, own rings would use %lu bytes",
+		mux->ifname, mux->priority,
+		(unsigned long)mux->frameSize * mux->frameCount, mux->ownRingBytesMax);
+}
+
+// Find or open the shared socket. Called with sharedMuxListLock held.
+static shared_rawsock_mux_t *sharedMuxAttach(const char *ifname, U8 priority, int mark, U16 ethertype, U32 frame_size, U32 shared_frames)
+{
+	shared_rawsock_mux_t *mux;
+	for (mux = sharedMuxList; mux; mux = mux->next) {
+		if (strcmp(mux->ifname, ifname) == 0 && mux->priority == priority && mux->mark == mark) {
+			if (frame_size > mux->frameSize) {
+				AVB_LOGF_ERROR("Frame size %u exceeds the %u of the shared TX socket %s prio %u",
+					frame_size, mux->frameSize, ifname, priority);
+				return NULL;
+			}
+			return mux;
+		}
+	}
+
+	mux = calloc(1, sizeof(shared_rawsock_mux_t));
+	if (!mux) {
+		AVB_LOG_ERROR("Creating shared rawsock; malloc failed");
+		return NULL;
+	}
+	strncpy(mux->ifname, ifname, sizeof(mux->ifname) - 1);
+	mux->priority = priority;
+	mux->mark = mark;
+	mux->frameSize = frame_size > SHARED_MIN_FRAME_SIZE ? frame_size : SHARED_MIN_FRAME_SIZE;
+	mux->frameCount = shared_frames;
+
+	mux->pvRawsock = openavbRawsockOpen(ifname, FALSE, TRUE, ethertype, mux->frameSize, mux->frameCount);
+	if (!mux->pvRawsock) {
+		free(mux);
+		return NULL;
+	}
+	openavbRawsockTxSetMark(mux->pvRawsock, mark);
+	pthread_mutex_init(&mux->lock, NULL);
+
+	mux->next = sharedMuxList;
+	sharedMuxList = mux;
+
+	AVB_LOGF_INFO("Opened shared TX socket %s prio %u mark %d: %u frames of %u bytes",
+		ifname, priority, mark, mux->frameCount, mux->frameSize);
+	return mux;
+}
+
+// Attach a stream to the shared TX socket for ifname/priority/mark, opening it if needed
+void* sharedRawsockOpen(shared_rawsock_t *rawsock, const char *ifname, U8 priority, int mark, U16 ethertype, U32 frame_size, U32 num_frames, U32 shared_frames)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+
+	baseRawsockOpen(&rawsock->base, ifname, FALSE, TRUE, ethertype, frame_size, num_frames);
+
+	rawsock->pStage = malloc(frame_size);
+	if (!rawsock->pStage) {
+		AVB_LOG_ERROR("Creating shared rawsock; malloc failed");
+		free(rawsock);
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&sharedMuxListLock);
+	shared_rawsock_mux_t *mux = sharedMuxAttach(ifname, priority, mark, ethertype, frame_size, shared_frames);
+	if (!mux) {
+		pthread_mutex_unlock(&sharedMuxListLock);
+		free(rawsock->pStage);
+		free(rawsock);
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return NULL;
+	}
+	rawsock->mux = mux;
+
+	pthread_mutex_lock(&mux->lock);
+	mux->streams++;
+	if (mux->streams > mux->streamsMax) {
+		mux->streamsMax = mux->streams;
+	}
+	rawsock->ownRingBytes = (unsigned long)frame_size * num_frames;
+	mux->ownRingBytes += rawsock->ownRingBytes;
+	if (mux->ownRingBytes > mux->ownRingBytesMax) {
+		mux->ownRingBytesMax = mux->ownRingBytes;
+	}
+	AVB_LOGF_INFO("Stream attached to shared TX socket %s prio %u (%d streams)", ifname, priority, mux->streams);
+	pthread_mutex_unlock(&mux->lock);
+	pthread_mutex_unlock(&sharedMuxListLock);
+
+	// the stream sends from the interface of the shared socket
+	rawsock->base.ifInfo = ((base_rawsock_t*)mux->pvRawsock)->ifInfo;
+
+	// fill virtual functions table
+	rawsock_cb_t *cb = &rawsock->base.cb;
+	cb->close = sharedRawsockClose;
+	cb->getSocket = sharedRawsockGetSocket;
+	cb->getTxFrame = sharedRawsockGetTxFrame;
+	cb->relTxFrame = sharedRawsockRelTxFrame;
+	cb->txFrameReady = sharedRawsockTxFrameReady;
+	cb->send = sharedRawsockSend;
+	cb->txSetMark = sharedRawsockTxSetMark;
+	cb->txBufLevel = sharedRawsockTxBufLevel;
+	cb->getTXOutOfBuffers = sharedRawsockGetTXOutOfBuffers;
+	cb->getTXOutOfBuffersCyclic = sharedRawsockGetTXOutOfBuffersCyclic;
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return rawsock;
+}
+
+// Detach the stream, closing the shared socket with the last one
+void sharedRawsockClose(void *pvRawsock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+	shared_rawsock_t *rawsock = (shared_rawsock_t*)pvRawsock;
+
+	if (rawsock) {
+		shared_rawsock_mux_t *mux = rawsock->mux;
+
+		pthread_mutex_lock(&sharedMuxListLock);
+		pthread_mutex_lock(&mux->lock);
+		AVB_LOGF_INFO("Stream detached from shared TX socket %s prio %u: frames=%lu, bytes=%lu, out of buffers=%lu",
+			mux->ifname, mux->priority, rawsock->txFrames, rawsock->txBytes, rawsock->txOutOfBuffer);
+		mux->streams--;
+		mux->ownRingBytes -= rawsock->ownRingBytes;
+		pthread_mutex_unlock(&mux->lock);
+
+		if (mux->streams == 0) {
+			sharedMuxLogStats(mux);
+
+			shared_rawsock_mux_t **ppMux = &sharedMuxList;
+			while (*ppMux != mux) {
+				ppMux = &(*ppMux)->next;
+			}
+			*ppMux = mux->next;
+
+			openavbRawsockClose(mux->pvRawsock);
+			pthread_mutex_destroy(&mux->lock);
+			free(mux);
+		}
+		pthread_mutex_unlock(&sharedMuxListLock);
+
+		free(rawsock->pStage);
+		rawsock->pStage = NULL;
+	}
+
+	baseRawsockClose(pvRawsock);
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+}
+
+// Get the stream's staging buffer
+U8* sharedRawsockGetTxFrame(void *pvRawsock, bool blocking, unsigned int *len)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
+	shared_rawsock_t *rawsock = (shared_rawsock_t*)pvRawsock;
+
+	if (!VALID_TX_RAWSOCK(rawsock) || len == NULL) {
+		AVB_LOG_ERROR("Getting TX frame; bad arguments");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+		return NULL;
+	}
+	if (rawsock->bStageOut) {
+		AVB_LOG_ERROR("Getting TX frame; too many TX buffers in use");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+		return NULL;
+	}
+
+	rawsock->bStageOut = TRUE;
+	*len = rawsock->base.frameSize;
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+	return rawsock->pStage;
+}
+
+// Release the staging buffer, without sending it
+bool sharedRawsockRelTxFrame(void *pvRawsock, U8 *pBuffer)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
+	shared_rawsock_t *rawsock = (shared_rawsock_t*)pvRawsock;
+
+	if (!VALID_TX_RAWSOCK(rawsock) || pBuffer != rawsock->pStage) {
+		AVB_LOG_ERROR("Releasing TX frame; invalid argument");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+		return FALSE;
+	}
+
+	rawsock->bStageOut = FALSE;
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+	return TRUE;
+}
+
+// Copy the staged frame into the shared ring and mark it ready to send
+bool sharedRawsockTxFrameReady(void *pvRawsock, U8 *pBuffer, unsigned int len, U64 timeNsec)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
+	shared_rawsock_t *rawsock = (shared_rawsock_t*)pvRawsock;
+
+	if (!VALID_TX_RAWSOCK(rawsock) || pBuffer != rawsock->pStage || len > rawsock->base.frameSize) {
+		AVB_LOG_ERROR("Marking TX frame ready; invalid argument");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+		return FALSE;
+	}
+	shared_rawsock_mux_t *mux = rawsock->mux;
+
+	// Take a ring slot only now, so slots are marked ready in the order they
+	// are handed out and the kernel never stops at a slot still being filled.
+	U8 *pSlot;
+	unsigned int slotLen;
+	int busy = 0;
+	while (1) {
+		pthread_mutex_lock(&mux->lock);
+		pSlot = openavbRawsockGetTxFrame(mux->pvRawsock, FALSE, &slotLen);
+		if (!pSlot && mux->framesPending) {
+			// The ring is full of frames nobody has sent yet, flush them
+			// rather than wait for a send that may never come.
+			openavbRawsockSend(mux->pvRawsock);
+			mux->sends++;
+			mux->framesSent += mux->framesPending;
+			mux->framesPending = 0;
+			pSlot = openavbRawsockGetTxFrame(mux->pvRawsock, FALSE, &slotLen);
+		}
+		if (pSlot) {
+			break;
+		}
+		pthread_mutex_unlock(&mux->lock);
+
+		if (++busy > SHARED_TX_BUSY_TRIES) {
+			// Drop the frame, the caller does not block
+			if (!rawsock->txOutOfBuffer) {
+				AVB_LOGF_INFO("Shared TX socket %s prio %u: TX buffer busy", mux->ifname, mux->priority);
+			}
+			++rawsock->txOutOfBuffer;
+			++rawsock->txOutOfBufferCyclic;
+			rawsock->bStageOut = FALSE;
+			AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+			return FALSE;
+		}
+		usleep(SHARED_TX_BUSY_USEC);
+	}
+
+	memcpy(pSlot, pBuffer, len);
+	bool ret = openavbRawsockTxFrameReady(mux->pvRawsock, pSlot, len, timeNsec);
+	if (ret) {
+		mux->framesPending++;
+	}
+	pthread_mutex_unlock(&mux->lock);
+
+	if (ret) {
+		rawsock->txFrames++;
+		rawsock->txBytes += len;
+	}
+	rawsock->bStageOut = FALSE;
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+	return ret;
+}
+
+// Send the frames of all streams that are ready. The first stream to send
+// in an interval flushes the frames the others have marked ready so far,
+// the others only reach the kernel if they added frames since.
+int sharedRawsockSend(void *pvRawsock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
+	shared_rawsock_t *rawsock = (shared_rawsock_t*)pvRawsock;
+
+	if (!VALID_TX_RAWSOCK(rawsock)) {
+		AVB_LOG_ERROR("Send; invalid argument");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+		return -1;
+	}
+	shared_rawsock_mux_t *mux = rawsock->mux;
+
+	int sent = 0;
+	pthread_mutex_lock(&mux->lock);
+	mux->sendRequests++;
+	if (mux->framesPending) {
+		sent = openavbRawsockSend(mux->pvRawsock);
+		mux->sends++;
+		mux->framesSent += mux->framesPending;
+		mux->framesPending = 0;
+	}
+	pthread_mutex_unlock(&mux->lock);
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+	return sent;
+}
+
+// The mark is fixed when the shared socket is opened
+bool sharedRawsockTxSetMark(void *pvRawsock, int mark)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+	shared_rawsock_t *rawsock = (shared_rawsock_t*)pvRawsock;
+
+	bool ret = VALID_TX_RAWSOCK(rawsock) && rawsock->mux->mark == mark;
+	if (!ret) {
+		AVB_LOGF_ERROR("Setting TX mark %d; shared TX socket uses %d", mark, rawsock ? rawsock->mux->mark : -1);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return ret;
+}
+
+// Count used TX buffers in the shared ring
+int sharedRawsockTxBufLevel(void *pvRawsock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
+	shared_rawsock_t *rawsock = (shared_rawsock_t*)pvRawsock;
+
+	if (!VALID_RAWSOCK(rawsock)) {
+		AVB_LOG_ERROR("getting buffer level; invalid arguments");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+		return -1;
+	}
+
+	pthread_mutex_lock(&rawsock->mux->lock);
+	int level = openavbRawsockTxBufLevel(rawsock->mux->pvRawsock);
+	pthread_mutex_unlock(&rawsock->mux->lock);
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+	return level;
+}
+
+int sharedRawsockGetSocket(void *pvRawsock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+	shared_rawsock_t *rawsock = (shared_rawsock_t*)pvRawsock;
+
+	if (!VALID_RAWSOCK(rawsock)) {
+		AVB_LOG_ERROR("Getting socket; invalid arguments");
+		AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+		return -1;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return openavbRawsockGetSocket(rawsock->mux->pvRawsock);
+}
+
+unsigned long sharedRawsockGetTXOutOfBuffers(void *pvRawsock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+	unsigned long counter = 0;
+	shared_rawsock_t *rawsock = (shared_rawsock_t*)pvRawsock;
+
+	if(VALID_TX_RAWSOCK(rawsock)) {
+		counter = rawsock->txOutOfBuffer;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return counter;
+}
+
+unsigned long sharedRawsockGetTXOutOfBuffersCyclic(void *pvRawsock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
+	unsigned long counter = 0;
+	shared_rawsock_t *rawsock = (shared_rawsock_t*)pvRawsock;
+
+	if(VALID_TX_RAWSOCK(rawsock)) {
+		counter = rawsock->txOutOfBufferCyclic;
+		rawsock->txOutOfBufferCyclic = 0;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK);
+	return counter;
+}
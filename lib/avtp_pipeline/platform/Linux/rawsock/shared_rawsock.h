@@ -0,0 +1,126 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+#ifndef SHARED_RAWSOCK_H
+#define SHARED_RAWSOCK_H
+
+#include "rawsock_impl.h"
+#include <pthread.h>
+
+// One underlying TX socket (and its ring) shared by all streams that open it
+// with the same interface, priority and mark.
+//
+typedef struct shared_rawsock_mux {
+	struct shared_rawsock_mux *next;
+
+	// what the socket is shared by
+	char ifname[IFNAMSIZ + 10];
+	U8 priority;
+	int mark;
+
+	// the underlying rawsock and the lock serializing access to it
+	void *pvRawsock;
+	pthread_mutex_t lock;
+
+	// size of the frames and number of frames in the underlying ring
+	U32 frameSize;
+	U32 frameCount;
+
+	// streams currently attached, and the most at any time
+	int streams;
+	int streamsMax;
+	// memory the attached streams would have used for rings of their own
+	unsigned long ownRingBytes;
+	unsigned long ownRingBytesMax;
+
+	// frames marked ready since the last send
+	int framesPending;
+
+	// send calls by the streams, and the sends that reached the kernel
+	unsigned long sendRequests;
+	unsigned long sends;
+	unsigned long framesSent;
+} shared_rawsock_mux_t;
+
+// State information for one stream's view of a shared socket
+//
+typedef struct {
+	base_rawsock_t base;
+
+	shared_rawsock_mux_t *mux;
+
+	// the stream builds its frame here and it is copied into the shared
+	// ring when marked ready, so a frame held by one stream never blocks
+	// the frames of the others in the ring
+	U8 *pStage;
+	bool bStageOut;
+
+	// memory a ring of the stream's own would have used
+	unsigned long ownRingBytes;
+
+	// per stream frame accounting
+	unsigned long txFrames;
+	unsigned long txBytes;
+	unsigned long txOutOfBuffer;
+	unsigned long txOutOfBufferCyclic;
+} shared_rawsock_t;
+
+// Attach a stream to the shared TX socket for ifname/priority/mark, opening it if needed
+void* sharedRawsockOpen(shared_rawsock_t *rawsock, const char *ifname, U8 priority, int mark, U16 ethertype, U32 frame_size, U32 num_frames, U32 shared_frames);
+
+// Detach the stream, closing the shared socket with the last one
+void sharedRawsockClose(void *pvRawsock);
+
+// Get the stream's staging buffer
+U8* sharedRawsockGetTxFrame(void *pvRawsock, bool blocking, unsigned int *len);
+
+// Release the staging buffer, without sending it
+bool sharedRawsockRelTxFrame(void *pvRawsock, U8 *pBuffer);
+
+// Copy the staged frame into the shared ring and mark it ready to send
+bool sharedRawsockTxFrameReady(void *pvRawsock, U8 *pBuffer, unsigned int len, U64 timeNsec);
+
+// Send the frames of all streams that are ready; skipped if there are none
+int sharedRawsockSend(void *pvRawsock);
+
+// The mark is fixed when the shared socket is opened
+bool sharedRawsockTxSetMark(void *pvRawsock, int mark);
+
+// Count used TX buffers in the shared ring
+int sharedRawsockTxBufLevel(void *pvRawsock);
+
+int sharedRawsockGetSocket(void *pvRawsock);
+
+unsigned long sharedRawsockGetTXOutOfBuffers(void *pvRawsock);
+
+unsigned long sharedRawsockGetTXOutOfBuffersCyclic(void *pvRawsock);
+
+#endif
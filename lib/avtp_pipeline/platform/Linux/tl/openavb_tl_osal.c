@@ -250,6 +250,52 @@ static int openavbTLCfgCallback(void *user, const char *tlSection, const char *n
 			&& pCfg->max_transmit_deficit_usec <= UINT32_MAX)
 			valOK = TRUE;
 	}
+	else if (MATCH(name, "tx_catchup")) {
+		if (MATCH(value, "reset")) {
+			pCfg->tx_catchup = TL_TX_CATCHUP_RESET;
+			valOK = TRUE;
+		}
+		else if (MATCH(value, "rate")) {
+			pCfg->tx_catchup = TL_TX_CATCHUP_RATE;
+			valOK = TRUE;
+		}
+		else if (MATCH(value, "drop")) {
+			pCfg->tx_catchup = TL_TX_CATCHUP_DROP;
+			valOK = TRUE;
+		}
+		else if (MATCH(value, "skip")) {
+			pCfg->tx_catchup = TL_TX_CATCHUP_SKIP;
+			valOK = TRUE;
+		}
+	}
+	else if (MATCH(name, "tx_catchup_frames")) {
+		errno = 0;
+		pCfg->tx_catchup_frames = strtol(value, &pEnd, 10);
+		if (*pEnd == '\0' && errno == 0
+			&& pCfg->tx_catchup_frames <= UINT32_MAX)
+			valOK = TRUE;
+	}
+	else if (MATCH(name, "tx_test_stall_usec")) {
+		errno = 0;
+		pCfg->tx_test_stall_usec = strtol(value, &pEnd, 10);
+		if (*pEnd == '\0' && errno == 0
+			&& pCfg->tx_test_stall_usec <= UINT32_MAX)
+			valOK = TRUE;
+	}
+	else if (MATCH(name, "tx_test_stall_seconds")) {
+		errno = 0;
+		pCfg->tx_test_stall_seconds = strtol(value, &pEnd, 10);
+		if (*pEnd == '\0' && errno == 0
+			&& pCfg->tx_test_stall_seconds <= UINT32_MAX)
+			valOK = TRUE;
+	}
+	else if (MATCH(name, "rx_test_drop_interval")) {
+		errno = 0;
+		pCfg->rx_test_drop_interval = strtol(value, &pEnd, 10);
+		if (*pEnd == '\0' && errno == 0
+			&& pCfg->rx_test_drop_interval <= UINT32_MAX)
+			valOK = TRUE;
+	}
 	else if (MATCH(name, "internal_latency")) {
 		errno = 0;
 		pCfg->internal_latency = strtol(value, &pEnd, 10);
@@ -280,6 +326,13 @@ static int openavbTLCfgCallback(void *user, const char *tlSection, const char *n
 			&& pCfg->raw_tx_buffers <= UINT32_MAX)
 			valOK = TRUE;
 	}
+	else if (MATCH(name, "tx_shared_frames")) {
+		errno = 0;
+		pCfg->tx_shared_frames = strtol(value, &pEnd, 10);
+		if (*pEnd == '\0' && errno == 0
+			&& pCfg->tx_shared_frames <= UINT32_MAX)
+			valOK = TRUE;
+	}
 	else if (MATCH(name, "raw_rx_buffers")) {
 		errno = 0;
 		pCfg->raw_rx_buffers = strtol(value, &pEnd, 10);
@@ -287,6 +340,59 @@ static int openavbTLCfgCallback(void *user, const char *tlSection, const char *n
 			&& pCfg->raw_rx_buffers <= UINT32_MAX)
 			valOK = TRUE;
 	}
+	else if (MATCH(name, "tx_zero_copy")) {
+		errno = 0;
+		long tmp;
+		tmp = strtol(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0) {
+			pCfg->tx_zero_copy = (tmp == 1);
+			valOK = TRUE;
+		}
+	}
+	else if (MATCH(name, "rx_zero_copy")) {
+		errno = 0;
+		long tmp;
+		tmp = strtol(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0) {
+			pCfg->rx_zero_copy = (tmp == 1);
+			valOK = TRUE;
+		}
+	}
+	else if (MATCH(name, "rx_pipeline")) {
+		errno = 0;
+		long tmp;
+		tmp = strtol(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0) {
+			pCfg->rx_pipeline = (tmp == 1);
+			valOK = TRUE;
+		}
+	}
+	else if (MATCH(name, "rx_pipeline_frames")) {
+		errno = 0;
+		pCfg->rx_pipeline_frames = strtol(value, &pEnd, 10);
+		if (*pEnd == '\0' && errno == 0
+			&& pCfg->rx_pipeline_frames > 0
+			&& pCfg->rx_pipeline_frames <= INT32_MAX)
+			valOK = TRUE;
+	}
+	else if (MATCH(name, "rx_pipeline_net_affinity")) {
+		errno = 0;
+		unsigned long tmp;
+		tmp = strtoul(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0) {
+			pCfg->rx_pipeline_net_affinity = tmp;
+			valOK = TRUE;
+		}
+	}
+	else if (MATCH(name, "rx_pipeline_delivery_affinity")) {
+		errno = 0;
+		unsigned long tmp;
+		tmp = strtoul(value, &pEnd, 0);
+		if (*pEnd == '\0' && errno == 0) {
+			pCfg->rx_pipeline_delivery_affinity = tmp;
+			valOK = TRUE;
+		}
+	}
 	else if (MATCH(name, "report_seconds")) {
 		errno = 0;
 		pCfg->report_seconds = strtol(value, &pEnd, 10);
@@ -350,6 +456,13 @@ static int openavbTLCfgCallback(void *user, const char *tlSection, const char *n
 			valOK = TRUE;
 		}
 	}
+	else if (MATCH(name, "spin_wait_guard_usec")) {
+		errno = 0;
+		pCfg->spin_wait_guard_usec = strtol(value, &pEnd, 10);
+		if (*pEnd == '\0' && errno == 0
+			&& pCfg->spin_wait_guard_usec <= UINT32_MAX)
+			valOK = TRUE;
+	}
 	else if (MATCH(name, "tx_blocking_in_intf")) {
 		errno = 0;
 		long tmp;
@@ -77,6 +77,22 @@ void *openavbRawsockOpen(const char *ifname,	// network interface name to bind t
 					 U32 frame_size,		// maximum size of frame to send/receive
 					 U32 num_frames);		// number of frames in the circular buffer
 
+// Open a TX raw socket that shares one underlying socket and circular buffer
+// with all other streams of the process opened with the same interface,
+// priority (SR class) and mark. Each stream keeps its own Ethernet header and
+// frame accounting. Frames are copied into the shared buffer when marked ready
+// and a send flushes the ready frames of all streams together.
+//
+// Returns rawsock handle which must be passed back to other rawsock library functions.
+//
+void *openavbRawsockOpenShared(const char *ifname,	// network interface name to bind to
+					 U8 priority,			// SR class priority the socket is shared by
+					 int mark,				// SO_MARK of the shared socket
+					 U16 ethertype,			// Ethernet type (protocol)
+					 U32 frame_size,		// maximum size of frame to send
+					 U32 num_frames,		// frames the stream would have used on its own
+					 U32 shared_frames);	// frames in the shared buffer, if this opens it
+
 // Set signal on RX mode
 void openavbSetRxSignalMode(void *rawsock, bool rxSignalMode);
 
@@ -111,6 +127,12 @@ int openavbRawsockRxParseHdr(void* rawsock, U8 *pBuffer, hdr_info_t *pInfo);
 // Release the received frame for re-use.
 bool openavbRawsockRelRxFrame(void *rawsock, U8 *pFrame);
 
+// Number of received frames the client may keep without releasing them
+// while it gets new ones. Frames may then be released in any order and from
+// any thread. Returns 0 if each frame must be released before the next
+// call to openavbRawsockGetRxFrame().
+int openavbRawsockRxHoldLimit(void *rawsock);
+
 // Add (or drop) membership in link-layer multicast group
 bool openavbRawsockRxMulticast(void *rawsock, bool add_membership, const U8 buf[ETH_ALEN]);
 
@@ -39,6 +39,7 @@ void baseRawsockSetRxSignalMode(void *rawsock, bool rxSignalMode) {}
 int baseRawsockGetSocket(void *rawsock) { AVB_LOG_ERROR("baseRawsockGetSocket called"); return -1; }
 U8 *baseRawsockGetRxFrame(void *rawsock, U32 usecTimeout, U32 *offset, U32 *len) { AVB_LOG_ERROR("baseRawsockGetRxFrame called"); return NULL; }
 bool baseRawsockRelRxFrame(void *rawsock, U8 *pFrame) { return false; }
+int baseRawsockRxHoldLimit(void *rawsock) { return 0; }
 bool baseRawsockRxMulticast(void *rawsock, bool add_membership, const U8 buf[]) { return false; }
 bool baseRawsockRxAVTPSubtype(void *rawsock, U8 subtype) { return false; }
 bool baseRawsockTxSetMark(void *rawsock, int prio) { return false; }
@@ -69,6 +70,7 @@ void* baseRawsockOpen(base_rawsock_t* rawsock, const char *ifname, bool rx_mode,
 	cb->getRxFrame = baseRawsockGetRxFrame;
 	cb->rxParseHdr = baseRawsockRxParseHdr;
 	cb->relRxFrame = baseRawsockRelRxFrame;
+	cb->rxHoldLimit = baseRawsockRxHoldLimit;
 	cb->rxMulticast = baseRawsockRxMulticast;
 	cb->rxAVTPSubtype = baseRawsockRxAVTPSubtype;
 	cb->txSetHdr = baseRawsockTxSetHdr;
@@ -352,6 +354,16 @@ bool openavbRawsockRelRxFrame(void *pvRawsock, U8 *pBuffer)
 	return ret;
 }
 
+int openavbRawsockRxHoldLimit(void *pvRawsock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK_DETAIL);
+
+	int ret = ((base_rawsock_t*)pvRawsock)->cb.rxHoldLimit(pvRawsock);
+
+	AVB_TRACE_EXIT(AVB_TRACE_RAWSOCK_DETAIL);
+	return ret;
+}
+
 bool openavbRawsockRxMulticast(void *pvRawsock, bool add_membership, const U8 addr[ETH_ALEN])
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_RAWSOCK);
@@ -69,6 +69,7 @@ typedef struct {
 	U8* (*getRxFrame)(void* rawsock, U32 usecTimeout, U32* offset, U32* len);
 	int (*rxParseHdr)(void* rawsock, U8* pBuffer, hdr_info_t* pInfo);
 	bool (*relRxFrame)(void* rawsock, U8* pFrame);
+	int (*rxHoldLimit)(void* rawsock);
 	bool (*rxMulticast)(void* rawsock, bool add_membership, const U8 buf[ETH_ALEN]);
 	bool (*rxAVTPSubtype)(void* rawsock, U8 subtype);
 	bool (*txSetHdr)(void* rawsock, hdr_info_t* pInfo);
@@ -72,6 +72,7 @@ bool listenerStartStream(tl_state_t *pTLState)
 		pListenerData->ifname,
 		&pListenerData->streamID,
 		pListenerData->destAddr,
+		pCfg->max_transit_usec,
 		pCfg->raw_rx_buffers,
 		pCfg->rx_signal_mode,
 		&pListenerData->avtpHandle);
@@ -81,6 +82,27 @@ bool listenerStartStream(tl_state_t *pTLState)
 		return FALSE;
 	}
 
+	if (pTLState->pAvdeccRxCounters) {
+		// Publish the RX counters where the AVDECC process can read them.
+		openavbAvtpRxSetCounters(pListenerData->avtpHandle, pTLState->pAvdeccRxCounters);
+	}
+
+	if (pCfg->rx_test_drop_interval) {
+		AVB_LOGF_WARNING("Test aid: dropping one in every %u received frames", pCfg->rx_test_drop_interval);
+		openavbAvtpRxSetTestDrop(pListenerData->avtpHandle, pCfg->rx_test_drop_interval);
+	}
+
+	if (pCfg->rx_pipeline) {
+		if (pCfg->rx_zero_copy) {
+			AVB_LOG_WARNING("rx_zero_copy is ignored when rx_pipeline is set");
+		}
+		openavbAvtpRxPipelineOn(pListenerData->avtpHandle, pCfg->rx_pipeline_frames,
+			pCfg->rx_pipeline_net_affinity, pCfg->rx_pipeline_delivery_affinity, pCfg->thread_rt_priority);
+	}
+	else if (pCfg->rx_zero_copy) {
+		openavbAvtpRxZeroCopyOn(pListenerData->avtpHandle);
+	}
+
 	// Setup timers
 	U64 nowNS;
 	CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
@@ -91,6 +113,7 @@ bool listenerStartStream(tl_state_t *pTLState)
 	// Clear counters
 	pListenerData->nReportCalls = 0;
 	pListenerData->nReportFrames = 0;
+	openavbAvtpRxCounters(pListenerData->avtpHandle, &pListenerData->lastRxCounters);
 
 	// Clear stats
 	openavbListenerClearStats(pTLState);
@@ -131,6 +154,13 @@ void listenerStopStream(tl_state_t *pTLState)
 		openavbListenerGetStat(pTLState, TL_STAT_RX_LOST),
 		openavbListenerGetStat(pTLState, TL_STAT_RX_BYTES));
 
+	avtp_rx_counters_t rxCounters;
+	openavbAvtpRxCounters(pListenerData->avtpHandle, &rxCounters);
+	AVB_LOGF_INFO("RX "STREAMID_FORMAT", Counters: seq_mismatch=%u, media_reset=%u, ts_valid=%u, ts_not_valid=%u, ts_uncertain=%u, unsupported_format=%u, stream_id_mismatch=%u, late=%u, early=%u",
+		STREAMID_ARGS(&pListenerData->streamID),
+		rxCounters.seqMismatch, rxCounters.mediaReset, rxCounters.tsValid, rxCounters.tsNotValid, rxCounters.tsUncertain,
+		rxCounters.unsupportedFormat, rxCounters.streamIdMismatch, rxCounters.lateTimestamp, rxCounters.earlyTimestamp);
+
 	if (pTLState->bStreaming) {
 		openavbAvtpShutdownListener(pListenerData->avtpHandle);
 		pTLState->bStreaming = FALSE;
@@ -154,10 +184,40 @@ static inline void listenerShowStats(listener_data_t *pListenerData, tl_state_t
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "bytes=%lld, ", LOG_RT_DATATYPE_U64, &bytes);
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "rxbuf=%d, ", LOG_RT_DATATYPE_U32, &rxbuf);
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "mqbuf=%d, ", LOG_RT_DATATYPE_U32, &mqbuf);
-	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "mqrdy=%d", LOG_RT_DATATYPE_U32, &mqrdy);
+	if (pTLState->cfg.rx_pipeline) {
+		avtp_rx_pipeline_stats_t pipeStats;
+		openavbAvtpRxPipelineStats(pListenerData->avtpHandle, &pipeStats);
+		AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "mqrdy=%d, ", LOG_RT_DATATYPE_U32, &mqrdy);
+		AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "rxq=%d, ", LOG_RT_DATATYPE_U32, &pipeStats.queueLevel);
+		AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "rxqmax=%d, ", LOG_RT_DATATYPE_U32, &pipeStats.queueLevelMax);
+		AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "rxqdrop=%lld", LOG_RT_DATATYPE_U64, &pipeStats.framesDropped);
+	}
+	else {
+		AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "mqrdy=%d", LOG_RT_DATATYPE_U32, &mqrdy);
+	}
 
 	openavbListenerAddStat(pTLState, TL_STAT_RX_LOST, lost);
 	openavbListenerAddStat(pTLState, TL_STAT_RX_BYTES, bytes);
+
+	// Header problems are only counted while receiving; report what changed since the last report.
+	avtp_rx_counters_t rxCounters, *pLast = &pListenerData->lastRxCounters;
+	openavbAvtpRxCounters(pListenerData->avtpHandle, &rxCounters);
+	if (rxCounters.seqMismatch != pLast->seqMismatch
+		|| rxCounters.mediaReset != pLast->mediaReset
+		|| rxCounters.unsupportedFormat != pLast->unsupportedFormat
+		|| rxCounters.streamIdMismatch != pLast->streamIdMismatch
+		|| rxCounters.lateTimestamp != pLast->lateTimestamp
+		|| rxCounters.earlyTimestamp != pLast->earlyTimestamp) {
+		AVB_LOGF_WARNING("RX UID:%d, seq_mismatch=%u, media_reset=%u, unsupported_format=%u, stream_id_mismatch=%u, late=%u, early=%u",
+			pListenerData->streamID.uniqueID,
+			rxCounters.seqMismatch - pLast->seqMismatch,
+			rxCounters.mediaReset - pLast->mediaReset,
+			rxCounters.unsupportedFormat - pLast->unsupportedFormat,
+			rxCounters.streamIdMismatch - pLast->streamIdMismatch,
+			rxCounters.lateTimestamp - pLast->lateTimestamp,
+			rxCounters.earlyTimestamp - pLast->earlyTimestamp);
+	}
+	*pLast = rxCounters;
 }
 
 static inline bool listenerDoStream(tl_state_t *pTLState)
@@ -382,6 +442,10 @@ void openavbListenerAddStat(tl_state_t *pTLState, tl_stat_t stat, U64 val)
 		case TL_STAT_TX_FRAMES:
 		case TL_STAT_TX_LATE:
 		case TL_STAT_TX_BYTES:
+		case TL_STAT_TX_CATCHUP:
+		case TL_STAT_TX_RECOVERED:
+		case TL_STAT_TX_SKIPPED:
+		case TL_STAT_TX_PURGED:
 			break;
 		case TL_STAT_RX_CALLS:
 			pListenerData->stats.totalCalls += val;
@@ -425,6 +489,10 @@ U64 openavbListenerGetStat(tl_state_t *pTLState, tl_stat_t stat)
 		case TL_STAT_TX_FRAMES:
 		case TL_STAT_TX_LATE:
 		case TL_STAT_TX_BYTES:
+		case TL_STAT_TX_CATCHUP:
+		case TL_STAT_TX_RECOVERED:
+		case TL_STAT_TX_SKIPPED:
+		case TL_STAT_TX_PURGED:
 			break;
 		case TL_STAT_RX_CALLS:
 			val = pListenerData->stats.totalCalls;
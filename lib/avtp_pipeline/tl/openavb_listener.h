@@ -37,6 +37,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define OPENAVB_TL_LISTENER_H 1
 
 #include "openavb_tl.h"
+#include "openavb_avtp.h"
 
 typedef struct {
 	U64 totalCalls;
@@ -61,6 +62,7 @@ typedef struct {
 	U64				nextSecondNS;
 	unsigned long	lastReportFrames;
 	listener_stats_t stats;
+	avtp_rx_counters_t lastRxCounters;
 } listener_data_t;
 
 void openavbTLRunListener(tl_state_t *pTLState);
@@ -95,6 +95,7 @@ bool talkerStartStream(tl_state_t *pTLState)
 		pTalkerData->vlanID,
 		pTalkerData->vlanPCP,
 		pTalkerData->wakeFrames * pCfg->raw_tx_buffers,
+		pCfg->tx_shared_frames,
 		&pTalkerData->avtpHandle);
 	if (IS_OPENAVB_FAILURE(rc)) {
 		AVB_LOG_ERROR("Failed to create AVTP stream");
@@ -104,6 +105,15 @@ bool talkerStartStream(tl_state_t *pTLState)
 
 	avtp_stream_t *pStream = (avtp_stream_t *)(pTalkerData->avtpHandle);
 
+	if (pCfg->tx_zero_copy) {
+		if (pCfg->tx_blocking_in_intf) {
+			AVB_LOG_WARNING("tx_zero_copy is ignored when tx_blocking_in_intf is set");
+		}
+		else {
+			openavbAvtpTxZeroCopyOn(pTalkerData->avtpHandle);
+		}
+	}
+
 	pTalkerData->wakeRate = transmitInterval / pCfg->batch_factor;
 
 	pTalkerData->sleepUsec = MICROSECONDS_PER_SECOND / pTalkerData->wakeRate;
@@ -123,6 +133,37 @@ bool talkerStartStream(tl_state_t *pTLState)
 	// counts of intervals and frames between reports
 	pTalkerData->cntFrames = 0;
 	pTalkerData->cntWakes = 0;
+	pTalkerData->wakeLateSumNS = 0;
+	pTalkerData->wakeLateMaxNS = 0;
+	memset(pTalkerData->wakeLateHist, 0, sizeof(pTalkerData->wakeLateHist));
+	memset(&pTalkerData->spinWait, 0, sizeof(pTalkerData->spinWait));
+
+	// transmit deficit recovery
+	pTalkerData->bCatchingUp = FALSE;
+	pTalkerData->catchupFrames = 0;
+	pTalkerData->catchupRate = 0;
+	pTalkerData->maxDeficitFrames = ((U64)pCfg->max_transmit_deficit_usec * 1000 / pTalkerData->intervalNS) * pTalkerData->wakeFrames;
+	pTalkerData->mqSteadyItems = 0;
+	pTalkerData->cntCatchup = 0;
+	pTalkerData->cntRecovered = 0;
+	pTalkerData->cntSkipped = 0;
+	pTalkerData->cntPurged = 0;
+
+	if (pCfg->tx_catchup == TL_TX_CATCHUP_RATE) {
+		// Frames per wake covered by the reservation of max_interval_frames per class interval
+		U32 reservedFrames = ((U64)pTalkerData->classRate * pCfg->max_interval_frames) / pTalkerData->wakeRate;
+		U32 headroom = reservedFrames > pTalkerData->wakeFrames ? reservedFrames - pTalkerData->wakeFrames : 0;
+
+		pTalkerData->catchupRate = pCfg->tx_catchup_frames ? pCfg->tx_catchup_frames : headroom;
+		if (pTalkerData->catchupRate == 0) {
+			AVB_LOG_WARNING("tx_catchup=rate: no headroom in the stream reservation, catching up 1 extra frame per interval");
+			pTalkerData->catchupRate = 1;
+		}
+		if (pTalkerData->catchupRate > headroom) {
+			AVB_LOGF_WARNING("tx_catchup=rate: catching up exceeds the stream reservation by %" PRIu32 " frames per interval",
+				pTalkerData->catchupRate - headroom);
+		}
+	}
 
 	// setup the initial times
 	U64 nowNS;
@@ -140,6 +181,7 @@ bool talkerStartStream(tl_state_t *pTLState)
 	pTalkerData->lastReportFrames = 0;
 	pTalkerData->nextSecondNS = nowNS + NANOSECONDS_PER_SECOND;
 	pTalkerData->nextCycleNS = nowNS + pTalkerData->intervalNS;
+	pTalkerData->nextStallNS = nowNS + ((U64)pCfg->tx_test_stall_seconds * NANOSECONDS_PER_SECOND);
 
 	// Clear stats
 	openavbTalkerClearStats(pTLState);
@@ -177,6 +219,10 @@ void talkerStopStream(tl_state_t *pTLState)
 	openavbTalkerAddStat(pTLState, TL_STAT_TX_FRAMES, pTalkerData->cntFrames);
 //	openavbTalkerAddStat(pTLState, TL_STAT_TX_LATE, 0);		// Can't calculate at this time
 	openavbTalkerAddStat(pTLState, TL_STAT_TX_BYTES, openavbAvtpBytes(pTalkerData->avtpHandle));
+	openavbTalkerAddStat(pTLState, TL_STAT_TX_CATCHUP, pTalkerData->cntCatchup);
+	openavbTalkerAddStat(pTLState, TL_STAT_TX_RECOVERED, pTalkerData->cntRecovered);
+	openavbTalkerAddStat(pTLState, TL_STAT_TX_SKIPPED, pTalkerData->cntSkipped);
+	openavbTalkerAddStat(pTLState, TL_STAT_TX_PURGED, pTalkerData->cntPurged);
 
 	AVB_LOGF_INFO("TX "STREAMID_FORMAT", Totals: calls=%" PRIu64 ", frames=%" PRIu64 ", late=%" PRIu64 ", bytes=%" PRIu64 ", TXOutOfBuffs=%ld",
 		STREAMID_ARGS(&pTalkerData->streamID),
@@ -186,6 +232,12 @@ void talkerStopStream(tl_state_t *pTLState)
 		openavbTalkerGetStat(pTLState, TL_STAT_TX_BYTES),
 		rawsock ? openavbRawsockGetTXOutOfBuffers(rawsock) : 0
 		);
+	AVB_LOGF_INFO("TX "STREAMID_FORMAT", Catch-up totals: events=%" PRIu64 ", recovered=%" PRIu64 ", skipped=%" PRIu64 ", purged=%" PRIu64,
+		STREAMID_ARGS(&pTalkerData->streamID),
+		openavbTalkerGetStat(pTLState, TL_STAT_TX_CATCHUP),
+		openavbTalkerGetStat(pTLState, TL_STAT_TX_RECOVERED),
+		openavbTalkerGetStat(pTLState, TL_STAT_TX_SKIPPED),
+		openavbTalkerGetStat(pTLState, TL_STAT_TX_PURGED));
 
 	if (pTLState->bStreaming) {
 		openavbAvtpShutdownTalker(pTalkerData->avtpHandle);
@@ -195,6 +247,29 @@ void talkerStopStream(tl_state_t *pTLState)
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 }
 
+// Upper bound in usec of the wake up error of the given share (in per mille) of the wakes since the last report.
+static U32 talkerWakeLatePercentileUsec(talker_data_t *pTalkerData, U32 perMille)
+{
+	U32 total = 0, count = 0;
+	int i1;
+
+	for (i1 = 0; i1 < TALKER_WAKE_HIST_BUCKETS; i1++) {
+		total += pTalkerData->wakeLateHist[i1];
+	}
+	if (total == 0) {
+		return 0;
+	}
+	U32 target = ((U64)total * perMille + 999) / 1000;
+	for (i1 = 0; i1 < TALKER_WAKE_HIST_BUCKETS - 1; i1++) {
+		count += pTalkerData->wakeLateHist[i1];
+		if (count >= target) {
+			return 1 << i1;
+		}
+	}
+	// Beyond the histogram
+	return pTalkerData->wakeLateMaxNS / 1000;
+}
+
 static inline void talkerShowStats(talker_data_t *pTalkerData, tl_state_t *pTLState)
 {
 	S32 late = pTalkerData->wakesPerReport - pTalkerData->cntWakes;
@@ -202,6 +277,10 @@ static inline void talkerShowStats(talker_data_t *pTalkerData, tl_state_t *pTLSt
 	if (late < 0) late = 0;
 	U32 txbuf = openavbAvtpTxBufferLevel(pTalkerData->avtpHandle);
 	U32 mqbuf = openavbMediaQCountItems(pTLState->pMediaQ, TRUE);
+	U32 wakeAvgUsec = pTalkerData->cntWakes ? (pTalkerData->wakeLateSumNS / pTalkerData->cntWakes) / 1000 : 0;
+	U32 wakeMaxUsec = pTalkerData->wakeLateMaxNS / 1000;
+	U32 wakeP50Usec = talkerWakeLatePercentileUsec(pTalkerData, 500);
+	U32 wakeP99Usec = talkerWakeLatePercentileUsec(pTalkerData, 990);
 
 	AVB_LOGRT_INFO(LOG_RT_BEGIN, LOG_RT_ITEM, FALSE, "TX UID:%d, ", LOG_RT_DATATYPE_U16, &pTalkerData->streamID.uniqueID);
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "calls=%ld, ", LOG_RT_DATATYPE_U32, &pTalkerData->cntWakes);
@@ -209,12 +288,96 @@ static inline void talkerShowStats(talker_data_t *pTalkerData, tl_state_t *pTLSt
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "late=%d, ", LOG_RT_DATATYPE_U32, &late);
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "bytes=%lld, ", LOG_RT_DATATYPE_U64, &bytes);
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "txbuf=%d, ", LOG_RT_DATATYPE_U32, &txbuf);
-	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "mqbuf=%d, ", LOG_RT_DATATYPE_U32, &mqbuf);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "mqbuf=%d, ", LOG_RT_DATATYPE_U32, &mqbuf);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "wake-avg=%dus, ", LOG_RT_DATATYPE_U32, &wakeAvgUsec);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "wake-p50<%dus, ", LOG_RT_DATATYPE_U32, &wakeP50Usec);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "wake-p99<%dus, ", LOG_RT_DATATYPE_U32, &wakeP99Usec);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "wake-max=%dus, ", LOG_RT_DATATYPE_U32, &wakeMaxUsec);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "catchup=%ld, ", LOG_RT_DATATYPE_U32, &pTalkerData->cntCatchup);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "recovered=%ld, ", LOG_RT_DATATYPE_U32, &pTalkerData->cntRecovered);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "skipped=%ld, ", LOG_RT_DATATYPE_U32, &pTalkerData->cntSkipped);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "purged=%ld", LOG_RT_DATATYPE_U32, &pTalkerData->cntPurged);
 
 	openavbTalkerAddStat(pTLState, TL_STAT_TX_LATE, late);
 	openavbTalkerAddStat(pTLState, TL_STAT_TX_BYTES, bytes);
 }
 
+// Drop the oldest media queue items until the queue is back to the depth it
+// had while the talker was keeping up.
+static void talkerPurgeBacklog(talker_data_t *pTalkerData, tl_state_t *pTLState)
+{
+	U32 items = openavbMediaQCountItems(pTLState->pMediaQ, TRUE);
+
+	while (items-- > pTalkerData->mqSteadyItems) {
+		if (!openavbMediaQTailLock(pTLState->pMediaQ, TRUE))
+			break;
+		openavbMediaQTailPull(pTLState->pMediaQ);
+		pTalkerData->cntPurged++;
+	}
+}
+
+// Called once per interval after nextCycleNS has moved to the next interval.
+// Decides what to do when the talker is behind its transmit schedule.
+static inline void talkerCatchUp(talker_data_t *pTalkerData, tl_state_t *pTLState, U64 nowNS)
+{
+	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
+	U64 intervals;
+
+	if (pCfg->tx_catchup == TL_TX_CATCHUP_RESET) {
+		if ((pTalkerData->nextCycleNS + ((U64)pCfg->max_transmit_deficit_usec * 1000)) < nowNS) {
+			// Hit max deficit time. Something must be wrong. Reset the cycle timer.
+			if (!pTalkerData->bCatchingUp)
+				pTalkerData->cntCatchup++;
+			pTalkerData->bCatchingUp = FALSE;
+			pTalkerData->cntSkipped += ((nowNS - pTalkerData->nextCycleNS) / pTalkerData->intervalNS) * pTalkerData->wakeFrames;
+
+			// Align clock : allows for some performance gain
+			nowNS = ((nowNS + (pTalkerData->intervalNS)) / pTalkerData->intervalNS) * pTalkerData->intervalNS;
+			pTalkerData->nextCycleNS = nowNS + pTalkerData->intervalNS;
+		}
+		else if (pTalkerData->nextCycleNS + pTalkerData->intervalNS <= nowNS) {
+			// The next wakes follow back to back until the deficit is made up
+			if (!pTalkerData->bCatchingUp)
+				pTalkerData->cntCatchup++;
+			pTalkerData->bCatchingUp = TRUE;
+		}
+		else {
+			pTalkerData->bCatchingUp = FALSE;
+		}
+		return;
+	}
+
+	if (nowNS < pTalkerData->nextCycleNS + pTalkerData->intervalNS) {
+		// Keeping up, or late by less than an interval
+		if (pCfg->tx_catchup == TL_TX_CATCHUP_DROP)
+			pTalkerData->mqSteadyItems = openavbMediaQCountItems(pTLState->pMediaQ, TRUE);
+		return;
+	}
+
+	// Move past the missed intervals while staying on the original cycle grid
+	intervals = (nowNS - pTalkerData->nextCycleNS) / pTalkerData->intervalNS;
+	pTalkerData->nextCycleNS += intervals * pTalkerData->intervalNS;
+	pTalkerData->cntCatchup++;
+
+	switch (pCfg->tx_catchup) {
+		case TL_TX_CATCHUP_RATE:
+			pTalkerData->catchupFrames += intervals * pTalkerData->wakeFrames;
+			if (pTalkerData->catchupFrames > pTalkerData->maxDeficitFrames) {
+				pTalkerData->cntSkipped += pTalkerData->catchupFrames - pTalkerData->maxDeficitFrames;
+				pTalkerData->catchupFrames = pTalkerData->maxDeficitFrames;
+			}
+			break;
+		case TL_TX_CATCHUP_DROP:
+			pTalkerData->cntSkipped += intervals * pTalkerData->wakeFrames;
+			talkerPurgeBacklog(pTalkerData, pTLState);
+			break;
+		case TL_TX_CATCHUP_SKIP:
+		default:
+			pTalkerData->cntSkipped += intervals * pTalkerData->wakeFrames;
+			break;
+	}
+}
+
 static inline bool talkerDoStream(tl_state_t *pTLState)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
@@ -233,26 +396,64 @@ static inline bool talkerDoStream(tl_state_t *pTLState)
 		U64 nowNS;
 
 		if (!pCfg->tx_blocking_in_intf) {
+			U64 wakeNS = pTalkerData->nextCycleNS;
 
 			if (!pCfg->spin_wait) {
 				// sleep until the next interval
 				SLEEP_UNTIL_NSEC(pTalkerData->nextCycleNS);
+				CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &wakeNS);
 			} else {
 #if !IGB_LAUNCHTIME_ENABLED && !ATL_LAUNCHTIME_ENABLED
-				SPIN_UNTIL_NSEC(pTalkerData->nextCycleNS);
+				// sleep until close to the next interval then spin the rest
+				wakeNS = SPIN_UNTIL_NSEC(&pTalkerData->spinWait, pTalkerData->nextCycleNS, (U64)pCfg->spin_wait_guard_usec * 1000);
 #endif
 			}
 
+			// track how far past the interval start the thread actually woke
+			U32 lateUsec = 0;
+			if (wakeNS > pTalkerData->nextCycleNS) {
+				U64 lateNS = wakeNS - pTalkerData->nextCycleNS;
+				pTalkerData->wakeLateSumNS += lateNS;
+				if (lateNS > pTalkerData->wakeLateMaxNS)
+					pTalkerData->wakeLateMaxNS = lateNS;
+				lateUsec = lateNS < (U64)UINT32_MAX * 1000 ? lateNS / 1000 : UINT32_MAX;
+			}
+			int bucket = lateUsec ? 32 - __builtin_clz(lateUsec) : 0;
+			pTalkerData->wakeLateHist[bucket < TALKER_WAKE_HIST_BUCKETS ? bucket : TALKER_WAKE_HIST_BUCKETS - 1]++;
+
+			if (pCfg->tx_test_stall_usec && pCfg->tx_test_stall_seconds && wakeNS >= pTalkerData->nextStallNS) {
+				// Test aid: behave as if the thread had been held off
+				pTalkerData->nextStallNS = wakeNS + ((U64)pCfg->tx_test_stall_seconds * NANOSECONDS_PER_SECOND);
+				SLEEP_NSEC((U64)pCfg->tx_test_stall_usec * 1000);
+			}
+
 			//AVB_DBG_INTERVAL(8000, TRUE);
 
-			// send the frames for this interval
+			// send the frames for this interval, plus some of the deficit with tx_catchup=rate
+			U32 extraFrames = pTalkerData->catchupFrames < pTalkerData->catchupRate ? pTalkerData->catchupFrames : pTalkerData->catchupRate;
+			U32 sentFrames = 0;
 			int i;
-			for (i = pTalkerData->wakeFrames; i > 0; i--) {
+			for (i = pTalkerData->wakeFrames + extraFrames; i > 0; i--) {
 				if (IS_OPENAVB_SUCCESS(openavbAvtpTx(pTalkerData->avtpHandle, i == 1, pCfg->tx_blocking_in_intf)))
-					pTalkerData->cntFrames++;
+					sentFrames++;
 				else
 					break;
 			}
+			pTalkerData->cntFrames += sentFrames;
+
+			if (extraFrames) {
+				if (sentFrames > pTalkerData->wakeFrames) {
+					pTalkerData->cntRecovered += sentFrames - pTalkerData->wakeFrames;
+					pTalkerData->catchupFrames -= sentFrames - pTalkerData->wakeFrames;
+				}
+				if (sentFrames < pTalkerData->wakeFrames + extraFrames) {
+					// Ran out of media, there is nothing left to make up
+					pTalkerData->catchupFrames = 0;
+				}
+			}
+			else if (pTalkerData->bCatchingUp) {
+				pTalkerData->cntRecovered += sentFrames;
+			}
 		}
 		else {
 			// Interface module block option
@@ -280,9 +481,20 @@ static inline bool talkerDoStream(tl_state_t *pTLState)
 			  
 				openavbTalkerAddStat(pTLState, TL_STAT_TX_CALLS, pTalkerData->cntWakes);
 				openavbTalkerAddStat(pTLState, TL_STAT_TX_FRAMES, pTalkerData->cntFrames);
+				openavbTalkerAddStat(pTLState, TL_STAT_TX_CATCHUP, pTalkerData->cntCatchup);
+				openavbTalkerAddStat(pTLState, TL_STAT_TX_RECOVERED, pTalkerData->cntRecovered);
+				openavbTalkerAddStat(pTLState, TL_STAT_TX_SKIPPED, pTalkerData->cntSkipped);
+				openavbTalkerAddStat(pTLState, TL_STAT_TX_PURGED, pTalkerData->cntPurged);
 
 				pTalkerData->cntFrames = 0;
 				pTalkerData->cntWakes = 0;
+				pTalkerData->wakeLateSumNS = 0;
+				pTalkerData->wakeLateMaxNS = 0;
+				memset(pTalkerData->wakeLateHist, 0, sizeof(pTalkerData->wakeLateHist));
+				pTalkerData->cntCatchup = 0;
+				pTalkerData->cntRecovered = 0;
+				pTalkerData->cntSkipped = 0;
+				pTalkerData->cntPurged = 0;
 				pTalkerData->nextReportNS = nowNS + (pCfg->report_seconds * NANOSECONDS_PER_SECOND);
 			}
 		} else if (pCfg->report_frames > 0 && pTalkerData->cntFrames != pTalkerData->lastReportFrames) {
@@ -300,12 +512,7 @@ static inline bool talkerDoStream(tl_state_t *pTLState)
 		if (!pCfg->tx_blocking_in_intf) {
 			pTalkerData->nextCycleNS += pTalkerData->intervalNS;
 
-			if ((pTalkerData->nextCycleNS + (pCfg->max_transmit_deficit_usec * 1000)) < nowNS) {
-				// Hit max deficit time. Something must be wrong. Reset the cycle timer.	
-				// Align clock : allows for some performance gain
-				nowNS = ((nowNS + (pTalkerData->intervalNS)) / pTalkerData->intervalNS) * pTalkerData->intervalNS;
-				pTalkerData->nextCycleNS = nowNS + pTalkerData->intervalNS;
-			}				
+			talkerCatchUp(pTalkerData, pTLState, nowNS);
 		}
 	}
 	else {
@@ -487,6 +694,18 @@ void openavbTalkerAddStat(tl_state_t *pTLState, tl_stat_t stat, U64 val)
 		case TL_STAT_TX_BYTES:
 			pTalkerData->stats.totalBytes += val;
 			break;
+		case TL_STAT_TX_CATCHUP:
+			pTalkerData->stats.totalCatchup += val;
+			break;
+		case TL_STAT_TX_RECOVERED:
+			pTalkerData->stats.totalRecovered += val;
+			break;
+		case TL_STAT_TX_SKIPPED:
+			pTalkerData->stats.totalSkipped += val;
+			break;
+		case TL_STAT_TX_PURGED:
+			pTalkerData->stats.totalPurged += val;
+			break;
 		case TL_STAT_RX_CALLS:
 		case TL_STAT_RX_FRAMES:
 		case TL_STAT_RX_LOST:
@@ -530,6 +749,18 @@ U64 openavbTalkerGetStat(tl_state_t *pTLState, tl_stat_t stat)
 		case TL_STAT_TX_BYTES:
 			val = pTalkerData->stats.totalBytes;
 			break;
+		case TL_STAT_TX_CATCHUP:
+			val = pTalkerData->stats.totalCatchup;
+			break;
+		case TL_STAT_TX_RECOVERED:
+			val = pTalkerData->stats.totalRecovered;
+			break;
+		case TL_STAT_TX_SKIPPED:
+			val = pTalkerData->stats.totalSkipped;
+			break;
+		case TL_STAT_TX_PURGED:
+			val = pTalkerData->stats.totalPurged;
+			break;
 		case TL_STAT_RX_CALLS:
 		case TL_STAT_RX_FRAMES:
 		case TL_STAT_RX_LOST:
@@ -38,6 +38,9 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #include "openavb_tl.h"
 
+// Wake up error histogram. Bucket n counts wakes less than 2^n usec late, the last one the rest.
+#define TALKER_WAKE_HIST_BUCKETS	12
+
 typedef struct {
 	// Data from callback
 	char			ifname[IFNAMSIZ + 10]; // Include space for the socket type prefix (e.g. "simple:eth0")
@@ -63,6 +66,23 @@ typedef struct {
 	U64 			nextReportNS;
 	U64				nextSecondNS;
 	unsigned long	lastReportFrames;
+	spin_wait_t		spinWait;
+	U64				wakeLateSumNS;
+	U64				wakeLateMaxNS;
+	U32				wakeLateHist[TALKER_WAKE_HIST_BUCKETS];
+
+	// Transmit deficit recovery, see tx_catchup
+	bool			bCatchingUp;
+	U64				catchupFrames;
+	U32				catchupRate;
+	U64				maxDeficitFrames;
+	U32				mqSteadyItems;
+	U64				nextStallNS;
+	unsigned long	cntCatchup;
+	unsigned long	cntRecovered;
+	unsigned long	cntSkipped;
+	unsigned long	cntPurged;
+
 	talker_stats_t	stats;
 } talker_data_t;
 
@@ -223,7 +223,7 @@ static bool checkMapCallbacks(openavb_tl_cfg_t *pCfg)
 		AVB_LOG_WARNING("INI doesn't specify mapping callback for '_rx_init'.");
 		// validCfg = FALSE;
 	}
-	if ((pCfg->role == AVB_ROLE_LISTENER) && !pCfg->map_cb.map_rx_cb) {
+	if ((pCfg->role == AVB_ROLE_LISTENER) && !pCfg->map_cb.map_rx_cb && !pCfg->map_cb.map_rx_hdr_cb) {
 		AVB_LOG_ERROR("INI doesn't specify mapping callback for '_rx'.");
 		validCfg = FALSE;
 	}
@@ -377,6 +377,11 @@ EXTERN_DLL_EXPORT void openavbTLInitCfg(openavb_tl_cfg_t *pCfg)
 	pCfg->max_frame_size = 1500;
 	pCfg->max_transit_usec = 50000;
 	pCfg->max_transmit_deficit_usec = 50000;
+	pCfg->tx_catchup = TL_TX_CATCHUP_RESET;
+	pCfg->tx_catchup_frames = 0;
+	pCfg->tx_test_stall_usec = 0;
+	pCfg->tx_test_stall_seconds = 0;
+	pCfg->rx_test_drop_interval = 0;
 	pCfg->internal_latency = 0;
 	pCfg->max_stale = MICROSECONDS_PER_SECOND;
 	pCfg->batch_factor = 1;
@@ -386,7 +391,14 @@ EXTERN_DLL_EXPORT void openavbTLInitCfg(openavb_tl_cfg_t *pCfg)
 	pCfg->sr_class = SR_CLASS_B;
 	pCfg->sr_rank = SR_RANK_REGULAR;
 	pCfg->raw_tx_buffers = 8;
+	pCfg->tx_shared_frames = 0;
 	pCfg->raw_rx_buffers = 100;
+	pCfg->tx_zero_copy = FALSE;
+	pCfg->rx_zero_copy = FALSE;
+	pCfg->rx_pipeline = FALSE;
+	pCfg->rx_pipeline_frames = 256;
+	pCfg->rx_pipeline_net_affinity = 0xFFFFFFFF;
+	pCfg->rx_pipeline_delivery_affinity = 0xFFFFFFFF;
 	pCfg->tx_blocking_in_intf =  0;
 	pCfg->rx_signal_mode = 1;
 	pCfg->pMapInitFn = NULL;
@@ -394,6 +406,7 @@ EXTERN_DLL_EXPORT void openavbTLInitCfg(openavb_tl_cfg_t *pCfg)
 	pCfg->vlan_id = 0;
 	pCfg->fixed_timestamp = 0;
 	pCfg->spin_wait = FALSE;
+	pCfg->spin_wait_guard_usec = 50;
 	pCfg->thread_rt_priority = 0;
 	pCfg->thread_affinity = 0xFFFFFFFF;
 
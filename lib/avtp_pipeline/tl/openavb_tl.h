@@ -40,6 +40,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_osal.h"
 #include "openavb_mediaq_pub.h"
 #include "openavb_tl_pub.h"
+#include "openavb_avtp_counters.h"
 
 typedef enum OPENAVB_TL_AVB_VER_STATE 
 {
@@ -53,6 +54,10 @@ typedef struct {
 	U64 totalFrames;
 	U64 totalLate;
 	U64 totalBytes;
+	U64 totalCatchup;
+	U64 totalRecovered;
+	U64 totalSkipped;
+	U64 totalPurged;
 } talker_stats_t;
 
 THREAD_TYPE(TLThread);
@@ -101,6 +106,9 @@ typedef struct {
 	// Handle to the AVDECC Msg support.  (Value set by avdeccMsgThread)
 	int avdeccMsgHandle;
 
+	// Listener RX counters shared with the AVDECC process.  (Value set by avdeccMsgThread)
+	avtp_rx_counters_t *pAvdeccRxCounters;
+
 	// Per stream Stats Mutex
 	MUTEX_HANDLE(statsMutex);
 
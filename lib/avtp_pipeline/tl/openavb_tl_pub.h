@@ -67,6 +67,14 @@ typedef enum {
 	TL_STAT_RX_LOST,
 	/// Number of bytes received
 	TL_STAT_RX_BYTES,
+	/// Number of times the talker fell behind its transmit schedule
+	TL_STAT_TX_CATCHUP,
+	/// Number of frames sent to make up a transmit deficit
+	TL_STAT_TX_RECOVERED,
+	/// Number of frames given up instead of recovered
+	TL_STAT_TX_SKIPPED,
+	/// Number of media queue items purged to drop a backlog
+	TL_STAT_TX_PURGED,
 } tl_stat_t;
 
 /// Maximum number of configuration parameters inside INI file a host can have
@@ -91,6 +99,18 @@ typedef enum {
 	TL_INIT_STATE_RUNNING,
 } tl_init_state_t;
 
+/// How a talker recovers after it falls behind its transmit schedule
+typedef enum {
+	/// Send the missed frames back to back and reset the cycle timer once the deficit exceeds max_transmit_deficit_usec
+	TL_TX_CATCHUP_RESET,
+	/// Send the missed frames a few extra frames per interval, up to max_transmit_deficit_usec worth of frames
+	TL_TX_CATCHUP_RATE,
+	/// Give up the missed intervals and purge the media queue items that built up
+	TL_TX_CATCHUP_DROP,
+	/// Give up the missed intervals but keep the queued media with its timestamps
+	TL_TX_CATCHUP_SKIP,
+} tl_tx_catchup_t;
+
 /// Structure containing configuration of the host
 typedef struct {
 	/// Role of the host
@@ -117,6 +137,16 @@ typedef struct {
 	/// Maximum transmit deficit in usec - should be set to expected buffer size
 	/// on the listener side (talker only)
 	U32 max_transmit_deficit_usec;
+	/// How the talker recovers a transmit deficit (talker only)
+	tl_tx_catchup_t tx_catchup;
+	/// Extra frames per interval sent by #TL_TX_CATCHUP_RATE, 0 to use the headroom of the stream reservation (talker only)
+	U32 tx_catchup_frames;
+	/// Test aid: stall the talker for this many usec every tx_test_stall_seconds (talker only)
+	U32 tx_test_stall_usec;
+	/// Test aid: seconds between the stalls injected with tx_test_stall_usec (talker only)
+	U32 tx_test_stall_seconds;
+	/// Test aid: drop every Nth received frame to exercise loss handling, 0 to disable (listener only)
+	U32 rx_test_drop_interval;
 	/// Specify manual an internal latency (talker only)
 	U32 internal_latency;
 	/// Number of microseconds after which late MediaQItem will be purged as too
@@ -136,8 +166,22 @@ typedef struct {
 	U8 sr_rank;
 	/// Number of raw TX buffers that should be used (talker only)
 	U32 raw_tx_buffers;
+	/// Share one raw TX socket and ring of this many frames with the other talkers of the same interface and SR class, 0 for a socket of its own (talker only)
+	U32 tx_shared_frames;
+	/// Let the interface module build media queue items in the raw TX frame (talker only)
+	bool tx_zero_copy;
 	/// Number of raw RX buffers (listener only)
 	U32 raw_rx_buffers;
+	/// Keep received frames in the raw socket ring while media queue items reference them (listener only)
+	bool rx_zero_copy;
+	/// Receive, reassemble and deliver to the interface module on separate threads (listener only)
+	bool rx_pipeline;
+	/// Number of received frames queued between the RX pipeline network thread and reassembly (listener only)
+	U32 rx_pipeline_frames;
+	/// Bit mask used for CPU pinning of the RX pipeline network thread (listener only)
+	U32 rx_pipeline_net_affinity;
+	/// Bit mask used for CPU pinning of the RX pipeline delivery thread (listener only)
+	U32 rx_pipeline_delivery_affinity;
 	/// Is the interface module blocking in the TX CB.
 	bool tx_blocking_in_intf;
 	/// Network interface name. Not used on all platforms.
@@ -150,6 +194,8 @@ typedef struct {
 	U32 fixed_timestamp;
 	/// Wait for next observation interval by spinning rather than sleeping
 	bool spin_wait;
+	/// Time in usec before the next interval at which spin_wait stops sleeping and starts spinning
+	U32 spin_wait_guard_usec;
 	/// Bit mask used for CPU pinning
 	U32 thread_affinity;
 	/// Real time priority of thread.
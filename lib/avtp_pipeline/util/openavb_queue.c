@@ -40,7 +40,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 OPENAVB_CODE_MODULE_PRI
 
 struct openavb_queue_elem {
-	bool setFlg;
+	volatile bool setFlg;
 	void *data;
 };
 
@@ -152,6 +152,8 @@ openavb_queue_elem_t openavbQueueHeadLock(openavb_queue_t queue)
 {
 	if (queue) {
 		if (!queue->elemArray[queue->head].setFlg) {
+			// Don't let writes to the element move ahead of the flag check
+			__sync_synchronize();
 			return &queue->elemArray[queue->head];
 		}
 	}
@@ -165,6 +167,8 @@ void openavbQueueHeadUnlock(openavb_queue_t queue)
 void openavbQueueHeadPush(openavb_queue_t queue)
 {
 	if (queue) {
+		// Element data must be visible before the tail side sees the flag
+		__sync_synchronize();
 		queue->elemArray[queue->head++].setFlg = TRUE;		
 		if (queue->head >= queue->queueSize) {
 			queue->head = 0;
@@ -176,6 +180,8 @@ openavb_queue_elem_t openavbQueueTailLock(openavb_queue_t queue)
 {
 	if (queue) {
 		if (queue->elemArray[queue->tail].setFlg) {
+			// Don't let reads of the element move ahead of the flag check
+			__sync_synchronize();
 			return &queue->elemArray[queue->tail];
 		}
 	}
@@ -189,6 +195,8 @@ void openavbQueueTailUnlock(openavb_queue_t queue)
 void openavbQueueTailPull(openavb_queue_t queue)
 {
 	if (queue) {
+		// Finish with the element before the head side may refill it
+		__sync_synchronize();
 		queue->elemArray[queue->tail++].setFlg = FALSE;
 		if (queue->tail >= queue->queueSize) {
 			queue->tail = 0;
@@ -36,6 +36,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 * - Only head and tail access possible.
 * - Head and Tail locking.
 * - If there is a single task accessing head and a single task accessing tail no synchronization is needed.
+*   Lock, push and pull include the memory barriers for this.
 * - If synchronization is needed the Pull and Push functions should be protected before calling.
 */
 
@@ -45,6 +45,14 @@ OPENAVB_CODE_MODULE_PRI
 #define OPENAVB_TIMESTAMP_PRINT_BUFFER_SIZE 		2048
 #define OPENAVB_TIMESTAMP_DUMP_PRINTBUF_INTERVAL 	30
 
+// Jitter sketch. Values below the linear limit get a bucket each, larger
+// values get OPENAVB_TIMESTAMP_SKETCH_SUB buckets per power of two, which
+// bounds the percentile error to 25%.
+#define OPENAVB_TIMESTAMP_SKETCH_LINEAR				8
+#define OPENAVB_TIMESTAMP_SKETCH_SUB_BITS			2
+#define OPENAVB_TIMESTAMP_SKETCH_SUB				(1 << OPENAVB_TIMESTAMP_SKETCH_SUB_BITS)
+#define OPENAVB_TIMESTAMP_SKETCH_BUCKETS			(OPENAVB_TIMESTAMP_SKETCH_LINEAR + (32 - 3) * OPENAVB_TIMESTAMP_SKETCH_SUB)
+
 // CORE_TODO: This should be enhanced to account for dropped packet detection and perhaps PTP time adjusts
 
 struct openavb_timestamp_eval {
@@ -61,26 +69,92 @@ struct openavb_timestamp_eval {
 	// Data
 	U32 tsCnt;
 	U32 tsPrev;
-	U32 tsInterval;
+	U32 tsSkip;
 	U32 tsJitter;
-	U64 tsAccumJitter;
-	U32 tsDrift;
-	U64 tsTtlReal;
-	U64 tsTtlCalc;
+	U32 tsMinJitter;
 	U32 tsMaxJitter;
-	U32 tsMaxDrift;
+	U64 tsAccumJitter;
+	// Real minus calculated elapsed time
+	S64 tsDrift;
+	U64 tsMaxDrift;
+	U32 tsReportCnt;
+	U32 sketch[OPENAVB_TIMESTAMP_SKETCH_BUCKETS];
+
+	// Smoothing
+	U32 tsSmoothed;
+	S64 tsSmoothedDrift;
+
 	openavb_printbuf_t printbuf;
 };
 
+static inline U32 x_sketchBucket(U32 jitter)
+{
+	U32 msb;
+
+	if (jitter < OPENAVB_TIMESTAMP_SKETCH_LINEAR) {
+		return jitter;
+	}
+
+#if defined(__GNUC__)
+	msb = 31 - __builtin_clz(jitter);
+#else
+	{
+		U32 val = jitter;
+		msb = 0;
+		if (val >> 16) { val >>= 16; msb += 16; }
+		if (val >> 8) { val >>= 8; msb += 8; }
+		if (val >> 4) { val >>= 4; msb += 4; }
+		if (val >> 2) { val >>= 2; msb += 2; }
+		if (val >> 1) { msb += 1; }
+	}
+#endif
+
+	return OPENAVB_TIMESTAMP_SKETCH_LINEAR + (msb - 3) * OPENAVB_TIMESTAMP_SKETCH_SUB
+		+ ((jitter >> (msb - OPENAVB_TIMESTAMP_SKETCH_SUB_BITS)) & (OPENAVB_TIMESTAMP_SKETCH_SUB - 1));
+}
+
+// Largest jitter value that falls into the bucket
+static U32 x_sketchBucketMax(U32 bucket)
+{
+	U32 msb, sub;
+
+	if (bucket < OPENAVB_TIMESTAMP_SKETCH_LINEAR) {
+		return bucket;
+	}
+
+	msb = (bucket - OPENAVB_TIMESTAMP_SKETCH_LINEAR) / OPENAVB_TIMESTAMP_SKETCH_SUB + 3;
+	sub = (bucket - OPENAVB_TIMESTAMP_SKETCH_LINEAR) % OPENAVB_TIMESTAMP_SKETCH_SUB;
+	return (U32)((((U64)(OPENAVB_TIMESTAMP_SKETCH_SUB + sub + 1)) << (msb - OPENAVB_TIMESTAMP_SKETCH_SUB_BITS)) - 1);
+}
+
+static void x_resetStats(openavb_timestamp_eval_t tsEval)
+{
+	tsEval->tsCnt = 0;
+	tsEval->tsJitter = 0;
+	tsEval->tsMinJitter = (U32)-1;
+	tsEval->tsMaxJitter = 0;
+	tsEval->tsAccumJitter = 0;
+	tsEval->tsDrift = 0;
+	tsEval->tsMaxDrift = 0;
+	tsEval->tsReportCnt = 0;
+	memset(tsEval->sketch, 0, sizeof(tsEval->sketch));
+}
 
 openavb_timestamp_eval_t openavbTimestampEvalNew(void)
 {
-	return calloc(1, sizeof(struct openavb_timestamp_eval));
+	openavb_timestamp_eval_t tsEval = calloc(1, sizeof(struct openavb_timestamp_eval));
+	if (tsEval) {
+		x_resetStats(tsEval);
+	}
+	return tsEval;
 }
 
 void openavbTimestampEvalDelete(openavb_timestamp_eval_t tsEval)
 {
     if (tsEval) {
+		if (tsEval->printbuf) {
+			openavbPrintbufDelete(tsEval->printbuf);
+		}
 		free(tsEval);
 		tsEval = NULL;
     }
@@ -91,7 +165,9 @@ void openavbTimestampEvalInitialize(openavb_timestamp_eval_t tsEval, U32 tsRateI
     if (tsEval) {
 		tsEval->started = FALSE;
 		tsEval->tsRateInterval = tsRateInterval;
-		tsEval->printbuf = openavbPrintbufNew(OPENAVB_TIMESTAMP_PRINT_BUFFER_SIZE, OPENAVB_TIMESTAMP_DUMP_PRINTBUF_INTERVAL);
+		if (!tsEval->printbuf) {
+			tsEval->printbuf = openavbPrintbufNew(OPENAVB_TIMESTAMP_PRINT_BUFFER_SIZE, OPENAVB_TIMESTAMP_DUMP_PRINTBUF_INTERVAL);
+		}
     }
 }
 
@@ -99,6 +175,7 @@ void openavbTimestampEvalSetReport(openavb_timestamp_eval_t tsEval, U32 reportIn
 {
     if (tsEval) {
 		tsEval->reportInterval = reportInterval;
+		tsEval->tsReportCnt = 0;
     }
 }
 
@@ -111,62 +188,209 @@ void openavbTimestampEvalSetSmoothing(openavb_timestamp_eval_t tsEval, U32 tsMax
     }
 }
 
-U32 openavbTimestampEvalTimestamp(openavb_timestamp_eval_t tsEval, U32 ts)
+// Replace the timestamp with the one expected from the rate as long as it
+// stays within the smoothing limits, otherwise follow the real timestamp.
+static inline U32 x_smooth(openavb_timestamp_eval_t tsEval, U32 ts, U32 expect)
 {
-	U32 tsRet = ts;
+	U32 tsOut = tsEval->tsSmoothed + expect;
+	S32 diff = (S32)(ts - tsOut);
+	U32 jitter = diff < 0 ? -(U32)diff : (U32)diff;
+	S64 drift = tsEval->tsSmoothedDrift + diff;
 
-    if (tsEval) {
-		// Determine the Jitter
-		if (tsEval->tsPrev > ts) {
-			tsEval->tsInterval = (((U32)-1) - tsEval->tsPrev) + ts;
-		}
-		else {
-			tsEval->tsInterval = ts - tsEval->tsPrev;
-		}
+	if (jitter > tsEval->tsSmoothingMaxJitter
+		|| (U64)(drift < 0 ? -drift : drift) > tsEval->tsSmoothingMaxDrift) {
+		tsOut = ts;
+		drift = 0;
+	}
+	tsEval->tsSmoothed = tsOut;
+	tsEval->tsSmoothedDrift = drift;
+	return tsOut;
+}
 
-		// Save real ts for not interval
-		tsEval->tsPrev = ts;
+U32 openavbTimestampEvalTimestamps(openavb_timestamp_eval_t tsEval, U32 *ts, U32 cnt)
+{
+	U32 i = 0, smoothed = 0;
+	U32 tsPrev, expect, jitter = 0, minJitter, maxJitter;
+	U32 first, rate;
+	U32 *sketch;
+	bool smoothing;
+	U64 accumJitter, maxDrift;
+	S64 drift;
 
-		// Increment the main timestamp counter
+	if (!tsEval || !ts || !cnt) {
+		return 0;
+	}
+
+	if (!tsEval->started) {
+		// First timestamp starts the intervals
+		tsEval->started = TRUE;
+		tsEval->tsPrev = ts[0];
+		tsEval->tsSmoothed = ts[0];
+		tsEval->tsSmoothedDrift = 0;
+		tsEval->tsSkip = 0;
 		tsEval->tsCnt++;
+		i = 1;
+	}
+	if (i == cnt) {
+		return 0;
+	}
+	first = i;
+
+	// Work on locals, the loop only touches the timestamps and the sketch
+	tsPrev = tsEval->tsPrev;
+	minJitter = tsEval->tsMinJitter;
+	maxJitter = tsEval->tsMaxJitter;
+	accumJitter = tsEval->tsAccumJitter;
+	drift = tsEval->tsDrift;
+	maxDrift = tsEval->tsMaxDrift;
+	sketch = tsEval->sketch;
+	smoothing = tsEval->smoothing;
+	rate = tsEval->tsRateInterval;
+	expect = rate * (tsEval->tsSkip + 1);
+	tsEval->tsSkip = 0;
+
+	for (; i < cnt; i++) {
+		U32 tsReal = ts[i];
+		// Unsigned arithmetic handles the 32 bit wrap
+		S32 diff = (S32)((tsReal - tsPrev) - expect);
+		U64 absDrift;
 
-		// Accumulate totals
-		if (!tsEval->started) {
-			// First timestamp interval
-			tsEval->tsTtlCalc = 0;
-			tsEval->tsTtlReal = 0;
-			tsEval->started = TRUE;
+		jitter = diff < 0 ? -(U32)diff : (U32)diff;
+
+		tsPrev = tsReal;
+		drift += diff;
+		absDrift = drift < 0 ? -(U64)drift : (U64)drift;
+
+		accumJitter += jitter;
+		if (jitter < minJitter)
+			minJitter = jitter;
+		if (jitter > maxJitter)
+			maxJitter = jitter;
+		if (absDrift > maxDrift)
+			maxDrift = absDrift;
+		sketch[x_sketchBucket(jitter)]++;
+
+		if (smoothing) {
+			ts[i] = x_smooth(tsEval, tsReal, expect);
+			if (ts[i] != tsReal)
+				smoothed++;
 		}
-		else {
-			// All but first timestamp
-			tsEval->tsTtlCalc += tsEval->tsRateInterval;
-			tsEval->tsTtlReal += tsEval->tsInterval;
-
-			tsEval->tsJitter = abs(tsEval->tsRateInterval - tsEval->tsInterval);
-			if (tsEval->tsJitter > tsEval->tsMaxJitter) {
-				tsEval->tsMaxJitter = tsEval->tsJitter;
-			}
-			tsEval->tsAccumJitter += tsEval->tsJitter;
-
-			tsEval->tsDrift = abs(tsEval->tsTtlCalc - tsEval->tsTtlReal);
-
-			// Reporting
-			if (tsEval->reportInterval) {
-				if ((tsEval->tsCnt % tsEval->reportInterval) == 0) {
-					//printf("Jitter:%9u   AvgJitter:%9u   MaxJitter:%9u   Drift:%9u\n", tsEval->tsJitter, (U32)(tsEval->tsAccumJitter / tsEval->tsCnt), tsEval->tsMaxJitter, tsEval->tsDrift); 
-					openavbPrintbufPrintf(tsEval->printbuf, "Jitter:%9u   AvgJitter:%9u   MaxJitter:%9u   Drift:%9u\n", tsEval->tsJitter, (U32)(tsEval->tsAccumJitter / tsEval->tsCnt), tsEval->tsMaxJitter, tsEval->tsDrift);
-				}
-			}
+		expect = rate;
+	}
+
+	tsEval->tsPrev = tsPrev;
+	tsEval->tsJitter = jitter;
+	tsEval->tsMinJitter = minJitter;
+	tsEval->tsMaxJitter = maxJitter;
+	tsEval->tsAccumJitter = accumJitter;
+	tsEval->tsDrift = drift;
+	tsEval->tsMaxDrift = maxDrift;
+	tsEval->tsCnt += cnt - first;
+
+	// Reporting
+	if (tsEval->reportInterval) {
+		tsEval->tsReportCnt += cnt;
+		if (tsEval->tsReportCnt >= tsEval->reportInterval) {
+			tsEval->tsReportCnt %= tsEval->reportInterval;
+			openavbTimestampEvalReport(tsEval);
 		}
-    }
+	}
 
-	return tsRet;
+	return smoothed;
 }
 
+U32 openavbTimestampEvalTimestamp(openavb_timestamp_eval_t tsEval, U32 ts)
+{
+	openavbTimestampEvalTimestamps(tsEval, &ts, 1);
+	return ts;
+}
 
 void openavbTimestampEvalTimestampSkip(openavb_timestamp_eval_t tsEval, U32 cnt)
 {
     if (tsEval) {
+		// The next interval spans the skipped ones
+		tsEval->tsSkip += cnt;
     }
 }
 
+U32 openavbTimestampEvalJitterPercentile(openavb_timestamp_eval_t tsEval, U32 perMille)
+{
+	U64 target, seen = 0;
+	U32 intervals, bucket;
+
+	if (!tsEval || tsEval->tsCnt < 2) {
+		return 0;
+	}
+	intervals = tsEval->tsCnt - 1;
+	if (perMille > 1000) {
+		perMille = 1000;
+	}
+
+	// Rank of the requested interval, at least the first one
+	target = ((U64)intervals * perMille + 999) / 1000;
+	if (!target) {
+		target = 1;
+	}
+
+	for (bucket = 0; bucket < OPENAVB_TIMESTAMP_SKETCH_BUCKETS; bucket++) {
+		seen += tsEval->sketch[bucket];
+		if (seen >= target) {
+			// Never report more than the exact maximum
+			U32 val = x_sketchBucketMax(bucket);
+			return val < tsEval->tsMaxJitter ? val : tsEval->tsMaxJitter;
+		}
+	}
+	return tsEval->tsMaxJitter;
+}
+
+bool openavbTimestampEvalGetStats(openavb_timestamp_eval_t tsEval, openavb_timestamp_eval_stats_t *pStats)
+{
+	U32 intervals;
+
+	if (!tsEval || !pStats) {
+		return FALSE;
+	}
+
+	memset(pStats, 0, sizeof(*pStats));
+	pStats->tsCnt = tsEval->tsCnt;
+	if (tsEval->tsCnt < 2) {
+		// No interval yet
+		return TRUE;
+	}
+
+	intervals = tsEval->tsCnt - 1;
+	pStats->jitter = tsEval->tsJitter;
+	pStats->minJitter = tsEval->tsMinJitter;
+	pStats->maxJitter = tsEval->tsMaxJitter;
+	pStats->meanJitter = (U32)(tsEval->tsAccumJitter / intervals);
+	pStats->p50Jitter = openavbTimestampEvalJitterPercentile(tsEval, 500);
+	pStats->p99Jitter = openavbTimestampEvalJitterPercentile(tsEval, 990);
+	pStats->p999Jitter = openavbTimestampEvalJitterPercentile(tsEval, 999);
+	pStats->drift = tsEval->tsDrift;
+	pStats->maxDrift = tsEval->tsMaxDrift;
+	return TRUE;
+}
+
+void openavbTimestampEvalReport(openavb_timestamp_eval_t tsEval)
+{
+	openavb_timestamp_eval_stats_t stats;
+
+	if (!tsEval || !tsEval->printbuf || !openavbTimestampEvalGetStats(tsEval, &stats)) {
+		return;
+	}
+
+	openavbPrintbufPrintf(tsEval->printbuf, "Jitter:%9u   AvgJitter:%9u   MaxJitter:%9u   Drift:%9llu   MinJitter:%9u   P50:%9u   P99:%9u   P99.9:%9u   MaxDrift:%9llu\n",
+		stats.jitter, stats.meanJitter, stats.maxJitter,
+		(unsigned long long)(stats.drift < 0 ? -stats.drift : stats.drift),
+		stats.minJitter, stats.p50Jitter, stats.p99Jitter, stats.p999Jitter,
+		(unsigned long long)stats.maxDrift);
+}
+
+void openavbTimestampEvalResetStats(openavb_timestamp_eval_t tsEval)
+{
+	if (tsEval) {
+		x_resetStats(tsEval);
+		// The next timestamp restarts the intervals
+		tsEval->started = FALSE;
+	}
+}
@@ -41,6 +41,22 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 typedef struct openavb_timestamp_eval * openavb_timestamp_eval_t;
 
+// Timestamp statistics. Jitter is the distance of an interval from the
+// expected interval and drift the real minus the expected elapsed time,
+// all in nanoseconds.
+typedef struct {
+	U32 tsCnt;			// Timestamps evaluated
+	U32 jitter;			// Jitter of the last interval
+	U32 minJitter;
+	U32 maxJitter;
+	U32 meanJitter;
+	U32 p50Jitter;		// Percentiles from a sketch, within 25% of the exact value
+	U32 p99Jitter;
+	U32 p999Jitter;
+	S64 drift;
+	U64 maxDrift;		// Largest absolute drift
+} openavb_timestamp_eval_stats_t;
+
 // Create and initialize the timestamp evaluator.
 // tsInterval is the expected timestamp interval in nanoseconds.
 openavb_timestamp_eval_t openavbTimestampEvalNew(void);
@@ -60,9 +76,25 @@ void openavbTimestampEvalSetSmoothing(openavb_timestamp_eval_t tsEval, U32 tsMax
 // Record timestamp and optionally smooth it.
 U32 openavbTimestampEvalTimestamp(openavb_timestamp_eval_t tsEval, U32 ts);
 
+// Record cnt consecutive timestamps. When smoothing, the smoothed values are written back to ts.
+// Returns the number of timestamps changed by smoothing.
+U32 openavbTimestampEvalTimestamps(openavb_timestamp_eval_t tsEval, U32 *ts, U32 cnt);
+
 // Skip cnt number of timestamp intervals
 void openavbTimestampEvalTimestampSkip(openavb_timestamp_eval_t tsEval, U32 cnt);
 
+// Get the jitter value at or below which perMille of the intervals fall.
+U32 openavbTimestampEvalJitterPercentile(openavb_timestamp_eval_t tsEval, U32 perMille);
+
+// Get the statistics gathered so far. Nothing is formatted.
+bool openavbTimestampEvalGetStats(openavb_timestamp_eval_t tsEval, openavb_timestamp_eval_stats_t *pStats);
+
+// Format the statistics into the report buffer. Called on the report interval, if one is set.
+void openavbTimestampEvalReport(openavb_timestamp_eval_t tsEval);
+
+// Clear the statistics, the next timestamp starts a new evaluation.
+void openavbTimestampEvalResetStats(openavb_timestamp_eval_t tsEval);
+
 
 
 
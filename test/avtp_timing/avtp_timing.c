@@ -0,0 +1,994 @@
+/*
+ * AVTP stream timing analyzer
+ *
+ * Reads AVTP streams from a libpcap capture file, or live from an
+ * AF_PACKET socket, and reports for every stream ID:
+ *
+ *  - packet, timestamp valid and timestamp uncertain counts
+ *  - sequence gaps, lost and duplicate or reordered packets
+ *  - the presentation time interval per packet, from a least squares fit
+ *    of the AVTP timestamps against the sequence numbers, and the RMS
+ *    deviation of the timestamps from that line
+ *  - a histogram of the interval between timestamps, relative to the
+ *    stream's reference interval
+ *  - drift in ppm, from a least squares fit of the AVTP timestamps
+ *    against the capture time, so relative to the capture clock
+ *
+ * Everything is computed in one pass with a fixed amount of state per
+ * stream, so captures of any length can be analyzed, and a live capture
+ * reads from a TPACKET_V3 ring to keep up with a loaded link.
+ *
+ * -g writes a synthetic capture with known drift, jitter and loss, and -T
+ * analyzes one and checks the results, which is what the test target runs.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+#define ETHERTYPE_AVTP		0x22f0
+#define ETHERTYPE_VLAN		0x8100
+#define AVTP_HDR_LEN		24
+
+#define MAX_STREAMS		1024	/* power of 2, the hash table size */
+#define WARMUP_INTERVALS	16
+#define HIST_BINS		64
+
+#define PCAP_MAGIC_USEC		0xa1b2c3d4
+#define PCAP_MAGIC_NSEC		0xa1b23c4d
+#define PCAP_LINKTYPE_ETHERNET	1
+
+#define RING_BLOCK_SIZE		(1 << 22)
+#define RING_BLOCK_NR		64
+#define RING_FRAME_SIZE		2048
+#define RING_BLOCK_TOV_MS	10
+
+/**
+ * Running least squares fit of y against x (Welford's update). The fit is
+ * of y - ref * x, with ref close to the expected slope, so the residuals
+ * are not lost in rounding next to the size of y.
+ */
+struct fit {
+	double ref;
+	uint64_t n;
+	double mean_x;
+	double mean_y;
+	double m2x;
+	double m2y;
+	double cxy;
+};
+
+struct stream {
+	int used;
+	uint64_t id;
+	uint8_t dst[6];
+	uint8_t subtype;
+
+	uint64_t packets;
+	uint64_t bytes;
+	uint64_t tv_packets;
+	uint64_t tu_packets;
+
+	/* sequence numbers, unwrapped into seq_index */
+	int have_seq;
+	uint8_t last_seq;
+	uint64_t seq_index;
+	uint64_t seq_gaps;
+	uint64_t seq_lost;
+	uint64_t seq_dups;
+
+	/* presentation times, unwrapped into ts (ns since the first) */
+	int have_ts;
+	uint32_t last_ts;
+	int64_t ts;
+	uint64_t last_ts_index;
+	uint64_t first_cap_ns;
+	uint64_t last_cap_ns;
+
+	/* per packet interval between timestamps */
+	double interval_min;
+	double interval_max;
+	int warmup;
+	double warmup_interval[WARMUP_INTERVALS];
+	double ref_interval;
+	uint64_t hist[HIST_BINS];
+	uint64_t hist_under;
+	uint64_t hist_over;
+
+	struct fit by_index;
+	struct fit by_time;
+};
+
+struct analyzer {
+	struct stream streams[MAX_STREAMS];
+	int nstreams;
+	uint64_t frames;
+	uint64_t avtp_frames;
+	uint64_t dropped_streams;
+	double bin_ns;
+	int verbose;
+	FILE *csv;
+};
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+	(void)sig;
+	stop = 1;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Line fitting
+ */
+
+static void fit_add(struct fit *f, double x, double y)
+{
+	double dx, dy;
+
+	y -= f->ref * x;
+	f->n++;
+	dx = x - f->mean_x;
+	f->mean_x += dx / f->n;
+	dy = y - f->mean_y;
+	f->mean_y += dy / f->n;
+	f->m2x += dx * (x - f->mean_x);
+	f->m2y += dy * (y - f->mean_y);
+	f->cxy += dx * (y - f->mean_y);
+}
+
+static double fit_slope(const struct fit *f)
+{
+	return f->ref + (f->m2x > 0.0 ? f->cxy / f->m2x : 0.0);
+}
+
+/* RMS distance of the points from the fitted line */
+static double fit_rms(const struct fit *f)
+{
+	double ss;
+
+	if (f->n < 3 || f->m2x <= 0.0)
+		return 0.0;
+	ss = f->m2y - f->cxy * f->cxy / f->m2x;
+	return ss > 0.0 ? sqrt(ss / f->n) : 0.0;
+}
+
+/*
+ * Per stream analysis
+ */
+
+static struct stream *stream_find(struct analyzer *a, uint64_t id)
+{
+	uint64_t h = id * 0x9e3779b97f4a7c15ULL;
+	unsigned int i = (unsigned int)(h >> 40) & (MAX_STREAMS - 1);
+	unsigned int probes;
+
+	for (probes = 0; probes < MAX_STREAMS; probes++) {
+		struct stream *s = &a->streams[i];
+
+		if (s->used && s->id == id)
+			return s;
+		if (!s->used) {
+			/* keep some room so probing stays short */
+			if (a->nstreams >= MAX_STREAMS / 2)
+				return NULL;
+			memset(s, 0, sizeof *s);
+			s->used = 1;
+			s->id = id;
+			s->interval_min = INFINITY;
+			s->interval_max = -INFINITY;
+			s->by_time.ref = 1.0;
+			a->nstreams++;
+			return s;
+		}
+		i = (i + 1) & (MAX_STREAMS - 1);
+	}
+	return NULL;
+}
+
+static int cmp_double(const void *pa, const void *pb)
+{
+	double a = *(const double *)pa, b = *(const double *)pb;
+
+	return (a > b) - (a < b);
+}
+
+static void hist_add(struct analyzer *a, struct stream *s, double interval)
+{
+	double bin = floor((interval - s->ref_interval) / a->bin_ns) +
+	    HIST_BINS / 2;
+
+	if (bin < 0)
+		s->hist_under++;
+	else if (bin >= HIST_BINS)
+		s->hist_over++;
+	else
+		s->hist[(int)bin]++;
+}
+
+static void stream_interval(struct analyzer *a, struct stream *s,
+			    double interval)
+{
+	int i;
+
+	if (interval < s->interval_min)
+		s->interval_min = interval;
+	if (interval > s->interval_max)
+		s->interval_max = interval;
+
+	if (s->warmup < WARMUP_INTERVALS) {
+		s->warmup_interval[s->warmup++] = interval;
+		if (s->warmup < WARMUP_INTERVALS)
+			return;
+
+		/* the median of the first intervals is the reference, so a
+		 * startup glitch does not shift the whole histogram */
+		double sorted[WARMUP_INTERVALS];
+
+		memcpy(sorted, s->warmup_interval, sizeof sorted);
+		qsort(sorted, WARMUP_INTERVALS, sizeof sorted[0], cmp_double);
+		s->ref_interval = sorted[WARMUP_INTERVALS / 2];
+		for (i = 0; i < WARMUP_INTERVALS; i++)
+			hist_add(a, s, s->warmup_interval[i]);
+		return;
+	}
+	hist_add(a, s, interval);
+}
+
+static void avtp_frame(struct analyzer *a, const uint8_t *dst,
+		       const uint8_t *pdu, uint32_t len, uint64_t cap_ns)
+{
+	struct stream *s;
+	uint64_t id;
+	uint8_t seq;
+
+	if (len < AVTP_HDR_LEN)
+		return;
+	/* stream data only: control bit clear and stream ID valid */
+	if ((pdu[0] & 0x80) || !(pdu[1] & 0x80))
+		return;
+
+	a->avtp_frames++;
+	memcpy(&id, pdu + 4, sizeof id);
+	s = stream_find(a, id);
+	if (!s) {
+		a->dropped_streams++;
+		return;
+	}
+	if (s->packets == 0) {
+		memcpy(s->dst, dst, sizeof s->dst);
+		s->subtype = pdu[0];
+		s->first_cap_ns = cap_ns;
+	}
+	s->packets++;
+	s->bytes += len;
+	s->last_cap_ns = cap_ns;
+
+	seq = pdu[2];
+	if (!s->have_seq) {
+		s->have_seq = 1;
+	} else {
+		uint8_t delta = seq - s->last_seq;
+
+		if (delta == 0 || delta > 128) {
+			/* repeated or late packet; leave the sequence alone */
+			s->seq_dups++;
+			return;
+		}
+		if (delta > 1) {
+			s->seq_gaps++;
+			s->seq_lost += delta - 1;
+		}
+		s->seq_index += delta;
+	}
+	s->last_seq = seq;
+
+	if (!(pdu[1] & 0x01))
+		return;
+	s->tv_packets++;
+	if (pdu[3] & 0x01)
+		s->tu_packets++;
+
+	uint32_t ts = ntohl(*(const uint32_t *)(pdu + 12));
+
+	if (!s->have_ts) {
+		s->have_ts = 1;
+		s->ts = 0;
+	} else {
+		/* 32 bit nanoseconds wrap every 4.3 s */
+		double interval = (double)(int32_t)(ts - s->last_ts) /
+		    (double)(s->seq_index - s->last_ts_index);
+
+		s->ts += (int32_t)(ts - s->last_ts);
+		if (s->by_index.n == 1)
+			s->by_index.ref = interval;
+		stream_interval(a, s, interval);
+	}
+	s->last_ts = ts;
+	s->last_ts_index = s->seq_index;
+
+	fit_add(&s->by_index, (double)s->seq_index, (double)s->ts);
+	fit_add(&s->by_time, (double)(cap_ns - s->first_cap_ns),
+		(double)s->ts);
+
+	if (a->csv)
+		fprintf(a->csv, "%016llx,%llu,%llu,%lld\n",
+			(unsigned long long)be64toh(s->id),
+			(unsigned long long)s->seq_index,
+			(unsigned long long)(cap_ns - s->first_cap_ns),
+			(long long)s->ts);
+}
+
+/* Ethernet frame, with or without an 802.1Q tag */
+static void eth_frame(struct analyzer *a, const uint8_t *frame,
+		      uint32_t len, uint64_t cap_ns)
+{
+	uint32_t off = 12;
+	uint16_t type;
+
+	a->frames++;
+	if (len < off + 2)
+		return;
+	type = (frame[off] << 8) | frame[off + 1];
+	if (type == ETHERTYPE_VLAN) {
+		off += 4;
+		if (len < off + 2)
+			return;
+		type = (frame[off] << 8) | frame[off + 1];
+	}
+	if (type != ETHERTYPE_AVTP)
+		return;
+	off += 2;
+	avtp_frame(a, frame, frame + off, len - off, cap_ns);
+}
+
+/*
+ * Report
+ */
+
+static int cmp_stream(const void *pa, const void *pb)
+{
+	const struct stream *a = pa, *b = pb;
+	uint64_t ia = be64toh(a->id), ib = be64toh(b->id);
+
+	if (a->used != b->used)
+		return b->used - a->used;
+	return (ia > ib) - (ia < ib);
+}
+
+static void report(struct analyzer *a, FILE *out)
+{
+	static struct stream sorted[MAX_STREAMS];
+	int i, j;
+
+	memcpy(sorted, a->streams, sizeof sorted);
+	qsort(sorted, MAX_STREAMS, sizeof sorted[0], cmp_stream);
+
+	fprintf(out, "%llu frames, %llu AVTP stream frames, %d streams\n",
+		(unsigned long long)a->frames,
+		(unsigned long long)a->avtp_frames, a->nstreams);
+	if (a->dropped_streams)
+		fprintf(out, "%llu frames of streams beyond the first %d not analyzed\n",
+			(unsigned long long)a->dropped_streams, MAX_STREAMS / 2);
+
+	fprintf(out, "%-16s %-17s %4s %9s %9s %6s %6s %6s %12s %9s %9s %9s %10s\n",
+		"stream_id", "dest", "subt", "packets", "ts_valid", "gaps",
+		"lost", "dups", "interval_ns", "min_ns", "max_ns", "rms_ns",
+		"drift_ppm");
+	for (i = 0; i < a->nstreams; i++) {
+		struct stream *s = &sorted[i];
+
+		fprintf(out, "%016llx %02x:%02x:%02x:%02x:%02x:%02x %4x %9llu %9llu %6llu %6llu %6llu ",
+			(unsigned long long)be64toh(s->id),
+			s->dst[0], s->dst[1], s->dst[2], s->dst[3], s->dst[4],
+			s->dst[5], s->subtype, (unsigned long long)s->packets,
+			(unsigned long long)s->tv_packets,
+			(unsigned long long)s->seq_gaps,
+			(unsigned long long)s->seq_lost,
+			(unsigned long long)s->seq_dups);
+		if (s->by_index.n < 2) {
+			fprintf(out, "%12s %9s %9s %9s %10s\n", "-", "-", "-",
+				"-", "-");
+			continue;
+		}
+		fprintf(out, "%12.3f %9.0f %9.0f %9.1f %10.3f\n",
+			fit_slope(&s->by_index), s->interval_min,
+			s->interval_max, fit_rms(&s->by_index),
+			(fit_slope(&s->by_time) - 1.0) * 1e6);
+	}
+
+	if (!a->verbose)
+		return;
+
+	for (i = 0; i < a->nstreams; i++) {
+		struct stream *s = &sorted[i];
+
+		if (s->warmup < WARMUP_INTERVALS)
+			continue;
+		fprintf(out, "\n%016llx interval histogram, %.0f ns bins relative to %.0f ns",
+			(unsigned long long)be64toh(s->id), a->bin_ns,
+			s->ref_interval);
+		if (s->tu_packets)
+			fprintf(out, ", %llu timestamps uncertain",
+				(unsigned long long)s->tu_packets);
+		fprintf(out, "\n");
+		if (s->hist_under)
+			fprintf(out, "  %8s .. %+8.0f ns: %llu\n", "",
+				-(HIST_BINS / 2) * a->bin_ns,
+				(unsigned long long)s->hist_under);
+		for (j = 0; j < HIST_BINS; j++) {
+			if (!s->hist[j])
+				continue;
+			fprintf(out, "  %+8.0f .. %+8.0f ns: %llu\n",
+				(j - HIST_BINS / 2) * a->bin_ns,
+				(j - HIST_BINS / 2 + 1) * a->bin_ns,
+				(unsigned long long)s->hist[j]);
+		}
+		if (s->hist_over)
+			fprintf(out, "  %+8.0f .. %8s ns: %llu\n",
+				(HIST_BINS / 2) * a->bin_ns, "",
+				(unsigned long long)s->hist_over);
+	}
+}
+
+/*
+ * Capture file
+ */
+
+struct pcap_hdr {
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+};
+
+struct pcap_rec {
+	uint32_t ts_sec;
+	uint32_t ts_frac;
+	uint32_t incl_len;
+	uint32_t orig_len;
+};
+
+static int read_pcap(struct analyzer *a, const char *path)
+{
+	const struct pcap_hdr *hdr;
+	const uint8_t *base, *p, *end;
+	uint32_t frac_ns;
+	int swapped;
+	struct stat st;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	if ((size_t)st.st_size < sizeof *hdr) {
+		fprintf(stderr, "%s: not a capture file\n", path);
+		close(fd);
+		return -1;
+	}
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	madvise((void *)base, st.st_size, MADV_SEQUENTIAL);
+
+	hdr = (const struct pcap_hdr *)base;
+	swapped = 0;
+	switch (hdr->magic) {
+	case PCAP_MAGIC_USEC:
+		frac_ns = 1000;
+		break;
+	case PCAP_MAGIC_NSEC:
+		frac_ns = 1;
+		break;
+	default:
+		swapped = 1;
+		if (__builtin_bswap32(hdr->magic) == PCAP_MAGIC_USEC) {
+			frac_ns = 1000;
+		} else if (__builtin_bswap32(hdr->magic) == PCAP_MAGIC_NSEC) {
+			frac_ns = 1;
+		} else {
+			fprintf(stderr, "%s: not a libpcap capture file (pcapng files can be converted with editcap -F pcap)\n",
+				path);
+			munmap((void *)base, st.st_size);
+			return -1;
+		}
+	}
+#define PCAP32(v) (swapped ? __builtin_bswap32(v) : (v))
+	if (PCAP32(hdr->linktype) != PCAP_LINKTYPE_ETHERNET) {
+		fprintf(stderr, "%s: link type %u is not Ethernet\n", path,
+			PCAP32(hdr->linktype));
+		munmap((void *)base, st.st_size);
+		return -1;
+	}
+
+	p = base + sizeof *hdr;
+	end = base + st.st_size;
+	while (p + sizeof(struct pcap_rec) <= end) {
+		const struct pcap_rec *rec = (const struct pcap_rec *)p;
+		uint32_t len = PCAP32(rec->incl_len);
+
+		p += sizeof *rec;
+		if (p + len > end) {
+			fprintf(stderr, "%s: truncated at the last packet\n",
+				path);
+			break;
+		}
+		eth_frame(a, p, len,
+			  (uint64_t)PCAP32(rec->ts_sec) * 1000000000ULL +
+			  (uint64_t)PCAP32(rec->ts_frac) * frac_ns);
+		p += len;
+	}
+#undef PCAP32
+
+	munmap((void *)base, st.st_size);
+	return 0;
+}
+
+/*
+ * Live capture
+ */
+
+static int read_live(struct analyzer *a, const char *ifname,
+		     unsigned int seconds, unsigned int report_sec)
+{
+	struct tpacket_req3 req;
+	struct tpacket_stats_v3 stats;
+	struct sockaddr_ll sll;
+	socklen_t slen;
+	uint64_t end_ns, next_report_ns;
+	unsigned int block = 0;
+	int version = TPACKET_V3;
+	uint8_t *ring;
+	int fd;
+
+	fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+	if (fd < 0) {
+		fprintf(stderr, "socket: %s\n", strerror(errno));
+		return -1;
+	}
+	memset(&req, 0, sizeof req);
+	req.tp_block_size = RING_BLOCK_SIZE;
+	req.tp_block_nr = RING_BLOCK_NR;
+	req.tp_frame_size = RING_FRAME_SIZE;
+	req.tp_frame_nr = RING_BLOCK_SIZE / RING_FRAME_SIZE * RING_BLOCK_NR;
+	req.tp_retire_blk_tov = RING_BLOCK_TOV_MS;
+	if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version,
+		       sizeof version) < 0 ||
+	    setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof req) < 0) {
+		fprintf(stderr, "packet ring: %s\n", strerror(errno));
+		close(fd);
+		return -1;
+	}
+	ring = mmap(NULL, (size_t)RING_BLOCK_SIZE * RING_BLOCK_NR,
+		    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, fd, 0);
+	if (ring == MAP_FAILED)
+		ring = mmap(NULL, (size_t)RING_BLOCK_SIZE * RING_BLOCK_NR,
+			    PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (ring == MAP_FAILED) {
+		fprintf(stderr, "mmap: %s\n", strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	memset(&sll, 0, sizeof sll);
+	sll.sll_family = AF_PACKET;
+	sll.sll_protocol = htons(ETH_P_ALL);
+	sll.sll_ifindex = if_nametoindex(ifname);
+	if (sll.sll_ifindex == 0 ||
+	    bind(fd, (struct sockaddr *)&sll, sizeof sll) < 0) {
+		fprintf(stderr, "%s: %s\n", ifname, strerror(errno));
+		munmap(ring, (size_t)RING_BLOCK_SIZE * RING_BLOCK_NR);
+		close(fd);
+		return -1;
+	}
+
+	end_ns = seconds ? now_ns() + seconds * 1000000000ULL : 0;
+	next_report_ns = now_ns() + report_sec * 1000000000ULL;
+	while (!stop) {
+		struct tpacket_block_desc *bd = (struct tpacket_block_desc *)
+		    (ring + (size_t)block * RING_BLOCK_SIZE);
+
+		if (!(bd->hdr.bh1.block_status & TP_STATUS_USER)) {
+			struct pollfd pfd = { .fd = fd, .events = POLLIN };
+
+			poll(&pfd, 1, 100);
+		} else {
+			struct tpacket3_hdr *ph = (struct tpacket3_hdr *)
+			    ((uint8_t *)bd + bd->hdr.bh1.offset_to_first_pkt);
+			uint32_t i;
+
+			for (i = 0; i < bd->hdr.bh1.num_pkts; i++) {
+				/* the kernel strips the VLAN tag into the
+				 * header, the frame is untagged here */
+				eth_frame(a, (uint8_t *)ph + ph->tp_mac,
+					  ph->tp_snaplen,
+					  (uint64_t)ph->tp_sec * 1000000000ULL +
+					  ph->tp_nsec);
+				ph = (struct tpacket3_hdr *)((uint8_t *)ph +
+							     ph->tp_next_offset);
+			}
+			__sync_synchronize();
+			bd->hdr.bh1.block_status = TP_STATUS_KERNEL;
+			block = (block + 1) % RING_BLOCK_NR;
+		}
+
+		if (end_ns || report_sec) {
+			uint64_t now = now_ns();
+
+			if (end_ns && now >= end_ns)
+				break;
+			if (report_sec && now >= next_report_ns) {
+				report(a, stdout);
+				printf("\n");
+				fflush(stdout);
+				next_report_ns += report_sec * 1000000000ULL;
+			}
+		}
+	}
+
+	slen = sizeof stats;
+	if (getsockopt(fd, SOL_PACKET, PACKET_STATISTICS, &stats, &slen) == 0)
+		printf("kernel: %u packets, %u dropped\n", stats.tp_packets,
+		       stats.tp_drops);
+
+	munmap(ring, (size_t)RING_BLOCK_SIZE * RING_BLOCK_NR);
+	close(fd);
+	return 0;
+}
+
+/*
+ * Synthetic capture
+ */
+
+struct gen_stream {
+	double ppm;
+	int vlan;
+	int sparse;
+	uint64_t seq;
+	double next_ns;
+};
+
+#define GEN_STREAMS		24
+#define GEN_SECONDS		5
+#define GEN_INTERVAL_NS		125000.0
+#define GEN_JITTER_NS		400.0
+#define GEN_LOSS_EVERY		2000
+#define GEN_TRANSIT_NS		2000000
+#define GEN_FRAME_LEN		(14 + 4 + AVTP_HDR_LEN + 48)
+
+static double gen_ppm(int i)
+{
+	return (i % 7 - 3) * 12.5;
+}
+
+static uint64_t gen_rng = 0x853c49e6748fea9bULL;
+
+static double gen_random(void)
+{
+	gen_rng ^= gen_rng >> 12;
+	gen_rng ^= gen_rng << 25;
+	gen_rng ^= gen_rng >> 27;
+	return (double)((gen_rng * 2685821657736338717ULL) >> 11) /
+	    (double)(1ULL << 53);
+}
+
+/*
+ * Class A streams at 8000 packets per second, interleaved in capture time
+ * order. Stream i runs (i % 7 - 3) * 12.5 ppm off the capture clock, has
+ * GEN_JITTER_NS of uniform jitter on its presentation times and loses
+ * every GEN_LOSS_EVERY-th packet. Odd streams are VLAN tagged and every
+ * fourth stream only sets a timestamp on every 8th packet.
+ */
+static int generate(const char *path, uint64_t *packets)
+{
+	struct gen_stream gs[GEN_STREAMS];
+	uint8_t frame[GEN_FRAME_LEN];
+	struct pcap_hdr hdr;
+	uint64_t count = 0;
+	FILE *f;
+	int i;
+
+	f = fopen(path, "wb");
+	if (!f) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	setvbuf(f, NULL, _IOFBF, 1 << 20);
+
+	memset(&hdr, 0, sizeof hdr);
+	hdr.magic = PCAP_MAGIC_NSEC;
+	hdr.version_major = 2;
+	hdr.version_minor = 4;
+	hdr.snaplen = 65535;
+	hdr.linktype = PCAP_LINKTYPE_ETHERNET;
+	fwrite(&hdr, sizeof hdr, 1, f);
+
+	for (i = 0; i < GEN_STREAMS; i++) {
+		gs[i].ppm = gen_ppm(i);
+		gs[i].vlan = i & 1;
+		gs[i].sparse = (i % 4) == 0;
+		gs[i].seq = 0;
+		gs[i].next_ns = 1000000000.0 + i * (GEN_INTERVAL_NS / GEN_STREAMS);
+	}
+
+	for (;;) {
+		struct gen_stream *g;
+		struct pcap_rec rec;
+		uint64_t cap_ns, pt;
+		int n = 0, off = 12;
+		uint64_t k;
+
+		for (i = 1; i < GEN_STREAMS; i++)
+			if (gs[i].next_ns < gs[n].next_ns)
+				n = i;
+		g = &gs[n];
+		if (g->next_ns >= 1000000000.0 * (1 + GEN_SECONDS))
+			break;
+		cap_ns = (uint64_t)g->next_ns;
+		g->next_ns += GEN_INTERVAL_NS;
+
+		k = g->seq++;
+		if (k % GEN_LOSS_EVERY == GEN_LOSS_EVERY - 1)
+			continue;
+
+		/* the talker clock runs ppm fast against the capture clock */
+		pt = (uint64_t)((double)cap_ns * (1.0 + g->ppm * 1e-6) +
+				GEN_TRANSIT_NS +
+				(gen_random() - 0.5) * GEN_JITTER_NS);
+
+		memset(frame, 0, sizeof frame);
+		frame[0] = 0x91;
+		frame[1] = 0xe0;
+		frame[2] = 0xf0;
+		frame[5] = n;
+		frame[6] = 0x02;
+		frame[11] = n;
+		if (g->vlan) {
+			frame[off++] = 0x81;
+			frame[off++] = 0x00;
+			frame[off++] = 0x60;
+			frame[off++] = 0x02;
+		}
+		frame[off++] = 0x22;
+		frame[off++] = 0xf0;
+		frame[off + 0] = 0x02;	/* AAF */
+		frame[off + 1] = 0x80;	/* sv */
+		if (!g->sparse || (k % 8) == 0)
+			frame[off + 1] |= 0x01;	/* tv */
+		frame[off + 2] = (uint8_t)k;
+		frame[off + 4] = 0x02;
+		frame[off + 9] = 0x02;
+		frame[off + 11] = n;
+		*(uint32_t *)(frame + off + 12) = htonl((uint32_t)pt);
+		*(uint16_t *)(frame + off + 20) = htons(48);
+
+		rec.ts_sec = cap_ns / 1000000000ULL;
+		rec.ts_frac = cap_ns % 1000000000ULL;
+		rec.incl_len = rec.orig_len = off + AVTP_HDR_LEN + 48;
+		fwrite(&rec, sizeof rec, 1, f);
+		fwrite(frame, rec.incl_len, 1, f);
+		count++;
+	}
+
+	if (fclose(f) != 0) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	if (packets)
+		*packets = count;
+	return 0;
+}
+
+/* Analyze a synthetic capture and compare with what it was made with */
+static int self_test(struct analyzer *a)
+{
+	char path[] = "/tmp/avtp_timing_XXXXXX";
+	uint64_t packets, start, elapsed;
+	int i, fd, errors = 0;
+
+	fd = mkstemp(path);
+	if (fd < 0) {
+		fprintf(stderr, "mkstemp: %s\n", strerror(errno));
+		return 1;
+	}
+	close(fd);
+	if (generate(path, &packets) < 0) {
+		unlink(path);
+		return 1;
+	}
+
+	start = now_ns();
+	if (read_pcap(a, path) < 0) {
+		unlink(path);
+		return 1;
+	}
+	elapsed = now_ns() - start;
+	unlink(path);
+	report(a, stdout);
+
+	printf("\n%llu packets analyzed in %.3f s, %.0f packets/s\n",
+	       (unsigned long long)packets, elapsed / 1e9,
+	       packets / (elapsed / 1e9));
+
+	if (a->nstreams != GEN_STREAMS || a->avtp_frames != packets) {
+		printf("FAIL: %d streams and %llu packets found\n",
+		       a->nstreams, (unsigned long long)a->avtp_frames);
+		return 1;
+	}
+	for (i = 0; i < MAX_STREAMS; i++) {
+		struct stream *s = &a->streams[i];
+		uint64_t sent = GEN_SECONDS * (uint64_t)(1e9 / GEN_INTERVAL_NS);
+		int n;
+		double interval, ppm, rms;
+
+		if (!s->used)
+			continue;
+		n = be64toh(s->id) & 0xff;
+		interval = fit_slope(&s->by_index);
+		ppm = (fit_slope(&s->by_time) - 1.0) * 1e6;
+		rms = fit_rms(&s->by_index);
+
+		/* lost packets are the ones between the first and last seen */
+		if (s->seq_lost != (sent - 1) / GEN_LOSS_EVERY ||
+		    s->seq_gaps != s->seq_lost || s->seq_dups != 0) {
+			printf("FAIL: stream %d lost %llu in %llu gaps\n", n,
+			       (unsigned long long)s->seq_lost,
+			       (unsigned long long)s->seq_gaps);
+			errors++;
+		}
+		if (fabs(ppm - gen_ppm(n)) > 0.05) {
+			printf("FAIL: stream %d drift %.3f ppm, made with %.3f\n",
+			       n, ppm, gen_ppm(n));
+			errors++;
+		}
+		if (fabs(interval - GEN_INTERVAL_NS * (1.0 + gen_ppm(n) * 1e-6)) > 0.05) {
+			printf("FAIL: stream %d interval %.3f ns\n", n,
+			       interval);
+			errors++;
+		}
+		/* uniform jitter of width J has an RMS of J / sqrt(12) */
+		if (fabs(rms - GEN_JITTER_NS / sqrt(12.0)) > GEN_JITTER_NS * 0.05) {
+			printf("FAIL: stream %d rms deviation %.1f ns\n", n,
+			       rms);
+			errors++;
+		}
+		if (s->interval_max - s->interval_min > 2 * GEN_JITTER_NS + 1000) {
+			printf("FAIL: stream %d interval range %.0f .. %.0f ns\n",
+			       n, s->interval_min, s->interval_max);
+			errors++;
+		}
+	}
+
+	printf("%s\n", errors ? "FAIL" : "PASS");
+	return errors ? 1 : 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: avtp_timing [options] capture.pcap\n"
+		"       avtp_timing [options] -i ifname\n"
+		"       avtp_timing -g out.pcap\n"
+		"       avtp_timing -T\n"
+		"\n"
+		"  -i ifname  capture live from a network interface (needs CAP_NET_RAW)\n"
+		"  -d sec     stop a live capture after this many seconds (default: on Ctrl-C)\n"
+		"  -r sec     report every sec seconds during a live capture\n"
+		"  -b ns      interval histogram bin width (default 100 ns)\n"
+		"  -v         print the interval histograms\n"
+		"  -w file    write stream_id,seq_index,capture_ns,avtp_ns of every\n"
+		"             timestamp to a csv file, for plotting\n"
+		"  -g file    write a synthetic capture of %d streams and exit\n"
+		"  -T         analyze a synthetic capture and check the results\n",
+		GEN_STREAMS);
+}
+
+int main(int argc, char **argv)
+{
+	static struct analyzer a;
+	const char *ifname = NULL, *csv = NULL, *gen = NULL;
+	unsigned int seconds = 0, report_sec = 0;
+	int test = 0, c, ret;
+
+	a.bin_ns = 100.0;
+	while ((c = getopt(argc, argv, "i:d:r:b:vw:g:Th")) != -1) {
+		switch (c) {
+		case 'i':
+			ifname = optarg;
+			break;
+		case 'd':
+			seconds = strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			report_sec = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			a.bin_ns = strtod(optarg, NULL);
+			if (a.bin_ns <= 0.0) {
+				usage();
+				return 2;
+			}
+			break;
+		case 'v':
+			a.verbose = 1;
+			break;
+		case 'w':
+			csv = optarg;
+			break;
+		case 'g':
+			gen = optarg;
+			break;
+		case 'T':
+			test = 1;
+			break;
+		default:
+			usage();
+			return 2;
+		}
+	}
+
+	if (gen)
+		return generate(gen, NULL) < 0 ? 1 : 0;
+	if (test)
+		return self_test(&a);
+	if (!ifname && optind != argc - 1) {
+		usage();
+		return 2;
+	}
+
+	if (csv) {
+		a.csv = fopen(csv, "w");
+		if (!a.csv) {
+			fprintf(stderr, "%s: %s\n", csv, strerror(errno));
+			return 1;
+		}
+		fprintf(a.csv, "stream_id,seq_index,capture_ns,avtp_ns\n");
+	}
+
+	if (ifname) {
+		signal(SIGINT, on_signal);
+		signal(SIGTERM, on_signal);
+		ret = read_live(&a, ifname, seconds, report_sec);
+	} else {
+		ret = read_pcap(&a, argv[optind]);
+	}
+	if (ret == 0)
+		report(&a, stdout);
+
+	if (a.csv)
+		fclose(a.csv);
+	return ret < 0 ? 1 : 0;
+}